@@ -0,0 +1,21 @@
+#include "cpp_cases.h"
+
+#include <opentracing-c/opentracing.hpp>
+
+void bench_cpp_span_lifecycle(opentracing_tracer* tracer, long iterations)
+{
+    opentracingc::Tracer t(tracer);
+    for (long i = 0; i < iterations; i++) {
+        opentracingc::Span span = t.start_span("lifecycle");
+    }
+}
+
+void bench_cpp_set_tag_string(opentracing_span* span, int iterations)
+{
+    /* The caller keeps ownership. */
+    opentracingc::Span s(span);
+    for (int i = 0; i < iterations; i++) {
+        s.set_tag("key", "value");
+    }
+    s.release();
+}
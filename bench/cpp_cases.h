@@ -0,0 +1,21 @@
+#ifndef OPENTRACINGC_BENCH_CPP_CASES_H
+#define OPENTRACINGC_BENCH_CPP_CASES_H
+
+#include <opentracing-c/tracer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Loops of the C cases of the same name, written with opentracing.hpp, to
+ * check the bindings cost nothing over hand-written C.
+ */
+void bench_cpp_span_lifecycle(opentracing_tracer* tracer, long iterations);
+void bench_cpp_set_tag_string(opentracing_span* span, int iterations);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_BENCH_CPP_CASES_H */
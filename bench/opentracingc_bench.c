@@ -0,0 +1,1438 @@
+#include <assert.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/continuation.h>
+#include <opentracing-c/dynamic_load.h>
+#include <opentracing-c/header_codec.h>
+#include <opentracing-c/sampler.h>
+#include <opentracing-c/scope_manager.h>
+#include <opentracing-c/socket_reporter.h>
+#include <opentracing-c/span_batch.h>
+#include <opentracing-c/tracer.h>
+
+#include "cpp_cases.h"
+
+/*
+ * Microbenchmarks for the span lifecycle. Every case runs against each tracer
+ * and reports nanoseconds and heap allocations per operation as JSON, e.g.
+ *
+ *     opentracingc_bench --iterations 1000000 > results.json
+ *     opentracingc_bench --library libvendor.so --config '{...}'
+ */
+
+#define DEFAULT_ITERATIONS 1000000L
+#define CHUNK_SIZE 64
+
+/* Allocation counting. */
+
+static unsigned long num_allocations = 0;
+
+#if defined(__GLIBC__)
+
+#define HAVE_ALLOCATION_COUNTING 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t num, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+    __atomic_fetch_add(&num_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size)
+{
+    __atomic_fetch_add(&num_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    __atomic_fetch_add(&num_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+#else
+
+#define HAVE_ALLOCATION_COUNTING 0
+
+#endif /* defined(__GLIBC__) */
+
+static unsigned long allocation_count(void)
+{
+    return __atomic_load_n(&num_allocations, __ATOMIC_RELAXED);
+}
+
+/* Timing. */
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+typedef struct bench_context {
+    opentracing_tracer* tracer;
+    opentracing_span* parent;
+    double elapsed_ns;
+    unsigned long allocations;
+    long num_ops;
+    double start_ns;
+    unsigned long start_allocations;
+} bench_context;
+
+static void bench_start(bench_context* ctx)
+{
+    ctx->start_allocations = allocation_count();
+    ctx->start_ns = now_ns();
+}
+
+static void bench_stop(bench_context* ctx, long num_ops)
+{
+    ctx->elapsed_ns += now_ns() - ctx->start_ns;
+    ctx->allocations += allocation_count() - ctx->start_allocations;
+    ctx->num_ops += num_ops;
+}
+
+static void destroy_span(opentracing_span* span)
+{
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+}
+
+static void finish_and_destroy(opentracing_span* span)
+{
+    span->finish(span);
+    destroy_span(span);
+}
+
+/* Cases. */
+
+static void bench_span_lifecycle(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    long i;
+
+    tracer = ctx->tracer;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        span = tracer->start_span(tracer, "lifecycle");
+        span->finish(span);
+        destroy_span(span);
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_start_span(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* spans[CHUNK_SIZE];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i] = tracer->start_span(tracer, "start_span");
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            finish_and_destroy(spans[i]);
+        }
+    }
+}
+
+static void bench_start_span_interned(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* spans[CHUNK_SIZE];
+    opentracing_string_handle operation_name;
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    operation_name = opentracing_intern("start_span");
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i] = opentracing_tracer_start_span_interned(
+                tracer, operation_name, NULL);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            finish_and_destroy(spans[i]);
+        }
+    }
+}
+
+static void bench_start_span_with_options(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* spans[CHUNK_SIZE];
+    opentracing_start_span_options options;
+    opentracing_span_reference refs[2];
+    opentracing_span_context* parent_context;
+    opentracing_tag tags[4];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    parent_context = ctx->parent->span_context(ctx->parent);
+    refs[0].type = opentracing_span_reference_child_of;
+    refs[0].referenced_context = parent_context;
+    refs[1].type = opentracing_span_reference_follows_from;
+    refs[1].referenced_context = parent_context;
+    tags[0].key = "component";
+    tags[0].value.type = opentracing_value_string;
+    tags[0].value.value.string_value = "bench";
+    tags[1].key = "http.status_code";
+    tags[1].value.type = opentracing_value_int64;
+    tags[1].value.value.int64_value = 200;
+    tags[2].key = "error";
+    tags[2].value.type = opentracing_value_bool;
+    tags[2].value.value.bool_value = opentracing_false;
+    tags[3].key = "sampling.priority";
+    tags[3].value.type = opentracing_value_uint64;
+    tags[3].value.value.uint64_value = 1;
+    memset(&options, 0, sizeof(options));
+    options.references = refs;
+    options.num_references = 2;
+    options.tags = tags;
+    options.num_tags = 4;
+
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i] = tracer->start_span_with_options(
+                tracer, "start_span_with_options", &options);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            finish_and_destroy(spans[i]);
+        }
+    }
+}
+
+static void
+bench_set_tag(bench_context* ctx, long iterations, const opentracing_value* v)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "set_tag");
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            span->set_tag(span, "key", v);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+}
+
+#define BENCH_SET_TAG(suffix, value_type, member, member_value)            \
+    static void bench_set_tag_##suffix(bench_context* ctx, long iterations) \
+    {                                                                       \
+        opentracing_value value;                                            \
+        value.type = value_type;                                            \
+        value.value.member = member_value;                                  \
+        bench_set_tag(ctx, iterations, &value);                             \
+    }
+
+BENCH_SET_TAG(bool, opentracing_value_bool, bool_value, opentracing_true)
+BENCH_SET_TAG(double, opentracing_value_double, double_value, 1.5)
+BENCH_SET_TAG(int64, opentracing_value_int64, int64_value, -42)
+BENCH_SET_TAG(uint64, opentracing_value_uint64, uint64_value, 42)
+BENCH_SET_TAG(string, opentracing_value_string, string_value, "value")
+BENCH_SET_TAG(null, opentracing_value_null, string_value, NULL)
+
+#undef BENCH_SET_TAG
+
+/* Tag value taken from the middle of a larger buffer. */
+static void bench_set_tag_string_view(bench_context* ctx, long iterations)
+{
+    static const char request[] = "GET /index.html HTTP/1.1";
+    opentracing_value value;
+
+    value.type = opentracing_value_string_view;
+    value.value.string_view_value.data = request + 4;
+    value.value.string_view_value.length = 11;
+    bench_set_tag(ctx, iterations, &value);
+}
+
+/* The same cases through the C++ bindings. */
+
+static void bench_span_lifecycle_cpp(bench_context* ctx, long iterations)
+{
+    bench_start(ctx);
+    bench_cpp_span_lifecycle(ctx->tracer, iterations);
+    bench_stop(ctx, iterations);
+}
+
+static void bench_set_tag_string_cpp(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    long done;
+
+    tracer = ctx->tracer;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "set_tag");
+        bench_start(ctx);
+        bench_cpp_set_tag_string(span, CHUNK_SIZE);
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+}
+
+#define NUM_BATCH_TAGS 16
+
+static void init_batch_tags(opentracing_tag* tags, char (*keys)[16])
+{
+    int i;
+    for (i = 0; i < NUM_BATCH_TAGS; i++) {
+        sprintf(keys[i], "tag.%d", i);
+        tags[i].key = keys[i];
+        tags[i].value.type = opentracing_value_int64;
+        tags[i].value.value.int64_value = i;
+    }
+}
+
+/* Baseline for set_tags: the same tags through individual set_tag calls. */
+static void bench_set_tag_loop(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_tag tags[NUM_BATCH_TAGS];
+    char keys[NUM_BATCH_TAGS][16];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    init_batch_tags(tags, keys);
+    for (done = 0; done < iterations; done += NUM_BATCH_TAGS) {
+        span = tracer->start_span(tracer, "set_tag_loop");
+        bench_start(ctx);
+        for (i = 0; i < NUM_BATCH_TAGS; i++) {
+            span->set_tag(span, tags[i].key, &tags[i].value);
+        }
+        bench_stop(ctx, NUM_BATCH_TAGS);
+        finish_and_destroy(span);
+    }
+}
+
+static void bench_set_tags(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_tag tags[NUM_BATCH_TAGS];
+    char keys[NUM_BATCH_TAGS][16];
+    long done;
+
+    tracer = ctx->tracer;
+    init_batch_tags(tags, keys);
+    for (done = 0; done < iterations; done += NUM_BATCH_TAGS) {
+        span = tracer->start_span(tracer, "set_tags");
+        bench_start(ctx);
+        opentracing_span_set_tags(span, tags, NUM_BATCH_TAGS);
+        bench_stop(ctx, NUM_BATCH_TAGS);
+        finish_and_destroy(span);
+    }
+}
+
+/* Same tags as set_tag_loop with keys interned up front. */
+static void bench_set_tag_interned(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_tag tags[NUM_BATCH_TAGS];
+    opentracing_string_handle handles[NUM_BATCH_TAGS];
+    char keys[NUM_BATCH_TAGS][16];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    init_batch_tags(tags, keys);
+    for (i = 0; i < NUM_BATCH_TAGS; i++) {
+        handles[i] = opentracing_intern(tags[i].key);
+    }
+    for (done = 0; done < iterations; done += NUM_BATCH_TAGS) {
+        span = tracer->start_span(tracer, "set_tag_interned");
+        bench_start(ctx);
+        for (i = 0; i < NUM_BATCH_TAGS; i++) {
+            opentracing_span_set_tag_interned(
+                span, handles[i], &tags[i].value);
+        }
+        bench_stop(ctx, NUM_BATCH_TAGS);
+        finish_and_destroy(span);
+    }
+}
+
+static void bench_log_fields(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_log_field fields[3];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    fields[0].key = "event";
+    fields[0].value.type = opentracing_value_string;
+    fields[0].value.value.string_value = "cache.miss";
+    fields[1].key = "size";
+    fields[1].value.type = opentracing_value_uint64;
+    fields[1].value.value.uint64_value = 4096;
+    fields[2].key = "ratio";
+    fields[2].value.type = opentracing_value_double;
+    fields[2].value.value.double_value = 0.25;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "log_fields");
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            span->log_fields(span, fields, 3);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+}
+
+static void bench_log_fields_interned(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_interned_log_field fields[3];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    fields[0].key = opentracing_intern("event");
+    fields[0].value.type = opentracing_value_string;
+    fields[0].value.value.string_value = "cache.miss";
+    fields[1].key = opentracing_intern("size");
+    fields[1].value.type = opentracing_value_uint64;
+    fields[1].value.value.uint64_value = 4096;
+    fields[2].key = opentracing_intern("ratio");
+    fields[2].value.type = opentracing_value_double;
+    fields[2].value.value.double_value = 0.25;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "log_fields_interned");
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            opentracing_span_log_fields_interned(span, fields, 3);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+}
+
+static void bench_set_baggage_item(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "set_baggage_item");
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            span->set_baggage_item(span, "tenant", "acme");
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+}
+
+static void bench_baggage_item(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    const char* value;
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    value = NULL;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        span = tracer->start_span(tracer, "baggage_item");
+        span->set_baggage_item(span, "region", "eu");
+        span->set_baggage_item(span, "tenant", "acme");
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            value = span->baggage_item(span, "tenant");
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        finish_and_destroy(span);
+    }
+    assert(value != NULL);
+    (void) value;
+}
+
+/* Children of a span carrying baggage, as in a service mesh request. */
+static void bench_start_child_with_baggage(bench_context* ctx,
+                                           long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* parent;
+    opentracing_span* spans[CHUNK_SIZE];
+    opentracing_start_span_options options;
+    opentracing_span_reference refs[1];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    parent = tracer->start_span(tracer, "baggage_parent");
+    parent->set_baggage_item(parent, "tenant", "acme");
+    parent->set_baggage_item(parent, "region", "eu-west-1");
+    parent->set_baggage_item(parent, "request.id", "4bf92f3577b34da6");
+    parent->set_baggage_item(parent, "user.tier", "gold");
+    refs[0].type = opentracing_span_reference_child_of;
+    refs[0].referenced_context = parent->span_context(parent);
+    memset(&options, 0, sizeof(options));
+    options.references = refs;
+    options.num_references = 1;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i] = tracer->start_span_with_options(
+                tracer, "child_with_baggage", &options);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            finish_and_destroy(spans[i]);
+        }
+    }
+    finish_and_destroy(parent);
+}
+
+/* Handing a request's trace to an event loop callback and back. */
+static void bench_continuation(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_continuation continuation;
+    long i;
+
+    tracer = ctx->tracer;
+    span = tracer->start_span(tracer, "continuation");
+    opentracing_activate_span(span);
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_continuation_capture(&continuation);
+        opentracing_continuation_restore(&continuation);
+        opentracing_continuation_suspend(&continuation);
+        opentracing_continuation_release(&continuation);
+    }
+    bench_stop(ctx, iterations);
+    opentracing_deactivate_span(span);
+    finish_and_destroy(span);
+}
+
+typedef struct bench_carrier {
+    char data[256];
+    size_t length;
+} bench_carrier;
+
+static int bench_carrier_write(void* arg, const char* data, size_t len)
+{
+    bench_carrier* carrier;
+
+    carrier = (bench_carrier*) arg;
+    if (len > sizeof(carrier->data) - carrier->length) {
+        return -1;
+    }
+    memcpy(carrier->data + carrier->length, data, len);
+    carrier->length += len;
+    return 0;
+}
+
+static void bench_inject_binary(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span_context* context;
+    bench_carrier carrier;
+    long i;
+
+    tracer = ctx->tracer;
+    context = ctx->parent->span_context(ctx->parent);
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        carrier.length = 0;
+        tracer->inject_binary(tracer, &bench_carrier_write, &carrier, context);
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_inject_binary_buffer(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span_context* context;
+    bench_carrier carrier;
+    long i;
+
+    tracer = ctx->tracer;
+    context = ctx->parent->span_context(ctx->parent);
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_tracer_inject_binary_buffer(tracer,
+                                                carrier.data,
+                                                sizeof(carrier.data),
+                                                &carrier.length,
+                                                context);
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_extract_binary_buffer(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span_context* context;
+    bench_carrier carrier;
+    long i;
+
+    tracer = ctx->tracer;
+    carrier.length = 0;
+    opentracing_tracer_inject_binary_buffer(tracer,
+                                            carrier.data,
+                                            sizeof(carrier.data),
+                                            &carrier.length,
+                                            ctx->parent->span_context(
+                                                ctx->parent));
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        if (opentracing_tracer_extract_binary_buffer(
+                tracer, carrier.data, carrier.length, &context) ==
+            opentracing_propagation_error_code_success) {
+            ((opentracing_destructible*) context)
+                ->destroy((opentracing_destructible*) context);
+        }
+    }
+    bench_stop(ctx, iterations);
+}
+
+/* HTTP headers with a hashed index, like a server's request header table. */
+
+#define BENCH_NUM_HEADERS 60
+#define BENCH_HEADER_SLOTS 128
+
+typedef struct bench_headers {
+    opentracing_http_headers_writer writer;
+    opentracing_http_headers_reader reader;
+    char keys[BENCH_NUM_HEADERS][32];
+    char values[BENCH_NUM_HEADERS][64];
+    int num_headers;
+    /* Header index plus one, zero for empty slots. */
+    int slots[BENCH_HEADER_SLOTS];
+} bench_headers;
+
+static void bench_headers_destroy(opentracing_destructible* destructible)
+{
+    (void) destructible;
+}
+
+static unsigned int bench_header_hash(const char* key)
+{
+    unsigned int hash;
+
+    /* FNV-1a over the lowercased name. */
+    hash = 2166136261U;
+    for (; *key != '\0'; key++) {
+        hash = (hash ^ (unsigned char) tolower((unsigned char) *key)) *
+               16777619U;
+    }
+    return hash;
+}
+
+static opentracing_propagation_error_code
+bench_headers_set(opentracing_text_map_writer* writer,
+                  const char* key,
+                  const char* value)
+{
+    bench_headers* headers;
+    unsigned int slot;
+
+    headers = (bench_headers*) writer;
+    if (headers->num_headers == BENCH_NUM_HEADERS) {
+        return opentracing_propagation_error_code_invalid_carrier;
+    }
+    strncpy(headers->keys[headers->num_headers], key, 31);
+    strncpy(headers->values[headers->num_headers], value, 63);
+    headers->num_headers++;
+    slot = bench_header_hash(key) % BENCH_HEADER_SLOTS;
+    while (headers->slots[slot] != 0) {
+        slot = (slot + 1) % BENCH_HEADER_SLOTS;
+    }
+    headers->slots[slot] = headers->num_headers;
+    return opentracing_propagation_error_code_success;
+}
+
+static bench_headers* bench_headers_from_reader(
+    opentracing_text_map_reader* reader)
+{
+    return (bench_headers*) (((char*) reader) -
+                             offsetof(bench_headers, reader));
+}
+
+static opentracing_propagation_error_code bench_headers_foreach_key(
+    opentracing_text_map_reader* reader,
+    opentracing_propagation_error_code (*handler)(void*,
+                                                  const char*,
+                                                  const char*),
+    void* arg)
+{
+    bench_headers* headers;
+    opentracing_propagation_error_code return_code;
+    int i;
+
+    headers = bench_headers_from_reader(reader);
+    for (i = 0; i < headers->num_headers; i++) {
+        return_code = handler(arg, headers->keys[i], headers->values[i]);
+        if (return_code != opentracing_propagation_error_code_success) {
+            return return_code;
+        }
+    }
+    return opentracing_propagation_error_code_success;
+}
+
+static opentracing_propagation_error_code
+bench_headers_get(opentracing_text_map_reader* reader,
+                  const char* key,
+                  const char** value)
+{
+    bench_headers* headers;
+    unsigned int slot;
+    int index;
+
+    headers = bench_headers_from_reader(reader);
+    slot = bench_header_hash(key) % BENCH_HEADER_SLOTS;
+    for (; headers->slots[slot] != 0; slot = (slot + 1) % BENCH_HEADER_SLOTS) {
+        index = headers->slots[slot] - 1;
+        if (strcasecmp(headers->keys[index], key) == 0) {
+            *value = headers->values[index];
+            return opentracing_propagation_error_code_success;
+        }
+    }
+    return opentracing_propagation_error_code_span_context_not_found;
+}
+
+/* Typical request headers plus the parent's span context. */
+static void bench_headers_init(bench_headers* headers,
+                               bench_context* ctx,
+                               opentracing_bool keyed)
+{
+    opentracing_tracer* tracer;
+    char key[32];
+    int i;
+
+    memset(headers, 0, sizeof(*headers));
+    headers->writer.base.base.destroy = &bench_headers_destroy;
+    headers->writer.base.set = &bench_headers_set;
+    headers->reader.base.base.destroy = &bench_headers_destroy;
+    headers->reader.base.foreach_key = &bench_headers_foreach_key;
+    if (keyed) {
+        headers->reader.base.header.size = sizeof(opentracing_text_map_reader);
+        headers->reader.base.header.version = OPENTRACINGC_VTABLE_VERSION;
+        headers->reader.base.get = &bench_headers_get;
+    }
+    tracer = ctx->tracer;
+    tracer->inject_http_headers(
+        tracer, &headers->writer, ctx->parent->span_context(ctx->parent));
+    for (i = headers->num_headers; i < BENCH_NUM_HEADERS; i++) {
+        sprintf(key, "x-request-header-%d", i);
+        bench_headers_set((opentracing_text_map_writer*) headers, key, "value");
+    }
+}
+
+static void bench_extract_headers(bench_context* ctx,
+                                  long iterations,
+                                  opentracing_bool keyed)
+{
+    opentracing_tracer* tracer;
+    opentracing_span_context* context;
+    bench_headers headers;
+    long i;
+
+    tracer = ctx->tracer;
+    bench_headers_init(&headers, ctx, keyed);
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        if (tracer->extract_http_headers(tracer, &headers.reader, &context) ==
+            opentracing_propagation_error_code_success) {
+            ((opentracing_destructible*) context)
+                ->destroy((opentracing_destructible*) context);
+        }
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_extract_http_headers(bench_context* ctx, long iterations)
+{
+    bench_extract_headers(ctx, iterations, opentracing_false);
+}
+
+static void bench_extract_http_headers_get(bench_context* ctx,
+                                           long iterations)
+{
+    bench_extract_headers(ctx, iterations, opentracing_true);
+}
+
+static void bench_finish(bench_context* ctx, long iterations)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* spans[CHUNK_SIZE];
+    long done;
+    int i;
+
+    tracer = ctx->tracer;
+    for (done = 0; done < iterations; done += CHUNK_SIZE) {
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i] = tracer->start_span(tracer, "finish");
+        }
+        bench_start(ctx);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            spans[i]->finish(spans[i]);
+        }
+        bench_stop(ctx, CHUNK_SIZE);
+        for (i = 0; i < CHUNK_SIZE; i++) {
+            destroy_span(spans[i]);
+        }
+    }
+}
+
+typedef struct bench_case {
+    const char* name;
+    void (*run)(bench_context* ctx, long iterations);
+} bench_case;
+
+static const bench_case bench_cases[] = {
+    {"span_lifecycle", &bench_span_lifecycle},
+    {"span_lifecycle_cpp", &bench_span_lifecycle_cpp},
+    {"start_span", &bench_start_span},
+    {"start_span_interned", &bench_start_span_interned},
+    {"start_span_with_options", &bench_start_span_with_options},
+    {"set_tag_bool", &bench_set_tag_bool},
+    {"set_tag_double", &bench_set_tag_double},
+    {"set_tag_int64", &bench_set_tag_int64},
+    {"set_tag_uint64", &bench_set_tag_uint64},
+    {"set_tag_string", &bench_set_tag_string},
+    {"set_tag_string_view", &bench_set_tag_string_view},
+    {"set_tag_string_cpp", &bench_set_tag_string_cpp},
+    {"set_tag_null", &bench_set_tag_null},
+    {"set_tag_loop", &bench_set_tag_loop},
+    {"set_tags", &bench_set_tags},
+    {"set_tag_interned", &bench_set_tag_interned},
+    {"log_fields", &bench_log_fields},
+    {"log_fields_interned", &bench_log_fields_interned},
+    {"set_baggage_item", &bench_set_baggage_item},
+    {"baggage_item", &bench_baggage_item},
+    {"start_child_with_baggage", &bench_start_child_with_baggage},
+    {"continuation", &bench_continuation},
+    {"inject_binary", &bench_inject_binary},
+    {"inject_binary_buffer", &bench_inject_binary_buffer},
+    {"extract_binary_buffer", &bench_extract_binary_buffer},
+    {"extract_http_headers", &bench_extract_http_headers},
+    {"extract_http_headers_get", &bench_extract_http_headers_get},
+    {"finish", &bench_finish}};
+
+#define NUM_BENCH_CASES ((int) (sizeof(bench_cases) / sizeof(bench_cases[0])))
+
+/* Header codec and clock cases, independent of the tracer. Each has a
+   naive baseline. */
+
+static const char bench_traceparent[] =
+    "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+
+static volatile uint64_t bench_sink;
+
+static void bench_traceparent_encode(bench_context* ctx, long iterations)
+{
+    char out[OPENTRACINGC_TRACEPARENT_LENGTH + 1];
+    opentracing_trace_id trace_id;
+    long i;
+
+    trace_id.high = 0x0af7651916cd43ddULL;
+    trace_id.low = 0x8448eb211c80319cULL;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_traceparent_encode(
+            &trace_id, (uint64_t) i, opentracing_true, out);
+        bench_sink += (unsigned char) out[40];
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_traceparent_encode_snprintf(bench_context* ctx,
+                                              long iterations)
+{
+    char out[OPENTRACINGC_TRACEPARENT_LENGTH + 1];
+    opentracing_trace_id trace_id;
+    long i;
+
+    trace_id.high = 0x0af7651916cd43ddULL;
+    trace_id.low = 0x8448eb211c80319cULL;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        snprintf(out,
+                 sizeof(out),
+                 "00-%016" PRIx64 "%016" PRIx64 "-%016" PRIx64 "-%02x",
+                 trace_id.high,
+                 trace_id.low,
+                 (uint64_t) i,
+                 1U);
+        bench_sink += (unsigned char) out[40];
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_traceparent_decode(bench_context* ctx, long iterations)
+{
+    opentracing_trace_id trace_id;
+    opentracing_bool sampled;
+    uint64_t span_id;
+    long i;
+
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_traceparent_decode(bench_traceparent,
+                                       OPENTRACINGC_TRACEPARENT_LENGTH,
+                                       &trace_id,
+                                       &span_id,
+                                       &sampled);
+        bench_sink += span_id;
+    }
+    bench_stop(ctx, iterations);
+}
+
+static void bench_traceparent_decode_sscanf(bench_context* ctx,
+                                            long iterations)
+{
+    opentracing_trace_id trace_id;
+    unsigned int version;
+    unsigned int flags;
+    uint64_t span_id;
+    long i;
+
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        sscanf(bench_traceparent,
+               "%2x-%16" SCNx64 "%16" SCNx64 "-%16" SCNx64 "-%2x",
+               &version,
+               &trace_id.high,
+               &trace_id.low,
+               &span_id,
+               &flags);
+        bench_sink += span_id;
+    }
+    bench_stop(ctx, iterations);
+}
+
+/* Clock reads for a span start, against two clock_gettime calls. */
+
+static void bench_now_clock_gettime(bench_context* ctx, long iterations)
+{
+    struct timespec steady;
+    struct timespec system;
+    long i;
+
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &steady);
+        clock_gettime(CLOCK_REALTIME, &system);
+        bench_sink += (uint64_t) steady.tv_nsec + (uint64_t) system.tv_nsec;
+    }
+    bench_stop(ctx, iterations);
+}
+
+/* Falls back to the default source where the requested one is missing. */
+static void bench_now_source(bench_context* ctx,
+                             long iterations,
+                             opentracing_clock_source source)
+{
+    opentracing_duration steady;
+    opentracing_timestamp system;
+    long i;
+
+    opentracing_set_clock_source(source);
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_now(&steady, &system);
+        bench_sink += (uint64_t) steady.value.tv_nsec +
+                      (uint64_t) system.value.tv_nsec;
+    }
+    bench_stop(ctx, iterations);
+    opentracing_set_clock_source(opentracing_clock_source_default);
+}
+
+static void bench_now(bench_context* ctx, long iterations)
+{
+    bench_now_source(ctx, iterations, opentracing_clock_source_default);
+}
+
+static void bench_now_coarse(bench_context* ctx, long iterations)
+{
+    bench_now_source(ctx, iterations, opentracing_clock_source_coarse);
+}
+
+static void bench_now_tsc(bench_context* ctx, long iterations)
+{
+    bench_now_source(ctx, iterations, opentracing_clock_source_tsc);
+}
+
+/* Sampling decisions spread over a few operation names. */
+
+static const char* const bench_operation_names[] = {
+    "GET /health", "GET /users", "POST /orders", "GET /orders/{id}"};
+
+#define NUM_BENCH_OPERATION_NAMES \
+    ((int) (sizeof(bench_operation_names) / sizeof(bench_operation_names[0])))
+
+static void bench_sampler_adaptive(bench_context* ctx, long iterations)
+{
+    opentracing_adaptive_sampler_options options;
+    opentracing_sampler* sampler;
+    opentracing_trace_id trace_id;
+    long i;
+
+    memset(&options, 0, sizeof(options));
+    options.target_per_second = 10.0;
+    sampler = opentracing_make_adaptive_sampler(&options);
+    assert(sampler != NULL);
+    trace_id.high = 0;
+    trace_id.low = 0;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        trace_id.low += UINT64_C(0x9E3779B97F4A7C15);
+        bench_sink += (uint64_t) sampler->is_sampled(
+            sampler,
+            &trace_id,
+            bench_operation_names[i % NUM_BENCH_OPERATION_NAMES]);
+    }
+    bench_stop(ctx, iterations);
+    ((opentracing_destructible*) sampler)
+        ->destroy((opentracing_destructible*) sampler);
+}
+
+/* Span batches of typical server spans, timed per span. */
+
+#define BENCH_BATCH_SIZE 64
+#define BENCH_BATCH_TAGS 4
+
+typedef struct bench_batch {
+    opentracing_span_data spans[BENCH_BATCH_SIZE];
+    const opentracing_span_data* span_ptrs[BENCH_BATCH_SIZE];
+    opentracing_tag tags[BENCH_BATCH_TAGS];
+} bench_batch;
+
+static void bench_batch_init(bench_batch* batch)
+{
+    int i;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->tags[0].key = (char*) "http.method";
+    batch->tags[0].value.type = opentracing_value_string;
+    batch->tags[0].value.value.string_value = "GET";
+    batch->tags[1].key = (char*) "http.status_code";
+    batch->tags[1].value.type = opentracing_value_int64;
+    batch->tags[1].value.value.int64_value = 200;
+    batch->tags[2].key = (char*) "component";
+    batch->tags[2].value.type = opentracing_value_string;
+    batch->tags[2].value.value.string_value = "http";
+    batch->tags[3].key = (char*) "error";
+    batch->tags[3].value.type = opentracing_value_bool;
+    batch->tags[3].value.value.bool_value = opentracing_false;
+    for (i = 0; i < BENCH_BATCH_SIZE; i++) {
+        batch->spans[i].trace_id.high = (uint64_t) (i / 8);
+        batch->spans[i].trace_id.low = UINT64_C(0x9E3779B97F4A7C15);
+        batch->spans[i].span_id = (uint64_t) i + 1;
+        batch->spans[i].parent_span_id = (i % 8 == 0) ? 0 : (uint64_t) i;
+        batch->spans[i].operation_name =
+            bench_operation_names[i % NUM_BENCH_OPERATION_NAMES];
+        batch->spans[i].start_timestamp.value.tv_sec = 1500000000;
+        batch->spans[i].start_timestamp.value.tv_nsec = i * 1000;
+        batch->spans[i].duration.value.tv_nsec = 250000;
+        batch->spans[i].tags = batch->tags;
+        batch->spans[i].num_tags = BENCH_BATCH_TAGS;
+        batch->spans[i].local_root = (opentracing_bool) (i % 8 == 0);
+        batch->span_ptrs[i] = &batch->spans[i];
+    }
+}
+
+static void bench_span_batch_encode(bench_context* ctx, long iterations)
+{
+    bench_batch batch;
+    opentracing_span_batch_encoder* encoder;
+    const char* data;
+    size_t length;
+    long i;
+
+    bench_batch_init(&batch);
+    encoder = opentracing_span_batch_encoder_new();
+    assert(encoder != NULL);
+    iterations = (iterations + BENCH_BATCH_SIZE - 1) / BENCH_BATCH_SIZE;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_span_batch_encode(
+            encoder, batch.span_ptrs, BENCH_BATCH_SIZE, &data, &length);
+        bench_sink += (uint64_t) length;
+    }
+    bench_stop(ctx, iterations * BENCH_BATCH_SIZE);
+    opentracing_span_batch_encoder_destroy(encoder);
+}
+
+static void bench_span_batch_decode(bench_context* ctx, long iterations)
+{
+    bench_batch batch;
+    opentracing_span_batch_encoder* encoder;
+    opentracing_span_batch_decoder* decoder;
+    const opentracing_span_data* span;
+    const char* data;
+    size_t length;
+    int num_spans;
+    long i;
+
+    bench_batch_init(&batch);
+    encoder = opentracing_span_batch_encoder_new();
+    assert(encoder != NULL);
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+    opentracing_span_batch_encode(
+        encoder, batch.span_ptrs, BENCH_BATCH_SIZE, &data, &length);
+    iterations = (iterations + BENCH_BATCH_SIZE - 1) / BENCH_BATCH_SIZE;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        opentracing_span_batch_decode_begin(decoder, data, length, &num_spans);
+        while (opentracing_span_batch_decode_next(decoder, &span) ==
+               opentracing_span_batch_status_ok) {
+            bench_sink += span->span_id;
+        }
+    }
+    bench_stop(ctx, iterations * BENCH_BATCH_SIZE);
+    opentracing_span_batch_decoder_destroy(decoder);
+    opentracing_span_batch_encoder_destroy(encoder);
+}
+
+/*
+ * Reporting batches to a loopback UDP socket nobody reads, so the kernel
+ * drops datagrams once the receive buffer fills.
+ */
+static void bench_socket_reporter_send(bench_context* ctx,
+                                       long iterations,
+                                       int max_datagrams_per_send)
+{
+    bench_batch batch;
+    opentracing_socket_reporter_options options;
+    opentracing_reporter* reporter;
+    struct sockaddr_in address;
+    socklen_t address_length;
+    char address_str[64];
+    int fd;
+    long i;
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(fd >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address_length = sizeof(address);
+    if (bind(fd, (struct sockaddr*) &address, sizeof(address)) != 0 ||
+        getsockname(fd, (struct sockaddr*) &address, &address_length) != 0) {
+        assert(0);
+    }
+    sprintf(address_str, "127.0.0.1:%d", (int) ntohs(address.sin_port));
+
+    bench_batch_init(&batch);
+    memset(&options, 0, sizeof(options));
+    options.address = address_str;
+    options.max_datagrams_per_send = max_datagrams_per_send;
+    reporter = opentracing_make_socket_reporter(&options);
+    assert(reporter != NULL);
+    iterations = (iterations + BENCH_BATCH_SIZE - 1) / BENCH_BATCH_SIZE;
+    bench_start(ctx);
+    for (i = 0; i < iterations; i++) {
+        reporter->report(reporter, batch.span_ptrs, BENCH_BATCH_SIZE);
+    }
+    bench_stop(ctx, iterations * BENCH_BATCH_SIZE);
+    ((opentracing_destructible*) reporter)
+        ->destroy((opentracing_destructible*) reporter);
+    close(fd);
+}
+
+static void bench_socket_reporter(bench_context* ctx, long iterations)
+{
+    bench_socket_reporter_send(ctx, iterations, 0);
+}
+
+/* One datagram per system call, as without sendmmsg. */
+static void bench_socket_reporter_single(bench_context* ctx, long iterations)
+{
+    bench_socket_reporter_send(ctx, iterations, 1);
+}
+
+static const bench_case codec_cases[] = {
+    {"traceparent_encode", &bench_traceparent_encode},
+    {"traceparent_encode_snprintf", &bench_traceparent_encode_snprintf},
+    {"traceparent_decode", &bench_traceparent_decode},
+    {"traceparent_decode_sscanf", &bench_traceparent_decode_sscanf},
+    {"now_clock_gettime", &bench_now_clock_gettime},
+    {"now", &bench_now},
+    {"now_coarse", &bench_now_coarse},
+    {"now_tsc", &bench_now_tsc},
+    {"sampler_adaptive", &bench_sampler_adaptive},
+    {"span_batch_encode", &bench_span_batch_encode},
+    {"span_batch_decode", &bench_span_batch_decode},
+    {"socket_reporter", &bench_socket_reporter},
+    {"socket_reporter_single", &bench_socket_reporter_single}};
+
+#define NUM_CODEC_CASES ((int) (sizeof(codec_cases) / sizeof(codec_cases[0])))
+
+/* Reporter that discards spans, to include recording cost in results. */
+
+static void discard_reporter_destroy(opentracing_destructible* destructible)
+{
+    (void) destructible;
+}
+
+static void discard_reporter_report(opentracing_reporter* reporter,
+                                    const opentracing_span_data* const* spans,
+                                    int num_spans)
+{
+    (void) reporter;
+    (void) spans;
+    (void) num_spans;
+}
+
+static void discard_reporter_flush(opentracing_reporter* reporter)
+{
+    (void) reporter;
+}
+
+static opentracing_reporter discard_reporter = {{&discard_reporter_destroy},
+                                                &discard_reporter_report,
+                                                &discard_reporter_flush};
+
+/* Driver. */
+
+static int num_results = 0;
+
+/* Write str as a JSON string literal. Library paths may need escaping. */
+static void write_json_string(FILE* out, const char* str)
+{
+    const unsigned char* c;
+
+    fputc('"', out);
+    for (c = (const unsigned char*) str; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        }
+        else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        }
+        else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void run_cases(FILE* out,
+                      const char* tracer_name,
+                      opentracing_tracer* tracer,
+                      const bench_case* cases,
+                      int num_cases,
+                      long iterations)
+{
+    bench_context ctx;
+    int i;
+
+    for (i = 0; i < num_cases; i++) {
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.tracer = tracer;
+        ctx.parent = tracer->start_span(tracer, "parent");
+        if (ctx.parent == NULL) {
+            fprintf(stderr, "%s: failed to start span\n", tracer_name);
+            return;
+        }
+
+        /* Warm up free lists and caches before measuring. */
+        cases[i].run(&ctx, (iterations / 10) + CHUNK_SIZE);
+        ctx.elapsed_ns = 0;
+        ctx.allocations = 0;
+        ctx.num_ops = 0;
+        cases[i].run(&ctx, iterations);
+        finish_and_destroy(ctx.parent);
+
+        fprintf(out, "%s    {\"tracer\": ", (num_results == 0) ? "" : ",\n");
+        write_json_string(out, tracer_name);
+        fprintf(out,
+                ", \"name\": \"%s\", "
+                "\"iterations\": %ld, \"ns_per_op\": %.3f, "
+                "\"allocs_per_op\": ",
+                cases[i].name,
+                ctx.num_ops,
+                ctx.elapsed_ns / (double) ctx.num_ops);
+        if (HAVE_ALLOCATION_COUNTING) {
+            fprintf(out,
+                    "%.3f}",
+                    (double) ctx.allocations / (double) ctx.num_ops);
+        }
+        else {
+            fprintf(out, "null}");
+        }
+        num_results++;
+    }
+}
+
+static void run_tracer(FILE* out,
+                       const char* tracer_name,
+                       opentracing_tracer* tracer,
+                       long iterations)
+{
+    run_cases(out, tracer_name, tracer, bench_cases, NUM_BENCH_CASES, iterations);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--iterations N] [--output FILE] "
+            "[--library LIB [--config CONFIG]]\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    opentracing_basic_tracer_options options;
+    opentracing_library_handle handle;
+    opentracing_tracer* tracer;
+    const char* library;
+    const char* config;
+    const char* output;
+    char error[256];
+    long iterations;
+    FILE* out;
+    int i;
+
+    iterations = DEFAULT_ITERATIONS;
+    library = NULL;
+    config = "";
+    output = NULL;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--library") == 0 && i + 1 < argc) {
+            library = argv[++i];
+        }
+        else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            config = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (iterations <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    iterations = ((iterations + CHUNK_SIZE - 1) / CHUNK_SIZE) * CHUNK_SIZE;
+
+    out = stdout;
+    if (output != NULL) {
+        out = fopen(output, "w");
+        if (out == NULL) {
+            perror(output);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+
+    run_cases(out,
+              "none",
+              opentracing_global_tracer(),
+              codec_cases,
+              NUM_CODEC_CASES,
+              iterations);
+    run_tracer(out, "noop", opentracing_global_tracer(), iterations);
+
+    tracer = opentracing_make_basic_tracer(NULL);
+    assert(tracer != NULL);
+    run_tracer(out, "basic", tracer, iterations);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+
+    memset(&options, 0, sizeof(options));
+    options.reporter = &discard_reporter;
+    options.background_reporting = opentracing_true;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    run_tracer(out, "basic_background", tracer, iterations);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+
+    memset(&options, 0, sizeof(options));
+    options.reporter = &discard_reporter;
+    options.sampler = opentracing_make_const_sampler(opentracing_false);
+    assert(options.sampler != NULL);
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    run_tracer(out, "basic_unsampled", tracer, iterations);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+
+    if (library != NULL) {
+        memset(&handle, 0, sizeof(handle));
+        memset(error, 0, sizeof(error));
+        if (opentracing_dynamically_load_tracing_library(
+                library, &handle, error, sizeof(error)) !=
+            opentracing_dynamic_load_error_code_success) {
+            fprintf(stderr, "Failed to load %s: %s\n", library, error);
+        }
+        else if (!handle.factory(config, &tracer, error, sizeof(error))) {
+            fprintf(stderr, "Failed to create tracer: %s\n", error);
+            opentracing_library_handle_destroy(&handle);
+        }
+        else {
+            run_tracer(out, library, tracer, iterations);
+            ((opentracing_destructible*) tracer)
+                ->destroy((opentracing_destructible*) tracer);
+            opentracing_library_handle_destroy(&handle);
+        }
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+if(__CHECK_ATOMICS)
+  return()
+endif()
+set(__CHECK_ATOMICS 1)
+
+function(__check_have_atomic_builtins var)
+  set(tmp_dir "${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeTmp")
+  try_compile(have_atomic_builtins
+    "${tmp_dir}/atomic_builtins_test"
+    "${CMAKE_CURRENT_SOURCE_DIR}/cmake/atomic_builtins_test.c")
+  if(have_atomic_builtins)
+    set(${var} ON PARENT_SCOPE)
+    message(STATUS "Checking for __atomic builtins - Success")
+  else()
+    message(STATUS "Checking for __atomic builtins - Failed")
+  endif()
+endfunction()
+
+function(__check_thread_local_keyword)
+  if(DEFINED OPENTRACINGC_THREAD_LOCAL_KEYWORD)
+    return()
+  endif()
+  set(tmp_dir "${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeTmp")
+  foreach(keyword "__thread" "_Thread_local")
+    try_compile(have_${keyword}
+      "${tmp_dir}/thread_local_test"
+      "${CMAKE_CURRENT_SOURCE_DIR}/cmake/thread_local_test.c"
+      COMPILE_DEFINITIONS "-DTHREAD_LOCAL=${keyword}")
+    if(have_${keyword})
+      message(STATUS "Checking for thread-local keyword ${keyword} - Success")
+      set(OPENTRACINGC_THREAD_LOCAL_KEYWORD "${keyword}" CACHE INTERNAL
+          "Thread-local storage keyword")
+      return()
+    endif()
+  endforeach()
+  message(STATUS "Checking for thread-local keyword - Failed")
+  set(OPENTRACINGC_THREAD_LOCAL_KEYWORD "" CACHE INTERNAL
+      "Thread-local storage keyword")
+endfunction()
+
+function(check_atomics)
+  __check_have_atomic_builtins(have_atomic_builtins)
+  if(NOT have_atomic_builtins)
+    message(FATAL_ERROR "opentracing-c requires compiler __atomic builtins")
+  endif()
+  set(OPENTRACINGC_HAVE_ATOMIC_BUILTINS ON PARENT_SCOPE)
+
+  __check_thread_local_keyword()
+  if(OPENTRACINGC_THREAD_LOCAL_KEYWORD)
+    set(OPENTRACINGC_HAVE_THREAD_LOCAL ON PARENT_SCOPE)
+  endif()
+endfunction()
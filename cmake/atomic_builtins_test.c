@@ -0,0 +1,12 @@
+int main(void)
+{
+    int value;
+    int expected;
+    __atomic_store_n(&value, 0, __ATOMIC_RELAXED);
+    expected = __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+    (void) __atomic_compare_exchange_n(
+        &value, &expected, 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    (void) __atomic_exchange_n(&value, 2, __ATOMIC_ACQ_REL);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_fetch_add(&value, 1, __ATOMIC_RELAXED) - 2;
+}
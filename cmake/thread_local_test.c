@@ -0,0 +1,6 @@
+static THREAD_LOCAL int value;
+
+int main(void)
+{
+    return value;
+}
@@ -0,0 +1,3 @@
+#include "active_span.h"
+
+#include "active_span_snippet.c"
@@ -0,0 +1,9 @@
+#ifndef ACTIVE_SPAN_H
+#define ACTIVE_SPAN_H
+
+#include <opentracing-c/scope_manager.h>
+#include <opentracing-c/tracer.h>
+
+void handle_request(opentracing_span* request_span);
+
+#endif /* ACTIVE_SPAN_H */
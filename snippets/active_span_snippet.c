@@ -0,0 +1,25 @@
+static void load_user(void)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+
+    tracer = opentracing_global_tracer();
+    /* No references needed, the active span is the parent. */
+    span = tracer->start_span(tracer, "load_user");
+    if (span == NULL) {
+        /* Error creating span. */
+    }
+    /* ... */
+    span->finish(span);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+}
+
+void handle_request(opentracing_span* request_span)
+{
+    if (!opentracing_activate_span(request_span)) {
+        /* Out of memory, spans will not be children of request_span. */
+    }
+    load_user();
+    opentracing_deactivate_span(request_span);
+}
@@ -1,6 +1,7 @@
 #include "text_map_iterator.h"
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 typedef struct text_map_reader {
     /* Base class instance. */
@@ -56,9 +57,11 @@ static void noop_destroy(opentracing_destructible* d)
 static void text_map_reader_init(text_map_reader* reader, const text_map* map)
 {
     assert(reader != NULL);
-    ((opentracing_text_map_reader*) &reader)->foreach_key =
+    /* Zeroing the header marks the optional slots, e.g. get, as absent. */
+    memset(reader, 0, sizeof(*reader));
+    ((opentracing_text_map_reader*) reader)->foreach_key =
         &text_map_reader_foreach_key;
-    ((opentracing_destructible*) &reader)->destroy = &noop_destroy;
+    ((opentracing_destructible*) reader)->destroy = &noop_destroy;
     reader->map = map;
 }
 
@@ -0,0 +1,246 @@
+#include <opentracing-c/baggage.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/internal/atomic.h>
+#include <opentracing-c/internal/hash.h>
+
+/* Containers with more items than this carry a hash index. Below it, a scan
+ * comparing stored hashes is as fast as probing. */
+#define MAX_UNINDEXED_ITEMS 8
+
+#define ALIGN_POINTER(size) \
+    (((size) + sizeof(void*) - 1) & ~(size_t)(sizeof(void*) - 1))
+
+typedef struct baggage_entry {
+    uint32_t hash;
+    size_t key_len;
+    size_t value_len;
+    const char* key;
+    const char* value;
+} baggage_entry;
+
+/* Allocated as one block: this header, the entries, the index (if any), then
+ * the null-terminated keys and values. */
+struct opentracing_baggage {
+    int ref_count;
+    int num_items;
+    /* Slot count minus one, zero without an index. */
+    uint32_t index_mask;
+    baggage_entry* items;
+    /* Entry position plus one, zero for empty slots. */
+    uint32_t* index;
+};
+
+static int find_item(const opentracing_baggage* baggage,
+                     const char* key,
+                     size_t key_len,
+                     uint32_t hash)
+{
+    const baggage_entry* entry;
+    uint32_t slot;
+    int i;
+
+    if (baggage == NULL) {
+        return -1;
+    }
+    if (baggage->index_mask == 0) {
+        for (i = 0; i < baggage->num_items; i++) {
+            entry = &baggage->items[i];
+            if (entry->hash == hash && entry->key_len == key_len &&
+                memcmp(entry->key, key, key_len) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    for (slot = hash & baggage->index_mask; baggage->index[slot] != 0;
+         slot = (slot + 1) & baggage->index_mask) {
+        entry = &baggage->items[baggage->index[slot] - 1];
+        if (entry->hash == hash && entry->key_len == key_len &&
+            memcmp(entry->key, key, key_len) == 0) {
+            return (int) baggage->index[slot] - 1;
+        }
+    }
+    return -1;
+}
+
+static char* copy_chars(char* dst, const char* src, size_t len)
+{
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+    return dst + len + 1;
+}
+
+opentracing_baggage* opentracing_baggage_with_item(
+    const opentracing_baggage* baggage,
+    const char* key,
+    size_t key_len,
+    const char* value,
+    size_t value_len)
+{
+    opentracing_baggage* result;
+    const baggage_entry* src;
+    baggage_entry* dst;
+    uint32_t hash;
+    uint32_t num_slots;
+    uint32_t slot;
+    size_t size;
+    size_t strings_size;
+    char* strings;
+    int old_size;
+    int replaced;
+    int num_items;
+    int i;
+
+    assert(key != NULL);
+    assert(value != NULL);
+    hash = opentracing_hash_fnv1a(key, key_len);
+    replaced = find_item(baggage, key, key_len, hash);
+    old_size = opentracing_baggage_size(baggage);
+    num_items = (replaced < 0) ? old_size + 1 : old_size;
+
+    strings_size = key_len + value_len + 2;
+    for (i = 0; i < old_size; i++) {
+        if (i != replaced) {
+            src = &baggage->items[i];
+            strings_size += src->key_len + src->value_len + 2;
+        }
+    }
+    num_slots = 0;
+    if (num_items > MAX_UNINDEXED_ITEMS) {
+        for (num_slots = 16; num_slots < (uint32_t) num_items * 2;
+             num_slots *= 2) {
+        }
+    }
+    size = ALIGN_POINTER(sizeof(opentracing_baggage)) +
+           sizeof(baggage_entry) * num_items + sizeof(uint32_t) * num_slots;
+    result = (opentracing_baggage*) malloc(size + strings_size);
+    if (result == NULL) {
+        return NULL;
+    }
+    result->ref_count = 1;
+    result->num_items = num_items;
+    result->index_mask = (num_slots > 0) ? num_slots - 1 : 0;
+    result->items =
+        (baggage_entry*) (((char*) result) +
+                          ALIGN_POINTER(sizeof(opentracing_baggage)));
+    result->index = (uint32_t*) (result->items + num_items);
+    strings = ((char*) result) + size;
+
+    for (i = 0; i < num_items; i++) {
+        dst = &result->items[i];
+        if (i == replaced || i == old_size) {
+            dst->hash = hash;
+            dst->key_len = key_len;
+            dst->key = strings;
+            strings = copy_chars(strings, key, key_len);
+            dst->value_len = value_len;
+            dst->value = strings;
+            strings = copy_chars(strings, value, value_len);
+        }
+        else {
+            src = &baggage->items[i];
+            dst->hash = src->hash;
+            dst->key_len = src->key_len;
+            dst->key = strings;
+            strings = copy_chars(strings, src->key, src->key_len);
+            dst->value_len = src->value_len;
+            dst->value = strings;
+            strings = copy_chars(strings, src->value, src->value_len);
+        }
+    }
+
+    if (num_slots > 0) {
+        memset(result->index, 0, sizeof(uint32_t) * num_slots);
+        for (i = 0; i < num_items; i++) {
+            for (slot = result->items[i].hash & result->index_mask;
+                 result->index[slot] != 0;
+                 slot = (slot + 1) & result->index_mask) {
+            }
+            result->index[slot] = (uint32_t) i + 1;
+        }
+    }
+    return result;
+}
+
+opentracing_baggage* opentracing_baggage_retain(const opentracing_baggage* baggage)
+{
+    opentracing_baggage* mutable_baggage;
+
+    mutable_baggage = (opentracing_baggage*) baggage;
+    if (mutable_baggage != NULL) {
+        OPENTRACINGC_ATOMIC_FETCH_ADD(
+            &mutable_baggage->ref_count, 1, OPENTRACINGC_ATOMIC_RELAXED);
+    }
+    return mutable_baggage;
+}
+
+void opentracing_baggage_release(const opentracing_baggage* baggage)
+{
+    opentracing_baggage* mutable_baggage;
+
+    mutable_baggage = (opentracing_baggage*) baggage;
+    if (mutable_baggage != NULL &&
+        OPENTRACINGC_ATOMIC_FETCH_SUB(&mutable_baggage->ref_count,
+                                      1,
+                                      OPENTRACINGC_ATOMIC_ACQ_REL) == 1) {
+        free(mutable_baggage);
+    }
+}
+
+int opentracing_baggage_size(const opentracing_baggage* baggage)
+{
+    return (baggage != NULL) ? baggage->num_items : 0;
+}
+
+const char* opentracing_baggage_get(const opentracing_baggage* baggage,
+                                    const char* key)
+{
+    size_t key_len;
+    int i;
+
+    assert(key != NULL);
+    if (baggage == NULL) {
+        return NULL;
+    }
+    key_len = strlen(key);
+    i = find_item(baggage, key, key_len, opentracing_hash_fnv1a(key, key_len));
+    return (i >= 0) ? baggage->items[i].value : NULL;
+}
+
+void opentracing_baggage_item(const opentracing_baggage* baggage,
+                              int index,
+                              opentracing_string_view* key,
+                              opentracing_string_view* value)
+{
+    const baggage_entry* entry;
+
+    assert(index >= 0 && index < opentracing_baggage_size(baggage));
+    assert(key != NULL);
+    assert(value != NULL);
+    entry = &baggage->items[index];
+    key->data = entry->key;
+    key->length = entry->key_len;
+    value->data = entry->value;
+    value->length = entry->value_len;
+}
+
+void opentracing_baggage_foreach(const opentracing_baggage* baggage,
+                                 opentracing_bool (*f)(void*,
+                                                       const char*,
+                                                       const char*),
+                                 void* arg)
+{
+    int i;
+
+    assert(f != NULL);
+    for (i = 0; i < opentracing_baggage_size(baggage); i++) {
+        if (!f(arg, baggage->items[i].key, baggage->items[i].value)) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef OPENTRACINGC_BAGGAGE_H
+#define OPENTRACINGC_BAGGAGE_H
+
+#include <stddef.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/value.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Immutable, reference counted set of baggage items for use by tracer
+ * implementations. A child span context can share its parent's baggage by
+ * retaining it instead of copying every item, and a span that changes its
+ * baggage gets a new container while contexts holding the old one are
+ * unaffected. Items, strings and the lookup index of a container live in a
+ * single allocation. NULL is a valid empty container for every function.
+ * Containers may be shared between threads.
+ */
+typedef struct opentracing_baggage opentracing_baggage;
+
+/**
+ * Return a container holding the items of baggage with key set to value,
+ * replacing any existing value for key. Items keep their insertion order.
+ * @param baggage Container to start from. May be NULL. Not modified.
+ * @param key Item key. Need not be null-terminated.
+ * @param key_len Length of key.
+ * @param value Item value. Need not be null-terminated.
+ * @param value_len Length of value.
+ * @return New container with a reference count of one, NULL if out of
+ *         memory. Release using opentracing_baggage_release().
+ */
+OPENTRACINGC_EXPORT opentracing_baggage*
+opentracing_baggage_with_item(const opentracing_baggage* baggage,
+                              const char* key,
+                              size_t key_len,
+                              const char* value,
+                              size_t value_len) OPENTRACINGC_NONNULL(2, 4);
+
+/**
+ * Add a reference to a container.
+ * @param baggage Container. May be NULL.
+ * @return baggage, for convenience.
+ */
+OPENTRACINGC_EXPORT opentracing_baggage*
+opentracing_baggage_retain(const opentracing_baggage* baggage);
+
+/**
+ * Drop a reference to a container, freeing it when none remain.
+ * @param baggage Container. May be NULL.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_baggage_release(const opentracing_baggage* baggage);
+
+/**
+ * Number of items in a container.
+ * @param baggage Container. May be NULL.
+ * @return Number of items.
+ */
+OPENTRACINGC_EXPORT int
+opentracing_baggage_size(const opentracing_baggage* baggage);
+
+/**
+ * Look up the value of a baggage item. Hashed, so the cost does not grow
+ * with the number of items.
+ * @param baggage Container. May be NULL.
+ * @param key Null-terminated key.
+ * @return Null-terminated value that lives as long as the container, or NULL
+ *         if key is absent.
+ */
+OPENTRACINGC_EXPORT const char*
+opentracing_baggage_get(const opentracing_baggage* baggage, const char* key)
+    OPENTRACINGC_NONNULL(2);
+
+/**
+ * Read an item by position, e.g. to encode a container without calling back
+ * for each item.
+ * @param baggage Container. May be NULL.
+ * @param index Item position from zero to opentracing_baggage_size() - 1.
+ * @param[out] key Key, null-terminated after length bytes.
+ * @param[out] value Value, null-terminated after length bytes.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_baggage_item(const opentracing_baggage* baggage,
+                         int index,
+                         opentracing_string_view* key,
+                         opentracing_string_view* value)
+    OPENTRACINGC_NONNULL(3, 4);
+
+/**
+ * Call f for each item in insertion order, stopping early if f returns
+ * opentracing_false. Matches foreach_baggage_item, so span contexts can
+ * forward to it directly.
+ * @param baggage Container. May be NULL.
+ * @param f Callback taking arg, a key and a value.
+ * @param arg User-defined context argument.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_baggage_foreach(const opentracing_baggage* baggage,
+                            opentracing_bool (*f)(void*,
+                                                  const char*,
+                                                  const char*),
+                            void* arg) OPENTRACINGC_NONNULL(2);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_BAGGAGE_H */
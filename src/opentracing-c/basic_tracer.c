@@ -0,0 +1,2091 @@
+#include <opentracing-c/basic_tracer.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <opentracing-c/baggage.h>
+#include <opentracing-c/binary.h>
+#include <opentracing-c/header_codec.h>
+#include <opentracing-c/internal/atomic.h>
+#include <opentracing-c/internal/pool.h>
+#include <opentracing-c/internal/recorder.h>
+#include <opentracing-c/internal/stats.h>
+#include <opentracing-c/sampler.h>
+#include <opentracing-c/scope_manager.h>
+
+#define MAX_CACHED_OBJECTS 1024
+
+#define DEFAULT_BUFFER_SIZE 4096
+#define DEFAULT_BATCH_SIZE 256
+#define DEFAULT_FLUSH_INTERVAL_MS 50
+#define DEFAULT_CLOSE_TIMEOUT_MS 1000
+
+#define INLINE_TAGS 8
+#define INLINE_LOGS 4
+#define INLINE_REFERENCES 2
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(size) \
+    (((size) + (ARENA_ALIGNMENT - 1)) & ~((size_t) ARENA_ALIGNMENT - 1))
+#define INLINE_ARENA_SIZE 512
+#define ARENA_CHUNK_SIZE 2048
+
+#define TRACE_ID_KEY "ot-tracer-traceid"
+#define SPAN_ID_KEY "ot-tracer-spanid"
+#define SAMPLED_KEY "ot-tracer-sampled"
+#define BAGGAGE_PREFIX "ot-baggage-"
+#define BAGGAGE_PREFIX_LENGTH (sizeof(BAGGAGE_PREFIX) - 1)
+
+#define MAX_STACK_BAGGAGE 16
+
+static const char basic_span_context_type[] = "opentracing-c/basic";
+
+typedef struct basic_span_context {
+    opentracing_span_context base;
+    int ref_count;
+    opentracing_trace_id trace_id;
+    uint64_t span_id;
+    opentracing_bool sampled;
+    /* Set for contexts extracted from carriers. */
+    opentracing_bool remote;
+    /* Shared with parent and child contexts until either changes it. */
+    const opentracing_baggage* baggage;
+} basic_span_context;
+
+/*
+ * Context a span replaced when it changed shared baggage. The span handed
+ * the old context out through span_context(), so it stays referenced until
+ * the span is destroyed.
+ */
+typedef struct replaced_context {
+    basic_span_context* context;
+    struct replaced_context* next;
+} replaced_context;
+
+typedef struct basic_tracer {
+    opentracing_tracer base;
+    opentracing_reporter* reporter;
+    opentracing_recorder* recorder;
+    opentracing_sampler* sampler;
+    /* Scratch space used by the collector thread to build report batches. */
+    const opentracing_span_data** batch;
+    int close_timeout_ms;
+    opentracing_bool ignore_text_map_baggage;
+} basic_tracer;
+
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t size;
+    size_t used;
+} arena_chunk;
+
+#define ARENA_CHUNK_HEADER_SIZE ARENA_ALIGN(sizeof(arena_chunk))
+
+typedef struct basic_span {
+    opentracing_span base;
+    /* One reference for the owner, one while queued for reporting. */
+    int ref_count;
+    basic_tracer* tracer;
+    basic_span_context* context;
+    replaced_context* replaced;
+    opentracing_span_data data;
+    opentracing_duration start_time_steady;
+    opentracing_bool finished;
+
+    opentracing_tag* tags;
+    int num_tags;
+    int tag_capacity;
+
+    opentracing_log_record* logs;
+    int num_logs;
+    int log_capacity;
+
+    opentracing_span_data_reference* references;
+    int num_references;
+
+    /* Storage for copied strings and log fields. */
+    size_t arena_used;
+    arena_chunk* arena_overflow;
+
+    opentracing_tag inline_tags[INLINE_TAGS];
+    opentracing_log_record inline_logs[INLINE_LOGS];
+    opentracing_span_data_reference inline_references[INLINE_REFERENCES];
+    union {
+        char bytes[INLINE_ARENA_SIZE];
+        double alignment;
+    } arena;
+} basic_span;
+
+/*
+ * Span of a trace that is not sampled. Nothing is recorded, so it only holds
+ * a context for propagation. Children of an unsampled span share its
+ * context.
+ */
+typedef struct unsampled_span {
+    opentracing_span base;
+    basic_tracer* tracer;
+    basic_span_context* context;
+    replaced_context* replaced;
+} unsampled_span;
+
+static const opentracing_vtable_header span_context_header =
+    OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span_context);
+static const opentracing_vtable_header span_header =
+    OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span);
+static const opentracing_vtable_header tracer_header =
+    OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_tracer);
+
+static const opentracing_pool span_pool =
+    OPENTRACINGC_POOL_INIT(basic_span,
+                           opentracing_pool_slot_span,
+                           MAX_CACHED_OBJECTS);
+
+static const opentracing_pool span_context_pool =
+    OPENTRACINGC_POOL_INIT(basic_span_context,
+                           opentracing_pool_slot_span_context,
+                           MAX_CACHED_OBJECTS);
+
+static const opentracing_pool unsampled_span_pool =
+    OPENTRACINGC_POOL_INIT(unsampled_span,
+                           opentracing_pool_slot_unsampled_span,
+                           MAX_CACHED_OBJECTS);
+
+static const char empty_str[] = "";
+
+/* Clocks. */
+
+static opentracing_bool time_value_is_zero(const opentracing_time_value* value)
+{
+    return (value->tv_sec == 0 && value->tv_nsec == 0) ? opentracing_true
+                                                       : opentracing_false;
+}
+
+static void time_value_subtract(opentracing_time_value* result,
+                                const opentracing_time_value* end,
+                                const opentracing_time_value* start)
+{
+    result->tv_sec = end->tv_sec - start->tv_sec;
+    result->tv_nsec = end->tv_nsec - start->tv_nsec;
+    if (result->tv_nsec < 0) {
+        result->tv_sec--;
+        result->tv_nsec += 1000000000L;
+    }
+    if (result->tv_sec < 0) {
+        result->tv_sec = 0;
+        result->tv_nsec = 0;
+    }
+}
+
+/* ID generation. */
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+static OPENTRACINGC_THREAD_LOCAL uint64_t random_state = 0;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static uint64_t random_seed = 0;
+
+#define GOLDEN_GAMMA UINT64_C(0x9E3779B97F4A7C15)
+
+static uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static uint64_t random_id(void)
+{
+    uint64_t id;
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    struct timespec ts;
+    if (random_state == 0) {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        random_state = mix64((uint64_t) ts.tv_sec * 1000000000U +
+                             (uint64_t) ts.tv_nsec) ^
+                       mix64((uint64_t)(size_t) &random_state) ^
+                       mix64(OPENTRACINGC_ATOMIC_FETCH_ADD(
+                           &random_seed, GOLDEN_GAMMA,
+                           OPENTRACINGC_ATOMIC_RELAXED));
+    }
+    do {
+        random_state += GOLDEN_GAMMA;
+        id = mix64(random_state);
+    } while (id == 0);
+#else
+    do {
+        id = mix64(OPENTRACINGC_ATOMIC_FETCH_ADD(
+                       &random_seed, GOLDEN_GAMMA,
+                       OPENTRACINGC_ATOMIC_RELAXED) +
+                   GOLDEN_GAMMA);
+    } while (id == 0);
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return id;
+}
+
+/* Span context. */
+
+static void basic_span_context_destroy(opentracing_destructible* destructible);
+
+static opentracing_span_context*
+basic_span_context_retain(opentracing_span_context* span_context)
+{
+    basic_span_context* context;
+
+    assert(span_context != NULL);
+    context = (basic_span_context*) span_context;
+    OPENTRACINGC_ATOMIC_FETCH_ADD(
+        &context->ref_count, 1, OPENTRACINGC_ATOMIC_RELAXED);
+    return span_context;
+}
+
+static void
+basic_span_context_foreach_baggage_item(opentracing_span_context* span_context,
+                                        opentracing_bool (*f)(void*,
+                                                              const char*,
+                                                              const char*),
+                                        void* arg)
+{
+    assert(span_context != NULL);
+    assert(f != NULL);
+    opentracing_baggage_foreach(
+        ((const basic_span_context*) span_context)->baggage, f, arg);
+}
+
+static opentracing_bool
+is_basic_span_context(const opentracing_span_context* span_context)
+{
+    if (span_context->type_descriptor == basic_span_context_type) {
+        return opentracing_true;
+    }
+    return (span_context->type_descriptor != NULL &&
+            span_context->type_descriptor_length ==
+                sizeof(basic_span_context_type) &&
+            memcmp(span_context->type_descriptor,
+                   basic_span_context_type,
+                   sizeof(basic_span_context_type)) == 0)
+               ? opentracing_true
+               : opentracing_false;
+}
+
+static basic_span_context* basic_span_context_new(void)
+{
+    basic_span_context* context;
+
+    context = (basic_span_context*) opentracing_pool_alloc(&span_context_pool);
+    if (context == NULL) {
+        return NULL;
+    }
+    memset(context, 0, sizeof(*context));
+    ((opentracing_destructible*) context)->destroy =
+        &basic_span_context_destroy;
+    ((opentracing_span_context*) context)->header = span_context_header;
+    ((opentracing_span_context*) context)->foreach_baggage_item =
+        &basic_span_context_foreach_baggage_item;
+    ((opentracing_span_context*) context)->type_descriptor =
+        basic_span_context_type;
+    ((opentracing_span_context*) context)->type_descriptor_length =
+        sizeof(basic_span_context_type);
+    ((opentracing_span_context*) context)->retain = &basic_span_context_retain;
+    context->ref_count = 1;
+    context->sampled = opentracing_true;
+    return context;
+}
+
+static void basic_span_context_release(basic_span_context* context)
+{
+    if (OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &context->ref_count, 1, OPENTRACINGC_ATOMIC_ACQ_REL) != 1) {
+        return;
+    }
+    opentracing_baggage_release(context->baggage);
+    opentracing_pool_free(&span_context_pool, context);
+}
+
+static void basic_span_context_destroy(opentracing_destructible* destructible)
+{
+    assert(destructible != NULL);
+    basic_span_context_release((basic_span_context*) destructible);
+}
+
+static opentracing_bool
+basic_span_context_set_baggage(basic_span_context* context,
+                               const char* key,
+                               size_t key_len,
+                               const char* value,
+                               size_t value_len)
+{
+    opentracing_baggage* baggage;
+
+    baggage = opentracing_baggage_with_item(
+        context->baggage, key, key_len, value, value_len);
+    if (baggage == NULL) {
+        return opentracing_false;
+    }
+    opentracing_baggage_release(context->baggage);
+    context->baggage = baggage;
+    return opentracing_true;
+}
+
+/*
+ * Replace a shared context with a private copy so it can be changed.
+ * Contexts retained elsewhere must not change under their holders. The old
+ * context is pushed onto replaced rather than released, so pointers the span
+ * already handed out stay valid.
+ */
+static opentracing_bool basic_span_context_unshare(basic_span_context** context,
+                                                   replaced_context** replaced)
+{
+    basic_span_context* copy;
+    replaced_context* node;
+
+    if (OPENTRACINGC_ATOMIC_LOAD(&(*context)->ref_count,
+                                 OPENTRACINGC_ATOMIC_ACQUIRE) == 1) {
+        return opentracing_true;
+    }
+    node = (replaced_context*) malloc(sizeof(replaced_context));
+    if (node == NULL) {
+        return opentracing_false;
+    }
+    copy = basic_span_context_new();
+    if (copy == NULL) {
+        free(node);
+        return opentracing_false;
+    }
+    copy->trace_id = (*context)->trace_id;
+    copy->span_id = (*context)->span_id;
+    copy->sampled = (*context)->sampled;
+    copy->remote = (*context)->remote;
+    copy->baggage = opentracing_baggage_retain((*context)->baggage);
+    node->context = *context;
+    node->next = *replaced;
+    *replaced = node;
+    *context = copy;
+    return opentracing_true;
+}
+
+static void basic_span_context_release_replaced(replaced_context* replaced)
+{
+    replaced_context* next;
+
+    for (; replaced != NULL; replaced = next) {
+        next = replaced->next;
+        basic_span_context_release(replaced->context);
+        free(replaced);
+    }
+}
+
+/* Span arena. */
+
+static void* basic_span_arena_alloc(basic_span* span, size_t size)
+{
+    arena_chunk* chunk;
+    size_t chunk_size;
+    void* ptr;
+
+    size = ARENA_ALIGN(size);
+    if (INLINE_ARENA_SIZE - span->arena_used >= size) {
+        ptr = &span->arena.bytes[span->arena_used];
+        span->arena_used += size;
+        return ptr;
+    }
+
+    chunk = span->arena_overflow;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        chunk_size = (size > ARENA_CHUNK_SIZE) ? size : ARENA_CHUNK_SIZE;
+        chunk = (arena_chunk*) malloc(ARENA_CHUNK_HEADER_SIZE + chunk_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = span->arena_overflow;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        span->arena_overflow = chunk;
+    }
+    ptr = ((char*) chunk) + ARENA_CHUNK_HEADER_SIZE + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+static char* basic_span_arena_strdup(basic_span* span, const char* str)
+{
+    size_t len;
+    char* copy;
+
+    len = strlen(str);
+    copy = (char*) basic_span_arena_alloc(span, len + 1);
+    if (copy != NULL) {
+        memcpy(copy, str, len + 1);
+    }
+    return copy;
+}
+
+/*
+ * String views are copied with a terminating null character appended, so
+ * reporters may treat the copy's data as a C string if it has no embedded
+ * nulls.
+ */
+static opentracing_bool basic_span_copy_value(basic_span* span,
+                                              opentracing_value* dst,
+                                              const opentracing_value* src)
+{
+    const opentracing_string_view* view;
+    char* copy;
+
+    *dst = *src;
+    if (src->type == opentracing_value_string &&
+        src->value.string_value != NULL) {
+        dst->value.string_value =
+            basic_span_arena_strdup(span, src->value.string_value);
+        if (dst->value.string_value == NULL) {
+            return opentracing_false;
+        }
+    }
+    else if (src->type == opentracing_value_string_view) {
+        view = &src->value.string_view_value;
+        copy = (char*) basic_span_arena_alloc(span, view->length + 1);
+        if (copy == NULL) {
+            return opentracing_false;
+        }
+        if (view->length > 0) {
+            memcpy(copy, view->data, view->length);
+        }
+        copy[view->length] = '\0';
+        dst->value.string_view_value.data = copy;
+    }
+    return opentracing_true;
+}
+
+/* Span. */
+
+static void basic_span_release(basic_span* s);
+
+static void basic_span_finish(opentracing_span* span)
+{
+    span->finish_with_options(span, NULL);
+}
+
+static opentracing_bool basic_span_reserve_logs(basic_span* span, int num_logs)
+{
+    opentracing_log_record* logs;
+    int capacity;
+
+    if (num_logs <= span->log_capacity) {
+        return opentracing_true;
+    }
+    capacity = span->log_capacity * 2;
+    if (capacity < num_logs) {
+        capacity = num_logs;
+    }
+    if (span->logs == span->inline_logs) {
+        logs = (opentracing_log_record*) malloc(sizeof(opentracing_log_record) *
+                                                capacity);
+        if (logs != NULL) {
+            memcpy(logs,
+                   span->inline_logs,
+                   sizeof(opentracing_log_record) * span->num_logs);
+        }
+    }
+    else {
+        logs = (opentracing_log_record*) realloc(
+            span->logs, sizeof(opentracing_log_record) * capacity);
+    }
+    if (logs == NULL) {
+        return opentracing_false;
+    }
+    span->logs = logs;
+    span->log_capacity = capacity;
+    return opentracing_true;
+}
+
+/*
+ * Append a log record. Fields are taken from fields if it is not NULL,
+ * otherwise from interned_fields, whose keys are not copied.
+ */
+static opentracing_bool
+basic_span_append_log(basic_span* span,
+                      const opentracing_timestamp* ts,
+                      const opentracing_log_field* fields,
+                      const opentracing_interned_log_field* interned_fields,
+                      int num_fields)
+{
+    opentracing_log_record* record;
+    opentracing_log_field* copies;
+    const opentracing_value* value;
+    int i;
+
+    if (!basic_span_reserve_logs(span, span->num_logs + 1)) {
+        return opentracing_false;
+    }
+
+    copies = NULL;
+    if (num_fields > 0) {
+        copies = (opentracing_log_field*) basic_span_arena_alloc(
+            span, sizeof(opentracing_log_field) * num_fields);
+        if (copies == NULL) {
+            return opentracing_false;
+        }
+        for (i = 0; i < num_fields; i++) {
+            if (fields != NULL) {
+                copies[i].key = basic_span_arena_strdup(span, fields[i].key);
+                value = &fields[i].value;
+            }
+            else {
+                copies[i].key =
+                    opentracing_interned_string(interned_fields[i].key);
+                value = &interned_fields[i].value;
+            }
+            if (copies[i].key == NULL ||
+                !basic_span_copy_value(span, &copies[i].value, value)) {
+                return opentracing_false;
+            }
+        }
+    }
+
+    record = &span->logs[span->num_logs];
+    record->timestamp = *ts;
+    record->fields = copies;
+    record->num_fields = num_fields;
+    span->num_logs++;
+    return opentracing_true;
+}
+
+static void basic_span_append_logs(basic_span* span,
+                                   const opentracing_log_record* records,
+                                   int num_records)
+{
+    opentracing_timestamp now;
+    const opentracing_timestamp* timestamp;
+    int i;
+
+    if (num_records <= 0 ||
+        !basic_span_reserve_logs(span, span->num_logs + num_records)) {
+        return;
+    }
+    memset(&now, 0, sizeof(now));
+    for (i = 0; i < num_records; i++) {
+        timestamp = &records[i].timestamp;
+        if (time_value_is_zero(&timestamp->value)) {
+            if (time_value_is_zero(&now.value)) {
+                opentracing_now_system(&now);
+            }
+            timestamp = &now;
+        }
+        basic_span_append_log(span,
+                              timestamp,
+                              records[i].fields,
+                              NULL,
+                              records[i].num_fields);
+    }
+}
+
+static void
+basic_span_finish_with_options(opentracing_span* span,
+                               const opentracing_finish_span_options* options)
+{
+    basic_span* s;
+    opentracing_duration finish_time;
+    opentracing_reporter* reporter;
+    const opentracing_span_data* data;
+
+    assert(span != NULL);
+    s = (basic_span*) span;
+    if (s->finished) {
+        return;
+    }
+    s->finished = opentracing_true;
+    opentracing_stats_add(opentracing_stats_spans_finished, 1);
+
+    if (options != NULL && !time_value_is_zero(&options->finish_time.value)) {
+        finish_time = options->finish_time;
+    }
+    else {
+        opentracing_now_steady(&finish_time);
+    }
+
+    if (options != NULL) {
+        basic_span_append_logs(
+            s, options->log_records, options->num_log_records);
+    }
+
+    time_value_subtract(&s->data.duration.value,
+                        &finish_time.value,
+                        &s->start_time_steady.value);
+    s->data.tags = s->tags;
+    s->data.num_tags = s->num_tags;
+    s->data.logs = s->logs;
+    s->data.num_logs = s->num_logs;
+    s->data.references = s->references;
+    s->data.num_references = s->num_references;
+
+    reporter = s->tracer->reporter;
+    if (reporter == NULL || !s->context->sampled) {
+        return;
+    }
+    if (s->tracer->recorder != NULL) {
+        /* Only the owner can see the span until the push publishes it, so
+         * the collector's reference is added with a plain store. */
+        OPENTRACINGC_ATOMIC_STORE(
+            &s->ref_count, 2, OPENTRACINGC_ATOMIC_RELAXED);
+        if (!opentracing_recorder_push(s->tracer->recorder, s)) {
+            OPENTRACINGC_ATOMIC_STORE(
+                &s->ref_count, 1, OPENTRACINGC_ATOMIC_RELAXED);
+            opentracing_stats_add(opentracing_stats_spans_dropped, 1);
+        }
+        else {
+            opentracing_stats_add(opentracing_stats_spans_enqueued, 1);
+        }
+        return;
+    }
+    data = &s->data;
+    reporter->report(reporter, &data, 1);
+}
+
+static opentracing_span_context* basic_span_span_context(opentracing_span* span)
+{
+    assert(span != NULL);
+    return (opentracing_span_context*) ((basic_span*) span)->context;
+}
+
+static void basic_span_set_operation_name(opentracing_span* span,
+                                          const char* operation_name)
+{
+    basic_span* s;
+    char* copy;
+
+    assert(span != NULL);
+    assert(operation_name != NULL);
+    s = (basic_span*) span;
+    copy = basic_span_arena_strdup(s, operation_name);
+    if (copy != NULL) {
+        s->data.operation_name = copy;
+    }
+}
+
+static opentracing_bool basic_span_reserve_tags(basic_span* s, int num_tags)
+{
+    opentracing_tag* tags;
+    int capacity;
+
+    if (num_tags <= s->tag_capacity) {
+        return opentracing_true;
+    }
+    capacity = s->tag_capacity * 2;
+    if (capacity < num_tags) {
+        capacity = num_tags;
+    }
+    if (s->tags == s->inline_tags) {
+        tags = (opentracing_tag*) malloc(sizeof(opentracing_tag) * capacity);
+        if (tags != NULL) {
+            memcpy(tags, s->inline_tags, sizeof(opentracing_tag) * s->num_tags);
+        }
+    }
+    else {
+        tags = (opentracing_tag*) realloc(s->tags,
+                                          sizeof(opentracing_tag) * capacity);
+    }
+    if (tags == NULL) {
+        return opentracing_false;
+    }
+    s->tags = tags;
+    s->tag_capacity = capacity;
+    return opentracing_true;
+}
+
+/*
+ * Callers must reserve room for one more tag first. Interned keys live for
+ * the whole process and are stored without copying.
+ */
+static void basic_span_put_tag(basic_span* s,
+                               const char* key,
+                               opentracing_bool interned,
+                               const opentracing_value* value)
+{
+    opentracing_tag* tag;
+    int i;
+
+    assert(key != NULL);
+    assert(value != NULL);
+    for (i = 0; i < s->num_tags; i++) {
+        if (s->tags[i].key == key || strcmp(s->tags[i].key, key) == 0) {
+            basic_span_copy_value(s, &s->tags[i].value, value);
+            return;
+        }
+    }
+
+    assert(s->num_tags < s->tag_capacity);
+    tag = &s->tags[s->num_tags];
+    tag->key = interned ? (char*) key : basic_span_arena_strdup(s, key);
+    if (tag->key == NULL || !basic_span_copy_value(s, &tag->value, value)) {
+        return;
+    }
+    s->num_tags++;
+}
+
+static void basic_span_set_tag(opentracing_span* span,
+                               const char* key,
+                               const opentracing_value* value)
+{
+    basic_span* s;
+
+    assert(span != NULL);
+    s = (basic_span*) span;
+    if (basic_span_reserve_tags(s, s->num_tags + 1)) {
+        basic_span_put_tag(s, key, opentracing_false, value);
+    }
+}
+
+static void basic_span_set_tag_interned(opentracing_span* span,
+                                        opentracing_string_handle key,
+                                        const opentracing_value* value)
+{
+    basic_span* s;
+    const char* str;
+
+    assert(span != NULL);
+    s = (basic_span*) span;
+    str = opentracing_interned_string(key);
+    if (str != NULL && basic_span_reserve_tags(s, s->num_tags + 1)) {
+        basic_span_put_tag(s, str, opentracing_true, value);
+    }
+}
+
+static void basic_span_set_tags(opentracing_span* span,
+                                const opentracing_tag* tags,
+                                int num_tags)
+{
+    basic_span* s;
+    int i;
+
+    assert(span != NULL);
+    assert(tags != NULL || num_tags == 0);
+    s = (basic_span*) span;
+    if (num_tags <= 0 || !basic_span_reserve_tags(s, s->num_tags + num_tags)) {
+        return;
+    }
+    for (i = 0; i < num_tags; i++) {
+        basic_span_put_tag(s, tags[i].key, opentracing_false, &tags[i].value);
+    }
+}
+
+static void basic_span_log_fields(opentracing_span* span,
+                                  const opentracing_log_field* fields,
+                                  int num_fields)
+{
+    opentracing_timestamp timestamp;
+
+    assert(span != NULL);
+    assert(fields != NULL || num_fields == 0);
+    opentracing_now_system(&timestamp);
+    basic_span_append_log(
+        (basic_span*) span, &timestamp, fields, NULL, num_fields);
+}
+
+static void
+basic_span_log_fields_interned(opentracing_span* span,
+                               const opentracing_interned_log_field* fields,
+                               int num_fields)
+{
+    opentracing_timestamp timestamp;
+
+    assert(span != NULL);
+    assert(fields != NULL || num_fields == 0);
+    opentracing_now_system(&timestamp);
+    basic_span_append_log(
+        (basic_span*) span, &timestamp, NULL, fields, num_fields);
+}
+
+static void basic_span_log_records(opentracing_span* span,
+                                   const opentracing_log_record* records,
+                                   int num_records)
+{
+    assert(span != NULL);
+    assert(records != NULL || num_records == 0);
+    basic_span_append_logs((basic_span*) span, records, num_records);
+}
+
+static void basic_span_set_baggage_item(opentracing_span* span,
+                                        const char* key,
+                                        const char* value)
+{
+    basic_span* s;
+
+    assert(span != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+    s = (basic_span*) span;
+    if (basic_span_context_unshare(&s->context, &s->replaced)) {
+        basic_span_context_set_baggage(
+            s->context, key, strlen(key), value, strlen(value));
+    }
+}
+
+static const char* basic_span_baggage_item(const opentracing_span* span,
+                                           const char* key)
+{
+    const basic_span_context* context;
+    const char* value;
+
+    assert(span != NULL);
+    assert(key != NULL);
+    context = ((const basic_span*) span)->context;
+    value = opentracing_baggage_get(context->baggage, key);
+    return (value != NULL) ? value : empty_str;
+}
+
+static opentracing_tracer* basic_span_tracer(const opentracing_span* span)
+{
+    assert(span != NULL);
+    return (opentracing_tracer*) ((const basic_span*) span)->tracer;
+}
+
+static void basic_span_release(basic_span* s)
+{
+    arena_chunk* chunk;
+    arena_chunk* next;
+
+    if (OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &s->ref_count, 1, OPENTRACINGC_ATOMIC_ACQ_REL) != 1) {
+        return;
+    }
+
+    basic_span_context_release(s->context);
+    basic_span_context_release_replaced(s->replaced);
+    for (chunk = s->arena_overflow; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    if (s->tags != s->inline_tags) {
+        free(s->tags);
+    }
+    if (s->logs != s->inline_logs) {
+        free(s->logs);
+    }
+    if (s->references != s->inline_references) {
+        free(s->references);
+    }
+    opentracing_pool_free(&span_pool, s);
+}
+
+static void basic_span_destroy(opentracing_destructible* destructible)
+{
+    assert(destructible != NULL);
+    basic_span_release((basic_span*) destructible);
+}
+
+static void basic_span_init(basic_span* s, basic_tracer* tracer)
+{
+    opentracing_span* span;
+
+    span = (opentracing_span*) s;
+    ((opentracing_destructible*) span)->destroy = &basic_span_destroy;
+    span->header = span_header;
+    span->finish = &basic_span_finish;
+    span->finish_with_options = &basic_span_finish_with_options;
+    span->span_context = &basic_span_span_context;
+    span->set_operation_name = &basic_span_set_operation_name;
+    span->set_tag = &basic_span_set_tag;
+    span->log_fields = &basic_span_log_fields;
+    span->set_baggage_item = &basic_span_set_baggage_item;
+    span->baggage_item = &basic_span_baggage_item;
+    span->tracer = &basic_span_tracer;
+    span->set_tags = &basic_span_set_tags;
+    span->log_records = &basic_span_log_records;
+    span->set_tag_interned = &basic_span_set_tag_interned;
+    span->log_fields_interned = &basic_span_log_fields_interned;
+
+    s->ref_count = 1;
+    s->tracer = tracer;
+    s->context = NULL;
+    s->replaced = NULL;
+    memset(&s->data, 0, sizeof(s->data));
+    memset(&s->start_time_steady, 0, sizeof(s->start_time_steady));
+    s->finished = opentracing_false;
+    s->tags = s->inline_tags;
+    s->num_tags = 0;
+    s->tag_capacity = INLINE_TAGS;
+    s->logs = s->inline_logs;
+    s->num_logs = 0;
+    s->log_capacity = INLINE_LOGS;
+    s->references = s->inline_references;
+    s->num_references = 0;
+    s->arena_used = 0;
+    s->arena_overflow = NULL;
+}
+
+/* Unsampled span. */
+
+static void unsampled_span_finish(opentracing_span* span)
+{
+    (void) span;
+}
+
+static void unsampled_span_finish_with_options(
+    opentracing_span* span, const opentracing_finish_span_options* options)
+{
+    (void) span;
+    (void) options;
+}
+
+static opentracing_span_context*
+unsampled_span_span_context(opentracing_span* span)
+{
+    assert(span != NULL);
+    return (opentracing_span_context*) ((unsampled_span*) span)->context;
+}
+
+static void unsampled_span_set_operation_name(opentracing_span* span,
+                                              const char* operation_name)
+{
+    (void) span;
+    (void) operation_name;
+}
+
+static void unsampled_span_set_tag(opentracing_span* span,
+                                   const char* key,
+                                   const opentracing_value* value)
+{
+    (void) span;
+    (void) key;
+    (void) value;
+}
+
+static void unsampled_span_log_fields(opentracing_span* span,
+                                      const opentracing_log_field* fields,
+                                      int num_fields)
+{
+    (void) span;
+    (void) fields;
+    (void) num_fields;
+}
+
+static void unsampled_span_set_baggage_item(opentracing_span* span,
+                                            const char* key,
+                                            const char* value)
+{
+    unsampled_span* s;
+
+    assert(span != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+    s = (unsampled_span*) span;
+    if (basic_span_context_unshare(&s->context, &s->replaced)) {
+        basic_span_context_set_baggage(
+            s->context, key, strlen(key), value, strlen(value));
+    }
+}
+
+static const char* unsampled_span_baggage_item(const opentracing_span* span,
+                                               const char* key)
+{
+    const char* value;
+
+    assert(span != NULL);
+    assert(key != NULL);
+    value = opentracing_baggage_get(
+        ((const unsampled_span*) span)->context->baggage, key);
+    return (value != NULL) ? value : empty_str;
+}
+
+static opentracing_tracer* unsampled_span_tracer(const opentracing_span* span)
+{
+    assert(span != NULL);
+    return (opentracing_tracer*) ((const unsampled_span*) span)->tracer;
+}
+
+static void unsampled_span_set_tags(opentracing_span* span,
+                                    const opentracing_tag* tags,
+                                    int num_tags)
+{
+    (void) span;
+    (void) tags;
+    (void) num_tags;
+}
+
+static void unsampled_span_log_records(opentracing_span* span,
+                                       const opentracing_log_record* records,
+                                       int num_records)
+{
+    (void) span;
+    (void) records;
+    (void) num_records;
+}
+
+static void unsampled_span_set_tag_interned(opentracing_span* span,
+                                            opentracing_string_handle key,
+                                            const opentracing_value* value)
+{
+    (void) span;
+    (void) key;
+    (void) value;
+}
+
+static void
+unsampled_span_log_fields_interned(opentracing_span* span,
+                                   const opentracing_interned_log_field* fields,
+                                   int num_fields)
+{
+    (void) span;
+    (void) fields;
+    (void) num_fields;
+}
+
+static void unsampled_span_destroy(opentracing_destructible* destructible)
+{
+    unsampled_span* s;
+
+    assert(destructible != NULL);
+    s = (unsampled_span*) destructible;
+    basic_span_context_release(s->context);
+    basic_span_context_release_replaced(s->replaced);
+    opentracing_pool_free(&unsampled_span_pool, s);
+}
+
+/* Copied into each unsampled span, which then only sets its own fields. */
+static const opentracing_span unsampled_span_vtable = {
+    {&unsampled_span_destroy},
+    OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span),
+    &unsampled_span_finish,
+    &unsampled_span_finish_with_options,
+    &unsampled_span_span_context,
+    &unsampled_span_set_operation_name,
+    &unsampled_span_set_tag,
+    &unsampled_span_log_fields,
+    &unsampled_span_set_baggage_item,
+    &unsampled_span_baggage_item,
+    &unsampled_span_tracer,
+    &unsampled_span_set_tags,
+    &unsampled_span_log_records,
+    &unsampled_span_set_tag_interned,
+    &unsampled_span_log_fields_interned};
+
+/*
+ * Start an unsampled span. With a parent, the span shares the parent's
+ * context. Otherwise it gets a new context in the given trace.
+ */
+static opentracing_span*
+unsampled_span_new(basic_tracer* tracer,
+                   const basic_span_context* parent,
+                   const opentracing_trace_id* trace_id)
+{
+    unsampled_span* s;
+    basic_span_context* context;
+
+    s = (unsampled_span*) opentracing_pool_alloc(&unsampled_span_pool);
+    if (s == NULL) {
+        return NULL;
+    }
+    if (parent != NULL) {
+        /* Only the reference count changes. */
+        context = (basic_span_context*) basic_span_context_retain(
+            (opentracing_span_context*) parent);
+    }
+    else {
+        context = basic_span_context_new();
+        if (context == NULL) {
+            opentracing_pool_free(&unsampled_span_pool, s);
+            return NULL;
+        }
+        context->trace_id = *trace_id;
+        context->span_id = random_id();
+        context->sampled = opentracing_false;
+    }
+    s->base = unsampled_span_vtable;
+    s->tracer = tracer;
+    s->context = context;
+    s->replaced = NULL;
+    opentracing_stats_add(opentracing_stats_spans_started, 1);
+    return (opentracing_span*) s;
+}
+
+/* Tracer. */
+
+static void basic_tracer_close(opentracing_tracer* tracer)
+{
+    basic_tracer* t;
+    opentracing_duration start;
+    opentracing_duration end;
+
+    assert(tracer != NULL);
+    t = (basic_tracer*) tracer;
+    if (t->recorder != NULL) {
+        opentracing_recorder_flush(t->recorder, t->close_timeout_ms);
+    }
+    if (t->reporter != NULL) {
+        opentracing_now_steady(&start);
+        t->reporter->flush(t->reporter);
+        opentracing_now_steady(&end);
+        opentracing_stats_record(
+            opentracing_stats_flush_duration, &start, &end);
+    }
+}
+
+static void basic_tracer_drain(void* arg, void* const* items, int num_items)
+{
+    basic_tracer* t;
+    const basic_span* s;
+    opentracing_duration finish_time;
+    opentracing_duration start;
+    opentracing_duration end;
+    int i;
+
+    t = (basic_tracer*) arg;
+    opentracing_now_steady(&start);
+    for (i = 0; i < num_items; i++) {
+        s = (const basic_span*) items[i];
+        t->batch[i] = &s->data;
+        finish_time.value.tv_sec =
+            s->start_time_steady.value.tv_sec + s->data.duration.value.tv_sec;
+        finish_time.value.tv_nsec =
+            s->start_time_steady.value.tv_nsec + s->data.duration.value.tv_nsec;
+        opentracing_stats_record(
+            opentracing_stats_finish_to_export, &finish_time, &start);
+    }
+    opentracing_stats_add(opentracing_stats_spans_drained,
+                          (uint64_t) num_items);
+    t->reporter->report(t->reporter, t->batch, num_items);
+    opentracing_now_steady(&end);
+    opentracing_stats_record(opentracing_stats_flush_duration, &start, &end);
+    for (i = 0; i < num_items; i++) {
+        basic_span_release((basic_span*) items[i]);
+    }
+}
+
+static void basic_tracer_destroy(opentracing_destructible* destructible)
+{
+    basic_tracer* t;
+
+    assert(destructible != NULL);
+    t = (basic_tracer*) destructible;
+    basic_tracer_close((opentracing_tracer*) t);
+    if (t->recorder != NULL) {
+        opentracing_recorder_destroy(t->recorder);
+    }
+    free((void*) t->batch);
+    if (t->reporter != NULL) {
+        ((opentracing_destructible*) t->reporter)
+            ->destroy((opentracing_destructible*) t->reporter);
+    }
+    if (t->sampler != NULL) {
+        ((opentracing_destructible*) t->sampler)
+            ->destroy((opentracing_destructible*) t->sampler);
+    }
+    free(t);
+}
+
+/* The first child_of reference is preferred as parent. */
+static const basic_span_context*
+select_parent(const opentracing_start_span_options* options)
+{
+    const opentracing_span_reference* ref;
+    const basic_span_context* parent;
+    int i;
+
+    parent = NULL;
+    for (i = 0; i < options->num_references; i++) {
+        ref = &options->references[i];
+        if (ref->referenced_context == NULL ||
+            !is_basic_span_context(ref->referenced_context)) {
+            continue;
+        }
+        if (ref->type == opentracing_span_reference_child_of) {
+            return (const basic_span_context*) ref->referenced_context;
+        }
+        if (parent == NULL) {
+            parent = (const basic_span_context*) ref->referenced_context;
+        }
+    }
+    return parent;
+}
+
+/*
+ * Spans started without references are children of the active span, or of
+ * the active span context.
+ */
+static const basic_span_context* active_parent(void)
+{
+    const opentracing_span_context* context;
+
+    context = opentracing_active_span_context();
+    return (context != NULL && is_basic_span_context(context))
+               ? (const basic_span_context*) context
+               : NULL;
+}
+
+static opentracing_bool
+basic_span_add_references(basic_span* s,
+                          const opentracing_start_span_options* options)
+{
+    const opentracing_span_reference* ref;
+    const basic_span_context* ref_context;
+    opentracing_span_data_reference* dst;
+    int i;
+
+    if (options->num_references > INLINE_REFERENCES) {
+        s->references = (opentracing_span_data_reference*) malloc(
+            sizeof(opentracing_span_data_reference) * options->num_references);
+        if (s->references == NULL) {
+            s->references = s->inline_references;
+            return opentracing_false;
+        }
+    }
+
+    for (i = 0; i < options->num_references; i++) {
+        ref = &options->references[i];
+        if (ref->referenced_context == NULL ||
+            !is_basic_span_context(ref->referenced_context)) {
+            continue;
+        }
+        ref_context = (const basic_span_context*) ref->referenced_context;
+        dst = &s->references[s->num_references];
+        dst->type = ref->type;
+        dst->trace_id = ref_context->trace_id;
+        dst->span_id = ref_context->span_id;
+        s->num_references++;
+    }
+    return opentracing_true;
+}
+
+/*
+ * Interned operation names live for the whole process and are stored without
+ * copying.
+ */
+static opentracing_span*
+basic_tracer_start_span_common(opentracing_tracer* tracer,
+                               const char* operation_name,
+                               opentracing_bool interned,
+                               const opentracing_start_span_options* options)
+{
+    basic_tracer* t;
+    basic_span* s;
+    basic_span_context* context;
+    const basic_span_context* parent;
+    opentracing_bool implicit_parent;
+    opentracing_span_data_reference* ref;
+    opentracing_trace_id trace_id;
+
+    assert(tracer != NULL);
+    assert(operation_name != NULL);
+    t = (basic_tracer*) tracer;
+
+    /* Decide on sampling before allocating anything. */
+    implicit_parent = opentracing_false;
+    if (options != NULL && options->num_references > 0) {
+        parent = select_parent(options);
+    }
+    else {
+        parent = active_parent();
+        implicit_parent = (parent != NULL) ? opentracing_true
+                                           : opentracing_false;
+    }
+    if (parent != NULL) {
+        trace_id = parent->trace_id;
+        if (!parent->sampled) {
+            return unsampled_span_new(t, parent, &trace_id);
+        }
+    }
+    else {
+        trace_id.high = random_id();
+        trace_id.low = random_id();
+        if (t->sampler != NULL &&
+            !t->sampler->is_sampled(t->sampler, &trace_id, operation_name)) {
+            return unsampled_span_new(t, NULL, &trace_id);
+        }
+    }
+
+    s = (basic_span*) opentracing_pool_alloc(&span_pool);
+    if (s == NULL) {
+        return NULL;
+    }
+    basic_span_init(s, t);
+
+    context = basic_span_context_new();
+    if (context == NULL) {
+        opentracing_pool_free(&span_pool, s);
+        return NULL;
+    }
+    s->context = context;
+
+    if (options != NULL && !basic_span_add_references(s, options)) {
+        goto cleanup;
+    }
+    if (implicit_parent) {
+        ref = &s->references[s->num_references++];
+        ref->type = opentracing_span_reference_child_of;
+        ref->trace_id = parent->trace_id;
+        ref->span_id = parent->span_id;
+    }
+
+    context->trace_id = trace_id;
+    if (parent != NULL) {
+        s->data.parent_span_id = parent->span_id;
+        context->baggage = opentracing_baggage_retain(parent->baggage);
+    }
+    context->span_id = random_id();
+    s->data.trace_id = context->trace_id;
+    s->data.span_id = context->span_id;
+    s->data.local_root =
+        (parent == NULL || parent->remote) ? opentracing_true
+                                           : opentracing_false;
+
+    s->data.operation_name =
+        interned ? (char*) operation_name
+                 : basic_span_arena_strdup(s, operation_name);
+    if (s->data.operation_name == NULL) {
+        goto cleanup;
+    }
+
+    opentracing_now(&s->start_time_steady, &s->data.start_timestamp);
+    if (options != NULL &&
+        !time_value_is_zero(&options->start_time_steady.value)) {
+        s->start_time_steady = options->start_time_steady;
+    }
+    if (options != NULL &&
+        !time_value_is_zero(&options->start_time_system.value)) {
+        s->data.start_timestamp = options->start_time_system;
+    }
+
+    if (options != NULL && options->num_tags > 0) {
+        if (!basic_span_reserve_tags(s, options->num_tags)) {
+            goto cleanup;
+        }
+        basic_span_set_tags(
+            (opentracing_span*) s, options->tags, options->num_tags);
+    }
+
+    opentracing_stats_add(opentracing_stats_spans_started, 1);
+    opentracing_stats_add(opentracing_stats_spans_sampled, 1);
+    return (opentracing_span*) s;
+
+cleanup:
+    basic_span_destroy((opentracing_destructible*) s);
+    return NULL;
+}
+
+static opentracing_span* basic_tracer_start_span_with_options(
+    opentracing_tracer* tracer,
+    const char* operation_name,
+    const opentracing_start_span_options* options)
+{
+    return basic_tracer_start_span_common(
+        tracer, operation_name, opentracing_false, options);
+}
+
+static opentracing_span* basic_tracer_start_span_interned(
+    opentracing_tracer* tracer,
+    opentracing_string_handle operation_name,
+    const opentracing_start_span_options* options)
+{
+    const char* str;
+
+    str = opentracing_interned_string(operation_name);
+    if (str == NULL) {
+        return NULL;
+    }
+    return basic_tracer_start_span_common(
+        tracer, str, opentracing_true, options);
+}
+
+static opentracing_span* basic_tracer_start_span(opentracing_tracer* tracer,
+                                                 const char* operation_name)
+{
+    return tracer->start_span_with_options(tracer, operation_name, NULL);
+}
+
+/* Text map propagation. */
+
+typedef struct inject_baggage_arg {
+    opentracing_text_map_writer* carrier;
+    opentracing_propagation_error_code return_code;
+} inject_baggage_arg;
+
+static opentracing_bool
+inject_baggage_item(void* arg, const char* key, const char* value)
+{
+    inject_baggage_arg* inject_arg;
+    char buffer[256];
+    char* prefixed_key;
+    size_t key_len;
+
+    inject_arg = (inject_baggage_arg*) arg;
+    key_len = strlen(key);
+    prefixed_key = buffer;
+    if (BAGGAGE_PREFIX_LENGTH + key_len + 1 > sizeof(buffer)) {
+        prefixed_key = (char*) malloc(BAGGAGE_PREFIX_LENGTH + key_len + 1);
+        if (prefixed_key == NULL) {
+            inject_arg->return_code = opentracing_propagation_error_code_unknown;
+            return opentracing_false;
+        }
+    }
+    memcpy(prefixed_key, BAGGAGE_PREFIX, BAGGAGE_PREFIX_LENGTH);
+    memcpy(prefixed_key + BAGGAGE_PREFIX_LENGTH, key, key_len + 1);
+    inject_arg->return_code =
+        inject_arg->carrier->set(inject_arg->carrier, prefixed_key, value);
+    if (prefixed_key != buffer) {
+        free(prefixed_key);
+    }
+    return (inject_arg->return_code ==
+            opentracing_propagation_error_code_success)
+               ? opentracing_true
+               : opentracing_false;
+}
+
+static opentracing_propagation_error_code
+inject_text_map_common(opentracing_text_map_writer* carrier,
+                       const opentracing_span_context* span_context)
+{
+    const basic_span_context* context;
+    opentracing_propagation_error_code return_code;
+    inject_baggage_arg arg;
+    char trace_id[33];
+    char span_id[17];
+
+    if (!is_basic_span_context(span_context)) {
+        return opentracing_propagation_error_code_invalid_span_context;
+    }
+    context = (const basic_span_context*) span_context;
+
+    if (context->trace_id.high != 0) {
+        opentracing_hex_encode_trace_id(&context->trace_id, trace_id);
+        trace_id[32] = '\0';
+    }
+    else {
+        opentracing_hex_encode_u64(context->trace_id.low, trace_id);
+        trace_id[16] = '\0';
+    }
+    opentracing_hex_encode_u64(context->span_id, span_id);
+    span_id[16] = '\0';
+
+    return_code = carrier->set(carrier, TRACE_ID_KEY, trace_id);
+    if (return_code != opentracing_propagation_error_code_success) {
+        return return_code;
+    }
+    return_code = carrier->set(carrier, SPAN_ID_KEY, span_id);
+    if (return_code != opentracing_propagation_error_code_success) {
+        return return_code;
+    }
+    return_code =
+        carrier->set(carrier, SAMPLED_KEY, context->sampled ? "true" : "false");
+    if (return_code != opentracing_propagation_error_code_success) {
+        return return_code;
+    }
+
+    arg.carrier = carrier;
+    arg.return_code = opentracing_propagation_error_code_success;
+    basic_span_context_foreach_baggage_item(
+        (opentracing_span_context*) context, &inject_baggage_item, &arg);
+    return arg.return_code;
+}
+
+/*
+ * Context formats accepted on extraction, by precedence: ot-tracer keys,
+ * then W3C traceparent, then B3. A carrier holding several formats yields
+ * the context of the first one present, whether its keys are looked up or
+ * enumerated in any order, and headers of the others are ignored.
+ */
+enum { EXTRACT_TRACEPARENT, EXTRACT_B3, EXTRACT_NUM_HEADERS };
+
+typedef struct extract_header {
+    /* span_context_not_found until the header is seen. */
+    opentracing_propagation_error_code return_code;
+    opentracing_trace_id trace_id;
+    uint64_t span_id;
+    opentracing_bool sampled;
+} extract_header;
+
+typedef struct extract_arg {
+    basic_span_context* context;
+    opentracing_bool found_trace_id;
+    opentracing_bool found_span_id;
+    opentracing_bool ignore_baggage;
+    /* ot-tracer keys seen. Baggage alone is not a context. */
+    int num_fields;
+    extract_header headers[EXTRACT_NUM_HEADERS];
+} extract_arg;
+
+static void extract_arg_init(extract_arg* arg)
+{
+    int i;
+
+    memset(arg, 0, sizeof(*arg));
+    for (i = 0; i < EXTRACT_NUM_HEADERS; i++) {
+        arg->headers[i].return_code =
+            opentracing_propagation_error_code_span_context_not_found;
+        arg->headers[i].sampled = opentracing_true;
+    }
+}
+
+/* Whether ot-tracer keys or one of the first num_headers headers were seen. */
+static opentracing_bool extract_has_format(const extract_arg* arg,
+                                           int num_headers)
+{
+    int i;
+
+    if (arg->found_trace_id || arg->found_span_id) {
+        return opentracing_true;
+    }
+    for (i = 0; i < num_headers; i++) {
+        if (arg->headers[i].return_code !=
+            opentracing_propagation_error_code_span_context_not_found) {
+            return opentracing_true;
+        }
+    }
+    return opentracing_false;
+}
+
+/* Apply the context of the most preferred format found. */
+static opentracing_propagation_error_code
+extract_resolve(extract_arg* arg)
+{
+    const extract_header* header;
+    int i;
+
+    if (arg->found_trace_id || arg->found_span_id) {
+        return (arg->found_trace_id && arg->found_span_id)
+                   ? opentracing_propagation_error_code_success
+                   : opentracing_propagation_error_code_span_context_corrupted;
+    }
+    for (i = 0; i < EXTRACT_NUM_HEADERS; i++) {
+        header = &arg->headers[i];
+        if (header->return_code ==
+            opentracing_propagation_error_code_span_context_not_found) {
+            continue;
+        }
+        if (header->return_code == opentracing_propagation_error_code_success) {
+            arg->context->trace_id = header->trace_id;
+            arg->context->span_id = header->span_id;
+            arg->context->sampled = header->sampled;
+        }
+        return header->return_code;
+    }
+    return (arg->num_fields == 0)
+               ? opentracing_propagation_error_code_span_context_not_found
+               : opentracing_propagation_error_code_span_context_corrupted;
+}
+
+static opentracing_propagation_error_code
+extract_text_map_handler(void* arg, const char* key, const char* value)
+{
+    extract_arg* extract;
+    extract_header* header;
+
+    extract = (extract_arg*) arg;
+    if (strcasecmp(key, TRACE_ID_KEY) == 0) {
+        if (!opentracing_hex_decode_trace_id(
+                value, strlen(value), &extract->context->trace_id)) {
+            return opentracing_propagation_error_code_span_context_corrupted;
+        }
+        extract->found_trace_id = opentracing_true;
+        extract->num_fields++;
+    }
+    else if (strcasecmp(key, SPAN_ID_KEY) == 0) {
+        if (!opentracing_hex_decode_u64(
+                value, strlen(value), &extract->context->span_id)) {
+            return opentracing_propagation_error_code_span_context_corrupted;
+        }
+        extract->found_span_id = opentracing_true;
+        extract->num_fields++;
+    }
+    else if (strcasecmp(key, SAMPLED_KEY) == 0) {
+        extract->context->sampled =
+            (strcasecmp(value, "true") == 0 || strcmp(value, "1") == 0)
+                ? opentracing_true
+                : opentracing_false;
+        extract->num_fields++;
+    }
+    else if (strcasecmp(key, OPENTRACINGC_TRACEPARENT_HEADER) == 0) {
+        /* Accept W3C and B3 contexts from other tracers as well. */
+        header = &extract->headers[EXTRACT_TRACEPARENT];
+        header->return_code = opentracing_traceparent_decode(value,
+                                                             strlen(value),
+                                                             &header->trace_id,
+                                                             &header->span_id,
+                                                             &header->sampled);
+    }
+    else if (strcasecmp(key, OPENTRACINGC_B3_HEADER) == 0) {
+        header = &extract->headers[EXTRACT_B3];
+        header->return_code = opentracing_b3_decode(value,
+                                                    strlen(value),
+                                                    &header->trace_id,
+                                                    &header->span_id,
+                                                    &header->sampled);
+    }
+    else if (strncasecmp(key, BAGGAGE_PREFIX, BAGGAGE_PREFIX_LENGTH) == 0 &&
+             !extract->ignore_baggage) {
+        if (!basic_span_context_set_baggage(
+                extract->context,
+                key + BAGGAGE_PREFIX_LENGTH,
+                strlen(key + BAGGAGE_PREFIX_LENGTH),
+                value,
+                strlen(value))) {
+            return opentracing_propagation_error_code_unknown;
+        }
+    }
+    return opentracing_propagation_error_code_success;
+}
+
+static opentracing_propagation_error_code
+extract_baggage_handler(void* arg, const char* key, const char* value)
+{
+    if (strncasecmp(key, BAGGAGE_PREFIX, BAGGAGE_PREFIX_LENGTH) != 0) {
+        return opentracing_propagation_error_code_success;
+    }
+    return extract_text_map_handler(arg, key, value);
+}
+
+/* Look up the context keys directly. Baggage keys are not known in advance,
+ * so they still take a pass over the carrier, but only once a context has
+ * been found. */
+static opentracing_propagation_error_code
+extract_text_map_keyed(opentracing_text_map_reader* carrier, extract_arg* arg)
+{
+    static const char* const keys[] = {TRACE_ID_KEY,
+                                       SPAN_ID_KEY,
+                                       SAMPLED_KEY,
+                                       OPENTRACINGC_TRACEPARENT_HEADER,
+                                       OPENTRACINGC_B3_HEADER};
+    opentracing_propagation_error_code return_code;
+    const char* value;
+    size_t i;
+
+    for (i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        /* Keys are in order of precedence, so stop at the first format. */
+        if (i >= 3 && extract_has_format(arg, (int) i - 3)) {
+            break;
+        }
+        return_code = carrier->get(carrier, keys[i], &value);
+        if (return_code ==
+            opentracing_propagation_error_code_span_context_not_found) {
+            continue;
+        }
+        if (return_code == opentracing_propagation_error_code_success) {
+            return_code = extract_text_map_handler(arg, keys[i], value);
+        }
+        if (return_code != opentracing_propagation_error_code_success) {
+            return return_code;
+        }
+    }
+
+    if ((arg->num_fields == 0 &&
+         !extract_has_format(arg, EXTRACT_NUM_HEADERS)) ||
+        arg->ignore_baggage) {
+        return opentracing_propagation_error_code_success;
+    }
+    return carrier->foreach_key(carrier, &extract_baggage_handler, arg);
+}
+
+static opentracing_propagation_error_code
+extract_text_map_common(const basic_tracer* tracer,
+                        opentracing_text_map_reader* carrier,
+                        opentracing_span_context** span_context)
+{
+    opentracing_propagation_error_code return_code;
+    extract_arg arg;
+
+    *span_context = NULL;
+    extract_arg_init(&arg);
+    arg.ignore_baggage = tracer->ignore_text_map_baggage;
+    arg.context = basic_span_context_new();
+    if (arg.context == NULL) {
+        return opentracing_propagation_error_code_unknown;
+    }
+    arg.context->remote = opentracing_true;
+
+    if (OPENTRACINGC_TEXT_MAP_READER_HAS(carrier, get)) {
+        return_code = extract_text_map_keyed(carrier, &arg);
+    }
+    else {
+        return_code =
+            carrier->foreach_key(carrier, &extract_text_map_handler, &arg);
+    }
+    if (return_code == opentracing_propagation_error_code_success) {
+        return_code = extract_resolve(&arg);
+    }
+
+    if (return_code != opentracing_propagation_error_code_success) {
+        basic_span_context_release(arg.context);
+        return return_code;
+    }
+    *span_context = (opentracing_span_context*) arg.context;
+    return return_code;
+}
+
+static opentracing_propagation_error_code
+basic_tracer_inject_text_map(opentracing_tracer* tracer,
+                             opentracing_text_map_writer* carrier,
+                             const opentracing_span_context* span_context)
+{
+    (void) tracer;
+    return inject_text_map_common(carrier, span_context);
+}
+
+static opentracing_propagation_error_code
+basic_tracer_inject_http_headers(opentracing_tracer* tracer,
+                                 opentracing_http_headers_writer* carrier,
+                                 const opentracing_span_context* span_context)
+{
+    (void) tracer;
+    return inject_text_map_common((opentracing_text_map_writer*) carrier,
+                                  span_context);
+}
+
+static opentracing_propagation_error_code
+basic_tracer_extract_text_map(opentracing_tracer* tracer,
+                              opentracing_text_map_reader* carrier,
+                              opentracing_span_context** span_context)
+{
+    return extract_text_map_common(
+        (const basic_tracer*) tracer, carrier, span_context);
+}
+
+static opentracing_propagation_error_code
+basic_tracer_extract_http_headers(opentracing_tracer* tracer,
+                                  opentracing_http_headers_reader* carrier,
+                                  opentracing_span_context** span_context)
+{
+    return extract_text_map_common((const basic_tracer*) tracer,
+                                   (opentracing_text_map_reader*) carrier,
+                                   span_context);
+}
+
+/* Binary propagation. */
+
+/*
+ * Encode into buffer, or into a temporary allocation passed back through
+ * heap_buffer if buffer is too small.
+ */
+static opentracing_propagation_error_code
+encode_binary(const basic_span_context* context,
+              char* buffer,
+              size_t capacity,
+              size_t* length,
+              char** heap_buffer)
+{
+    opentracing_binary_span_context encoded;
+    opentracing_binary_baggage_item stack_items[MAX_STACK_BAGGAGE];
+    opentracing_binary_baggage_item* items;
+    opentracing_propagation_error_code return_code;
+    int num_baggage;
+    int i;
+
+    items = stack_items;
+    num_baggage = opentracing_baggage_size(context->baggage);
+    if (num_baggage > MAX_STACK_BAGGAGE) {
+        items = (opentracing_binary_baggage_item*) malloc(
+            sizeof(opentracing_binary_baggage_item) * num_baggage);
+        if (items == NULL) {
+            return opentracing_propagation_error_code_unknown;
+        }
+    }
+    for (i = 0; i < num_baggage; i++) {
+        opentracing_baggage_item(
+            context->baggage, i, &items[i].key, &items[i].value);
+    }
+    encoded.trace_id = context->trace_id;
+    encoded.span_id = context->span_id;
+    encoded.sampled = context->sampled;
+    encoded.baggage = items;
+    encoded.num_baggage = num_baggage;
+
+    return_code = opentracing_binary_encode(&encoded, buffer, capacity, length);
+    if (return_code == opentracing_propagation_error_code_invalid_carrier &&
+        heap_buffer != NULL) {
+        *heap_buffer = (char*) malloc(*length);
+        return_code =
+            (*heap_buffer == NULL)
+                ? opentracing_propagation_error_code_unknown
+                : opentracing_binary_encode(
+                      &encoded, *heap_buffer, *length, length);
+    }
+    if (items != stack_items) {
+        free(items);
+    }
+    return return_code;
+}
+
+static opentracing_propagation_error_code
+basic_tracer_inject_binary_buffer(opentracing_tracer* tracer,
+                                  char* buffer,
+                                  size_t capacity,
+                                  size_t* length,
+                                  const opentracing_span_context* span_context)
+{
+    (void) tracer;
+    if (!is_basic_span_context(span_context)) {
+        return opentracing_propagation_error_code_invalid_span_context;
+    }
+    return encode_binary((const basic_span_context*) span_context,
+                         buffer,
+                         capacity,
+                         length,
+                         NULL);
+}
+
+/* The whole context is written with a single callback invocation. */
+static opentracing_propagation_error_code
+basic_tracer_inject_binary(opentracing_tracer* tracer,
+                           int (*callback)(void*, const char*, size_t),
+                           void* arg,
+                           const opentracing_span_context* span_context)
+{
+    opentracing_propagation_error_code return_code;
+    char stack_buffer[256];
+    char* heap_buffer;
+    size_t length;
+
+    (void) tracer;
+    if (!is_basic_span_context(span_context)) {
+        return opentracing_propagation_error_code_invalid_span_context;
+    }
+    heap_buffer = NULL;
+    return_code = encode_binary((const basic_span_context*) span_context,
+                                stack_buffer,
+                                sizeof(stack_buffer),
+                                &length,
+                                &heap_buffer);
+    if (return_code == opentracing_propagation_error_code_success &&
+        callback(arg,
+                 (heap_buffer != NULL) ? heap_buffer : stack_buffer,
+                 length) != 0) {
+        return_code = opentracing_propagation_error_code_invalid_carrier;
+    }
+    free(heap_buffer);
+    return return_code;
+}
+
+static opentracing_propagation_error_code
+decode_binary(basic_span_context* context, const char* data, size_t len)
+{
+    opentracing_binary_span_context decoded;
+    opentracing_binary_baggage_item stack_items[MAX_STACK_BAGGAGE];
+    opentracing_propagation_error_code return_code;
+    const opentracing_binary_baggage_item* item;
+    int i;
+
+    decoded.baggage = stack_items;
+    return_code =
+        opentracing_binary_decode(data, len, &decoded, MAX_STACK_BAGGAGE);
+    if (return_code == opentracing_propagation_error_code_success &&
+        decoded.num_baggage > MAX_STACK_BAGGAGE) {
+        decoded.baggage = (opentracing_binary_baggage_item*) malloc(
+            sizeof(opentracing_binary_baggage_item) * decoded.num_baggage);
+        if (decoded.baggage == NULL) {
+            return opentracing_propagation_error_code_unknown;
+        }
+        return_code = opentracing_binary_decode(
+            data, len, &decoded, decoded.num_baggage);
+    }
+    if (return_code != opentracing_propagation_error_code_success) {
+        goto cleanup;
+    }
+
+    context->trace_id = decoded.trace_id;
+    context->span_id = decoded.span_id;
+    context->sampled = decoded.sampled;
+    for (i = 0; i < decoded.num_baggage; i++) {
+        item = &decoded.baggage[i];
+        if (!basic_span_context_set_baggage(context,
+                                            item->key.data,
+                                            item->key.length,
+                                            item->value.data,
+                                            item->value.length)) {
+            return_code = opentracing_propagation_error_code_unknown;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (decoded.baggage != stack_items) {
+        free(decoded.baggage);
+    }
+    return return_code;
+}
+
+static opentracing_propagation_error_code
+basic_tracer_extract_binary_buffer(opentracing_tracer* tracer,
+                                   const char* data,
+                                   size_t length,
+                                   opentracing_span_context** span_context)
+{
+    basic_span_context* context;
+    opentracing_propagation_error_code return_code;
+
+    (void) tracer;
+    assert(span_context != NULL);
+    *span_context = NULL;
+    if (length == 0) {
+        return opentracing_propagation_error_code_span_context_not_found;
+    }
+
+    context = basic_span_context_new();
+    if (context == NULL) {
+        return opentracing_propagation_error_code_unknown;
+    }
+    context->remote = opentracing_true;
+    return_code = decode_binary(context, data, length);
+    if (return_code == opentracing_propagation_error_code_success) {
+        *span_context = (opentracing_span_context*) context;
+    }
+    else {
+        basic_span_context_release(context);
+    }
+    return return_code;
+}
+
+static opentracing_propagation_error_code
+basic_tracer_extract_binary(opentracing_tracer* tracer,
+                            int (*callback)(void*, char*, size_t),
+                            void* arg,
+                            opentracing_span_context** span_context)
+{
+    opentracing_propagation_error_code return_code;
+    char stack_buffer[256];
+    char* buffer;
+    char* new_buffer;
+    size_t capacity;
+    size_t len;
+    int num_read;
+
+    assert(span_context != NULL);
+    *span_context = NULL;
+
+    buffer = stack_buffer;
+    capacity = sizeof(stack_buffer);
+    len = 0;
+    for (;;) {
+        if (len == capacity) {
+            new_buffer = (char*) malloc(capacity * 2);
+            if (new_buffer == NULL) {
+                return_code = opentracing_propagation_error_code_unknown;
+                goto cleanup;
+            }
+            memcpy(new_buffer, buffer, len);
+            if (buffer != stack_buffer) {
+                free(buffer);
+            }
+            buffer = new_buffer;
+            capacity *= 2;
+        }
+        num_read = callback(arg, buffer + len, capacity - len);
+        if (num_read < 0) {
+            return_code = opentracing_propagation_error_code_invalid_carrier;
+            goto cleanup;
+        }
+        if (num_read == 0) {
+            break;
+        }
+        len += (size_t) num_read;
+    }
+
+    return_code =
+        basic_tracer_extract_binary_buffer(tracer, buffer, len, span_context);
+
+cleanup:
+    if (buffer != stack_buffer) {
+        free(buffer);
+    }
+    return return_code;
+}
+
+/* Custom propagation. */
+
+static opentracing_propagation_error_code
+basic_tracer_inject_custom(opentracing_tracer* tracer,
+                           opentracing_custom_carrier_writer* carrier,
+                           const opentracing_span_context* span_context)
+{
+    return carrier->inject(carrier, tracer, span_context);
+}
+
+static opentracing_propagation_error_code
+basic_tracer_extract_custom(opentracing_tracer* tracer,
+                            opentracing_custom_carrier_reader* carrier,
+                            opentracing_span_context** span_context)
+{
+    return carrier->extract(carrier, tracer, span_context);
+}
+
+/* The tracer owns the reporter and sampler even if it cannot be created. */
+static void
+destroy_owned_options(const opentracing_basic_tracer_options* options)
+{
+    if (options == NULL) {
+        return;
+    }
+    if (options->reporter != NULL) {
+        ((opentracing_destructible*) options->reporter)
+            ->destroy((opentracing_destructible*) options->reporter);
+    }
+    if (options->sampler != NULL) {
+        ((opentracing_destructible*) options->sampler)
+            ->destroy((opentracing_destructible*) options->sampler);
+    }
+}
+
+opentracing_tracer*
+opentracing_make_basic_tracer(const opentracing_basic_tracer_options* options)
+{
+    basic_tracer* t;
+    opentracing_tracer* tracer;
+    int batch_size;
+
+    t = (basic_tracer*) calloc(1, sizeof(basic_tracer));
+    if (t == NULL) {
+        destroy_owned_options(options);
+        return NULL;
+    }
+
+    tracer = (opentracing_tracer*) t;
+    ((opentracing_destructible*) tracer)->destroy = &basic_tracer_destroy;
+    tracer->header = tracer_header;
+    tracer->close = &basic_tracer_close;
+    tracer->start_span = &basic_tracer_start_span;
+    tracer->start_span_with_options = &basic_tracer_start_span_with_options;
+    tracer->start_span_interned = &basic_tracer_start_span_interned;
+    tracer->inject_binary_buffer = &basic_tracer_inject_binary_buffer;
+    tracer->extract_binary_buffer = &basic_tracer_extract_binary_buffer;
+    tracer->inject_text_map = &basic_tracer_inject_text_map;
+    tracer->inject_http_headers = &basic_tracer_inject_http_headers;
+    tracer->inject_binary = &basic_tracer_inject_binary;
+    tracer->inject_custom = &basic_tracer_inject_custom;
+    tracer->extract_text_map = &basic_tracer_extract_text_map;
+    tracer->extract_http_headers = &basic_tracer_extract_http_headers;
+    tracer->extract_binary = &basic_tracer_extract_binary;
+    tracer->extract_custom = &basic_tracer_extract_custom;
+
+    t->close_timeout_ms = DEFAULT_CLOSE_TIMEOUT_MS;
+    if (options == NULL) {
+        return tracer;
+    }
+    t->reporter = options->reporter;
+    t->sampler = options->sampler;
+    t->ignore_text_map_baggage = options->ignore_text_map_baggage;
+    if (options->close_timeout_ms > 0) {
+        t->close_timeout_ms = options->close_timeout_ms;
+    }
+    if (options->background_reporting && t->reporter != NULL) {
+        batch_size = (options->batch_size > 0) ? options->batch_size
+                                               : DEFAULT_BATCH_SIZE;
+        t->batch = (const opentracing_span_data**) malloc(
+            sizeof(opentracing_span_data*) * batch_size);
+        if (t->batch != NULL) {
+            t->recorder = opentracing_recorder_new(
+                &basic_tracer_drain,
+                t,
+                (options->buffer_size > 0) ? options->buffer_size
+                                           : DEFAULT_BUFFER_SIZE,
+                batch_size,
+                (options->flush_interval_ms > 0) ? options->flush_interval_ms
+                                                 : DEFAULT_FLUSH_INTERVAL_MS);
+        }
+        if (t->recorder == NULL) {
+            free((void*) t->batch);
+            free(t);
+            destroy_owned_options(options);
+            return NULL;
+        }
+    }
+    return tracer;
+}
@@ -0,0 +1,115 @@
+#ifndef OPENTRACINGC_BASIC_TRACER_H
+#define OPENTRACINGC_BASIC_TRACER_H
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/reporter.h>
+#include <opentracing-c/sampler.h>
+#include <opentracing-c/tracer.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Options used when calling opentracing_make_basic_tracer(). */
+typedef struct opentracing_basic_tracer_options {
+    /**
+     * Reporter to receive finished spans. The tracer takes ownership of the
+     * reporter and destroys it when the tracer is destroyed, or before
+     * opentracing_make_basic_tracer() returns NULL. May be NULL, in which
+     * case finished spans are discarded.
+     */
+    opentracing_reporter* reporter;
+
+    /**
+     * If opentracing_true, finished spans are pushed into a buffer owned by
+     * the finishing thread and reported in batches from a background
+     * collector thread. Otherwise, spans are reported on the thread that
+     * finishes them. Spans that do not fit in a full buffer are dropped.
+     */
+    opentracing_bool background_reporting;
+
+    /**
+     * Number of finished spans each thread can buffer before spans are
+     * dropped. Zero selects the default of 4096.
+     */
+    int buffer_size;
+
+    /**
+     * Maximum number of spans passed to a single report call. Zero selects
+     * the default of 256.
+     */
+    int batch_size;
+
+    /**
+     * Interval between collector passes in milliseconds. Zero selects the
+     * default of 50.
+     */
+    int flush_interval_ms;
+
+    /**
+     * Maximum time in milliseconds that close waits for buffered spans to be
+     * reported. Zero selects the default of 1000.
+     */
+    int close_timeout_ms;
+
+    /**
+     * If opentracing_true, ot-baggage- entries are ignored when extracting
+     * from text map and HTTP header carriers. Extraction from readers that
+     * provide get() then never enumerates the carrier; otherwise it takes one
+     * pass over the carrier whenever a span context is found.
+     */
+    opentracing_bool ignore_text_map_baggage;
+
+    /**
+     * Sampler consulted when a root span starts. The tracer takes ownership
+     * of the sampler and destroys it when the tracer is destroyed, or before
+     * opentracing_make_basic_tracer() returns NULL. May be NULL, in which
+     * case every trace is sampled. Spans with a parent follow the parent's
+     * decision.
+     */
+    opentracing_sampler* sampler;
+} opentracing_basic_tracer_options;
+
+/**
+ * Create a basic tracer. The basic tracer implements every slot of
+ * opentracing_tracer and opentracing_span. Spans and span contexts are
+ * recycled through per-thread free lists, so starting and destroying spans
+ * does not normally touch the system allocator.
+ *
+ * Span contexts are propagated using the "ot-tracer-" text map keys used by
+ * other OpenTracing basic tracers:
+ *   - ot-tracer-traceid: Hexadecimal trace ID (16 or 32 digits).
+ *   - ot-tracer-spanid: Hexadecimal span ID (16 digits).
+ *   - ot-tracer-sampled: "true" or "false".
+ *   - ot-baggage-<key>: Baggage item value.
+ *
+ * Extraction also accepts W3C traceparent and B3 single headers. If a
+ * carrier holds several formats, the context comes from the ot-tracer keys,
+ * else from traceparent, else from b3; the others are ignored. Readers
+ * that provide get() are queried for the context keys directly instead of
+ * being enumerated with foreach_key().
+ *
+ * Spans started without references are children of the calling thread's
+ * active span or span context (see scope_manager.h), if it came from a basic
+ * tracer.
+ *
+ * Spans of unsampled traces are not recorded or reported. They support
+ * baggage and propagate their context with sampled set to false, but their
+ * children share their context instead of allocating new span IDs.
+ *
+ * @param options Tracer options. May be NULL to use defaults.
+ * @return New tracer on success, NULL if out of memory, in which case the
+ *         reporter and sampler in options have been destroyed. Destroy using
+ *         the opentracing_destructible interface.
+ */
+OPENTRACINGC_EXPORT opentracing_tracer*
+opentracing_make_basic_tracer(const opentracing_basic_tracer_options* options);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_BASIC_TRACER_H */
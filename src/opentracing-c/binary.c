@@ -0,0 +1,162 @@
+#include <opentracing-c/binary.h>
+
+#include <assert.h>
+#include <string.h>
+
+#define MAX_U16 0xFFFF
+
+static void write_u64(char* out, uint64_t value)
+{
+    int i;
+    for (i = 7; i >= 0; i--) {
+        out[i] = (char) (value & 0xFF);
+        value >>= 8;
+    }
+}
+
+static uint64_t read_u64(const char* in)
+{
+    uint64_t value;
+    int i;
+    value = 0;
+    for (i = 0; i < 8; i++) {
+        value = (value << 8) | (unsigned char) in[i];
+    }
+    return value;
+}
+
+static void write_u16(char* out, size_t value)
+{
+    out[0] = (char) ((value >> 8) & 0xFF);
+    out[1] = (char) (value & 0xFF);
+}
+
+static size_t read_u16(const char* in)
+{
+    return ((size_t)(unsigned char) in[0] << 8) | (unsigned char) in[1];
+}
+
+static char* write_string(char* out, const opentracing_string_view* str)
+{
+    write_u16(out, str->length);
+    if (str->length > 0) {
+        memcpy(out + 2, str->data, str->length);
+    }
+    return out + 2 + str->length;
+}
+
+size_t opentracing_binary_encoded_length(
+    const opentracing_binary_span_context* span_context)
+{
+    size_t length;
+    int i;
+
+    assert(span_context != NULL);
+    length = OPENTRACINGC_BINARY_HEADER_LENGTH;
+    for (i = 0; i < span_context->num_baggage; i++) {
+        length += 4 + span_context->baggage[i].key.length +
+                  span_context->baggage[i].value.length;
+    }
+    return length;
+}
+
+opentracing_propagation_error_code
+opentracing_binary_encode(const opentracing_binary_span_context* span_context,
+                          char* buffer,
+                          size_t capacity,
+                          size_t* length)
+{
+    const opentracing_binary_baggage_item* item;
+    char* out;
+    int i;
+
+    assert(span_context != NULL);
+    assert(length != NULL);
+    assert(span_context->baggage != NULL || span_context->num_baggage == 0);
+
+    *length = opentracing_binary_encoded_length(span_context);
+    if (span_context->num_baggage < 0 || span_context->num_baggage > MAX_U16) {
+        return opentracing_propagation_error_code_invalid_span_context;
+    }
+    for (i = 0; i < span_context->num_baggage; i++) {
+        item = &span_context->baggage[i];
+        if (item->key.length > MAX_U16 || item->value.length > MAX_U16) {
+            return opentracing_propagation_error_code_invalid_span_context;
+        }
+    }
+    if (capacity < *length) {
+        return opentracing_propagation_error_code_invalid_carrier;
+    }
+
+    buffer[0] = OPENTRACINGC_BINARY_FORMAT_VERSION;
+    buffer[1] = span_context->sampled ? 1 : 0;
+    write_u64(buffer + 2, span_context->trace_id.high);
+    write_u64(buffer + 10, span_context->trace_id.low);
+    write_u64(buffer + 18, span_context->span_id);
+    write_u16(buffer + 26, (size_t) span_context->num_baggage);
+    write_u16(buffer + 28, 0);
+    out = buffer + OPENTRACINGC_BINARY_HEADER_LENGTH;
+    for (i = 0; i < span_context->num_baggage; i++) {
+        out = write_string(out, &span_context->baggage[i].key);
+        out = write_string(out, &span_context->baggage[i].value);
+    }
+    assert((size_t)(out - buffer) == *length);
+    return opentracing_propagation_error_code_success;
+}
+
+static opentracing_bool read_string(const char* data,
+                                    size_t length,
+                                    size_t* offset,
+                                    opentracing_string_view* str)
+{
+    if (length - *offset < 2) {
+        return opentracing_false;
+    }
+    str->length = read_u16(data + *offset);
+    *offset += 2;
+    if (length - *offset < str->length) {
+        return opentracing_false;
+    }
+    str->data = data + *offset;
+    *offset += str->length;
+    return opentracing_true;
+}
+
+opentracing_propagation_error_code
+opentracing_binary_decode(const char* data,
+                          size_t length,
+                          opentracing_binary_span_context* span_context,
+                          int max_baggage)
+{
+    opentracing_binary_baggage_item item;
+    size_t offset;
+    int i;
+
+    assert(span_context != NULL);
+    assert(span_context->baggage != NULL || max_baggage <= 0);
+
+    if (length == 0) {
+        return opentracing_propagation_error_code_span_context_not_found;
+    }
+    if (length < OPENTRACINGC_BINARY_HEADER_LENGTH ||
+        data[0] != OPENTRACINGC_BINARY_FORMAT_VERSION) {
+        return opentracing_propagation_error_code_span_context_corrupted;
+    }
+    span_context->sampled = data[1] ? opentracing_true : opentracing_false;
+    span_context->trace_id.high = read_u64(data + 2);
+    span_context->trace_id.low = read_u64(data + 10);
+    span_context->span_id = read_u64(data + 18);
+    span_context->num_baggage = (int) read_u16(data + 26);
+
+    offset = OPENTRACINGC_BINARY_HEADER_LENGTH;
+    for (i = 0; i < span_context->num_baggage; i++) {
+        if (!read_string(data, length, &offset, &item.key) ||
+            !read_string(data, length, &offset, &item.value)) {
+            return opentracing_propagation_error_code_span_context_corrupted;
+        }
+        if (i < max_baggage) {
+            span_context->baggage[i] = item;
+        }
+    }
+    return opentracing_propagation_error_code_success;
+}
@@ -0,0 +1,122 @@
+#ifndef OPENTRACINGC_BINARY_H
+#define OPENTRACINGC_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/propagation.h>
+#include <opentracing-c/span_data.h>
+#include <opentracing-c/value.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Binary span context wire format. All integers are big endian.
+ *
+ * | Offset | Size | Field                                  |
+ * |--------|------|----------------------------------------|
+ * | 0      | 1    | Format version                         |
+ * | 1      | 1    | Sampled flag, 0 or 1                   |
+ * | 2      | 8    | High 64 bits of trace ID               |
+ * | 10     | 8    | Low 64 bits of trace ID                |
+ * | 18     | 8    | Span ID                                |
+ * | 26     | 2    | Number of baggage items                |
+ * | 28     | 2    | Reserved, zero                         |
+ * | 30     |      | Per baggage item: 2 byte key length,   |
+ * |        |      | key, 2 byte value length, value        |
+ *
+ * Encoding and decoding work on caller-provided buffers and never allocate.
+ */
+
+/** Format version written by opentracing_binary_encode(). */
+#define OPENTRACINGC_BINARY_FORMAT_VERSION 0
+
+/** Size of the fixed part of the encoding. */
+#define OPENTRACINGC_BINARY_HEADER_LENGTH 30
+
+/** Baggage item referring to encoded or caller-owned data. */
+typedef struct opentracing_binary_baggage_item {
+    /** Baggage key. */
+    opentracing_string_view key;
+    /** Baggage value. */
+    opentracing_string_view value;
+} opentracing_binary_baggage_item;
+
+/** Tracer-independent view of a span context for the binary format. */
+typedef struct opentracing_binary_span_context {
+    /** Trace ID. */
+    opentracing_trace_id trace_id;
+    /** Span ID. */
+    uint64_t span_id;
+    /** Sampling decision. */
+    opentracing_bool sampled;
+    /**
+     * Baggage items. For decoding, an array of max_baggage items provided by
+     * the caller.
+     */
+    opentracing_binary_baggage_item* baggage;
+    /**
+     * Number of baggage items. After decoding, the number of items in the
+     * encoding, which may exceed the number stored in baggage.
+     */
+    int num_baggage;
+} opentracing_binary_span_context;
+
+/**
+ * Compute the encoded size of a span context.
+ * @param span_context Span context to measure.
+ * @return Number of bytes opentracing_binary_encode() writes.
+ */
+OPENTRACINGC_EXPORT size_t opentracing_binary_encoded_length(
+    const opentracing_binary_span_context* span_context)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Encode a span context into a buffer.
+ * @param span_context Span context to encode.
+ * @param buffer Output buffer. May be NULL if capacity is zero.
+ * @param capacity Size of buffer in bytes.
+ * @param[out] length Set to the encoded size, even if buffer is too small,
+ *                    so the call can be retried with a larger buffer.
+ * @return opentracing_propagation_error_code_invalid_carrier if buffer is too
+ *         small, opentracing_propagation_error_code_invalid_span_context if
+ *         the context has more than 65535 baggage items or a key or value
+ *         longer than 65535 bytes, success otherwise.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_binary_encode(const opentracing_binary_span_context* span_context,
+                          char* buffer,
+                          size_t capacity,
+                          size_t* length) OPENTRACINGC_NONNULL(1, 4);
+
+/**
+ * Decode a span context from a buffer. Baggage keys and values point into
+ * data and are not null-terminated.
+ * @param data Encoded span context.
+ * @param length Size of data in bytes.
+ * @param[out] span_context Decoded span context. Its baggage member must
+ *                          point to an array of max_baggage items, which
+ *                          receives the first max_baggage items.
+ * @param max_baggage Size of the baggage array.
+ * @return opentracing_propagation_error_code_span_context_not_found if length
+ *         is zero, opentracing_propagation_error_code_span_context_corrupted
+ *         if data is not a valid encoding, success otherwise.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_binary_decode(const char* data,
+                          size_t length,
+                          opentracing_binary_span_context* span_context,
+                          int max_baggage) OPENTRACINGC_NONNULL(3);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_BINARY_H */
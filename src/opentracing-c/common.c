@@ -0,0 +1,208 @@
+#include <opentracing-c/common.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <opentracing-c/internal/atomic.h>
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+    !defined(OPENTRACINGC_DISABLE_TSC)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define OPENTRACINGC_HAVE_TSC 1
+#endif /* defined(__x86_64__) && defined(__GNUC__) && \
+          !defined(OPENTRACINGC_DISABLE_TSC) */
+
+#define NS_PER_SEC INT64_C(1000000000)
+
+/* How often the system clock offset is re-read. */
+#define ANCHOR_REFRESH_NS NS_PER_SEC
+
+#define TSC_CALIBRATION_NS INT64_C(10000000)
+
+static int clock_source = opentracing_clock_source_default;
+
+/*
+ * System time minus steady time, and the steady time it was measured at.
+ * Zero anchor_steady_ns means not measured yet. The offset is published
+ * before the anchor time.
+ */
+static int64_t anchor_offset_ns = 0;
+static int64_t anchor_steady_ns = 0;
+
+static int64_t read_clock_ns(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (int64_t) ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+#ifdef OPENTRACINGC_HAVE_TSC
+
+/*
+ * Steady time is base_ns plus elapsed ticks times tsc_mult / 2^32. Written
+ * before the source is published.
+ */
+static uint64_t tsc_base_ticks = 0;
+static int64_t tsc_base_ns = 0;
+static uint64_t tsc_mult = 0;
+
+static opentracing_bool tsc_is_invariant(void)
+{
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+
+    if (!__get_cpuid(0x80000000U, &eax, &ebx, &ecx, &edx) ||
+        eax < 0x80000007U) {
+        return opentracing_false;
+    }
+    __get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx);
+    return (edx & (1U << 8)) ? opentracing_true : opentracing_false;
+}
+
+static opentracing_bool tsc_calibrate(void)
+{
+    uint64_t start_ticks;
+    uint64_t end_ticks;
+    int64_t start_ns;
+    int64_t end_ns;
+
+    if (!tsc_is_invariant()) {
+        return opentracing_false;
+    }
+    start_ns = read_clock_ns(CLOCK_MONOTONIC);
+    start_ticks = __rdtsc();
+    do {
+        end_ns = read_clock_ns(CLOCK_MONOTONIC);
+        end_ticks = __rdtsc();
+    } while (end_ns - start_ns < TSC_CALIBRATION_NS);
+    if (end_ticks <= start_ticks) {
+        return opentracing_false;
+    }
+    tsc_mult = ((uint64_t)(end_ns - start_ns) << 32) / (end_ticks - start_ticks);
+    tsc_base_ticks = end_ticks;
+    tsc_base_ns = end_ns;
+    return opentracing_true;
+}
+
+static int64_t read_tsc_ns(void)
+{
+    uint64_t ticks;
+    uint64_t high;
+    uint64_t low;
+
+    /* Split the multiplication so it cannot overflow. */
+    ticks = __rdtsc() - tsc_base_ticks;
+    high = ticks >> 32;
+    low = ticks & UINT64_C(0xFFFFFFFF);
+    return tsc_base_ns + (int64_t)(high * tsc_mult + ((low * tsc_mult) >> 32));
+}
+
+#endif /* OPENTRACINGC_HAVE_TSC */
+
+static int64_t read_steady_ns(void)
+{
+    switch (OPENTRACINGC_ATOMIC_LOAD(&clock_source,
+                                     OPENTRACINGC_ATOMIC_ACQUIRE)) {
+#ifdef CLOCK_MONOTONIC_COARSE
+    case opentracing_clock_source_coarse:
+        return read_clock_ns(CLOCK_MONOTONIC_COARSE);
+#endif /* CLOCK_MONOTONIC_COARSE */
+#ifdef OPENTRACINGC_HAVE_TSC
+    case opentracing_clock_source_tsc:
+        return read_tsc_ns();
+#endif /* OPENTRACINGC_HAVE_TSC */
+    default:
+        return read_clock_ns(CLOCK_MONOTONIC);
+    }
+}
+
+static int64_t system_offset_ns(int64_t steady_ns)
+{
+    int64_t anchor_ns;
+    int64_t system_ns;
+
+    anchor_ns = OPENTRACINGC_ATOMIC_LOAD(&anchor_steady_ns,
+                                         OPENTRACINGC_ATOMIC_ACQUIRE);
+    if (anchor_ns == 0 || steady_ns - anchor_ns > ANCHOR_REFRESH_NS ||
+        steady_ns < anchor_ns) {
+        /* Threads refreshing at the same time store near-equal values. */
+        system_ns = read_clock_ns(CLOCK_REALTIME);
+        anchor_ns = read_steady_ns();
+        OPENTRACINGC_ATOMIC_STORE(&anchor_offset_ns,
+                                  system_ns - anchor_ns,
+                                  OPENTRACINGC_ATOMIC_RELAXED);
+        OPENTRACINGC_ATOMIC_STORE(
+            &anchor_steady_ns, anchor_ns, OPENTRACINGC_ATOMIC_RELEASE);
+        return system_ns - anchor_ns;
+    }
+    return OPENTRACINGC_ATOMIC_LOAD(&anchor_offset_ns,
+                                    OPENTRACINGC_ATOMIC_RELAXED);
+}
+
+static void to_time_value(int64_t ns, opentracing_time_value* value)
+{
+    value->tv_sec = (time_t)(ns / NS_PER_SEC);
+    value->tv_nsec = (long int) (ns % NS_PER_SEC);
+}
+
+opentracing_bool opentracing_set_clock_source(opentracing_clock_source source)
+{
+    switch (source) {
+    case opentracing_clock_source_default:
+        break;
+    case opentracing_clock_source_coarse:
+#ifdef CLOCK_MONOTONIC_COARSE
+        break;
+#else
+        return opentracing_false;
+#endif /* CLOCK_MONOTONIC_COARSE */
+    case opentracing_clock_source_tsc:
+#ifdef OPENTRACINGC_HAVE_TSC
+        if (!tsc_calibrate()) {
+            return opentracing_false;
+        }
+        break;
+#else
+        return opentracing_false;
+#endif /* OPENTRACINGC_HAVE_TSC */
+    default:
+        return opentracing_false;
+    }
+    OPENTRACINGC_ATOMIC_STORE(
+        &clock_source, (int) source, OPENTRACINGC_ATOMIC_RELEASE);
+    /* The offset depends on the source. */
+    OPENTRACINGC_ATOMIC_STORE(
+        &anchor_steady_ns, INT64_C(0), OPENTRACINGC_ATOMIC_RELEASE);
+    return opentracing_true;
+}
+
+void opentracing_now_steady(opentracing_duration* steady)
+{
+    assert(steady != NULL);
+    to_time_value(read_steady_ns(), &steady->value);
+}
+
+void opentracing_now_system(opentracing_timestamp* system)
+{
+    int64_t steady_ns;
+
+    assert(system != NULL);
+    steady_ns = read_steady_ns();
+    to_time_value(steady_ns + system_offset_ns(steady_ns), &system->value);
+}
+
+void opentracing_now(opentracing_duration* steady,
+                     opentracing_timestamp* system)
+{
+    int64_t steady_ns;
+
+    assert(steady != NULL);
+    assert(system != NULL);
+    steady_ns = read_steady_ns();
+    to_time_value(steady_ns, &steady->value);
+    to_time_value(steady_ns + system_offset_ns(steady_ns), &system->value);
+}
@@ -45,6 +45,65 @@ typedef struct opentracing_timestamp {
     opentracing_time_value value;
 } opentracing_timestamp;
 
+/** Clock sources for opentracing_now() and related functions. */
+typedef enum opentracing_clock_source {
+    /** CLOCK_MONOTONIC, read through the vDSO where the platform has one. */
+    opentracing_clock_source_default = 0,
+
+    /**
+     * CLOCK_MONOTONIC_COARSE: cheaper to read, but only advances once per
+     * scheduler tick (typically 1 to 4 ms).
+     */
+    opentracing_clock_source_coarse = 1,
+
+    /**
+     * Time stamp counter calibrated against CLOCK_MONOTONIC. Only available
+     * on x86-64 CPUs with an invariant TSC.
+     */
+    opentracing_clock_source_tsc = 2
+} opentracing_clock_source;
+
+/**
+ * Select the clock source used by opentracing_now() and related functions.
+ * Steady readings from different sources are not comparable, so select a
+ * source once at startup, before any spans are started. Selecting the TSC
+ * calibrates it, which takes about 10 ms.
+ * @param source Clock source.
+ * @return opentracing_true on success, opentracing_false if the source is not
+ *         available on this platform, in which case the current source is
+ *         kept.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_set_clock_source(opentracing_clock_source source);
+
+/**
+ * Read the steady clock, for opentracing_start_span_options
+ * start_time_steady and opentracing_finish_span_options finish_time.
+ * @param[out] steady Current steady time.
+ */
+OPENTRACINGC_EXPORT void opentracing_now_steady(opentracing_duration* steady)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Read the system clock, for opentracing_start_span_options
+ * start_time_system and log timestamps. Derived from the steady clock and an
+ * offset to the system clock that is refreshed about once a second, so most
+ * calls read only one clock. Adjustments to the system clock therefore take
+ * up to a second to show.
+ * @param[out] system Current system time.
+ */
+OPENTRACINGC_EXPORT void opentracing_now_system(opentracing_timestamp* system)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Read both clocks with a single clock read, as needed to start a span.
+ * @param[out] steady Current steady time.
+ * @param[out] system Current system time, as for opentracing_now_system().
+ */
+OPENTRACINGC_EXPORT void opentracing_now(opentracing_duration* steady,
+                                         opentracing_timestamp* system)
+    OPENTRACINGC_NONNULL_ALL;
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,49 @@
+#include <opentracing-c/continuation.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <opentracing-c/scope_manager.h>
+
+opentracing_bool
+opentracing_continuation_capture(opentracing_continuation* continuation)
+{
+    assert(continuation != NULL);
+    return opentracing_continuation_capture_context(
+        continuation, opentracing_active_span_context());
+}
+
+opentracing_bool
+opentracing_continuation_capture_context(opentracing_continuation* continuation,
+                                         opentracing_span_context* span_context)
+{
+    assert(continuation != NULL);
+    if (span_context == NULL) {
+        continuation->span_context = NULL;
+        return opentracing_true;
+    }
+    continuation->span_context = opentracing_span_context_retain(span_context);
+    return (continuation->span_context != NULL) ? opentracing_true
+                                                : opentracing_false;
+}
+
+opentracing_bool
+opentracing_continuation_restore(const opentracing_continuation* continuation)
+{
+    assert(continuation != NULL);
+    return opentracing_activate_span_context(continuation->span_context);
+}
+
+void opentracing_continuation_suspend(
+    const opentracing_continuation* continuation)
+{
+    assert(continuation != NULL);
+    opentracing_deactivate_span_context(continuation->span_context);
+}
+
+void opentracing_continuation_release(opentracing_continuation* continuation)
+{
+    assert(continuation != NULL);
+    opentracing_span_context_release(continuation->span_context);
+    continuation->span_context = NULL;
+}
@@ -0,0 +1,99 @@
+#ifndef OPENTRACINGC_CONTINUATION_H
+#define OPENTRACINGC_CONTINUATION_H
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/span.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Continuation of a trace across callbacks of an event loop, where one
+ * thread interleaves the work of many requests and its active span says
+ * nothing about the request a callback belongs to. Capture a continuation
+ * where work is scheduled, store it with the callback's state, and restore
+ * it around the callback so spans started there join the captured trace:
+ *
+ *     opentracing_continuation_capture(&conn->continuation);
+ *     ...
+ *     opentracing_continuation_restore(&conn->continuation);
+ *     on_readable(conn);
+ *     opentracing_continuation_suspend(&conn->continuation);
+ *     ...
+ *     opentracing_continuation_release(&conn->continuation);
+ *
+ * A continuation is a single pointer to a retained span context, so
+ * capturing it is an atomic increment and restoring it pushes onto the
+ * thread's scope stack (see scope_manager.h); neither allocates. It may be
+ * restored any number of times, on any thread, until it is released.
+ */
+typedef struct opentracing_continuation {
+    /**
+     * Captured span context, or NULL if there was none. Owned by the
+     * continuation, and usable as the referenced context of an
+     * opentracing_span_reference while the continuation is held.
+     */
+    opentracing_span_context* span_context;
+} opentracing_continuation;
+
+/**
+ * Capture the calling thread's active span context.
+ * @param[out] continuation Continuation to initialize.
+ * @return opentracing_true on success, opentracing_false if the active span
+ *         context cannot be retained, in which case the continuation is
+ *         empty and restoring it starts new traces.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_continuation_capture(opentracing_continuation* continuation)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Capture a given span context, e.g. one extracted from a carrier.
+ * @param[out] continuation Continuation to initialize.
+ * @param span_context Span context to capture. May be NULL.
+ * @return opentracing_true on success, opentracing_false if the span context
+ *         cannot be retained, in which case the continuation is empty.
+ * @see opentracing_continuation_capture()
+ */
+OPENTRACINGC_EXPORT opentracing_bool opentracing_continuation_capture_context(
+    opentracing_continuation* continuation,
+    opentracing_span_context* span_context) OPENTRACINGC_NONNULL(1);
+
+/**
+ * Make the captured span context the calling thread's active span context.
+ * Restoring an empty continuation hides the active span instead.
+ * @param continuation Captured continuation.
+ * @return opentracing_true on success, opentracing_false if out of memory,
+ *         in which case the continuation must not be suspended.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_continuation_restore(const opentracing_continuation* continuation)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Undo the most recent restore of a continuation on the calling thread.
+ * @param continuation Restored continuation.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_continuation_suspend(const opentracing_continuation* continuation)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Drop the captured span context. The continuation is empty afterwards and
+ * must not be restored on any thread at the time.
+ * @param continuation Continuation instance.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_continuation_release(opentracing_continuation* continuation)
+    OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_CONTINUATION_H */
@@ -2,8 +2,38 @@
 
 #include <assert.h>
 #include <dlfcn.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
 
+typedef struct async_load {
+    char* lib;
+    char* config;
+    opentracing_library_handle* handle;
+    opentracing_tracer_load_callback callback;
+    void* arg;
+    char* error_buffer;
+    int error_buffer_length;
+} async_load;
+
+static void
+copy_error(const char* error, char* error_buffer, int error_buffer_length)
+{
+    size_t error_len;
+
+    if (error == NULL || error_buffer == NULL || error_buffer_length <= 0) {
+        return;
+    }
+    error_len = strlen(error) + 1;
+    if (error_len > (size_t) error_buffer_length) {
+        memcpy(error_buffer, error, (size_t) error_buffer_length - 1);
+        error_buffer[error_buffer_length - 1] = '\0';
+    }
+    else {
+        memcpy(error_buffer, error, error_len);
+    }
+}
+
 void opentracing_library_handle_destroy(opentracing_library_handle* handle)
 {
     if (handle == NULL) {
@@ -23,22 +53,7 @@ opentracing_dynamically_load_tracing_library(const char* lib,
                                              char* error_buffer,
                                              int error_buffer_length)
 {
-#define COPY_ERROR()                                                  \
-    do {                                                              \
-        if (error != NULL && error_buffer != NULL) {                  \
-            error_len = strlen(error) + 1;                            \
-            if (error_len > error_buffer_length) {                    \
-                memcpy(error_buffer, error, error_buffer_length - 1); \
-                error_buffer[error_buffer_length - 1] = '\0';         \
-            }                                                         \
-            else {                                                    \
-                memcpy(error_buffer, error, error_len);               \
-            }                                                         \
-        }                                                             \
-    } while (0)
-
     const char* error;
-    int error_len;
     int flags;
 
 #ifdef OPENTRACINGC_HAVE_WEAK_SYMBOLS
@@ -89,7 +104,7 @@ opentracing_dynamically_load_tracing_library(const char* lib,
 
 cleanup:
     if (return_code != opentracing_dynamic_load_error_code_success) {
-        COPY_ERROR();
+        copy_error(error, error_buffer, error_buffer_length);
         if (handle->lib_handle != NULL) {
             dlclose(handle->lib_handle);
             handle->lib_handle = NULL;
@@ -100,10 +115,127 @@ cleanup:
 #else
 
     error = "Platform has no weak symbol support";
-    COPY_ERROR();
+    copy_error(error, error_buffer, error_buffer_length);
     return opentracing_dynamic_load_error_code_not_supported;
 
 #endif /* OPENTRACINGC_HAVE_WEAK_SYMBOLS */
+}
+
+#ifdef OPENTRACINGC_HAVE_WEAK_SYMBOLS
 
-#undef COPY_ERROR
+static void* async_load_run(void* arg)
+{
+    async_load* load;
+    opentracing_tracer* tracer;
+    opentracing_dynamic_load_error_code return_code;
+
+    load = (async_load*) arg;
+    return_code = opentracing_dynamically_load_tracing_library(
+        load->lib, load->handle, load->error_buffer, load->error_buffer_length);
+    if (return_code == opentracing_dynamic_load_error_code_success) {
+        tracer = NULL;
+        if (!(*load->handle->factory)(load->config,
+                                      &tracer,
+                                      load->error_buffer,
+                                      load->error_buffer_length)) {
+            return_code = opentracing_dynamic_load_error_code_failure;
+        }
+        else if (tracer == NULL) {
+            copy_error("Tracer factory returned no tracer",
+                       load->error_buffer,
+                       load->error_buffer_length);
+            return_code = opentracing_dynamic_load_error_code_failure;
+        }
+        if (return_code == opentracing_dynamic_load_error_code_success) {
+            opentracing_init_global_tracer(tracer);
+        }
+        else {
+            opentracing_library_handle_destroy(load->handle);
+        }
+    }
+    if (load->callback != NULL) {
+        (*load->callback)(load->arg, return_code);
+    }
+    free(load);
+    return NULL;
+}
+
+static opentracing_bool start_loader_thread(async_load* load)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    int result;
+
+    if (pthread_attr_init(&attr) != 0) {
+        return opentracing_false;
+    }
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    result = pthread_create(&thread, &attr, &async_load_run, load);
+    pthread_attr_destroy(&attr);
+    return (result == 0) ? opentracing_true : opentracing_false;
+}
+
+#endif /* OPENTRACINGC_HAVE_WEAK_SYMBOLS */
+
+opentracing_dynamic_load_error_code
+opentracing_dynamically_load_tracer_async(
+    const char* lib,
+    const char* config,
+    opentracing_library_handle* handle,
+    opentracing_tracer_load_callback callback,
+    void* arg,
+    char* error_buffer,
+    int error_buffer_length)
+{
+#ifdef OPENTRACINGC_HAVE_WEAK_SYMBOLS
+
+    async_load* load;
+    size_t lib_len;
+    size_t config_len;
+
+    assert(lib != NULL);
+    assert(config != NULL);
+    assert(handle != NULL);
+    assert(error_buffer != NULL || error_buffer_length == 0);
+
+    /* The strings are copied into the same allocation. */
+    lib_len = strlen(lib) + 1;
+    config_len = strlen(config) + 1;
+    load = (async_load*) malloc(sizeof(async_load) + lib_len + config_len);
+    if (load == NULL) {
+        copy_error("Out of memory", error_buffer, error_buffer_length);
+        return opentracing_dynamic_load_error_code_failure;
+    }
+    load->lib = (char*) (load + 1);
+    memcpy(load->lib, lib, lib_len);
+    load->config = load->lib + lib_len;
+    memcpy(load->config, config, config_len);
+    load->handle = handle;
+    load->callback = callback;
+    load->arg = arg;
+    load->error_buffer = error_buffer;
+    load->error_buffer_length = error_buffer_length;
+
+    if (!start_loader_thread(load)) {
+        free(load);
+        copy_error("Cannot create loader thread",
+                   error_buffer,
+                   error_buffer_length);
+        return opentracing_dynamic_load_error_code_failure;
+    }
+    return opentracing_dynamic_load_error_code_success;
+
+#else
+
+    (void) lib;
+    (void) config;
+    (void) handle;
+    (void) callback;
+    (void) arg;
+    copy_error("Platform has no weak symbol support",
+               error_buffer,
+               error_buffer_length);
+    return opentracing_dynamic_load_error_code_not_supported;
+
+#endif /* OPENTRACINGC_HAVE_WEAK_SYMBOLS */
 }
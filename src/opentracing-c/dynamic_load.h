@@ -3,6 +3,7 @@
 
 #include <opentracing-c/config.h>
 #include <opentracing-c/tracer_factory.h>
+#include <opentracing-c/visibility.h>
 
 /** @file */
 
@@ -72,7 +73,8 @@ typedef struct opentracing_library_handle {
  * also destroyed.
  * @param handle Library handle to destroy.
  */
-void opentracing_library_handle_destroy(opentracing_library_handle* handle);
+OPENTRACINGC_EXPORT void
+opentracing_library_handle_destroy(opentracing_library_handle* handle);
 
 /**
  * Dynamically loads a tracing library and returns a handle that can be used
@@ -86,13 +88,62 @@ void opentracing_library_handle_destroy(opentracing_library_handle* handle);
  * @return opentracing_dynamic_load_error_code indicating success or failure.
  * @see opentracing_library_handle_destroy
  */
-opentracing_dynamic_load_error_code
+OPENTRACINGC_EXPORT opentracing_dynamic_load_error_code
 opentracing_dynamically_load_tracing_library(const char* lib,
                                              opentracing_library_handle* handle,
                                              char* error_buffer,
                                              int error_buffer_length)
     OPENTRACINGC_NONNULL(1, 2);
 
+/**
+ * Called when an asynchronous tracer load finishes.
+ * @param arg User-defined argument.
+ * @param return_code opentracing_dynamic_load_error_code_success if the
+ *                    tracer was installed as the global tracer, otherwise
+ *                    the error, whose message is in the error buffer.
+ * @see opentracing_dynamically_load_tracer_async()
+ */
+typedef void (*opentracing_tracer_load_callback)(
+    void* arg, opentracing_dynamic_load_error_code return_code);
+
+/**
+ * Load a tracing library, create a tracer with its factory and install it as
+ * the global tracer, all on a background thread, so that a large library does
+ * not delay startup. Returns immediately. Until the tracer is installed, the
+ * global tracer stays as it was, which at process start is the no-op tracer,
+ * so spans started in the meantime are not recorded. Other threads may keep
+ * using opentracing_global_tracer_acquire() during the swap, the replaced
+ * tracer is destroyed once they have released it.
+ * @param lib Shared library name. Copied.
+ * @param config Configuration string to pass to the tracer factory. Copied.
+ * @param[out] handle Library handle, set on success before callback is
+ *                    called. Must stay valid until then, and should be
+ *                    destroyed once the tracer is, i.e. after it was
+ *                    replaced and released by every thread holding it.
+ * @param callback Function called on the background thread once the load
+ *                 finishes. May be NULL.
+ * @param arg Argument to pass to callback.
+ * @param[out] error_buffer Buffer for potential error message, written
+ *                          before callback is called. Must stay valid until
+ *                          then.
+ * @param error_buffer_length Length of error_buffer. If error_buffer is NULL,
+ *                            must be zero.
+ * @return opentracing_dynamic_load_error_code_success if the load was
+ *         started, in which case callback will be called exactly once.
+ *         Otherwise the error, with its message in error_buffer, and
+ *         callback is not called.
+ * @see opentracing_dynamically_load_tracing_library()
+ */
+OPENTRACINGC_EXPORT opentracing_dynamic_load_error_code
+opentracing_dynamically_load_tracer_async(
+    const char* lib,
+    const char* config,
+    opentracing_library_handle* handle,
+    opentracing_tracer_load_callback callback,
+    void* arg,
+    char* error_buffer,
+    int error_buffer_length) OPENTRACINGC_NONNULL(1, 2, 3);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,223 @@
+#include <opentracing-c/header_codec.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <opentracing-c/internal/hex.h>
+
+/* Left-pad short IDs with zeros so every parse takes the 16 digit path. */
+static opentracing_bool decode_padded(const char* str, size_t len, uint64_t* out)
+{
+    char padded[16];
+
+    if (len == 16) {
+        return opentracing_hex_decode16(str, out);
+    }
+    if (len == 0 || len > 16) {
+        return opentracing_false;
+    }
+    memset(padded, '0', sizeof(padded) - len);
+    memcpy(padded + sizeof(padded) - len, str, len);
+    return opentracing_hex_decode16(padded, out);
+}
+
+/* traceparent only allows lowercase hex, the other formats accept both. */
+static opentracing_bool decode_lower2(const char* str, uint64_t* out)
+{
+    char padded[16];
+
+    memset(padded, '0', sizeof(padded) - 2);
+    padded[14] = str[0];
+    padded[15] = str[1];
+    return opentracing_hex_decode16_lower(padded, out);
+}
+
+void opentracing_hex_encode_u64(uint64_t value, char* out)
+{
+    assert(out != NULL);
+    opentracing_hex_encode16(value, out);
+}
+
+opentracing_bool
+opentracing_hex_decode_u64(const char* str, size_t len, uint64_t* out)
+{
+    uint64_t value;
+
+    assert(str != NULL);
+    assert(out != NULL);
+    if (!decode_padded(str, len, &value)) {
+        return opentracing_false;
+    }
+    *out = value;
+    return opentracing_true;
+}
+
+void opentracing_hex_encode_trace_id(const opentracing_trace_id* trace_id,
+                                     char* out)
+{
+    assert(trace_id != NULL);
+    assert(out != NULL);
+    opentracing_hex_encode16(trace_id->high, out);
+    opentracing_hex_encode16(trace_id->low, out + 16);
+}
+
+opentracing_bool opentracing_hex_decode_trace_id(const char* str,
+                                                 size_t len,
+                                                 opentracing_trace_id* trace_id)
+{
+    uint64_t high;
+    uint64_t low;
+
+    assert(str != NULL);
+    assert(trace_id != NULL);
+    if (len > 32) {
+        return opentracing_false;
+    }
+    high = 0;
+    if (len > 16) {
+        if (!decode_padded(str, len - 16, &high)) {
+            return opentracing_false;
+        }
+        str += len - 16;
+        len = 16;
+    }
+    if (!decode_padded(str, len, &low)) {
+        return opentracing_false;
+    }
+    trace_id->high = high;
+    trace_id->low = low;
+    return opentracing_true;
+}
+
+void opentracing_traceparent_encode(const opentracing_trace_id* trace_id,
+                                    uint64_t span_id,
+                                    opentracing_bool sampled,
+                                    char* out)
+{
+    assert(trace_id != NULL);
+    assert(out != NULL);
+    /* version-trace_id-span_id-flags */
+    out[0] = '0';
+    out[1] = '0';
+    out[2] = '-';
+    opentracing_hex_encode16(trace_id->high, out + 3);
+    opentracing_hex_encode16(trace_id->low, out + 19);
+    out[35] = '-';
+    opentracing_hex_encode16(span_id, out + 36);
+    out[52] = '-';
+    out[53] = '0';
+    out[54] = sampled ? '1' : '0';
+    out[55] = '\0';
+}
+
+opentracing_propagation_error_code
+opentracing_traceparent_decode(const char* str,
+                               size_t len,
+                               opentracing_trace_id* trace_id,
+                               uint64_t* span_id,
+                               opentracing_bool* sampled)
+{
+    opentracing_trace_id id;
+    uint64_t version;
+    uint64_t span;
+    uint64_t flags;
+
+    assert(str != NULL);
+    if (len < OPENTRACINGC_TRACEPARENT_LENGTH || str[2] != '-' ||
+        str[35] != '-' || str[52] != '-' ||
+        !decode_lower2(str, &version) || version == 0xFF ||
+        (version == 0 && len != OPENTRACINGC_TRACEPARENT_LENGTH) ||
+        (len > OPENTRACINGC_TRACEPARENT_LENGTH &&
+         str[OPENTRACINGC_TRACEPARENT_LENGTH] != '-') ||
+        !opentracing_hex_decode16_lower(str + 3, &id.high) ||
+        !opentracing_hex_decode16_lower(str + 19, &id.low) ||
+        !opentracing_hex_decode16_lower(str + 36, &span) ||
+        !decode_lower2(str + 53, &flags) ||
+        (id.high == 0 && id.low == 0) || span == 0) {
+        return opentracing_propagation_error_code_span_context_corrupted;
+    }
+    *trace_id = id;
+    *span_id = span;
+    *sampled = (flags & 1) ? opentracing_true : opentracing_false;
+    return opentracing_propagation_error_code_success;
+}
+
+void opentracing_b3_encode(const opentracing_trace_id* trace_id,
+                           uint64_t span_id,
+                           opentracing_bool sampled,
+                           char* out)
+{
+    assert(trace_id != NULL);
+    assert(out != NULL);
+    /* trace_id-span_id-sampled */
+    opentracing_hex_encode16(trace_id->high, out);
+    opentracing_hex_encode16(trace_id->low, out + 16);
+    out[32] = '-';
+    opentracing_hex_encode16(span_id, out + 33);
+    out[49] = '-';
+    out[50] = sampled ? '1' : '0';
+    out[51] = '\0';
+}
+
+static opentracing_bool decode_b3_sampling_state(char c,
+                                                 opentracing_bool* sampled)
+{
+    switch (c) {
+    case '0':
+        *sampled = opentracing_false;
+        return opentracing_true;
+    case '1':
+    case 'd':
+        *sampled = opentracing_true;
+        return opentracing_true;
+    default:
+        return opentracing_false;
+    }
+}
+
+opentracing_propagation_error_code
+opentracing_b3_decode(const char* str,
+                      size_t len,
+                      opentracing_trace_id* trace_id,
+                      uint64_t* span_id,
+                      opentracing_bool* sampled)
+{
+    opentracing_trace_id id;
+    opentracing_bool state;
+    const char* rest;
+    uint64_t parent;
+    uint64_t span;
+    size_t trace_len;
+    size_t rest_len;
+
+    assert(str != NULL);
+    if (len == 1) {
+        return decode_b3_sampling_state(str[0], sampled)
+                   ? opentracing_propagation_error_code_span_context_not_found
+                   : opentracing_propagation_error_code_span_context_corrupted;
+    }
+
+    trace_len = (len > 16 && str[16] == '-') ? 16 : 32;
+    if (len < trace_len + 17 || str[trace_len] != '-' ||
+        !opentracing_hex_decode_trace_id(str, trace_len, &id) ||
+        !opentracing_hex_decode16(str + trace_len + 1, &span)) {
+        return opentracing_propagation_error_code_span_context_corrupted;
+    }
+
+    /* Optional -sampling_state, then optional -parent_span_id. */
+    rest = str + trace_len + 17;
+    rest_len = len - trace_len - 17;
+    state = *sampled;
+    if (rest_len > 0 &&
+        (rest_len < 2 || rest[0] != '-' ||
+         !decode_b3_sampling_state(rest[1], &state) ||
+         (rest_len > 2 &&
+          (rest_len != 19 || rest[2] != '-' ||
+           !opentracing_hex_decode16(rest + 3, &parent))))) {
+        return opentracing_propagation_error_code_span_context_corrupted;
+    }
+    *trace_id = id;
+    *span_id = span;
+    *sampled = state;
+    return opentracing_propagation_error_code_success;
+}
@@ -0,0 +1,161 @@
+#ifndef OPENTRACINGC_HEADER_CODEC_H
+#define OPENTRACINGC_HEADER_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/propagation.h>
+#include <opentracing-c/span_data.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Codecs for trace and span IDs in HTTP headers, for use by tracers
+ * implementing inject_http_headers and extract_http_headers. Hex conversion
+ * uses SIMD instructions where available and validates input in the same
+ * pass. None of these functions allocate.
+ */
+
+/** W3C Trace Context header name. */
+#define OPENTRACINGC_TRACEPARENT_HEADER "traceparent"
+
+/** Length of a version 00 traceparent value, excluding the terminator. */
+#define OPENTRACINGC_TRACEPARENT_LENGTH 55
+
+/** B3 single header name. */
+#define OPENTRACINGC_B3_HEADER "b3"
+
+/**
+ * Length of a B3 single header value written by opentracing_b3_encode(),
+ * excluding the terminator.
+ */
+#define OPENTRACINGC_B3_LENGTH 51
+
+/**
+ * Write a 64 bit ID as 16 lowercase hex digits.
+ * @param value ID to encode.
+ * @param out Output buffer of at least 16 characters. Not null-terminated.
+ */
+OPENTRACINGC_EXPORT void opentracing_hex_encode_u64(uint64_t value, char* out)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Parse a 64 bit ID from 1 to 16 hex digits of either case.
+ * @param str Hex digits. Need not be null-terminated.
+ * @param len Number of digits.
+ * @param[out] out Parsed value. Unchanged on failure.
+ * @return opentracing_true on success, opentracing_false if len is out of
+ *         range or str contains a character that is not a hex digit.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_hex_decode_u64(const char* str, size_t len, uint64_t* out)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Write a 128 bit trace ID as 32 lowercase hex digits.
+ * @param trace_id Trace ID to encode.
+ * @param out Output buffer of at least 32 characters. Not null-terminated.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_hex_encode_trace_id(const opentracing_trace_id* trace_id,
+                                char* out) OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Parse a trace ID from 1 to 32 hex digits of either case. IDs of up to 16
+ * digits set only the low half.
+ * @param str Hex digits. Need not be null-terminated.
+ * @param len Number of digits.
+ * @param[out] trace_id Parsed trace ID. Unchanged on failure.
+ * @return opentracing_true on success, opentracing_false otherwise.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_hex_decode_trace_id(const char* str,
+                                size_t len,
+                                opentracing_trace_id* trace_id)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Format a W3C traceparent value, e.g.
+ * 00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01.
+ * @param trace_id Trace ID.
+ * @param span_id Span ID.
+ * @param sampled Sampling decision.
+ * @param out Output buffer of at least OPENTRACINGC_TRACEPARENT_LENGTH + 1
+ *            characters. Null-terminated.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_traceparent_encode(const opentracing_trace_id* trace_id,
+                               uint64_t span_id,
+                               opentracing_bool sampled,
+                               char* out) OPENTRACINGC_NONNULL(1, 4);
+
+/**
+ * Parse a W3C traceparent value. Values with a version above 00 are accepted
+ * if they start with a valid version 00 value, as the specification
+ * requires. Hex digits must be lowercase.
+ * @param str Header value. Need not be null-terminated.
+ * @param len Length of value.
+ * @param[out] trace_id Trace ID.
+ * @param[out] span_id Span ID.
+ * @param[out] sampled Sampled flag.
+ * @return opentracing_propagation_error_code_span_context_corrupted if the
+ *         value is malformed, has uppercase hex digits or an all-zero trace
+ *         or span ID, success otherwise.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_traceparent_decode(const char* str,
+                               size_t len,
+                               opentracing_trace_id* trace_id,
+                               uint64_t* span_id,
+                               opentracing_bool* sampled)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Format a B3 single header value with a 128 bit trace ID, e.g.
+ * 80f198ee56343ba864fe8b2a57d3eff7-e457b5a2e4d86bd1-1.
+ * @param trace_id Trace ID.
+ * @param span_id Span ID.
+ * @param sampled Sampling decision.
+ * @param out Output buffer of at least OPENTRACINGC_B3_LENGTH + 1
+ *            characters. Null-terminated.
+ */
+OPENTRACINGC_EXPORT void opentracing_b3_encode(
+    const opentracing_trace_id* trace_id,
+    uint64_t span_id,
+    opentracing_bool sampled,
+    char* out) OPENTRACINGC_NONNULL(1, 4);
+
+/**
+ * Parse a B3 single header value: a 16 or 32 digit trace ID, a span ID, and
+ * optionally a sampling state and parent span ID, separated by dashes.
+ * @param str Header value. Need not be null-terminated.
+ * @param len Length of value.
+ * @param[out] trace_id Trace ID.
+ * @param[out] span_id Span ID.
+ * @param[in,out] sampled Set to opentracing_true for sampling state 1 or d
+ *                        (debug) and opentracing_false for 0. Left
+ *                        unchanged if the value has no sampling state.
+ * @return opentracing_propagation_error_code_span_context_not_found if the
+ *         value only carries a sampling state,
+ *         opentracing_propagation_error_code_span_context_corrupted if it is
+ *         malformed, success otherwise.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_b3_decode(const char* str,
+                      size_t len,
+                      opentracing_trace_id* trace_id,
+                      uint64_t* span_id,
+                      opentracing_bool* sampled) OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_HEADER_CODEC_H */
@@ -0,0 +1,160 @@
+#include <opentracing-c/intern.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/internal/atomic.h>
+#include <opentracing-c/internal/hash.h>
+
+#define CHUNK_BITS 10
+#define CHUNK_SIZE (1U << CHUNK_BITS)
+#define CHUNK_MASK (CHUNK_SIZE - 1)
+#define MAX_CHUNKS 1024U
+#define INITIAL_TABLE_CAPACITY 256U
+
+/* Allocated with room for the whole string after the header. */
+typedef struct intern_entry {
+    uint32_t hash;
+    char str[1];
+} intern_entry;
+
+/*
+ * Handles index a two-level array so entries never move once published and
+ * lookups need no lock. Chunks and entries are published with release
+ * stores after they are fully initialized.
+ */
+static intern_entry** chunks[MAX_CHUNKS];
+
+/*
+ * Open addressing table from string to handle, only used when registering.
+ * Protected by intern_mutex, as is next_handle.
+ */
+static pthread_mutex_t intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+static opentracing_string_handle* table = NULL;
+static uint32_t table_capacity = 0;
+static uint32_t next_handle = 1;
+
+static intern_entry* lookup_entry(opentracing_string_handle handle)
+{
+    intern_entry** chunk;
+
+    if (handle == OPENTRACINGC_INVALID_STRING_HANDLE ||
+        (handle >> CHUNK_BITS) >= MAX_CHUNKS) {
+        return NULL;
+    }
+    chunk = OPENTRACINGC_ATOMIC_LOAD(&chunks[handle >> CHUNK_BITS],
+                                     OPENTRACINGC_ATOMIC_ACQUIRE);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    return OPENTRACINGC_ATOMIC_LOAD(&chunk[handle & CHUNK_MASK],
+                                    OPENTRACINGC_ATOMIC_ACQUIRE);
+}
+
+static void table_insert(opentracing_string_handle* slots,
+                         uint32_t capacity,
+                         uint32_t hash,
+                         opentracing_string_handle handle)
+{
+    uint32_t i;
+    i = hash & (capacity - 1);
+    while (slots[i] != 0) {
+        i = (i + 1) & (capacity - 1);
+    }
+    slots[i] = handle;
+}
+
+static opentracing_bool table_reserve(void)
+{
+    opentracing_string_handle* slots;
+    uint32_t capacity;
+    uint32_t i;
+
+    /* Keep the load factor at or below one half. */
+    if ((next_handle - 1) * 2 < table_capacity) {
+        return opentracing_true;
+    }
+    capacity = (table_capacity == 0) ? INITIAL_TABLE_CAPACITY
+                                     : table_capacity * 2;
+    slots = (opentracing_string_handle*) calloc(
+        capacity, sizeof(opentracing_string_handle));
+    if (slots == NULL) {
+        return opentracing_false;
+    }
+    for (i = 0; i < table_capacity; i++) {
+        if (table[i] != 0) {
+            table_insert(slots, capacity, lookup_entry(table[i])->hash, table[i]);
+        }
+    }
+    free(table);
+    table = slots;
+    table_capacity = capacity;
+    return opentracing_true;
+}
+
+opentracing_string_handle opentracing_intern(const char* str)
+{
+    opentracing_string_handle handle;
+    intern_entry** chunk;
+    intern_entry* entry;
+    uint32_t hash;
+    uint32_t i;
+    size_t len;
+
+    assert(str != NULL);
+    len = strlen(str);
+    hash = opentracing_hash_fnv1a(str, len);
+    handle = OPENTRACINGC_INVALID_STRING_HANDLE;
+
+    pthread_mutex_lock(&intern_mutex);
+    if (table_capacity > 0) {
+        for (i = hash & (table_capacity - 1); table[i] != 0;
+             i = (i + 1) & (table_capacity - 1)) {
+            entry = lookup_entry(table[i]);
+            if (entry->hash == hash && strcmp(entry->str, str) == 0) {
+                handle = table[i];
+                goto unlock;
+            }
+        }
+    }
+
+    if ((next_handle >> CHUNK_BITS) >= MAX_CHUNKS || !table_reserve()) {
+        goto unlock;
+    }
+    chunk = chunks[next_handle >> CHUNK_BITS];
+    if (chunk == NULL) {
+        chunk = (intern_entry**) calloc(CHUNK_SIZE, sizeof(intern_entry*));
+        if (chunk == NULL) {
+            goto unlock;
+        }
+        OPENTRACINGC_ATOMIC_STORE(&chunks[next_handle >> CHUNK_BITS],
+                                  chunk,
+                                  OPENTRACINGC_ATOMIC_RELEASE);
+    }
+
+    entry = (intern_entry*) malloc(sizeof(intern_entry) + len);
+    if (entry == NULL) {
+        goto unlock;
+    }
+    entry->hash = hash;
+    memcpy(entry->str, str, len + 1);
+
+    handle = next_handle++;
+    OPENTRACINGC_ATOMIC_STORE(
+        &chunk[handle & CHUNK_MASK], entry, OPENTRACINGC_ATOMIC_RELEASE);
+    table_insert(table, table_capacity, hash, handle);
+
+unlock:
+    pthread_mutex_unlock(&intern_mutex);
+    return handle;
+}
+
+const char* opentracing_interned_string(opentracing_string_handle handle)
+{
+    intern_entry* entry;
+    entry = lookup_entry(handle);
+    return (entry != NULL) ? entry->str : NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef OPENTRACINGC_INTERN_H
+#define OPENTRACINGC_INTERN_H
+
+#include <stdint.h>
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Compact handle for a string registered with opentracing_intern(). Zero is
+ * never a valid handle. Handles remain valid for the lifetime of the
+ * process, so they can be created once, e.g. in static initialization, and
+ * passed to the interned variants of set_tag, log_fields and start_span
+ * instead of the string itself.
+ */
+typedef uint32_t opentracing_string_handle;
+
+/** Handle value that never refers to a string. */
+#define OPENTRACINGC_INVALID_STRING_HANDLE ((opentracing_string_handle) 0)
+
+/**
+ * Register a string and return its handle. Registering an equal string again
+ * returns the same handle. The string is copied. Thread-safe, but takes a
+ * lock, so register keys once rather than on every use.
+ * @param str Null-terminated string.
+ * @return Handle on success, OPENTRACINGC_INVALID_STRING_HANDLE if out of
+ *         memory or the table is full.
+ */
+OPENTRACINGC_EXPORT opentracing_string_handle
+opentracing_intern(const char* str) OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Look up the string registered for a handle. Lock-free.
+ * @param handle String handle.
+ * @return Null-terminated string that lives until the process exits, or NULL
+ *         if the handle is invalid.
+ */
+OPENTRACINGC_EXPORT const char*
+opentracing_interned_string(opentracing_string_handle handle);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_INTERN_H */
@@ -0,0 +1,48 @@
+#ifndef OPENTRACINGC_INTERNAL_ATOMIC_H
+#define OPENTRACINGC_INTERNAL_ATOMIC_H
+
+#include <opentracing-c/config.h>
+
+/** @file */
+
+#ifndef OPENTRACINGC_HAVE_ATOMIC_BUILTINS
+#error "opentracing-c requires compiler __atomic builtins"
+#endif /* OPENTRACINGC_HAVE_ATOMIC_BUILTINS */
+
+/*
+ * Thin wrappers around the compiler __atomic builtins. C90 has no atomics of
+ * its own, so these keep the memory orders explicit and greppable.
+ */
+
+#define OPENTRACINGC_ATOMIC_RELAXED __ATOMIC_RELAXED
+#define OPENTRACINGC_ATOMIC_ACQUIRE __ATOMIC_ACQUIRE
+#define OPENTRACINGC_ATOMIC_RELEASE __ATOMIC_RELEASE
+#define OPENTRACINGC_ATOMIC_ACQ_REL __ATOMIC_ACQ_REL
+#define OPENTRACINGC_ATOMIC_SEQ_CST __ATOMIC_SEQ_CST
+
+#define OPENTRACINGC_ATOMIC_LOAD(ptr, order) __atomic_load_n((ptr), (order))
+
+#define OPENTRACINGC_ATOMIC_STORE(ptr, value, order) \
+    __atomic_store_n((ptr), (value), (order))
+
+#define OPENTRACINGC_ATOMIC_EXCHANGE(ptr, value, order) \
+    __atomic_exchange_n((ptr), (value), (order))
+
+#define OPENTRACINGC_ATOMIC_CAS_WEAK(ptr, expected, desired, success, failure) \
+    __atomic_compare_exchange_n(                                               \
+        (ptr), (expected), (desired), 1, (success), (failure))
+
+#define OPENTRACINGC_ATOMIC_CAS_STRONG(                \
+    ptr, expected, desired, success, failure)          \
+    __atomic_compare_exchange_n(                       \
+        (ptr), (expected), (desired), 0, (success), (failure))
+
+#define OPENTRACINGC_ATOMIC_FETCH_ADD(ptr, value, order) \
+    __atomic_fetch_add((ptr), (value), (order))
+
+#define OPENTRACINGC_ATOMIC_FETCH_SUB(ptr, value, order) \
+    __atomic_fetch_sub((ptr), (value), (order))
+
+#define OPENTRACINGC_ATOMIC_FENCE(order) __atomic_thread_fence(order)
+
+#endif /* OPENTRACINGC_INTERNAL_ATOMIC_H */
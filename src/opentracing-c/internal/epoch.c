@@ -0,0 +1,291 @@
+#include <opentracing-c/internal/epoch.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <opentracing-c/internal/atomic.h>
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * Per-thread reader state. The epoch is zero while the thread is outside any
+ * read-side section, otherwise it holds the global epoch observed on entry.
+ * Records are padded so readers on different threads never share a line.
+ */
+typedef struct epoch_record {
+    uint64_t epoch;
+    /* Only touched by the owning thread. */
+    int depth;
+    /* Nonzero while a thread owns the record. */
+    int in_use;
+    struct epoch_record* next;
+    char padding[CACHE_LINE_SIZE];
+} epoch_record;
+
+typedef struct epoch_retired {
+    opentracing_destructible* object;
+    uint64_t epoch;
+    struct epoch_retired* next;
+} epoch_retired;
+
+static uint64_t global_epoch = 1;
+
+/*
+ * Records are pushed onto this list once and never freed. Records of exited
+ * threads are handed to the next thread that needs one.
+ */
+static epoch_record* records = NULL;
+
+/*
+ * Readers that could not get a record, e.g. because they ran out of memory.
+ * Nothing is reclaimed while any of them are inside a section.
+ */
+static unsigned long anonymous_readers = 0;
+
+static pthread_mutex_t retired_mutex = PTHREAD_MUTEX_INITIALIZER;
+static epoch_retired* retired = NULL;
+/* Written under retired_mutex, read without it as a hint. */
+static unsigned long num_retired = 0;
+
+static pthread_once_t epoch_once = PTHREAD_ONCE_INIT;
+static pthread_key_t epoch_key;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+static OPENTRACINGC_THREAD_LOCAL epoch_record* current_record = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static void epoch_record_detach(void* arg)
+{
+    epoch_record* record;
+
+    record = (epoch_record*) arg;
+    assert(record->depth == 0);
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_record = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    OPENTRACINGC_ATOMIC_STORE(&record->in_use, 0, OPENTRACINGC_ATOMIC_RELEASE);
+}
+
+static void epoch_init(void)
+{
+    pthread_key_create(&epoch_key, &epoch_record_detach);
+}
+
+static epoch_record* epoch_record_attach(void)
+{
+    epoch_record* record;
+    epoch_record* head;
+    int expected;
+
+    pthread_once(&epoch_once, &epoch_init);
+
+    for (record =
+             OPENTRACINGC_ATOMIC_LOAD(&records, OPENTRACINGC_ATOMIC_ACQUIRE);
+         record != NULL;
+         record = record->next) {
+        expected = 0;
+        if (OPENTRACINGC_ATOMIC_LOAD(&record->in_use,
+                                     OPENTRACINGC_ATOMIC_RELAXED) == 0 &&
+            OPENTRACINGC_ATOMIC_CAS_STRONG(&record->in_use,
+                                           &expected,
+                                           1,
+                                           OPENTRACINGC_ATOMIC_ACQUIRE,
+                                           OPENTRACINGC_ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (record == NULL) {
+        record = (epoch_record*) calloc(1, sizeof(epoch_record));
+        if (record == NULL) {
+            return NULL;
+        }
+        record->in_use = 1;
+        head = OPENTRACINGC_ATOMIC_LOAD(&records, OPENTRACINGC_ATOMIC_RELAXED);
+        do {
+            record->next = head;
+        } while (!OPENTRACINGC_ATOMIC_CAS_WEAK(&records,
+                                               &head,
+                                               record,
+                                               OPENTRACINGC_ATOMIC_RELEASE,
+                                               OPENTRACINGC_ATOMIC_RELAXED));
+    }
+
+    if (pthread_setspecific(epoch_key, record) != 0) {
+        OPENTRACINGC_ATOMIC_STORE(
+            &record->in_use, 0, OPENTRACINGC_ATOMIC_RELEASE);
+        return NULL;
+    }
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_record = record;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return record;
+}
+
+static epoch_record* epoch_record_peek(void)
+{
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    return current_record;
+#else
+    pthread_once(&epoch_once, &epoch_init);
+    return (epoch_record*) pthread_getspecific(epoch_key);
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+}
+
+/*
+ * Oldest epoch observed by a reader that is still inside a section, or the
+ * maximum value if there is none. Objects retired at or before the result
+ * can no longer be reached by any reader.
+ */
+static uint64_t epoch_min_active(const epoch_record* skip)
+{
+    const epoch_record* record;
+    uint64_t min;
+    uint64_t epoch;
+
+    if (OPENTRACINGC_ATOMIC_LOAD(&anonymous_readers,
+                                 OPENTRACINGC_ATOMIC_SEQ_CST) != 0) {
+        return 0;
+    }
+
+    min = ~(uint64_t) 0;
+    for (record =
+             OPENTRACINGC_ATOMIC_LOAD(&records, OPENTRACINGC_ATOMIC_ACQUIRE);
+         record != NULL;
+         record = record->next) {
+        if (record == skip) {
+            continue;
+        }
+        epoch =
+            OPENTRACINGC_ATOMIC_LOAD(&record->epoch, OPENTRACINGC_ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < min) {
+            min = epoch;
+        }
+    }
+    return min;
+}
+
+static void epoch_reclaim(opentracing_bool wait)
+{
+    epoch_retired* ready;
+    epoch_retired** it;
+    epoch_retired* node;
+    uint64_t min;
+
+    if (wait) {
+        pthread_mutex_lock(&retired_mutex);
+    }
+    else if (pthread_mutex_trylock(&retired_mutex) != 0) {
+        return;
+    }
+
+    ready = NULL;
+    min = epoch_min_active(NULL);
+    it = &retired;
+    while (*it != NULL) {
+        node = *it;
+        if (node->epoch <= min) {
+            *it = node->next;
+            node->next = ready;
+            ready = node;
+            OPENTRACINGC_ATOMIC_STORE(
+                &num_retired, num_retired - 1, OPENTRACINGC_ATOMIC_RELAXED);
+        }
+        else {
+            it = &node->next;
+        }
+    }
+    pthread_mutex_unlock(&retired_mutex);
+
+    /* Destroy outside the lock, destructors may take a while. */
+    for (; ready != NULL; ready = node) {
+        node = ready->next;
+        ready->object->destroy(ready->object);
+        free(ready);
+    }
+}
+
+void opentracing_epoch_enter(void)
+{
+    epoch_record* record;
+
+    record = epoch_record_peek();
+    if (record == NULL) {
+        record = epoch_record_attach();
+        if (record == NULL) {
+            OPENTRACINGC_ATOMIC_FETCH_ADD(
+                &anonymous_readers, 1, OPENTRACINGC_ATOMIC_SEQ_CST);
+            return;
+        }
+    }
+
+    if (record->depth++ == 0) {
+        /* A sequentially consistent exchange rather than a store, so the
+           epoch is visible before any protected pointer is loaded. Pairs
+           with the increment in opentracing_epoch_retire(). */
+        OPENTRACINGC_ATOMIC_EXCHANGE(
+            &record->epoch,
+            OPENTRACINGC_ATOMIC_LOAD(&global_epoch,
+                                     OPENTRACINGC_ATOMIC_RELAXED),
+            OPENTRACINGC_ATOMIC_SEQ_CST);
+    }
+}
+
+void opentracing_epoch_exit(void)
+{
+    epoch_record* record;
+
+    record = epoch_record_peek();
+    if (record == NULL || record->depth == 0) {
+        /* Matching enter had no record. */
+        OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &anonymous_readers, 1, OPENTRACINGC_ATOMIC_RELEASE);
+    }
+    else if (--record->depth == 0) {
+        OPENTRACINGC_ATOMIC_STORE(&record->epoch, 0, OPENTRACINGC_ATOMIC_RELEASE);
+    }
+    else {
+        return;
+    }
+
+    if (OPENTRACINGC_ATOMIC_LOAD(&num_retired, OPENTRACINGC_ATOMIC_RELAXED) !=
+        0) {
+        epoch_reclaim(opentracing_false);
+    }
+}
+
+void opentracing_epoch_retire(opentracing_destructible* object)
+{
+    epoch_retired* node;
+    uint64_t epoch;
+
+    assert(object != NULL);
+
+    node = (epoch_retired*) malloc(sizeof(epoch_retired));
+    epoch = OPENTRACINGC_ATOMIC_FETCH_ADD(
+                &global_epoch, 1, OPENTRACINGC_ATOMIC_SEQ_CST) +
+            1;
+
+    if (node == NULL) {
+        /* Cannot defer, so wait for the other readers to leave instead. */
+        while (epoch_min_active(epoch_record_peek()) < epoch) {
+            sched_yield();
+        }
+        object->destroy(object);
+        return;
+    }
+
+    node->object = object;
+    node->epoch = epoch;
+    pthread_mutex_lock(&retired_mutex);
+    node->next = retired;
+    retired = node;
+    OPENTRACINGC_ATOMIC_STORE(
+        &num_retired, num_retired + 1, OPENTRACINGC_ATOMIC_RELAXED);
+    pthread_mutex_unlock(&retired_mutex);
+
+    epoch_reclaim(opentracing_true);
+}
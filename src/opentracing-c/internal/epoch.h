@@ -0,0 +1,42 @@
+#ifndef OPENTRACINGC_INTERNAL_EPOCH_H
+#define OPENTRACINGC_INTERNAL_EPOCH_H
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/destructible.h>
+
+/** @file */
+
+/**
+ * Epoch-based reclamation for objects that are read without locks. Readers
+ * bracket their accesses with opentracing_epoch_enter() and
+ * opentracing_epoch_exit(). A writer first unlinks an object so no new
+ * reader can find it, then retires it. Retired objects are destroyed once
+ * every reader that entered before the retirement has exited, either by the
+ * retiring thread or by the last such reader on its way out.
+ *
+ * Protected pointers must be published and loaded with sequentially
+ * consistent atomics for the grace period to be detected.
+ */
+
+/**
+ * Enter a read-side critical section on the calling thread. Sections may
+ * nest.
+ */
+void opentracing_epoch_enter(void);
+
+/**
+ * Leave the read-side critical section entered by the matching call to
+ * opentracing_epoch_enter().
+ */
+void opentracing_epoch_exit(void);
+
+/**
+ * Destroy an object once no reader can still be using it.
+ * @param object Object that has already been unlinked from all shared state.
+ *               The caller must not use it after this call.
+ */
+void opentracing_epoch_retire(opentracing_destructible* object)
+    OPENTRACINGC_NONNULL_ALL;
+
+#endif /* OPENTRACINGC_INTERNAL_EPOCH_H */
@@ -0,0 +1,14 @@
+#include <opentracing-c/internal/hash.h>
+
+uint32_t opentracing_hash_fnv1a(const char* data, size_t len)
+{
+    uint32_t hash;
+    size_t i;
+
+    hash = 2166136261U;
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
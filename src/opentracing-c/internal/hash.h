@@ -0,0 +1,17 @@
+#ifndef OPENTRACINGC_INTERNAL_HASH_H
+#define OPENTRACINGC_INTERNAL_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @file */
+
+/**
+ * Hash bytes with 32 bit FNV-1a, for the library's string tables.
+ * @param data Bytes to hash. May be NULL if len is zero.
+ * @param len Number of bytes.
+ * @return Hash value.
+ */
+uint32_t opentracing_hash_fnv1a(const char* data, size_t len);
+
+#endif /* OPENTRACINGC_INTERNAL_HASH_H */
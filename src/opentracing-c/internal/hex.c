@@ -0,0 +1,151 @@
+#include <opentracing-c/internal/hex.h>
+
+#ifdef OPENTRACINGC_HAVE_SSE2_HEX
+#include <emmintrin.h>
+#endif /* OPENTRACINGC_HAVE_SSE2_HEX */
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/* Digit value of each character, or 0xFF for characters that are not hex
+   digits. */
+static const unsigned char hex_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+void opentracing_hex_encode16_scalar(uint64_t value, char* out)
+{
+    int i;
+    for (i = 15; i >= 0; i--) {
+        out[i] = hex_digits[value & 0xF];
+        value >>= 4;
+    }
+}
+
+/* upper is 0xF0 to reject upper case letters, 0 to accept them. */
+static opentracing_bool
+decode16_scalar(const char* str, unsigned char upper, uint64_t* out)
+{
+    uint64_t value;
+    unsigned char invalid;
+    unsigned char digit;
+    unsigned char c;
+    int i;
+
+    /* Accumulate validity instead of branching per character. */
+    value = 0;
+    invalid = 0;
+    for (i = 0; i < 16; i++) {
+        c = (unsigned char) str[i];
+        digit = hex_values[c];
+        invalid |= digit;
+        invalid |= ((unsigned char) (c - 'A') < 6) ? upper : 0;
+        value = (value << 4) | (digit & 0xF);
+    }
+    *out = value;
+    return (invalid & 0xF0) ? opentracing_false : opentracing_true;
+}
+
+opentracing_bool opentracing_hex_decode16_scalar(const char* str, uint64_t* out)
+{
+    return decode16_scalar(str, 0, out);
+}
+
+opentracing_bool opentracing_hex_decode16_lower_scalar(const char* str,
+                                                       uint64_t* out)
+{
+    return decode16_scalar(str, 0xF0, out);
+}
+
+#ifdef OPENTRACINGC_HAVE_SSE2_HEX
+
+/* SSE2 implies x86, which is little endian. */
+
+void opentracing_hex_encode16_sse2(uint64_t value, char* out)
+{
+    __m128i bytes;
+    __m128i high;
+    __m128i low;
+    __m128i nibbles;
+    __m128i ascii;
+    uint64_t big_endian;
+
+    big_endian = __builtin_bswap64(value);
+    bytes = _mm_loadl_epi64((const __m128i*) &big_endian);
+    high = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+    low = _mm_and_si128(bytes, _mm_set1_epi8(0x0F));
+    nibbles = _mm_unpacklo_epi8(high, low);
+    ascii = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+    ascii = _mm_add_epi8(
+        ascii,
+        _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                      _mm_set1_epi8('a' - '0' - 10)));
+    _mm_storeu_si128((__m128i*) out, ascii);
+}
+
+/* fold is 0x20 to accept upper case letters, 0 to reject them. */
+static opentracing_bool
+decode16_sse2(const char* str, char fold, uint64_t* out)
+{
+    __m128i input;
+    __m128i lower;
+    __m128i is_digit;
+    __m128i is_letter;
+    __m128i nibbles;
+    __m128i bytes;
+    uint64_t big_endian;
+
+    input = _mm_loadu_si128((const __m128i*) str);
+
+    /* Signed compares, so characters above 0x7F fail both ranges. Setting
+       0x20 folds upper case letters into lower case and leaves digits
+       unchanged. Without it upper case letters fail the letter range. */
+    is_digit = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)),
+                             _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+    lower = _mm_or_si128(input, _mm_set1_epi8(fold));
+    is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                              _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return opentracing_false;
+    }
+    nibbles = _mm_or_si128(
+        _mm_and_si128(is_digit, _mm_sub_epi8(input, _mm_set1_epi8('0'))),
+        _mm_and_si128(is_letter,
+                      _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+    /* Each 16 bit lane holds the nibbles of one byte, most significant in
+       the low half. */
+    bytes = _mm_or_si128(
+        _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+        _mm_srli_epi16(nibbles, 8));
+    bytes = _mm_packus_epi16(bytes, bytes);
+    _mm_storel_epi64((__m128i*) &big_endian, bytes);
+    *out = __builtin_bswap64(big_endian);
+    return opentracing_true;
+}
+
+opentracing_bool opentracing_hex_decode16_sse2(const char* str, uint64_t* out)
+{
+    return decode16_sse2(str, 0x20, out);
+}
+
+opentracing_bool opentracing_hex_decode16_lower_sse2(const char* str,
+                                                     uint64_t* out)
+{
+    return decode16_sse2(str, 0, out);
+}
+
+#endif /* OPENTRACINGC_HAVE_SSE2_HEX */
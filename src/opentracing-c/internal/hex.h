@@ -0,0 +1,70 @@
+#ifndef OPENTRACINGC_INTERNAL_HEX_H
+#define OPENTRACINGC_INTERNAL_HEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+
+/** @file */
+
+/*
+ * Fixed-width hex conversion of 64 bit values. Both variants are always
+ * declared where available so tests can check them against each other; the
+ * public functions in header_codec.h pick the fastest.
+ */
+
+#if defined(__SSE2__) && !defined(OPENTRACINGC_DISABLE_SIMD)
+#define OPENTRACINGC_HAVE_SSE2_HEX 1
+#endif /* defined(__SSE2__) && !defined(OPENTRACINGC_DISABLE_SIMD) */
+
+/**
+ * Write value as 16 lowercase hex digits, most significant first.
+ * @param value Value to encode.
+ * @param out Output buffer of at least 16 characters. Not null-terminated.
+ */
+void opentracing_hex_encode16_scalar(uint64_t value, char* out);
+
+/**
+ * Parse exactly 16 hex digits of either case.
+ * @param str Input of at least 16 characters.
+ * @param[out] out Parsed value. Unspecified on failure.
+ * @return opentracing_true if all 16 characters are hex digits.
+ */
+opentracing_bool opentracing_hex_decode16_scalar(const char* str, uint64_t* out);
+
+/**
+ * Parse exactly 16 lowercase hex digits, as traceparent requires.
+ * @param str Input of at least 16 characters.
+ * @param[out] out Parsed value. Unspecified on failure.
+ * @return opentracing_true if all 16 characters are lowercase hex digits.
+ */
+opentracing_bool opentracing_hex_decode16_lower_scalar(const char* str,
+                                                       uint64_t* out);
+
+#ifdef OPENTRACINGC_HAVE_SSE2_HEX
+
+/** SSE2 version of opentracing_hex_encode16_scalar(). */
+void opentracing_hex_encode16_sse2(uint64_t value, char* out);
+
+/** SSE2 version of opentracing_hex_decode16_scalar(). */
+opentracing_bool opentracing_hex_decode16_sse2(const char* str, uint64_t* out);
+
+/** SSE2 version of opentracing_hex_decode16_lower_scalar(). */
+opentracing_bool opentracing_hex_decode16_lower_sse2(const char* str,
+                                                     uint64_t* out);
+
+#define opentracing_hex_encode16 opentracing_hex_encode16_sse2
+#define opentracing_hex_decode16 opentracing_hex_decode16_sse2
+#define opentracing_hex_decode16_lower opentracing_hex_decode16_lower_sse2
+
+#else
+
+#define opentracing_hex_encode16 opentracing_hex_encode16_scalar
+#define opentracing_hex_decode16 opentracing_hex_decode16_scalar
+#define opentracing_hex_decode16_lower opentracing_hex_decode16_lower_scalar
+
+#endif /* OPENTRACINGC_HAVE_SSE2_HEX */
+
+#endif /* OPENTRACINGC_INTERNAL_HEX_H */
@@ -0,0 +1,216 @@
+#include <opentracing-c/internal/pool.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <opentracing-c/internal/atomic.h>
+
+typedef struct pool_cache pool_cache;
+
+/*
+ * Header preceding every pooled object. The owner is fixed at allocation time
+ * so any thread can route a freed object back to the right free list. Two
+ * pointers keep the object itself aligned as well as malloc would.
+ */
+typedef struct pool_block {
+    pool_cache* owner;
+    struct pool_block* next;
+} pool_block;
+
+struct pool_cache {
+    /* Only touched by the owning thread. */
+    pool_block* local;
+    int num_local;
+
+    /* Treiber stack of blocks freed by other threads. */
+    pool_block* remote;
+};
+
+typedef struct pool_thread {
+    pool_cache caches[opentracing_pool_slot_count];
+    struct pool_thread* next_abandoned;
+} pool_thread;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+static pthread_mutex_t abandoned_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Caches of exited threads. Blocks allocated by an exited thread may still be
+ * alive elsewhere and point at its caches, so the caches are never freed, only
+ * handed over to the next thread that needs one.
+ */
+static pool_thread* abandoned_threads = NULL;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+static OPENTRACINGC_THREAD_LOCAL pool_thread* current_thread = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static void free_block_list(pool_block* block)
+{
+    pool_block* next;
+    for (; block != NULL; block = next) {
+        next = block->next;
+        free(block);
+    }
+}
+
+static void pool_thread_detach(void* arg)
+{
+    pool_thread* thread;
+    pool_cache* cache;
+    int i;
+
+    thread = (pool_thread*) arg;
+    for (i = 0; i < opentracing_pool_slot_count; i++) {
+        cache = &thread->caches[i];
+        free_block_list(cache->local);
+        cache->local = NULL;
+        cache->num_local = 0;
+        free_block_list(OPENTRACINGC_ATOMIC_EXCHANGE(
+            &cache->remote, NULL, OPENTRACINGC_ATOMIC_ACQUIRE));
+    }
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_thread = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+    pthread_mutex_lock(&abandoned_mutex);
+    thread->next_abandoned = abandoned_threads;
+    abandoned_threads = thread;
+    pthread_mutex_unlock(&abandoned_mutex);
+}
+
+static void pool_init(void)
+{
+    pthread_key_create(&pool_key, &pool_thread_detach);
+}
+
+static pool_thread* pool_thread_attach(void)
+{
+    pool_thread* thread;
+
+    pthread_once(&pool_once, &pool_init);
+
+    pthread_mutex_lock(&abandoned_mutex);
+    thread = abandoned_threads;
+    if (thread != NULL) {
+        abandoned_threads = thread->next_abandoned;
+    }
+    pthread_mutex_unlock(&abandoned_mutex);
+
+    if (thread == NULL) {
+        thread = (pool_thread*) calloc(1, sizeof(pool_thread));
+        if (thread == NULL) {
+            return NULL;
+        }
+    }
+    thread->next_abandoned = NULL;
+
+    if (pthread_setspecific(pool_key, thread) != 0) {
+        pool_thread_detach(thread);
+        return NULL;
+    }
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_thread = thread;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return thread;
+}
+
+static pool_thread* pool_thread_peek(void)
+{
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    return current_thread;
+#else
+    pthread_once(&pool_once, &pool_init);
+    return (pool_thread*) pthread_getspecific(pool_key);
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+}
+
+void* opentracing_pool_alloc(const opentracing_pool* pool)
+{
+    pool_thread* thread;
+    pool_cache* cache;
+    pool_block* block;
+    pool_block* it;
+
+    assert(pool != NULL);
+    assert(pool->slot < opentracing_pool_slot_count);
+
+    thread = pool_thread_peek();
+    if (thread == NULL) {
+        thread = pool_thread_attach();
+    }
+    if (thread == NULL) {
+        block = (pool_block*) malloc(sizeof(pool_block) + pool->object_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->owner = NULL;
+        return block + 1;
+    }
+
+    cache = &thread->caches[pool->slot];
+    block = cache->local;
+    if (block == NULL) {
+        block = OPENTRACINGC_ATOMIC_EXCHANGE(
+            &cache->remote, NULL, OPENTRACINGC_ATOMIC_ACQUIRE);
+        for (it = block; it != NULL; it = it->next) {
+            cache->num_local++;
+        }
+    }
+
+    if (block != NULL) {
+        cache->local = block->next;
+        cache->num_local--;
+    }
+    else {
+        block = (pool_block*) malloc(sizeof(pool_block) + pool->object_size);
+        if (block == NULL) {
+            return NULL;
+        }
+    }
+    block->owner = cache;
+    return block + 1;
+}
+
+void opentracing_pool_free(const opentracing_pool* pool, void* ptr)
+{
+    pool_thread* thread;
+    pool_block* block;
+    pool_cache* owner;
+    pool_block* head;
+
+    assert(pool != NULL);
+    assert(ptr != NULL);
+
+    block = ((pool_block*) ptr) - 1;
+    owner = block->owner;
+    if (owner == NULL) {
+        free(block);
+        return;
+    }
+
+    thread = pool_thread_peek();
+    if (thread != NULL && owner == &thread->caches[pool->slot]) {
+        if (owner->num_local >= pool->max_cached) {
+            free(block);
+            return;
+        }
+        block->next = owner->local;
+        owner->local = block;
+        owner->num_local++;
+        return;
+    }
+
+    head = OPENTRACINGC_ATOMIC_LOAD(&owner->remote,
+                                    OPENTRACINGC_ATOMIC_RELAXED);
+    do {
+        block->next = head;
+    } while (!OPENTRACINGC_ATOMIC_CAS_WEAK(&owner->remote,
+                                           &head,
+                                           block,
+                                           OPENTRACINGC_ATOMIC_RELEASE,
+                                           OPENTRACINGC_ATOMIC_RELAXED));
+}
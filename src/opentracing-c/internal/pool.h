@@ -0,0 +1,61 @@
+#ifndef OPENTRACINGC_INTERNAL_POOL_H
+#define OPENTRACINGC_INTERNAL_POOL_H
+
+#include <stddef.h>
+
+#include <opentracing-c/config.h>
+
+/** @file */
+
+/**
+ * Pool slots. Every thread keeps one free list per slot, so each pool must
+ * own a distinct slot.
+ */
+typedef enum opentracing_pool_slot {
+    opentracing_pool_slot_span,
+    opentracing_pool_slot_span_context,
+    opentracing_pool_slot_unsampled_span,
+    opentracing_pool_slot_count
+} opentracing_pool_slot;
+
+/**
+ * Fixed-size object pool backed by per-thread free lists. Objects freed on
+ * the thread that allocated them go straight back to that thread's list.
+ * Objects freed elsewhere are pushed onto a lock-free list owned by the
+ * allocating thread, which reclaims them in bulk the next time its own list
+ * runs dry.
+ */
+typedef struct opentracing_pool {
+    /** Size of each object in bytes. */
+    size_t object_size;
+    /** Free list slot. */
+    opentracing_pool_slot slot;
+    /**
+     * Maximum number of free objects a thread keeps before returning memory
+     * to the system allocator.
+     */
+    int max_cached;
+} opentracing_pool;
+
+#define OPENTRACINGC_POOL_INIT(type, slot, max_cached) \
+    {                                                  \
+        sizeof(type), (slot), (max_cached)             \
+    }
+
+/**
+ * Allocate an uninitialized object from the pool.
+ * @param pool Pool instance.
+ * @return Object pointer on success, NULL if out of memory.
+ */
+void* opentracing_pool_alloc(const opentracing_pool* pool)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Return an object to the pool. May be called from any thread.
+ * @param pool Pool the object was allocated from.
+ * @param ptr Object pointer.
+ */
+void opentracing_pool_free(const opentracing_pool* pool, void* ptr)
+    OPENTRACINGC_NONNULL_ALL;
+
+#endif /* OPENTRACINGC_INTERNAL_POOL_H */
@@ -0,0 +1,454 @@
+#include <opentracing-c/internal/recorder.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <opentracing-c/internal/atomic.h>
+
+#define THREAD_SLOTS 4
+#define CACHE_LINE_SIZE 64
+
+/*
+ * Single-producer, single-consumer ring. The producer owns head and the
+ * consumer owns tail; each side only reads the other's index with acquire
+ * semantics, so the hot path of a push is a plain write into the slot
+ * followed by a release store of head.
+ */
+typedef struct recorder_ring {
+    /* Producer side. */
+    unsigned long head;
+    unsigned long cached_tail;
+    char producer_padding[CACHE_LINE_SIZE];
+
+    /* Consumer side. */
+    unsigned long tail;
+    char consumer_padding[CACHE_LINE_SIZE];
+
+    void** items;
+    unsigned long mask;
+
+    /* One reference for the recorder, one for the producing thread. */
+    int ref_count;
+    /* Set once the producing thread stops using the ring. */
+    int abandoned;
+    struct recorder_ring* next;
+} recorder_ring;
+
+struct opentracing_recorder {
+    opentracing_recorder_drain drain;
+    void* arg;
+    unsigned long id;
+    unsigned long capacity;
+    int batch_size;
+    int flush_interval_ms;
+    void** batch;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t flushed;
+    /* New rings are pushed at the head under mutex. Only the collector
+       unlinks rings, so it may walk the list without holding the mutex. */
+    recorder_ring* rings;
+    unsigned long flush_requested;
+    unsigned long flush_completed;
+    opentracing_bool stopping;
+    pthread_t collector;
+};
+
+typedef struct recorder_thread_slot {
+    const opentracing_recorder* recorder;
+    unsigned long recorder_id;
+    recorder_ring* ring;
+} recorder_thread_slot;
+
+typedef struct recorder_thread {
+    recorder_thread_slot slots[THREAD_SLOTS];
+    int next_victim;
+} recorder_thread;
+
+static unsigned long next_recorder_id = 1;
+
+static pthread_once_t recorder_once = PTHREAD_ONCE_INIT;
+static pthread_key_t recorder_key;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+static OPENTRACINGC_THREAD_LOCAL recorder_thread* current_thread = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static void recorder_ring_release(recorder_ring* ring)
+{
+    if (OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &ring->ref_count, 1, OPENTRACINGC_ATOMIC_ACQ_REL) != 1) {
+        return;
+    }
+    free(ring->items);
+    free(ring);
+}
+
+static void recorder_ring_abandon(recorder_ring* ring)
+{
+    OPENTRACINGC_ATOMIC_STORE(&ring->abandoned, 1, OPENTRACINGC_ATOMIC_RELEASE);
+    recorder_ring_release(ring);
+}
+
+static void recorder_thread_detach(void* arg)
+{
+    recorder_thread* thread;
+    int i;
+
+    thread = (recorder_thread*) arg;
+    for (i = 0; i < THREAD_SLOTS; i++) {
+        if (thread->slots[i].ring != NULL) {
+            recorder_ring_abandon(thread->slots[i].ring);
+        }
+    }
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_thread = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    free(thread);
+}
+
+static void recorder_init(void)
+{
+    pthread_key_create(&recorder_key, &recorder_thread_detach);
+}
+
+static recorder_thread* recorder_thread_get(void)
+{
+    recorder_thread* thread;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    thread = current_thread;
+    if (thread != NULL) {
+        return thread;
+    }
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+    pthread_once(&recorder_once, &recorder_init);
+    thread = (recorder_thread*) pthread_getspecific(recorder_key);
+    if (thread != NULL) {
+        return thread;
+    }
+
+    thread = (recorder_thread*) calloc(1, sizeof(recorder_thread));
+    if (thread == NULL) {
+        return NULL;
+    }
+    if (pthread_setspecific(recorder_key, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_thread = thread;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return thread;
+}
+
+static recorder_ring* recorder_ring_attach(opentracing_recorder* recorder,
+                                           recorder_thread* thread)
+{
+    recorder_thread_slot* slot;
+    recorder_ring* ring;
+    int i;
+
+    slot = NULL;
+    for (i = 0; i < THREAD_SLOTS; i++) {
+        if (thread->slots[i].ring == NULL) {
+            slot = &thread->slots[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        slot = &thread->slots[thread->next_victim];
+        thread->next_victim = (thread->next_victim + 1) % THREAD_SLOTS;
+        recorder_ring_abandon(slot->ring);
+        slot->ring = NULL;
+    }
+
+    ring = (recorder_ring*) calloc(1, sizeof(recorder_ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->items = (void**) malloc(sizeof(void*) * recorder->capacity);
+    if (ring->items == NULL) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = recorder->capacity - 1;
+    ring->ref_count = 2;
+
+    pthread_mutex_lock(&recorder->mutex);
+    ring->next = recorder->rings;
+    recorder->rings = ring;
+    pthread_mutex_unlock(&recorder->mutex);
+
+    slot->recorder = recorder;
+    slot->recorder_id = recorder->id;
+    slot->ring = ring;
+    return ring;
+}
+
+static recorder_ring* recorder_ring_get(opentracing_recorder* recorder)
+{
+    recorder_thread* thread;
+    recorder_thread_slot* slot;
+    int i;
+
+    thread = recorder_thread_get();
+    if (thread == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < THREAD_SLOTS; i++) {
+        slot = &thread->slots[i];
+        if (slot->ring == NULL) {
+            continue;
+        }
+        if (slot->recorder == recorder) {
+            if (slot->recorder_id == recorder->id) {
+                return slot->ring;
+            }
+            /* Stale ring of a destroyed recorder at the same address. */
+            recorder_ring_abandon(slot->ring);
+            slot->ring = NULL;
+        }
+    }
+    return recorder_ring_attach(recorder, thread);
+}
+
+opentracing_bool opentracing_recorder_push(opentracing_recorder* recorder,
+                                           void* item)
+{
+    recorder_ring* ring;
+    unsigned long head;
+
+    assert(recorder != NULL);
+    ring = recorder_ring_get(recorder);
+    if (ring == NULL) {
+        return opentracing_false;
+    }
+
+    head = ring->head;
+    if (head - ring->cached_tail > ring->mask) {
+        ring->cached_tail =
+            OPENTRACINGC_ATOMIC_LOAD(&ring->tail, OPENTRACINGC_ATOMIC_ACQUIRE);
+        if (head - ring->cached_tail > ring->mask) {
+            return opentracing_false;
+        }
+    }
+    ring->items[head & ring->mask] = item;
+    OPENTRACINGC_ATOMIC_STORE(&ring->head, head + 1,
+                              OPENTRACINGC_ATOMIC_RELEASE);
+    return opentracing_true;
+}
+
+static void recorder_remove_abandoned(opentracing_recorder* recorder)
+{
+    recorder_ring** prev;
+    recorder_ring* ring;
+
+    pthread_mutex_lock(&recorder->mutex);
+    prev = &recorder->rings;
+    while (*prev != NULL) {
+        ring = *prev;
+        if (OPENTRACINGC_ATOMIC_LOAD(&ring->abandoned,
+                                     OPENTRACINGC_ATOMIC_ACQUIRE) &&
+            OPENTRACINGC_ATOMIC_LOAD(&ring->head,
+                                     OPENTRACINGC_ATOMIC_ACQUIRE) ==
+                ring->tail) {
+            *prev = ring->next;
+            recorder_ring_release(ring);
+        }
+        else {
+            prev = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+static void recorder_drain_all(opentracing_recorder* recorder)
+{
+    recorder_ring* ring;
+    unsigned long head;
+    unsigned long tail;
+    opentracing_bool has_abandoned;
+    int num_items;
+
+    pthread_mutex_lock(&recorder->mutex);
+    ring = recorder->rings;
+    pthread_mutex_unlock(&recorder->mutex);
+
+    has_abandoned = opentracing_false;
+    num_items = 0;
+    for (; ring != NULL; ring = ring->next) {
+        if (OPENTRACINGC_ATOMIC_LOAD(&ring->abandoned,
+                                     OPENTRACINGC_ATOMIC_ACQUIRE)) {
+            has_abandoned = opentracing_true;
+        }
+        tail = ring->tail;
+        head = OPENTRACINGC_ATOMIC_LOAD(&ring->head,
+                                        OPENTRACINGC_ATOMIC_ACQUIRE);
+        while (tail != head) {
+            recorder->batch[num_items++] = ring->items[tail & ring->mask];
+            tail++;
+            if (num_items == recorder->batch_size) {
+                OPENTRACINGC_ATOMIC_STORE(
+                    &ring->tail, tail, OPENTRACINGC_ATOMIC_RELEASE);
+                recorder->drain(recorder->arg, recorder->batch, num_items);
+                num_items = 0;
+            }
+        }
+        OPENTRACINGC_ATOMIC_STORE(&ring->tail, tail,
+                                  OPENTRACINGC_ATOMIC_RELEASE);
+    }
+    if (num_items > 0) {
+        recorder->drain(recorder->arg, recorder->batch, num_items);
+    }
+
+    if (has_abandoned) {
+        recorder_remove_abandoned(recorder);
+    }
+}
+
+static void deadline_after(struct timespec* deadline, int timeout_ms)
+{
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+static void* recorder_collect(void* arg)
+{
+    opentracing_recorder* recorder;
+    struct timespec deadline;
+    unsigned long generation;
+
+    recorder = (opentracing_recorder*) arg;
+    pthread_mutex_lock(&recorder->mutex);
+    while (!recorder->stopping) {
+        if (recorder->flush_requested == recorder->flush_completed) {
+            deadline_after(&deadline, recorder->flush_interval_ms);
+            pthread_cond_timedwait(
+                &recorder->wake, &recorder->mutex, &deadline);
+        }
+        if (recorder->stopping) {
+            break;
+        }
+        generation = recorder->flush_requested;
+        pthread_mutex_unlock(&recorder->mutex);
+
+        recorder_drain_all(recorder);
+
+        pthread_mutex_lock(&recorder->mutex);
+        recorder->flush_completed = generation;
+        pthread_cond_broadcast(&recorder->flushed);
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+    return NULL;
+}
+
+opentracing_recorder* opentracing_recorder_new(opentracing_recorder_drain drain,
+                                               void* arg,
+                                               int buffer_size,
+                                               int batch_size,
+                                               int flush_interval_ms)
+{
+    opentracing_recorder* recorder;
+
+    assert(drain != NULL);
+    assert(buffer_size > 0);
+    assert(batch_size > 0);
+    assert(flush_interval_ms > 0);
+
+    recorder = (opentracing_recorder*) calloc(1, sizeof(opentracing_recorder));
+    if (recorder == NULL) {
+        return NULL;
+    }
+    recorder->batch = (void**) malloc(sizeof(void*) * batch_size);
+    if (recorder->batch == NULL) {
+        free(recorder);
+        return NULL;
+    }
+    recorder->drain = drain;
+    recorder->arg = arg;
+    recorder->id = OPENTRACINGC_ATOMIC_FETCH_ADD(
+        &next_recorder_id, 1, OPENTRACINGC_ATOMIC_RELAXED);
+    recorder->capacity = 1;
+    while (recorder->capacity < (unsigned long) buffer_size) {
+        recorder->capacity <<= 1;
+    }
+    recorder->batch_size = batch_size;
+    recorder->flush_interval_ms = flush_interval_ms;
+
+    pthread_mutex_init(&recorder->mutex, NULL);
+    pthread_cond_init(&recorder->wake, NULL);
+    pthread_cond_init(&recorder->flushed, NULL);
+    if (pthread_create(
+            &recorder->collector, NULL, &recorder_collect, recorder) != 0) {
+        pthread_cond_destroy(&recorder->flushed);
+        pthread_cond_destroy(&recorder->wake);
+        pthread_mutex_destroy(&recorder->mutex);
+        free(recorder->batch);
+        free(recorder);
+        return NULL;
+    }
+    return recorder;
+}
+
+opentracing_bool opentracing_recorder_flush(opentracing_recorder* recorder,
+                                            int timeout_ms)
+{
+    struct timespec deadline;
+    unsigned long generation;
+    opentracing_bool drained;
+
+    assert(recorder != NULL);
+    deadline_after(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&recorder->mutex);
+    generation = ++recorder->flush_requested;
+    pthread_cond_signal(&recorder->wake);
+    while (recorder->flush_completed < generation && !recorder->stopping) {
+        if (pthread_cond_timedwait(
+                &recorder->flushed, &recorder->mutex, &deadline) ==
+            ETIMEDOUT) {
+            break;
+        }
+    }
+    drained = (recorder->flush_completed >= generation) ? opentracing_true
+                                                        : opentracing_false;
+    pthread_mutex_unlock(&recorder->mutex);
+    return drained;
+}
+
+void opentracing_recorder_destroy(opentracing_recorder* recorder)
+{
+    recorder_ring* ring;
+    recorder_ring* next;
+
+    assert(recorder != NULL);
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->stopping = opentracing_true;
+    pthread_cond_broadcast(&recorder->wake);
+    pthread_cond_broadcast(&recorder->flushed);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->collector, NULL);
+
+    recorder_drain_all(recorder);
+    for (ring = recorder->rings; ring != NULL; ring = next) {
+        next = ring->next;
+        recorder_ring_release(ring);
+    }
+
+    pthread_cond_destroy(&recorder->flushed);
+    pthread_cond_destroy(&recorder->wake);
+    pthread_mutex_destroy(&recorder->mutex);
+    free(recorder->batch);
+    free(recorder);
+}
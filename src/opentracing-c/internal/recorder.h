@@ -0,0 +1,76 @@
+#ifndef OPENTRACINGC_INTERNAL_RECORDER_H
+#define OPENTRACINGC_INTERNAL_RECORDER_H
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+
+/** @file */
+
+/**
+ * Recorder that moves items from the threads producing them to a background
+ * collector thread. Every producer thread gets its own single-producer,
+ * single-consumer ring, so pushing an item costs one release store and never
+ * contends with other producers. The collector periodically drains all rings
+ * and hands the items over in batches.
+ */
+typedef struct opentracing_recorder opentracing_recorder;
+
+/**
+ * Callback invoked on the collector thread with a batch of items.
+ * @param arg User-defined argument.
+ * @param items Array of items. Only valid for the duration of the call.
+ * @param num_items Number of items in array.
+ */
+typedef void (*opentracing_recorder_drain)(void* arg,
+                                           void* const* items,
+                                           int num_items);
+
+/**
+ * Create a recorder and start its collector thread.
+ * @param drain Callback to receive batches of items.
+ * @param arg Argument passed to drain.
+ * @param buffer_size Capacity of each producer thread's ring. Rounded up to a
+ *                    power of two.
+ * @param batch_size Maximum number of items passed to a single drain call.
+ * @param flush_interval_ms Time between collector passes in milliseconds.
+ * @return New recorder on success, NULL on failure.
+ */
+opentracing_recorder* opentracing_recorder_new(opentracing_recorder_drain drain,
+                                               void* arg,
+                                               int buffer_size,
+                                               int batch_size,
+                                               int flush_interval_ms)
+    OPENTRACINGC_NONNULL(1);
+
+/**
+ * Push an item into the calling thread's ring.
+ * @param recorder Recorder instance.
+ * @param item Item to push.
+ * @return opentracing_true on success, opentracing_false if the ring is full
+ *         or could not be allocated, in which case the caller still owns the
+ *         item.
+ */
+opentracing_bool opentracing_recorder_push(opentracing_recorder* recorder,
+                                           void* item) OPENTRACINGC_NONNULL(1);
+
+/**
+ * Wake the collector and wait until every item pushed before the call has
+ * been drained.
+ * @param recorder Recorder instance.
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return opentracing_true if drained before the deadline, opentracing_false
+ *         otherwise.
+ */
+opentracing_bool opentracing_recorder_flush(opentracing_recorder* recorder,
+                                            int timeout_ms)
+    OPENTRACINGC_NONNULL(1);
+
+/**
+ * Stop the collector thread, drain any remaining items on the calling thread
+ * and free the recorder.
+ * @param recorder Recorder instance.
+ */
+void opentracing_recorder_destroy(opentracing_recorder* recorder)
+    OPENTRACINGC_NONNULL(1);
+
+#endif /* OPENTRACINGC_INTERNAL_RECORDER_H */
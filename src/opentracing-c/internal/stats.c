@@ -0,0 +1,247 @@
+#include <opentracing-c/internal/stats.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/internal/atomic.h>
+
+#define CACHE_LINE_SIZE 64
+#define NS_PER_SEC INT64_C(1000000000)
+
+/*
+ * Counters of one thread. The owning thread is the only writer, so updates
+ * are a relaxed load and store rather than an atomic add.
+ */
+typedef struct stats_shard {
+    uint64_t counters[opentracing_stats_num_counters];
+    opentracing_histogram histograms[opentracing_stats_num_histograms];
+    /* Nonzero while a thread owns the shard. */
+    int in_use;
+    struct stats_shard* next;
+    char padding[CACHE_LINE_SIZE];
+} stats_shard;
+
+/*
+ * Shards are pushed onto this list once and never freed, so totals survive
+ * their threads. Shards of exited threads are handed to the next thread
+ * that needs one and keep counting from where they were.
+ */
+static stats_shard* shards = NULL;
+
+/*
+ * Shared by threads that could not get a shard, e.g. because they ran out
+ * of memory. Only this one is updated with atomic adds.
+ */
+static stats_shard shared_shard;
+
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+static OPENTRACINGC_THREAD_LOCAL stats_shard* current_shard = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static void stats_shard_detach(void* arg)
+{
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_shard = NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    OPENTRACINGC_ATOMIC_STORE(
+        &((stats_shard*) arg)->in_use, 0, OPENTRACINGC_ATOMIC_RELEASE);
+}
+
+static void stats_init(void)
+{
+    pthread_key_create(&stats_key, &stats_shard_detach);
+}
+
+static stats_shard* stats_shard_attach(void)
+{
+    stats_shard* shard;
+    stats_shard* head;
+    int expected;
+
+    for (shard = OPENTRACINGC_ATOMIC_LOAD(&shards, OPENTRACINGC_ATOMIC_ACQUIRE);
+         shard != NULL;
+         shard = shard->next) {
+        expected = 0;
+        if (OPENTRACINGC_ATOMIC_LOAD(&shard->in_use,
+                                     OPENTRACINGC_ATOMIC_RELAXED) == 0 &&
+            OPENTRACINGC_ATOMIC_CAS_STRONG(&shard->in_use,
+                                           &expected,
+                                           1,
+                                           OPENTRACINGC_ATOMIC_ACQUIRE,
+                                           OPENTRACINGC_ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (shard == NULL) {
+        shard = (stats_shard*) calloc(1, sizeof(stats_shard));
+        if (shard == NULL) {
+            return &shared_shard;
+        }
+        shard->in_use = 1;
+        head = OPENTRACINGC_ATOMIC_LOAD(&shards, OPENTRACINGC_ATOMIC_RELAXED);
+        do {
+            shard->next = head;
+        } while (!OPENTRACINGC_ATOMIC_CAS_WEAK(&shards,
+                                               &head,
+                                               shard,
+                                               OPENTRACINGC_ATOMIC_RELEASE,
+                                               OPENTRACINGC_ATOMIC_RELAXED));
+    }
+
+    if (pthread_setspecific(stats_key, shard) != 0) {
+        OPENTRACINGC_ATOMIC_STORE(
+            &shard->in_use, 0, OPENTRACINGC_ATOMIC_RELEASE);
+        return &shared_shard;
+    }
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    current_shard = shard;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return shard;
+}
+
+static stats_shard* shard_get(void)
+{
+    stats_shard* shard;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    shard = current_shard;
+    if (shard == NULL) {
+        pthread_once(&stats_once, &stats_init);
+        shard = stats_shard_attach();
+    }
+#else
+    pthread_once(&stats_once, &stats_init);
+    shard = (stats_shard*) pthread_getspecific(stats_key);
+    if (shard == NULL) {
+        shard = stats_shard_attach();
+    }
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+    return shard;
+}
+
+static void shard_add(stats_shard* shard, uint64_t* counter, uint64_t value)
+{
+    if (shard == &shared_shard) {
+        OPENTRACINGC_ATOMIC_FETCH_ADD(
+            counter, value, OPENTRACINGC_ATOMIC_RELAXED);
+        return;
+    }
+    OPENTRACINGC_ATOMIC_STORE(
+        counter,
+        OPENTRACINGC_ATOMIC_LOAD(counter, OPENTRACINGC_ATOMIC_RELAXED) + value,
+        OPENTRACINGC_ATOMIC_RELAXED);
+}
+
+/* Index of the highest set bit, so bucket i holds [2^i, 2^(i + 1)). */
+static int bucket_index(uint64_t ns)
+{
+    int index;
+    int shift;
+
+    index = 0;
+    for (shift = 32; shift > 0; shift >>= 1) {
+        if ((ns >> shift) != 0) {
+            ns >>= shift;
+            index += shift;
+        }
+    }
+    return (index < OPENTRACINGC_HISTOGRAM_NUM_BUCKETS)
+               ? index
+               : OPENTRACINGC_HISTOGRAM_NUM_BUCKETS - 1;
+}
+
+void opentracing_stats_add(opentracing_stats_counter counter, uint64_t value)
+{
+    stats_shard* shard;
+
+    shard = shard_get();
+    shard_add(shard, &shard->counters[counter], value);
+}
+
+void opentracing_stats_record(opentracing_stats_histogram histogram,
+                              const opentracing_duration* start,
+                              const opentracing_duration* end)
+{
+    stats_shard* shard;
+    opentracing_histogram* h;
+    int64_t ns;
+
+    assert(start != NULL);
+    assert(end != NULL);
+    ns = (int64_t)(end->value.tv_sec - start->value.tv_sec) * NS_PER_SEC +
+         (end->value.tv_nsec - start->value.tv_nsec);
+    if (ns < 0) {
+        ns = 0;
+    }
+    shard = shard_get();
+    h = &shard->histograms[histogram];
+    shard_add(shard, &h->buckets[bucket_index((uint64_t) ns)], 1);
+    shard_add(shard, &h->count, 1);
+    shard_add(shard, &h->sum_ns, (uint64_t) ns);
+}
+
+static void merge_histogram(opentracing_histogram* total,
+                            const opentracing_histogram* shard)
+{
+    int i;
+
+    for (i = 0; i < OPENTRACINGC_HISTOGRAM_NUM_BUCKETS; i++) {
+        total->buckets[i] += OPENTRACINGC_ATOMIC_LOAD(
+            &shard->buckets[i], OPENTRACINGC_ATOMIC_RELAXED);
+    }
+    total->count +=
+        OPENTRACINGC_ATOMIC_LOAD(&shard->count, OPENTRACINGC_ATOMIC_RELAXED);
+    total->sum_ns +=
+        OPENTRACINGC_ATOMIC_LOAD(&shard->sum_ns, OPENTRACINGC_ATOMIC_RELAXED);
+}
+
+static void merge_shard(opentracing_tracer_stats* stats,
+                        uint64_t* counters,
+                        const stats_shard* shard)
+{
+    int i;
+
+    for (i = 0; i < opentracing_stats_num_counters; i++) {
+        counters[i] += OPENTRACINGC_ATOMIC_LOAD(&shard->counters[i],
+                                                OPENTRACINGC_ATOMIC_RELAXED);
+    }
+    merge_histogram(&stats->finish_to_export,
+                    &shard->histograms[opentracing_stats_finish_to_export]);
+    merge_histogram(&stats->flush_duration,
+                    &shard->histograms[opentracing_stats_flush_duration]);
+}
+
+void opentracing_stats_merge(opentracing_tracer_stats* stats)
+{
+    uint64_t counters[opentracing_stats_num_counters];
+    const stats_shard* shard;
+
+    assert(stats != NULL);
+    memset(stats, 0, sizeof(*stats));
+    memset(counters, 0, sizeof(counters));
+    merge_shard(stats, counters, &shared_shard);
+    for (shard = OPENTRACINGC_ATOMIC_LOAD(&shards, OPENTRACINGC_ATOMIC_ACQUIRE);
+         shard != NULL;
+         shard = shard->next) {
+        merge_shard(stats, counters, shard);
+    }
+    stats->spans_started = counters[opentracing_stats_spans_started];
+    stats->spans_sampled = counters[opentracing_stats_spans_sampled];
+    stats->spans_finished = counters[opentracing_stats_spans_finished];
+    stats->spans_dropped = counters[opentracing_stats_spans_dropped];
+    stats->bytes_encoded = counters[opentracing_stats_bytes_encoded];
+
+    /* Shards are read one by one, so drains may be seen before pushes. */
+    if (counters[opentracing_stats_spans_enqueued] >
+        counters[opentracing_stats_spans_drained]) {
+        stats->export_queue_depth =
+            counters[opentracing_stats_spans_enqueued] -
+            counters[opentracing_stats_spans_drained];
+    }
+}
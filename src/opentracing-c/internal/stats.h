@@ -0,0 +1,67 @@
+#ifndef OPENTRACINGC_INTERNAL_STATS_H
+#define OPENTRACINGC_INTERNAL_STATS_H
+
+#include <stdint.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/stats.h>
+
+/** @file */
+
+/**
+ * Process-wide counters behind opentracing_get_tracer_stats(). Each thread
+ * owns a shard, found through thread-local storage or a pthread key, and is
+ * its only writer, so updates are plain relaxed loads and stores to a cache
+ * line no other thread writes. Reads merge every shard.
+ */
+
+/**
+ * Counters, in the order of the fields of opentracing_tracer_stats. The
+ * export queue depth is derived from the last two on merge.
+ */
+typedef enum opentracing_stats_counter {
+    opentracing_stats_spans_started,
+    opentracing_stats_spans_sampled,
+    opentracing_stats_spans_finished,
+    opentracing_stats_spans_dropped,
+    opentracing_stats_bytes_encoded,
+    opentracing_stats_spans_enqueued,
+    opentracing_stats_spans_drained,
+    opentracing_stats_num_counters
+} opentracing_stats_counter;
+
+/** Histograms, in the order of the fields of opentracing_tracer_stats. */
+typedef enum opentracing_stats_histogram {
+    opentracing_stats_finish_to_export,
+    opentracing_stats_flush_duration,
+    opentracing_stats_num_histograms
+} opentracing_stats_histogram;
+
+/**
+ * Add to a counter.
+ * @param counter Counter to update.
+ * @param value Amount to add.
+ */
+void opentracing_stats_add(opentracing_stats_counter counter, uint64_t value);
+
+/**
+ * Record a latency sample.
+ * @param histogram Histogram to update.
+ * @param start Start of the interval.
+ * @param end End of the interval. Samples ending before they start are
+ *            recorded as zero.
+ */
+void opentracing_stats_record(opentracing_stats_histogram histogram,
+                              const opentracing_duration* start,
+                              const opentracing_duration* end)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Sum every shard.
+ * @param[out] stats Set to the totals.
+ */
+void opentracing_stats_merge(opentracing_tracer_stats* stats)
+    OPENTRACINGC_NONNULL_ALL;
+
+#endif /* OPENTRACINGC_INTERNAL_STATS_H */
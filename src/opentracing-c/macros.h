@@ -0,0 +1,338 @@
+#ifndef OPENTRACINGC_MACROS_H
+#define OPENTRACINGC_MACROS_H
+
+#include <stddef.h>
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/tracer.h>
+
+/** @file */
+
+/**
+ * Instrumentation macros. Each macro expands to the corresponding vtable
+ * calls. If OPENTRACINGC_DISABLE is defined before this header is included,
+ * every macro instead expands to a statement with no effect: arguments are
+ * only used as operands of sizeof, so they are neither evaluated nor
+ * reported as unused, and the span variable is set to NULL.
+ *
+ * Spans passed to the tag, log and finish macros may be NULL, e.g. because
+ * starting the span failed, in which case the macro does nothing.
+ *
+ * Example:
+ * @code
+ * opentracing_span* span;
+ * OPENTRACINGC_START_GLOBAL_SPAN(span, "handle_request");
+ * OPENTRACINGC_SET_TAG_INT64(span, "http.status_code", status);
+ * OPENTRACINGC_FINISH_GLOBAL_SPAN(span);
+ * @endcode
+ */
+
+#ifdef OPENTRACINGC_DISABLE
+
+#define OPENTRACINGC_START_SPAN_WITH_OPTIONS(                 \
+    span, tracer, operation_name, options)                    \
+    do {                                                      \
+        (span) = NULL;                                        \
+        (void) sizeof(tracer);                                \
+        (void) sizeof(operation_name);                        \
+        (void) sizeof(options);                               \
+    } while (0)
+
+#define OPENTRACINGC_START_SPAN(span, tracer, operation_name) \
+    do {                                                      \
+        (span) = NULL;                                        \
+        (void) sizeof(tracer);                                \
+        (void) sizeof(operation_name);                        \
+    } while (0)
+
+#define OPENTRACINGC_START_GLOBAL_SPAN(span, operation_name) \
+    do {                                                     \
+        (span) = NULL;                                       \
+        (void) sizeof(operation_name);                       \
+    } while (0)
+
+#define OPENTRACINGC_SET_TAG(span, key, value) \
+    do {                                       \
+        (void) sizeof(span);                   \
+        (void) sizeof(key);                    \
+        (void) sizeof(value);                  \
+    } while (0)
+
+#define OPENTRACINGC_SET_TAG_VALUE_(span, key, member, tag_value) \
+    do {                                                          \
+        (void) sizeof(span);                                      \
+        (void) sizeof(key);                                       \
+        (void) sizeof(tag_value);                                 \
+    } while (0)
+
+#define OPENTRACINGC_SET_TAG_STRING_VIEW(span, key, str, len) \
+    do {                                                      \
+        (void) sizeof(span);                                  \
+        (void) sizeof(key);                                   \
+        (void) sizeof(str);                                   \
+        (void) sizeof(len);                                   \
+    } while (0)
+
+#define OPENTRACINGC_SET_TAGS(span, tags, num_tags) \
+    do {                                            \
+        (void) sizeof(span);                        \
+        (void) sizeof(tags);                        \
+        (void) sizeof(num_tags);                    \
+    } while (0)
+
+#define OPENTRACINGC_LOG_FIELDS(span, fields, num_fields) \
+    do {                                                  \
+        (void) sizeof(span);                              \
+        (void) sizeof(fields);                            \
+        (void) sizeof(num_fields);                        \
+    } while (0)
+
+#define OPENTRACINGC_LOG_RECORDS(span, records, num_records) \
+    do {                                                     \
+        (void) sizeof(span);                                 \
+        (void) sizeof(records);                              \
+        (void) sizeof(num_records);                          \
+    } while (0)
+
+#define OPENTRACINGC_FINISH_SPAN_WITH_OPTIONS(span, options) \
+    do {                                                     \
+        (void) sizeof(span);                                 \
+        (void) sizeof(options);                              \
+    } while (0)
+
+#define OPENTRACINGC_FINISH_SPAN(span) \
+    do {                               \
+        (void) sizeof(span);           \
+    } while (0)
+
+#define OPENTRACINGC_FINISH_GLOBAL_SPAN(span) \
+    do {                                      \
+        (void) sizeof(span);                  \
+    } while (0)
+
+#else
+
+/**
+ * Start a span.
+ * @param span Span pointer variable to assign the new span to.
+ * @param tracer Tracer instance. Evaluated once.
+ * @param operation_name Operation name.
+ * @param options Pointer to opentracing_start_span_options. May be NULL.
+ */
+#define OPENTRACINGC_START_SPAN_WITH_OPTIONS(                        \
+    span, tracer, operation_name, options)                           \
+    do {                                                             \
+        opentracing_tracer* opentracingc_tracer_ = (tracer);         \
+        (span) = opentracingc_tracer_->start_span_with_options(      \
+            opentracingc_tracer_, (operation_name), (options));      \
+    } while (0)
+
+/**
+ * Start a span with default options.
+ * @param span Span pointer variable to assign the new span to.
+ * @param tracer Tracer instance. Evaluated once.
+ * @param operation_name Operation name.
+ */
+#define OPENTRACINGC_START_SPAN(span, tracer, operation_name)               \
+    do {                                                                    \
+        opentracing_tracer* opentracingc_tracer_ = (tracer);                \
+        (span) = opentracingc_tracer_->start_span(opentracingc_tracer_,     \
+                                                  (operation_name));        \
+    } while (0)
+
+/**
+ * Start a span from the global tracer. The tracer is held with
+ * opentracing_global_tracer_acquire(), so a concurrent
+ * opentracing_init_global_tracer() does not destroy it under the span. The
+ * span must be finished with OPENTRACINGC_FINISH_GLOBAL_SPAN() on the same
+ * thread, which releases the tracer, even if starting it failed.
+ * @param span Span pointer variable to assign the new span to.
+ * @param operation_name Operation name.
+ */
+#define OPENTRACINGC_START_GLOBAL_SPAN(span, operation_name) \
+    OPENTRACINGC_START_SPAN(                                 \
+        span, opentracing_global_tracer_acquire(), operation_name)
+
+/**
+ * Set a tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param value Pointer to opentracing_value.
+ */
+#define OPENTRACINGC_SET_TAG(span, key, value)                                 \
+    do {                                                                       \
+        opentracing_span* opentracingc_span_ = (span);                         \
+        if (opentracingc_span_ != NULL) {                                      \
+            opentracingc_span_->set_tag(opentracingc_span_, (key), (value));   \
+        }                                                                      \
+    } while (0)
+
+/* Implementation detail of the typed OPENTRACINGC_SET_TAG_* macros. */
+#define OPENTRACINGC_SET_TAG_VALUE_(span, key, member, tag_value)              \
+    do {                                                                       \
+        opentracing_span* opentracingc_span_ = (span);                         \
+        opentracing_value opentracingc_value_;                                 \
+        if (opentracingc_span_ != NULL) {                                      \
+            opentracingc_value_.type = opentracing_value_##member;             \
+            opentracingc_value_.value.member##_value = (tag_value);            \
+            opentracingc_span_->set_tag(                                       \
+                opentracingc_span_, (key), &opentracingc_value_);              \
+        }                                                                      \
+    } while (0)
+
+/**
+ * Set a string tag from a buffer that need not be null-terminated.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param str Pointer to the first character.
+ * @param len Number of characters.
+ */
+#define OPENTRACINGC_SET_TAG_STRING_VIEW(span, key, str, len)                  \
+    do {                                                                       \
+        opentracing_span* opentracingc_span_ = (span);                         \
+        opentracing_value opentracingc_value_;                                 \
+        if (opentracingc_span_ != NULL) {                                      \
+            opentracingc_value_.type = opentracing_value_string_view;          \
+            opentracingc_value_.value.string_view_value.data = (str);          \
+            opentracingc_value_.value.string_view_value.length = (len);        \
+            opentracingc_span_->set_tag(                                       \
+                opentracingc_span_, (key), &opentracingc_value_);              \
+        }                                                                      \
+    } while (0)
+
+/**
+ * Set several tags on a span at once.
+ * @param span Span instance. May be NULL.
+ * @param tags Array of opentracing_tag.
+ * @param num_tags Number of tags in array.
+ * @see opentracing_span_set_tags()
+ */
+#define OPENTRACINGC_SET_TAGS(span, tags, num_tags)                         \
+    do {                                                                    \
+        opentracing_span* opentracingc_span_ = (span);                      \
+        if (opentracingc_span_ != NULL) {                                   \
+            opentracing_span_set_tags(                                      \
+                opentracingc_span_, (tags), (num_tags));                    \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Log fields on a span.
+ * @param span Span instance. May be NULL.
+ * @param fields Array of opentracing_log_field.
+ * @param num_fields Number of fields in array.
+ */
+#define OPENTRACINGC_LOG_FIELDS(span, fields, num_fields)                   \
+    do {                                                                    \
+        opentracing_span* opentracingc_span_ = (span);                      \
+        if (opentracingc_span_ != NULL) {                                   \
+            opentracingc_span_->log_fields(                                 \
+                opentracingc_span_, (fields), (num_fields));                \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Log several records with their own timestamps on a span.
+ * @param span Span instance. May be NULL.
+ * @param records Array of opentracing_log_record.
+ * @param num_records Number of records in array.
+ * @see opentracing_span_log_records()
+ */
+#define OPENTRACINGC_LOG_RECORDS(span, records, num_records)                \
+    do {                                                                    \
+        opentracing_span* opentracingc_span_ = (span);                      \
+        if (opentracingc_span_ != NULL) {                                   \
+            opentracing_span_log_records(                                   \
+                opentracingc_span_, (records), (num_records));              \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Finish a span with explicit options, destroy it and set the span variable
+ * to NULL.
+ * @param span Span pointer variable. May be NULL.
+ * @param options Pointer to opentracing_finish_span_options. May be NULL.
+ */
+#define OPENTRACINGC_FINISH_SPAN_WITH_OPTIONS(span, options)                \
+    do {                                                                    \
+        if ((span) != NULL) {                                               \
+            (span)->finish_with_options((span), (options));                 \
+            ((opentracing_destructible*) (span))                            \
+                ->destroy((opentracing_destructible*) (span));              \
+            (span) = NULL;                                                  \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Finish a span, destroy it and set the span variable to NULL.
+ * @param span Span pointer variable. May be NULL.
+ */
+#define OPENTRACINGC_FINISH_SPAN(span)                                      \
+    do {                                                                    \
+        if ((span) != NULL) {                                               \
+            (span)->finish(span);                                           \
+            ((opentracing_destructible*) (span))                            \
+                ->destroy((opentracing_destructible*) (span));              \
+            (span) = NULL;                                                  \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Finish a span started with OPENTRACINGC_START_GLOBAL_SPAN(), destroy it,
+ * set the span variable to NULL and release the global tracer.
+ * @param span Span pointer variable. May be NULL.
+ */
+#define OPENTRACINGC_FINISH_GLOBAL_SPAN(span)                               \
+    do {                                                                    \
+        OPENTRACINGC_FINISH_SPAN(span);                                     \
+        opentracing_global_tracer_release();                                \
+    } while (0)
+
+#endif /* OPENTRACINGC_DISABLE */
+
+/**
+ * Set a boolean tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param tag_value opentracing_bool value.
+ */
+#define OPENTRACINGC_SET_TAG_BOOL(span, key, tag_value) \
+    OPENTRACINGC_SET_TAG_VALUE_(span, key, bool, tag_value)
+
+/**
+ * Set a double tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param tag_value double value.
+ */
+#define OPENTRACINGC_SET_TAG_DOUBLE(span, key, tag_value) \
+    OPENTRACINGC_SET_TAG_VALUE_(span, key, double, tag_value)
+
+/**
+ * Set a signed integer tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param tag_value int64_t value.
+ */
+#define OPENTRACINGC_SET_TAG_INT64(span, key, tag_value) \
+    OPENTRACINGC_SET_TAG_VALUE_(span, key, int64, tag_value)
+
+/**
+ * Set an unsigned integer tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param tag_value uint64_t value.
+ */
+#define OPENTRACINGC_SET_TAG_UINT64(span, key, tag_value) \
+    OPENTRACINGC_SET_TAG_VALUE_(span, key, uint64, tag_value)
+
+/**
+ * Set a string tag on a span.
+ * @param span Span instance. May be NULL.
+ * @param key Tag key.
+ * @param tag_value Null-terminated string.
+ */
+#define OPENTRACINGC_SET_TAG_STRING(span, key, tag_value) \
+    OPENTRACINGC_SET_TAG_VALUE_(span, key, string, tag_value)
+
+#endif /* OPENTRACINGC_MACROS_H */
@@ -0,0 +1,660 @@
+#ifndef OPENTRACINGC_OPENTRACING_HPP
+#define OPENTRACINGC_OPENTRACING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif /* __cplusplus >= 201703L */
+
+#include <opentracing-c/scope_manager.h>
+#include <opentracing-c/span.h>
+#include <opentracing-c/tracer.h>
+
+/** @file */
+
+/**
+ * Header-only C++11 bindings. Span, SpanContext and Scope are move-only
+ * handles that own a span, a span context reference and an activation
+ * respectively, and undo them exactly once when they go out of scope. Every
+ * method is an inline call through the C vtables, and none allocate.
+ *
+ * Failures are reported the way the C interface reports them: handles are
+ * empty (test them with operator bool) instead of throwing, so the bindings
+ * work with exceptions disabled.
+ *
+ * @code{.cpp}
+ *     opentracingc::GlobalTracer tracer = opentracingc::Tracer::global();
+ *     opentracingc::Span span = tracer.start_span("handle_request");
+ *     span.set_tag("http.status_code", 200);
+ *     opentracingc::Scope scope(span);
+ *     // Spans started here are children of span.
+ * @endcode
+ */
+namespace opentracingc {
+
+/**
+ * Non-owning reference to a null-terminated string, which the C interface
+ * takes for names and keys. Binds to string literals, C strings and
+ * std::string without copying.
+ */
+class CStringRef {
+  public:
+    /** Refer to a C string. */
+    CStringRef(const char* str) noexcept : str_(str) {}
+
+    /** Refer to the contents of a std::string. */
+    CStringRef(const std::string& str) noexcept : str_(str.c_str()) {}
+
+    /** @return Null-terminated string. */
+    const char* c_str() const noexcept { return str_; }
+
+  private:
+    const char* str_;
+};
+
+/**
+ * Tag or log field value, implicitly converted from bool, arithmetic types,
+ * strings and nullptr. Strings are referenced, not copied, so they must
+ * outlive the call the value is passed to.
+ */
+class Value {
+  public:
+    /** Null value. */
+    Value(std::nullptr_t = nullptr) noexcept
+    {
+        value_.type = opentracing_value_null;
+        value_.value.string_value = nullptr;
+    }
+
+    /** Boolean value. */
+    Value(bool value) noexcept
+    {
+        value_.type = opentracing_value_bool;
+        value_.value.bool_value = value ? opentracing_true : opentracing_false;
+    }
+
+    /** Floating point value. */
+    Value(double value) noexcept
+    {
+        value_.type = opentracing_value_double;
+        value_.value.double_value = value;
+    }
+
+    /** Signed integer value. */
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value &&
+                                          std::is_signed<T>::value,
+                                      int>::type = 0>
+    Value(T value) noexcept
+    {
+        value_.type = opentracing_value_int64;
+        value_.value.int64_value = static_cast<int64_t>(value);
+    }
+
+    /** Unsigned integer value. */
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value &&
+                                          std::is_unsigned<T>::value &&
+                                          !std::is_same<T, bool>::value,
+                                      int>::type = 0>
+    Value(T value) noexcept
+    {
+        value_.type = opentracing_value_uint64;
+        value_.value.uint64_value = static_cast<uint64_t>(value);
+    }
+
+    /** Null-terminated string value. */
+    Value(const char* value) noexcept
+    {
+        value_.type = opentracing_value_string;
+        value_.value.string_value = value;
+    }
+
+    /** String value referring to the contents of a std::string. */
+    Value(const std::string& value) noexcept
+    {
+        value_.type = opentracing_value_string;
+        value_.value.string_value = value.c_str();
+    }
+
+    /** String value that need not be null-terminated. */
+    Value(opentracing_string_view value) noexcept
+    {
+        value_.type = opentracing_value_string_view;
+        value_.value.string_view_value = value;
+    }
+
+#if __cplusplus >= 201703L
+    /** String value that need not be null-terminated. */
+    Value(std::string_view value) noexcept
+    {
+        value_.type = opentracing_value_string_view;
+        value_.value.string_view_value.data = value.data();
+        value_.value.string_view_value.length = value.size();
+    }
+#endif /* __cplusplus >= 201703L */
+
+    /** Wrap a C value. */
+    Value(const opentracing_value& value) noexcept : value_(value) {}
+
+    /** @return C value. */
+    const opentracing_value* get() const noexcept { return &value_; }
+
+  private:
+    opentracing_value value_;
+};
+
+/**
+ * Log field with the layout of opentracing_log_field, so an array of them
+ * is passed to the tracer as is.
+ */
+struct LogField : opentracing_log_field {
+    /** Construct a field from a key and a value. */
+    LogField(CStringRef field_key, const Value& field_value) noexcept
+    {
+        key = field_key.c_str();
+        value = *field_value.get();
+    }
+};
+
+static_assert(sizeof(LogField) == sizeof(opentracing_log_field),
+              "LogField must have the layout of opentracing_log_field");
+
+/**
+ * Owning handle to a span context reference, e.g. one returned by
+ * extract() or taken with retain(). Releases it when destroyed.
+ */
+class SpanContext {
+  public:
+    /** Empty handle. */
+    SpanContext() noexcept : span_context_(nullptr) {}
+
+    /**
+     * Take ownership of a span context reference.
+     * @param span_context Span context to own. May be NULL.
+     */
+    explicit SpanContext(opentracing_span_context* span_context) noexcept
+        : span_context_(span_context)
+    {
+    }
+
+    /**
+     * Take a new reference to a borrowed span context, like the one a span
+     * returns, so it can outlive its span.
+     * @param span_context Borrowed span context. May be NULL.
+     * @return New handle, which is empty if the implementation cannot share
+     *         span contexts.
+     * @see opentracing_span_context_retain()
+     */
+    static SpanContext retain(opentracing_span_context* span_context) noexcept
+    {
+        return SpanContext((span_context != nullptr)
+                               ? opentracing_span_context_retain(span_context)
+                               : nullptr);
+    }
+
+    SpanContext(const SpanContext&) = delete;
+    SpanContext& operator=(const SpanContext&) = delete;
+
+    SpanContext(SpanContext&& other) noexcept
+        : span_context_(other.release())
+    {
+    }
+
+    SpanContext& operator=(SpanContext&& other) noexcept
+    {
+        reset(other.release());
+        return *this;
+    }
+
+    ~SpanContext() { reset(); }
+
+    /**
+     * Release the owned reference, if any, and take ownership of another.
+     * @param span_context Span context to own. May be NULL.
+     */
+    void reset(opentracing_span_context* span_context = nullptr) noexcept
+    {
+        opentracing_span_context_release(span_context_);
+        span_context_ = span_context;
+    }
+
+    /**
+     * Give up ownership without releasing the reference.
+     * @return Previously owned span context, or NULL.
+     */
+    opentracing_span_context* release() noexcept
+    {
+        opentracing_span_context* span_context = span_context_;
+        span_context_ = nullptr;
+        return span_context;
+    }
+
+    /** @return Owned span context, or NULL. */
+    opentracing_span_context* get() const noexcept { return span_context_; }
+
+    /** @return Whether the handle owns a span context. */
+    explicit operator bool() const noexcept
+    {
+        return span_context_ != nullptr;
+    }
+
+    /**
+     * Call a function for each baggage item.
+     * @param f Callable taking the key and value as const char*, returning
+     *          false to stop.
+     */
+    template <typename F>
+    void foreach_baggage_item(F f) const
+    {
+        span_context_->foreach_baggage_item(
+            span_context_, &call_baggage_item<F>, &f);
+    }
+
+  private:
+    template <typename F>
+    static opentracing_bool
+    call_baggage_item(void* arg, const char* key, const char* value)
+    {
+        return (*static_cast<F*>(arg))(key, value) ? opentracing_true
+                                                   : opentracing_false;
+    }
+
+    opentracing_span_context* span_context_;
+};
+
+/**
+ * Owning handle to a span. Finishes the span, unless finish() was already
+ * called, and destroys it when destroyed.
+ */
+class Span {
+  public:
+    /** Empty handle. */
+    Span() noexcept : span_(nullptr), finished_(false) {}
+
+    /**
+     * Take ownership of an unfinished span.
+     * @param span Span to own. May be NULL.
+     */
+    explicit Span(opentracing_span* span) noexcept
+        : span_(span), finished_(false)
+    {
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    Span(Span&& other) noexcept
+        : span_(other.span_), finished_(other.finished_)
+    {
+        other.span_ = nullptr;
+    }
+
+    Span& operator=(Span&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            span_ = other.span_;
+            finished_ = other.finished_;
+            other.span_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~Span() { reset(); }
+
+    /** Finish the span, if it is not already, and destroy it. */
+    void reset() noexcept
+    {
+        if (span_ == nullptr) {
+            return;
+        }
+        finish();
+        span_->base.destroy(&span_->base);
+        span_ = nullptr;
+    }
+
+    /**
+     * Give up ownership without finishing or destroying the span.
+     * @return Previously owned span, or NULL.
+     */
+    opentracing_span* release() noexcept
+    {
+        opentracing_span* span = span_;
+        span_ = nullptr;
+        return span;
+    }
+
+    /** @return Owned span, or NULL. */
+    opentracing_span* get() const noexcept { return span_; }
+
+    /** @return Whether the handle owns a span. */
+    explicit operator bool() const noexcept { return span_ != nullptr; }
+
+    /** Finish the span now. Later calls have no effect. */
+    void finish() noexcept
+    {
+        if (span_ != nullptr && !finished_) {
+            span_->finish(span_);
+            finished_ = true;
+        }
+    }
+
+    /**
+     * Finish the span now with explicit options. Later calls have no effect.
+     * @param options Finish options.
+     */
+    void finish(const opentracing_finish_span_options& options) noexcept
+    {
+        if (span_ != nullptr && !finished_) {
+            span_->finish_with_options(span_, &options);
+            finished_ = true;
+        }
+    }
+
+    /**
+     * Get the span context, which stays valid until the span is destroyed.
+     * set_baggage_item() may switch the span to a new context; contexts
+     * returned before keep their old baggage and remain valid. Use
+     * SpanContext::retain() to keep it for longer.
+     * @return Borrowed span context.
+     */
+    opentracing_span_context* context() const noexcept
+    {
+        return span_->span_context(span_);
+    }
+
+    /** @see opentracing_span::set_operation_name */
+    void set_operation_name(CStringRef operation_name) noexcept
+    {
+        span_->set_operation_name(span_, operation_name.c_str());
+    }
+
+    /** @see opentracing_span::set_tag */
+    void set_tag(CStringRef key, const Value& value) noexcept
+    {
+        span_->set_tag(span_, key.c_str(), value.get());
+    }
+
+    /** @see opentracing_span_set_tag_interned() */
+    void set_tag(opentracing_string_handle key, const Value& value) noexcept
+    {
+        opentracing_span_set_tag_interned(span_, key, value.get());
+    }
+
+    /** @see opentracing_span::log_fields */
+    void log(std::initializer_list<LogField> fields) noexcept
+    {
+        span_->log_fields(
+            span_, fields.begin(), static_cast<int>(fields.size()));
+    }
+
+    /** @see opentracing_span::set_baggage_item */
+    void set_baggage_item(CStringRef key, CStringRef value) noexcept
+    {
+        span_->set_baggage_item(span_, key.c_str(), value.c_str());
+    }
+
+    /** @see opentracing_span::baggage_item */
+    const char* baggage_item(CStringRef key) const noexcept
+    {
+        return span_->baggage_item(span_, key.c_str());
+    }
+
+  private:
+    opentracing_span* span_;
+    bool finished_;
+};
+
+/**
+ * Make a child_of reference.
+ * @param span_context Referenced span context.
+ */
+inline opentracing_span_reference
+child_of(opentracing_span_context* span_context) noexcept
+{
+    opentracing_span_reference reference;
+    reference.type = opentracing_span_reference_child_of;
+    reference.referenced_context = span_context;
+    return reference;
+}
+
+/** Make a child_of reference to a span. */
+inline opentracing_span_reference child_of(const Span& span) noexcept
+{
+    return child_of(span.context());
+}
+
+/** Make a child_of reference to a span context. */
+inline opentracing_span_reference
+child_of(const SpanContext& span_context) noexcept
+{
+    return child_of(span_context.get());
+}
+
+/**
+ * Make a follows_from reference.
+ * @param span_context Referenced span context.
+ */
+inline opentracing_span_reference
+follows_from(opentracing_span_context* span_context) noexcept
+{
+    opentracing_span_reference reference;
+    reference.type = opentracing_span_reference_follows_from;
+    reference.referenced_context = span_context;
+    return reference;
+}
+
+/** Make a follows_from reference to a span. */
+inline opentracing_span_reference follows_from(const Span& span) noexcept
+{
+    return follows_from(span.context());
+}
+
+/** Make a follows_from reference to a span context. */
+inline opentracing_span_reference
+follows_from(const SpanContext& span_context) noexcept
+{
+    return follows_from(span_context.get());
+}
+
+class GlobalTracer;
+
+/**
+ * Non-owning handle to a tracer. Tracers are shared and usually outlive
+ * the code tracing with them, so the handle is freely copyable.
+ */
+class Tracer {
+  public:
+    /**
+     * Refer to a tracer.
+     * @param tracer Tracer instance.
+     */
+    explicit Tracer(opentracing_tracer* tracer) noexcept : tracer_(tracer) {}
+
+    /* Copying would drop the hold on the global tracer. */
+    Tracer(const GlobalTracer&) = delete;
+    Tracer(GlobalTracer&&) = delete;
+
+    /**
+     * Hold the global tracer for the lifetime of the returned handle.
+     * @see GlobalTracer
+     */
+    static GlobalTracer global() noexcept;
+
+    /** @return Tracer instance. */
+    opentracing_tracer* get() const noexcept { return tracer_; }
+
+    /**
+     * Start a span.
+     * @param operation_name Name of operation associated with span.
+     * @return Span, which is empty on failure.
+     */
+    Span start_span(CStringRef operation_name) const noexcept
+    {
+        return Span(tracer_->start_span(tracer_, operation_name.c_str()));
+    }
+
+    /**
+     * Start a span with references to other spans.
+     * @param operation_name Name of operation associated with span.
+     * @param references References, e.g. from child_of().
+     * @return Span, which is empty on failure.
+     */
+    Span start_span(
+        CStringRef operation_name,
+        std::initializer_list<opentracing_span_reference> references) const
+        noexcept
+    {
+        opentracing_start_span_options options =
+            opentracing_start_span_options();
+        options.references = references.begin();
+        options.num_references = static_cast<int>(references.size());
+        return start_span(operation_name, options);
+    }
+
+    /**
+     * Start a span with options.
+     * @param operation_name Name of operation associated with span.
+     * @param options Options to override default span initialization values.
+     * @return Span, which is empty on failure.
+     */
+    Span start_span(CStringRef operation_name,
+                    const opentracing_start_span_options& options) const
+        noexcept
+    {
+        return Span(tracer_->start_span_with_options(
+            tracer_, operation_name.c_str(), &options));
+    }
+
+    /**
+     * Start a span with an interned operation name.
+     * @param operation_name Handle of operation name.
+     * @param options Options to override default span initialization
+     *                values. May be NULL.
+     * @return Span, which is empty on failure.
+     * @see opentracing_tracer_start_span_interned()
+     */
+    Span start_span(opentracing_string_handle operation_name,
+                    const opentracing_start_span_options* options =
+                        nullptr) const noexcept
+    {
+        return Span(opentracing_tracer_start_span_interned(
+            tracer_, operation_name, options));
+    }
+
+  private:
+    opentracing_tracer* tracer_;
+};
+
+/**
+ * Global tracer held with opentracing_global_tracer_acquire() and released
+ * when the handle is destroyed, so a concurrent
+ * opentracing_init_global_tracer() does not destroy it while in use. Spans
+ * started from it must be destroyed first, which declaring them after the
+ * handle ensures. Move-only, and must be destroyed on the thread that
+ * created it.
+ */
+class GlobalTracer : public Tracer {
+  public:
+    /** Hold the current global tracer. */
+    GlobalTracer() noexcept
+        : Tracer(opentracing_global_tracer_acquire()), held_(true)
+    {
+    }
+
+    GlobalTracer(const GlobalTracer&) = delete;
+    GlobalTracer& operator=(const GlobalTracer&) = delete;
+    GlobalTracer& operator=(GlobalTracer&&) = delete;
+
+    GlobalTracer(GlobalTracer&& other) noexcept
+        : Tracer(other.get()), held_(other.held_)
+    {
+        other.held_ = false;
+    }
+
+    ~GlobalTracer()
+    {
+        if (held_) {
+            opentracing_global_tracer_release();
+        }
+    }
+
+  private:
+    bool held_;
+};
+
+inline GlobalTracer Tracer::global() noexcept { return GlobalTracer(); }
+
+/**
+ * Activation of a span or span context on the calling thread (see
+ * scope_manager.h), undone when the scope is destroyed. Scopes must be
+ * destroyed in reverse order of creation on the thread that created them.
+ */
+class Scope {
+  public:
+    /**
+     * Activate a span. The span must outlive the scope.
+     * @param span Span to activate. May be empty to hide the active span.
+     */
+    explicit Scope(const Span& span) noexcept
+        : span_(span.get()),
+          span_context_(nullptr),
+          active_(opentracing_activate_span(span_) != opentracing_false)
+    {
+    }
+
+    /**
+     * Activate a span context. The span context must outlive the scope.
+     * @param span_context Span context to activate. May be empty to hide the
+     *                     active span.
+     */
+    explicit Scope(const SpanContext& span_context) noexcept
+        : span_(nullptr),
+          span_context_(span_context.get()),
+          active_(opentracing_activate_span_context(span_context_) !=
+                  opentracing_false)
+    {
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+    Scope(Scope&& other) noexcept
+        : span_(other.span_),
+          span_context_(other.span_context_),
+          active_(other.active_)
+    {
+        other.active_ = false;
+    }
+
+    ~Scope()
+    {
+        if (!active_) {
+            return;
+        }
+        if (span_context_ != nullptr) {
+            opentracing_deactivate_span_context(span_context_);
+        }
+        else {
+            opentracing_deactivate_span(span_);
+        }
+    }
+
+    /** @return Whether the activation succeeded. */
+    explicit operator bool() const noexcept { return active_; }
+
+  private:
+    opentracing_span* span_;
+    opentracing_span_context* span_context_;
+    bool active_;
+};
+
+} /* namespace opentracingc */
+
+#endif /* OPENTRACINGC_OPENTRACING_HPP */
@@ -0,0 +1,56 @@
+#include <opentracing-c/propagation.h>
+
+#include <assert.h>
+#include <strings.h>
+
+typedef struct get_arg {
+    const char* key;
+    const char* value;
+} get_arg;
+
+static opentracing_propagation_error_code
+get_handler(void* arg, const char* key, const char* value)
+{
+    get_arg* get;
+
+    get = (get_arg*) arg;
+    if (get->value == NULL && strcasecmp(key, get->key) == 0) {
+        get->value = value;
+    }
+    return opentracing_propagation_error_code_success;
+}
+
+opentracing_propagation_error_code
+opentracing_text_map_reader_get(opentracing_text_map_reader* reader,
+                                const char* key,
+                                const char** value)
+{
+    opentracing_propagation_error_code return_code;
+    get_arg arg;
+
+    assert(reader != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+    *value = NULL;
+    if (OPENTRACINGC_TEXT_MAP_READER_HAS(reader, get)) {
+        return_code = reader->get(reader, key, value);
+        if (return_code != opentracing_propagation_error_code_success) {
+            *value = NULL;
+        }
+        return return_code;
+    }
+
+    /* Relies on the documented requirement that foreach_key values outlive
+     * the handler call. */
+    arg.key = key;
+    arg.value = NULL;
+    return_code = reader->foreach_key(reader, &get_handler, &arg);
+    if (return_code != opentracing_propagation_error_code_success) {
+        return return_code;
+    }
+    if (arg.value == NULL) {
+        return opentracing_propagation_error_code_span_context_not_found;
+    }
+    *value = arg.value;
+    return opentracing_propagation_error_code_success;
+}
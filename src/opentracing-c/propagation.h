@@ -5,6 +5,8 @@
 
 #include <opentracing-c/common.h>
 #include <opentracing-c/span.h>
+#include <opentracing-c/visibility.h>
+#include <opentracing-c/vtable.h>
 
 /** @file */
 
@@ -96,6 +98,12 @@ typedef struct opentracing_text_map_reader {
     /** Base class member. */
     opentracing_destructible base;
 
+    /**
+     * Layout of this reader. Readers that leave the header zeroed are treated
+     * as providing only foreach_key.
+     */
+    opentracing_vtable_header header;
+
     /**
      * Returns text map contents via repeated calls to the handler function.
      * If any call to handler returns a non-nil error, immediately returns that
@@ -115,8 +123,51 @@ typedef struct opentracing_text_map_reader {
                                                       const char* key,
                                                       const char* value),
         void* arg) OPENTRACINGC_NONNULL(1, 2);
+
+    /**
+     * Look up a single key without enumerating the carrier. Keys are matched
+     * without regard to ASCII case, as HTTP header names are. If the carrier
+     * holds the key more than once, any one of its values may be returned.
+     * @attention Optional slot added in vtable version 6. Call through
+     *            opentracing_text_map_reader_get() unless the slot is known
+     *            to exist.
+     * @param reader Reader instance.
+     * @param key Key to look up.
+     * @param[out] value Set to the value, which must stay valid until the
+     *                   reader is next called or destroyed.
+     * @return opentracing_propagation_error_code_span_context_not_found if
+     *         the key is absent, success if it was found, or any other error
+     *         code if the lookup failed.
+     */
+    opentracing_propagation_error_code (*get)(
+        struct opentracing_text_map_reader* reader,
+        const char* key,
+        const char** value) OPENTRACINGC_NONNULL_ALL;
 } opentracing_text_map_reader;
 
+/**
+ * Check whether a text map reader provides a slot.
+ * @see OPENTRACINGC_VTABLE_HAS
+ */
+#define OPENTRACINGC_TEXT_MAP_READER_HAS(reader, slot) \
+    OPENTRACINGC_VTABLE_HAS(opentracing_text_map_reader, reader, slot)
+
+/**
+ * Call get() if the reader provides it, otherwise scan the carrier with
+ * foreach_key() for the first entry matching key. The fallback returns the
+ * value pointer passed to the handler, so readers whose values do not stay
+ * valid after each handler call must provide get() for callers of this
+ * function.
+ * @param reader Reader instance.
+ * @param key Key to look up, matched without regard to ASCII case.
+ * @param[out] value Set to the value, or NULL if the key is absent.
+ * @return Error code indicating success or failure, as for get().
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_text_map_reader_get(opentracing_text_map_reader* reader,
+                                const char* key,
+                                const char** value) OPENTRACINGC_NONNULL_ALL;
+
 /**
  * HTTP headers writer.
  * @extends opentracing_text_map_writer
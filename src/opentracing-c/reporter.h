@@ -0,0 +1,46 @@
+#ifndef OPENTRACINGC_REPORTER_H
+#define OPENTRACINGC_REPORTER_H
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/destructible.h>
+#include <opentracing-c/span_data.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Reporter interface. Receives finished spans from a tracer and exports them
+ * to wherever they need to go.
+ * @extends opentracing_destructible
+ */
+typedef struct opentracing_reporter {
+    /** Base class member. */
+    opentracing_destructible base;
+
+    /**
+     * Report a batch of finished spans. Span data must be copied if it is
+     * needed after report returns.
+     * @param reporter Reporter instance.
+     * @param spans Array of finished spans.
+     * @param num_spans Number of spans in array.
+     */
+    void (*report)(struct opentracing_reporter* reporter,
+                   const opentracing_span_data* const* spans,
+                   int num_spans) OPENTRACINGC_NONNULL_ALL;
+
+    /**
+     * Export any buffered spans. Called when the owning tracer is closed.
+     * @param reporter Reporter instance.
+     */
+    void (*flush)(struct opentracing_reporter* reporter)
+        OPENTRACINGC_NONNULL_ALL;
+} opentracing_reporter;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_REPORTER_H */
@@ -0,0 +1,438 @@
+#include <opentracing-c/sampler.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/internal/atomic.h>
+#include <opentracing-c/internal/hash.h>
+
+#define NS_PER_SEC 1000000000.0
+
+/* 2^64 as a double. */
+#define TWO_POW_64 18446744073709551616.0
+
+#define DEFAULT_MAX_OPERATIONS 256
+#define DEFAULT_ADJUST_INTERVAL_MS 1000
+
+static void sampler_destroy(opentracing_destructible* destructible)
+{
+    free(destructible);
+}
+
+/*
+ * Trace IDs with a low half below the threshold are sampled. The maximum
+ * threshold samples everything.
+ */
+static uint64_t rate_to_threshold(double rate)
+{
+    double threshold;
+
+    if (!(rate > 0.0)) {
+        return 0;
+    }
+    threshold = rate * TWO_POW_64;
+    return (threshold < TWO_POW_64) ? (uint64_t) threshold : UINT64_MAX;
+}
+
+static opentracing_bool is_below_threshold(const opentracing_trace_id* trace_id,
+                                           uint64_t threshold)
+{
+    return (trace_id->low < threshold || threshold == UINT64_MAX)
+               ? opentracing_true
+               : opentracing_false;
+}
+
+static int64_t steady_ns(void)
+{
+    opentracing_duration now;
+    opentracing_now_steady(&now);
+    return (int64_t) now.value.tv_sec * INT64_C(1000000000) +
+           now.value.tv_nsec;
+}
+
+/* Const sampler. */
+
+typedef struct const_sampler {
+    opentracing_sampler base;
+    opentracing_bool decision;
+} const_sampler;
+
+static opentracing_bool
+const_sampler_is_sampled(opentracing_sampler* sampler,
+                         const opentracing_trace_id* trace_id,
+                         const char* operation_name)
+{
+    (void) trace_id;
+    (void) operation_name;
+    return ((const const_sampler*) sampler)->decision;
+}
+
+opentracing_sampler* opentracing_make_const_sampler(opentracing_bool decision)
+{
+    const_sampler* sampler;
+
+    sampler = (const_sampler*) malloc(sizeof(const_sampler));
+    if (sampler == NULL) {
+        return NULL;
+    }
+    ((opentracing_destructible*) sampler)->destroy = &sampler_destroy;
+    ((opentracing_sampler*) sampler)->is_sampled = &const_sampler_is_sampled;
+    sampler->decision = decision ? opentracing_true : opentracing_false;
+    return (opentracing_sampler*) sampler;
+}
+
+/* Probabilistic sampler. */
+
+typedef struct probabilistic_sampler {
+    opentracing_sampler base;
+    uint64_t threshold;
+} probabilistic_sampler;
+
+static opentracing_bool
+probabilistic_sampler_is_sampled(opentracing_sampler* sampler,
+                                 const opentracing_trace_id* trace_id,
+                                 const char* operation_name)
+{
+    (void) operation_name;
+    return is_below_threshold(
+        trace_id, ((const probabilistic_sampler*) sampler)->threshold);
+}
+
+opentracing_sampler* opentracing_make_probabilistic_sampler(double rate)
+{
+    probabilistic_sampler* sampler;
+
+    sampler = (probabilistic_sampler*) malloc(sizeof(probabilistic_sampler));
+    if (sampler == NULL) {
+        return NULL;
+    }
+    ((opentracing_destructible*) sampler)->destroy = &sampler_destroy;
+    ((opentracing_sampler*) sampler)->is_sampled =
+        &probabilistic_sampler_is_sampled;
+    sampler->threshold = rate_to_threshold(rate);
+    return (opentracing_sampler*) sampler;
+}
+
+/* Rate limiting sampler. */
+
+/*
+ * Token bucket in its generic cell rate algorithm form: rather than a token
+ * count and refill time, track the time at which the bucket would next be
+ * full. Each sample pushes that time forward by one interval, and samples
+ * that would push it more than the burst allowance ahead of now are
+ * rejected. One word of state means one CAS per decision.
+ */
+typedef struct rate_limiting_sampler {
+    opentracing_sampler base;
+    int64_t interval_ns;
+    int64_t burst_ns;
+    int64_t full_at_ns;
+} rate_limiting_sampler;
+
+static opentracing_bool
+rate_limiting_sampler_is_sampled(opentracing_sampler* sampler,
+                                 const opentracing_trace_id* trace_id,
+                                 const char* operation_name)
+{
+    rate_limiting_sampler* s;
+    int64_t now;
+    int64_t full_at;
+    int64_t next_full_at;
+
+    (void) trace_id;
+    (void) operation_name;
+    s = (rate_limiting_sampler*) sampler;
+    now = steady_ns();
+    full_at = OPENTRACINGC_ATOMIC_LOAD(&s->full_at_ns,
+                                       OPENTRACINGC_ATOMIC_RELAXED);
+    do {
+        next_full_at = ((full_at > now) ? full_at : now) + s->interval_ns;
+        if (next_full_at - now > s->burst_ns) {
+            return opentracing_false;
+        }
+    } while (!OPENTRACINGC_ATOMIC_CAS_WEAK(&s->full_at_ns,
+                                           &full_at,
+                                           next_full_at,
+                                           OPENTRACINGC_ATOMIC_RELAXED,
+                                           OPENTRACINGC_ATOMIC_RELAXED));
+    return opentracing_true;
+}
+
+opentracing_sampler*
+opentracing_make_rate_limiting_sampler(double max_traces_per_second)
+{
+    rate_limiting_sampler* sampler;
+    double interval_ns;
+
+    if (!(max_traces_per_second > 0.0)) {
+        return NULL;
+    }
+    sampler = (rate_limiting_sampler*) malloc(sizeof(rate_limiting_sampler));
+    if (sampler == NULL) {
+        return NULL;
+    }
+    ((opentracing_destructible*) sampler)->destroy = &sampler_destroy;
+    ((opentracing_sampler*) sampler)->is_sampled =
+        &rate_limiting_sampler_is_sampled;
+    interval_ns = NS_PER_SEC / max_traces_per_second;
+    sampler->interval_ns = (interval_ns >= 1.0) ? (int64_t) interval_ns : 1;
+    /* A full bucket holds one second of samples, and at least one. */
+    sampler->burst_ns =
+        (max_traces_per_second > 1.0)
+            ? (int64_t)(interval_ns * max_traces_per_second)
+            : sampler->interval_ns;
+    sampler->full_at_ns = 0;
+    return (opentracing_sampler*) sampler;
+}
+
+/* Adaptive sampler. */
+
+/*
+ * Per-operation state. Operations are published fully initialized and live
+ * as long as the sampler. The counters cover the current adjustment window.
+ */
+typedef struct operation {
+    uint32_t hash;
+    const char* name;
+    uint64_t threshold;
+    int64_t window_start_ns;
+    uint64_t num_seen;
+    uint64_t num_sampled;
+} operation;
+
+/*
+ * Operations live in an open-addressed table of at least twice the maximum
+ * number of operations. Slots are claimed by compare-and-swap and never
+ * cleared, so lookups need no locks.
+ */
+typedef struct adaptive_sampler {
+    opentracing_sampler base;
+    double target_per_second;
+    uint64_t default_threshold;
+    int64_t interval_ns;
+    /* Samples allowed per window before adjusting early. */
+    uint64_t window_budget;
+    int max_operations;
+    int num_operations;
+    uint32_t mask;
+    operation** operations;
+} adaptive_sampler;
+
+static operation* operation_new(const char* name, uint32_t hash)
+{
+    operation* op;
+    size_t len;
+
+    len = strlen(name);
+    op = (operation*) malloc(sizeof(operation) + len + 1);
+    if (op == NULL) {
+        return NULL;
+    }
+    memcpy((char*) (op + 1), name, len + 1);
+    op->hash = hash;
+    op->name = (const char*) (op + 1);
+    /* New operations are sampled until their first adjustment. */
+    op->threshold = UINT64_MAX;
+    op->window_start_ns = steady_ns();
+    op->num_seen = 0;
+    op->num_sampled = 0;
+    return op;
+}
+
+/* Returns NULL once the operation limit is reached. */
+static operation*
+reserve_operation(adaptive_sampler* s, const char* name, uint32_t hash)
+{
+    operation* op;
+
+    if (OPENTRACINGC_ATOMIC_FETCH_ADD(
+            &s->num_operations, 1, OPENTRACINGC_ATOMIC_RELAXED) >=
+        s->max_operations) {
+        OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &s->num_operations, 1, OPENTRACINGC_ATOMIC_RELAXED);
+        return NULL;
+    }
+    op = operation_new(name, hash);
+    if (op == NULL) {
+        OPENTRACINGC_ATOMIC_FETCH_SUB(
+            &s->num_operations, 1, OPENTRACINGC_ATOMIC_RELAXED);
+    }
+    return op;
+}
+
+/* Release an operation that was never published. */
+static void unreserve_operation(adaptive_sampler* s, operation* op)
+{
+    if (op == NULL) {
+        return;
+    }
+    free(op);
+    OPENTRACINGC_ATOMIC_FETCH_SUB(
+        &s->num_operations, 1, OPENTRACINGC_ATOMIC_RELAXED);
+}
+
+/* Returns NULL for new operations once the limit is reached. */
+static operation* find_operation(adaptive_sampler* s, const char* name)
+{
+    operation* op;
+    operation* new_op;
+    uint32_t hash;
+    uint32_t i;
+    uint32_t probe;
+
+    hash = opentracing_hash_fnv1a(name, strlen(name));
+    new_op = NULL;
+    i = hash & s->mask;
+    for (probe = 0; probe <= s->mask; probe++, i = (i + 1) & s->mask) {
+        op = OPENTRACINGC_ATOMIC_LOAD(&s->operations[i],
+                                      OPENTRACINGC_ATOMIC_ACQUIRE);
+        if (op == NULL) {
+            if (new_op == NULL) {
+                new_op = reserve_operation(s, name, hash);
+                if (new_op == NULL) {
+                    return NULL;
+                }
+            }
+            if (OPENTRACINGC_ATOMIC_CAS_STRONG(&s->operations[i],
+                                               &op,
+                                               new_op,
+                                               OPENTRACINGC_ATOMIC_RELEASE,
+                                               OPENTRACINGC_ATOMIC_ACQUIRE)) {
+                return new_op;
+            }
+            /* Lost the slot. Check whether the winner added this name. */
+        }
+        if (op->hash == hash && strcmp(op->name, name) == 0) {
+            unreserve_operation(s, new_op);
+            return op;
+        }
+    }
+    /* Unreachable while the table is larger than the operation limit. */
+    unreserve_operation(s, new_op);
+    return NULL;
+}
+
+/*
+ * Set the probability that would have sampled the target rate over the
+ * window that just ended. Windows end after the adjustment interval, or
+ * early once they have used up their sample budget.
+ */
+static void adjust_operation(adaptive_sampler* s, operation* op, int64_t now)
+{
+    int64_t start;
+    uint64_t num_seen;
+
+    start = OPENTRACINGC_ATOMIC_LOAD(&op->window_start_ns,
+                                     OPENTRACINGC_ATOMIC_RELAXED);
+    if (now - start < s->interval_ns &&
+        OPENTRACINGC_ATOMIC_LOAD(&op->num_sampled,
+                                 OPENTRACINGC_ATOMIC_RELAXED) <
+            s->window_budget) {
+        return;
+    }
+    /* One thread ends each window. */
+    if (!OPENTRACINGC_ATOMIC_CAS_STRONG(&op->window_start_ns,
+                                        &start,
+                                        now,
+                                        OPENTRACINGC_ATOMIC_RELAXED,
+                                        OPENTRACINGC_ATOMIC_RELAXED)) {
+        return;
+    }
+    num_seen = OPENTRACINGC_ATOMIC_EXCHANGE(
+        &op->num_seen, UINT64_C(0), OPENTRACINGC_ATOMIC_RELAXED);
+    OPENTRACINGC_ATOMIC_STORE(
+        &op->num_sampled, UINT64_C(0), OPENTRACINGC_ATOMIC_RELAXED);
+    if (num_seen == 0) {
+        return;
+    }
+    OPENTRACINGC_ATOMIC_STORE(
+        &op->threshold,
+        rate_to_threshold(s->target_per_second * (double) (now - start) /
+                          NS_PER_SEC / (double) num_seen),
+        OPENTRACINGC_ATOMIC_RELAXED);
+}
+
+static opentracing_bool
+adaptive_sampler_is_sampled(opentracing_sampler* sampler,
+                            const opentracing_trace_id* trace_id,
+                            const char* operation_name)
+{
+    adaptive_sampler* s;
+    operation* op;
+    opentracing_bool sampled;
+
+    s = (adaptive_sampler*) sampler;
+    op = find_operation(s, operation_name);
+    if (op == NULL) {
+        return is_below_threshold(trace_id, s->default_threshold);
+    }
+    OPENTRACINGC_ATOMIC_FETCH_ADD(
+        &op->num_seen, UINT64_C(1), OPENTRACINGC_ATOMIC_RELAXED);
+    sampled = is_below_threshold(
+        trace_id,
+        OPENTRACINGC_ATOMIC_LOAD(&op->threshold, OPENTRACINGC_ATOMIC_RELAXED));
+    if (sampled) {
+        OPENTRACINGC_ATOMIC_FETCH_ADD(
+            &op->num_sampled, UINT64_C(1), OPENTRACINGC_ATOMIC_RELAXED);
+    }
+    adjust_operation(s, op, steady_ns());
+    return sampled;
+}
+
+static void adaptive_sampler_destroy(opentracing_destructible* destructible)
+{
+    adaptive_sampler* s;
+    uint32_t i;
+
+    s = (adaptive_sampler*) destructible;
+    for (i = 0; i <= s->mask; i++) {
+        free(s->operations[i]);
+    }
+    free(s->operations);
+    free(s);
+}
+
+opentracing_sampler* opentracing_make_adaptive_sampler(
+    const opentracing_adaptive_sampler_options* options)
+{
+    adaptive_sampler* sampler;
+    uint32_t num_slots;
+    double budget;
+
+    assert(options != NULL);
+    if (!(options->target_per_second > 0.0)) {
+        return NULL;
+    }
+    sampler = (adaptive_sampler*) calloc(1, sizeof(adaptive_sampler));
+    if (sampler == NULL) {
+        return NULL;
+    }
+    ((opentracing_destructible*) sampler)->destroy = &adaptive_sampler_destroy;
+    ((opentracing_sampler*) sampler)->is_sampled = &adaptive_sampler_is_sampled;
+    sampler->target_per_second = options->target_per_second;
+    sampler->default_threshold = rate_to_threshold(options->default_rate);
+    sampler->interval_ns =
+        (int64_t)((options->adjust_interval_ms > 0)
+                      ? options->adjust_interval_ms
+                      : DEFAULT_ADJUST_INTERVAL_MS) *
+        INT64_C(1000000);
+    budget = options->target_per_second * (double) sampler->interval_ns /
+             NS_PER_SEC;
+    sampler->window_budget = (budget > 1.0) ? (uint64_t) budget : 1;
+    sampler->max_operations = (options->max_operations > 0)
+                                  ? options->max_operations
+                                  : DEFAULT_MAX_OPERATIONS;
+    num_slots = 1;
+    while (num_slots < (uint32_t) sampler->max_operations * 2) {
+        num_slots *= 2;
+    }
+    sampler->mask = num_slots - 1;
+    sampler->operations = (operation**) calloc(num_slots, sizeof(operation*));
+    if (sampler->operations == NULL) {
+        free(sampler);
+        return NULL;
+    }
+    return (opentracing_sampler*) sampler;
+}
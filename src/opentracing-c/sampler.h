@@ -0,0 +1,128 @@
+#ifndef OPENTRACINGC_SAMPLER_H
+#define OPENTRACINGC_SAMPLER_H
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/destructible.h>
+#include <opentracing-c/span_data.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Sampler interface. Decides whether a new trace is recorded when its root
+ * span starts. Spans with a parent inherit the parent's decision, so
+ * samplers are only consulted for root spans.
+ * @extends opentracing_destructible
+ */
+typedef struct opentracing_sampler {
+    /** Base class member. */
+    opentracing_destructible base;
+
+    /**
+     * Decide whether to sample a new trace. Called concurrently from every
+     * thread that starts root spans, before the tracer allocates anything
+     * for the span.
+     * @param sampler Sampler instance.
+     * @param trace_id Trace ID of the new trace.
+     * @param operation_name Operation name of the root span.
+     * @return opentracing_true to record the trace, opentracing_false
+     *         otherwise.
+     */
+    opentracing_bool (*is_sampled)(struct opentracing_sampler* sampler,
+                                   const opentracing_trace_id* trace_id,
+                                   const char* operation_name)
+        OPENTRACINGC_NONNULL_ALL;
+} opentracing_sampler;
+
+/**
+ * Create a sampler that always makes the same decision.
+ * @param decision Decision to return.
+ * @return New sampler on success, NULL if out of memory. Destroy using the
+ *         opentracing_destructible interface.
+ */
+OPENTRACINGC_EXPORT opentracing_sampler*
+opentracing_make_const_sampler(opentracing_bool decision);
+
+/**
+ * Create a sampler that samples a fixed fraction of traces. The decision is
+ * derived from the low half of the trace ID, so every tracer using the same
+ * rate agrees on it.
+ * @param rate Fraction of traces to sample, from 0 to 1. Values outside the
+ *             range are clamped.
+ * @return New sampler on success, NULL if out of memory. Destroy using the
+ *         opentracing_destructible interface.
+ */
+OPENTRACINGC_EXPORT opentracing_sampler*
+opentracing_make_probabilistic_sampler(double rate);
+
+/**
+ * Create a sampler that samples at most a fixed number of traces per second,
+ * allowing bursts of up to one second's worth after idle periods. The
+ * limiter is a single atomic word updated with compare-and-swap, so
+ * threads never block each other.
+ * @param max_traces_per_second Sampling rate limit. Must be positive.
+ * @return New sampler on success, NULL if out of memory or the limit is not
+ *         positive. Destroy using the opentracing_destructible interface.
+ */
+OPENTRACINGC_EXPORT opentracing_sampler*
+opentracing_make_rate_limiting_sampler(double max_traces_per_second);
+
+/** Options used when calling opentracing_make_adaptive_sampler(). */
+typedef struct opentracing_adaptive_sampler_options {
+    /**
+     * Target number of traces sampled per second for each operation. Must
+     * be positive.
+     */
+    double target_per_second;
+
+    /**
+     * Maximum number of operations with their own sampling rate. Zero
+     * selects the default of 256.
+     */
+    int max_operations;
+
+    /**
+     * Fraction of traces sampled for operations beyond max_operations, from
+     * 0 to 1.
+     */
+    double default_rate;
+
+    /**
+     * Interval in milliseconds between sampling rate adjustments. Zero
+     * selects the default of 1000.
+     */
+    int adjust_interval_ms;
+} opentracing_adaptive_sampler_options;
+
+/**
+ * Create a sampler that keeps a separate sampling rate for each operation
+ * name and adjusts it to sample the target number of traces per second.
+ * New operations are sampled fully until their first adjustment. Rates are
+ * adjusted once per interval, or sooner when an operation exceeds its share
+ * of samples for the interval, so busy operations are brought down quickly
+ * and rare ones keep being sampled. Decisions use the operation name given
+ * when the root span starts. Renaming the span later does not change its
+ * decision or the operation it is counted against.
+ *
+ * Per-operation state is kept in a fixed-size table updated with
+ * compare-and-swap, so threads never block each other. Operations are never
+ * evicted.
+ * @param options Sampler options.
+ * @return New sampler on success, NULL if out of memory or the target is
+ *         not positive. Destroy using the opentracing_destructible
+ *         interface.
+ */
+OPENTRACINGC_EXPORT opentracing_sampler* opentracing_make_adaptive_sampler(
+    const opentracing_adaptive_sampler_options* options)
+    OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_SAMPLER_H */
@@ -0,0 +1,240 @@
+#include <opentracing-c/scope_manager.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INLINE_DEPTH 16
+
+/* Either a span or, for activated span contexts, only a span context. */
+typedef struct scope_entry {
+    opentracing_span* span;
+    opentracing_span_context* span_context;
+} scope_entry;
+
+/*
+ * Entries beyond the inline ones go to an overflow array, which is freed
+ * when the thread exits.
+ */
+typedef struct scope_stack {
+    scope_entry active;
+    int depth;
+    int overflow_capacity;
+    scope_entry* overflow;
+    scope_entry inline_entries[INLINE_DEPTH];
+} scope_stack;
+
+static pthread_once_t scope_once = PTHREAD_ONCE_INIT;
+static pthread_key_t scope_key;
+
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+
+/* The stack itself lives in thread-local storage; the key owns overflow. */
+static OPENTRACINGC_THREAD_LOCAL scope_stack current_stack;
+
+static void scope_thread_detach(void* arg)
+{
+    free(arg);
+    current_stack.overflow = NULL;
+    current_stack.overflow_capacity = 0;
+}
+
+static void scope_init(void)
+{
+    pthread_key_create(&scope_key, &scope_thread_detach);
+}
+
+static scope_stack* scope_stack_get(void)
+{
+    return &current_stack;
+}
+
+static opentracing_bool scope_stack_set_overflow(scope_stack* stack,
+                                                 scope_entry* overflow)
+{
+    pthread_once(&scope_once, &scope_init);
+    if (pthread_setspecific(scope_key, overflow) != 0) {
+        return opentracing_false;
+    }
+    stack->overflow = overflow;
+    return opentracing_true;
+}
+
+#else
+
+/* Without thread-local storage, the key owns the whole stack. */
+
+static void scope_thread_detach(void* arg)
+{
+    scope_stack* stack;
+
+    stack = (scope_stack*) arg;
+    free(stack->overflow);
+    free(stack);
+}
+
+static void scope_init(void)
+{
+    pthread_key_create(&scope_key, &scope_thread_detach);
+}
+
+static scope_stack* scope_stack_get(void)
+{
+    scope_stack* stack;
+
+    pthread_once(&scope_once, &scope_init);
+    stack = (scope_stack*) pthread_getspecific(scope_key);
+    if (stack != NULL) {
+        return stack;
+    }
+    stack = (scope_stack*) calloc(1, sizeof(scope_stack));
+    if (stack == NULL) {
+        return NULL;
+    }
+    if (pthread_setspecific(scope_key, stack) != 0) {
+        free(stack);
+        return NULL;
+    }
+    return stack;
+}
+
+static opentracing_bool scope_stack_set_overflow(scope_stack* stack,
+                                                 scope_entry* overflow)
+{
+    stack->overflow = overflow;
+    return opentracing_true;
+}
+
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+
+static scope_entry* scope_stack_entry(scope_stack* stack, int index)
+{
+    return (index < INLINE_DEPTH) ? &stack->inline_entries[index]
+                                  : &stack->overflow[index - INLINE_DEPTH];
+}
+
+static opentracing_bool scope_stack_reserve(scope_stack* stack)
+{
+    scope_entry* overflow;
+    scope_entry* old_overflow;
+    int capacity;
+
+    if (stack->depth < INLINE_DEPTH + stack->overflow_capacity) {
+        return opentracing_true;
+    }
+    capacity = (stack->overflow_capacity > 0) ? stack->overflow_capacity * 2
+                                              : INLINE_DEPTH;
+    overflow =
+        (scope_entry*) malloc(sizeof(scope_entry) * (size_t) capacity);
+    if (overflow == NULL) {
+        return opentracing_false;
+    }
+    if (stack->overflow_capacity > 0) {
+        memcpy(overflow,
+               stack->overflow,
+               sizeof(scope_entry) * (size_t) stack->overflow_capacity);
+    }
+    old_overflow = stack->overflow;
+    if (!scope_stack_set_overflow(stack, overflow)) {
+        free(overflow);
+        return opentracing_false;
+    }
+    free(old_overflow);
+    stack->overflow_capacity = capacity;
+    return opentracing_true;
+}
+
+static opentracing_bool scope_push(opentracing_span* span,
+                                   opentracing_span_context* span_context)
+{
+    scope_stack* stack;
+
+    stack = scope_stack_get();
+    if (stack == NULL || !scope_stack_reserve(stack)) {
+        return opentracing_false;
+    }
+    stack->active.span = span;
+    stack->active.span_context = span_context;
+    *scope_stack_entry(stack, stack->depth) = stack->active;
+    stack->depth++;
+    return opentracing_true;
+}
+
+static void scope_pop(opentracing_span* span,
+                      opentracing_span_context* span_context)
+{
+    scope_stack* stack;
+
+    stack = scope_stack_get();
+    assert(stack != NULL && stack->depth > 0 && stack->active.span == span &&
+           stack->active.span_context == span_context);
+    if (stack == NULL || stack->depth == 0 || stack->active.span != span ||
+        stack->active.span_context != span_context) {
+        return;
+    }
+    stack->depth--;
+    if (stack->depth > 0) {
+        stack->active = *scope_stack_entry(stack, stack->depth - 1);
+    }
+    else {
+        stack->active.span = NULL;
+        stack->active.span_context = NULL;
+    }
+}
+
+opentracing_bool opentracing_activate_span(opentracing_span* span)
+{
+    return scope_push(span, NULL);
+}
+
+void opentracing_deactivate_span(opentracing_span* span)
+{
+    scope_pop(span, NULL);
+}
+
+opentracing_bool
+opentracing_activate_span_context(opentracing_span_context* span_context)
+{
+    return scope_push(NULL, span_context);
+}
+
+void opentracing_deactivate_span_context(
+    opentracing_span_context* span_context)
+{
+    scope_pop(NULL, span_context);
+}
+
+static const scope_entry* scope_active(void)
+{
+#ifdef OPENTRACINGC_HAVE_THREAD_LOCAL
+    return &current_stack.active;
+#else
+    scope_stack* stack;
+
+    stack = scope_stack_get();
+    return (stack != NULL) ? &stack->active : NULL;
+#endif /* OPENTRACINGC_HAVE_THREAD_LOCAL */
+}
+
+opentracing_span* opentracing_active_span(void)
+{
+    const scope_entry* active;
+
+    active = scope_active();
+    return (active != NULL) ? active->span : NULL;
+}
+
+opentracing_span_context* opentracing_active_span_context(void)
+{
+    const scope_entry* active;
+
+    active = scope_active();
+    if (active == NULL) {
+        return NULL;
+    }
+    if (active->span != NULL) {
+        return active->span->span_context(active->span);
+    }
+    return active->span_context;
+}
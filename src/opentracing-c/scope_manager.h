@@ -0,0 +1,91 @@
+#ifndef OPENTRACINGC_SCOPE_MANAGER_H
+#define OPENTRACINGC_SCOPE_MANAGER_H
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/span.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Thread-local scope manager. Each thread has a stack of activated spans,
+ * the top of which is the thread's active span. The basic tracer makes spans
+ * started without references children of the active span, so a parent does
+ * not have to be passed down to every function that starts a span:
+ *
+ *     opentracing_activate_span(span);
+ *     handle_request();  (spans started in here are children of span)
+ *     opentracing_deactivate_span(span);
+ *
+ * A span context can be activated in place of a span, e.g. to resume a trace
+ * whose span lives on elsewhere (see continuation.h). The context then
+ * parents new spans, but there is no active span.
+ *
+ * The stack holds 16 entries without allocating. Activation does not retain
+ * the span or span context, so it must stay alive until it is deactivated.
+ */
+
+/**
+ * Push a span onto the calling thread's stack, making it the active span.
+ * @param span Span to activate. May be NULL to hide the active span, so
+ *             spans started until the matching deactivation are roots.
+ * @return opentracing_true on success, opentracing_false if out of memory,
+ *         in which case the span is not activated and must not be
+ *         deactivated.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_activate_span(opentracing_span* span);
+
+/**
+ * Pop the active span from the calling thread's stack, making the span
+ * activated before it active again. Activations must be undone in reverse
+ * order. Deactivating any span but the active one is an error, which is
+ * ignored unless assertions are enabled.
+ * @param span Active span. May be NULL to undo the activation of NULL.
+ */
+OPENTRACINGC_EXPORT void opentracing_deactivate_span(opentracing_span* span);
+
+/**
+ * Push a span context onto the calling thread's stack, making it the parent
+ * of spans started without references.
+ * @param span_context Span context to activate. May be NULL, which has the
+ *                     same effect as activating a NULL span.
+ * @return opentracing_true on success, opentracing_false if out of memory.
+ * @see opentracing_activate_span()
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_activate_span_context(opentracing_span_context* span_context);
+
+/**
+ * Pop the span context activated last from the calling thread's stack.
+ * @param span_context Active span context. May be NULL.
+ * @see opentracing_deactivate_span()
+ */
+OPENTRACINGC_EXPORT void
+opentracing_deactivate_span_context(opentracing_span_context* span_context);
+
+/**
+ * Get the active span of the calling thread. This is a single thread-local
+ * read.
+ * @return Active span, or NULL if no span or a span context is active.
+ */
+OPENTRACINGC_EXPORT opentracing_span* opentracing_active_span(void);
+
+/**
+ * Get the span context new spans of the calling thread are parented to:
+ * the context of the active span, or the active span context.
+ * @return Borrowed span context, or NULL if there is none.
+ */
+OPENTRACINGC_EXPORT opentracing_span_context*
+opentracing_active_span_context(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_SCOPE_MANAGER_H */
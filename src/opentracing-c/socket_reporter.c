@@ -0,0 +1,333 @@
+/* sendmmsg is a GNU extension. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif /* _GNU_SOURCE */
+
+#include <opentracing-c/socket_reporter.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <opentracing-c/internal/stats.h>
+#include <opentracing-c/span_batch.h>
+
+#define DEFAULT_MAX_DATAGRAM_SIZE 1472
+#define DEFAULT_MAX_DATAGRAMS_PER_SEND 64
+
+#define UNIX_PREFIX "unix:"
+#define UNIX_PREFIX_LENGTH (sizeof(UNIX_PREFIX) - 1)
+
+#ifdef HAVE_SENDMMSG
+
+typedef struct mmsghdr message;
+
+static int send_messages(int fd, message* messages, int num_messages)
+{
+    return sendmmsg(fd, messages, (unsigned int) num_messages, 0);
+}
+
+#else
+
+typedef struct message {
+    struct msghdr msg_hdr;
+} message;
+
+static int send_messages(int fd, message* messages, int num_messages)
+{
+    (void) num_messages;
+    return (sendmsg(fd, &messages->msg_hdr, 0) < 0) ? -1 : 1;
+}
+
+#endif /* HAVE_SENDMMSG */
+
+typedef struct socket_reporter {
+    opentracing_reporter base;
+    pthread_mutex_t mutex;
+    int fd;
+    struct sockaddr_storage address;
+    socklen_t address_length;
+    opentracing_span_batch_encoder* encoder;
+    size_t max_datagram_size;
+    int max_datagrams_per_send;
+
+    /* Datagrams waiting to be sent, each in a max_datagram_size slot. */
+    char* datagrams;
+    struct iovec* iovecs;
+    message* messages;
+    int* span_counts;
+    int num_pending;
+} socket_reporter;
+
+static opentracing_bool parse_unix_address(const char* path,
+                                           struct sockaddr_storage* address,
+                                           socklen_t* address_length)
+{
+    struct sockaddr_un* un;
+    size_t path_length;
+
+    un = (struct sockaddr_un*) address;
+    path_length = strlen(path);
+    if (path_length == 0 || path_length >= sizeof(un->sun_path)) {
+        return opentracing_false;
+    }
+    memset(un, 0, sizeof(*un));
+    un->sun_family = AF_UNIX;
+    memcpy(un->sun_path, path, path_length + 1);
+    *address_length =
+        (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_length + 1);
+    return opentracing_true;
+}
+
+static opentracing_bool parse_udp_address(const char* str,
+                                          struct sockaddr_storage* address,
+                                          socklen_t* address_length)
+{
+    char host[INET6_ADDRSTRLEN];
+    struct addrinfo hints;
+    struct addrinfo* result;
+    const char* port;
+    size_t host_length;
+
+    port = strrchr(str, ':');
+    if (port == NULL || port == str || port[1] == '\0') {
+        return opentracing_false;
+    }
+    host_length = (size_t)(port - str);
+    if (str[0] == '[') {
+        if (host_length < 2 || port[-1] != ']') {
+            return opentracing_false;
+        }
+        str++;
+        host_length -= 2;
+    }
+    if (host_length == 0 || host_length >= sizeof(host)) {
+        return opentracing_false;
+    }
+    memcpy(host, str, host_length);
+    host[host_length] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+    if (getaddrinfo(host, port + 1, &hints, &result) != 0) {
+        return opentracing_false;
+    }
+    memcpy(address, result->ai_addr, result->ai_addrlen);
+    *address_length = (socklen_t) result->ai_addrlen;
+    freeaddrinfo(result);
+    return opentracing_true;
+}
+
+static opentracing_bool parse_address(const char* str,
+                                      struct sockaddr_storage* address,
+                                      socklen_t* address_length)
+{
+    if (strncmp(str, UNIX_PREFIX, UNIX_PREFIX_LENGTH) == 0) {
+        return parse_unix_address(
+            str + UNIX_PREFIX_LENGTH, address, address_length);
+    }
+    return parse_udp_address(str, address, address_length);
+}
+
+static int open_socket(int family)
+{
+    int fd;
+    int flags;
+
+    fd = socket(family, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        fcntl(fd, F_SETFD, FD_CLOEXEC) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void send_pending(socket_reporter* r)
+{
+    int first;
+    int num_sent;
+    int num_dropped;
+
+    first = 0;
+    num_dropped = 0;
+    while (first < r->num_pending) {
+        num_sent =
+            send_messages(r->fd, &r->messages[first], r->num_pending - first);
+        if (num_sent > 0) {
+            first += num_sent;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        /* A full socket would refuse the remaining datagrams too. */
+#if EWOULDBLOCK != EAGAIN
+        if (errno == EWOULDBLOCK) {
+            break;
+        }
+#endif /* EWOULDBLOCK != EAGAIN */
+        if (errno == EAGAIN) {
+            break;
+        }
+        /* Drop the datagram that was refused and carry on. */
+        num_dropped += r->span_counts[first];
+        first++;
+    }
+    while (first < r->num_pending) {
+        num_dropped += r->span_counts[first];
+        first++;
+    }
+    if (num_dropped > 0) {
+        opentracing_stats_add(opentracing_stats_spans_dropped,
+                              (uint64_t) num_dropped);
+    }
+    r->num_pending = 0;
+}
+
+static void socket_reporter_report(opentracing_reporter* reporter,
+                                   const opentracing_span_data* const* spans,
+                                   int num_spans)
+{
+    socket_reporter* r;
+    const char* data;
+    size_t length;
+    int num_encoded;
+    int i;
+
+    assert(reporter != NULL);
+    assert(spans != NULL);
+    r = (socket_reporter*) reporter;
+    pthread_mutex_lock(&r->mutex);
+    while (num_spans > 0) {
+        if (!opentracing_span_batch_encode_prefix(r->encoder,
+                                                  spans,
+                                                  num_spans,
+                                                  r->max_datagram_size,
+                                                  &data,
+                                                  &length,
+                                                  &num_encoded)) {
+            opentracing_stats_add(opentracing_stats_spans_dropped,
+                                  (uint64_t) num_spans);
+            break;
+        }
+        if (length <= r->max_datagram_size) {
+            if (r->num_pending == r->max_datagrams_per_send) {
+                send_pending(r);
+            }
+            i = r->num_pending++;
+            memcpy(r->iovecs[i].iov_base, data, length);
+            r->iovecs[i].iov_len = length;
+            r->span_counts[i] = num_encoded;
+            opentracing_stats_add(opentracing_stats_bytes_encoded, length);
+        }
+        else {
+            opentracing_stats_add(opentracing_stats_spans_dropped,
+                                  (uint64_t) num_encoded);
+        }
+        spans += num_encoded;
+        num_spans -= num_encoded;
+    }
+    send_pending(r);
+    pthread_mutex_unlock(&r->mutex);
+}
+
+static void socket_reporter_flush(opentracing_reporter* reporter)
+{
+    /* Datagrams are sent before report returns. */
+    (void) reporter;
+}
+
+static void socket_reporter_destroy(opentracing_destructible* destructible)
+{
+    socket_reporter* r;
+
+    assert(destructible != NULL);
+    r = (socket_reporter*) destructible;
+    if (r->fd >= 0) {
+        close(r->fd);
+    }
+    opentracing_span_batch_encoder_destroy(r->encoder);
+    free(r->datagrams);
+    free(r->iovecs);
+    free(r->messages);
+    free(r->span_counts);
+    pthread_mutex_destroy(&r->mutex);
+    free(r);
+}
+
+opentracing_reporter* opentracing_make_socket_reporter(
+    const opentracing_socket_reporter_options* options)
+{
+    socket_reporter* r;
+    size_t num_datagrams;
+    size_t i;
+
+    assert(options != NULL);
+    r = (socket_reporter*) calloc(1, sizeof(socket_reporter));
+    if (r == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&r->mutex, NULL) != 0) {
+        free(r);
+        return NULL;
+    }
+    ((opentracing_destructible*) r)->destroy = &socket_reporter_destroy;
+    ((opentracing_reporter*) r)->report = &socket_reporter_report;
+    ((opentracing_reporter*) r)->flush = &socket_reporter_flush;
+    r->fd = -1;
+    r->max_datagram_size = (options->max_datagram_size > 0)
+                               ? options->max_datagram_size
+                               : DEFAULT_MAX_DATAGRAM_SIZE;
+    r->max_datagrams_per_send = (options->max_datagrams_per_send > 0)
+                                    ? options->max_datagrams_per_send
+                                    : DEFAULT_MAX_DATAGRAMS_PER_SEND;
+
+    if (options->address == NULL ||
+        !parse_address(options->address, &r->address, &r->address_length)) {
+        socket_reporter_destroy((opentracing_destructible*) r);
+        errno = EINVAL;
+        return NULL;
+    }
+    r->fd = open_socket(r->address.ss_family);
+    if (r->fd < 0) {
+        socket_reporter_destroy((opentracing_destructible*) r);
+        return NULL;
+    }
+
+    num_datagrams = (size_t) r->max_datagrams_per_send;
+    r->encoder = opentracing_span_batch_encoder_new();
+    r->datagrams = (char*) malloc(num_datagrams * r->max_datagram_size);
+    r->iovecs = (struct iovec*) calloc(num_datagrams, sizeof(struct iovec));
+    r->messages = (message*) calloc(num_datagrams, sizeof(message));
+    r->span_counts = (int*) calloc(num_datagrams, sizeof(int));
+    if (r->encoder == NULL || r->datagrams == NULL || r->iovecs == NULL ||
+        r->messages == NULL || r->span_counts == NULL) {
+        socket_reporter_destroy((opentracing_destructible*) r);
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (i = 0; i < num_datagrams; i++) {
+        r->iovecs[i].iov_base = r->datagrams + i * r->max_datagram_size;
+        r->messages[i].msg_hdr.msg_name = &r->address;
+        r->messages[i].msg_hdr.msg_namelen = r->address_length;
+        r->messages[i].msg_hdr.msg_iov = &r->iovecs[i];
+        r->messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    return (opentracing_reporter*) r;
+}
@@ -0,0 +1,62 @@
+#ifndef OPENTRACINGC_SOCKET_REPORTER_H
+#define OPENTRACINGC_SOCKET_REPORTER_H
+
+#include <stddef.h>
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/reporter.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Options used when calling opentracing_make_socket_reporter(). */
+typedef struct opentracing_socket_reporter_options {
+    /**
+     * Address of the local agent. Either "unix:<path>" for a Unix domain
+     * datagram socket, or "<host>:<port>" for UDP, where host is a numeric
+     * IPv4 address or a bracketed IPv6 address such as "[::1]:6831".
+     */
+    const char* address;
+
+    /**
+     * Maximum size of a datagram in bytes. Zero selects the default of 1472,
+     * which fits a UDP datagram in a 1500 byte Ethernet frame.
+     */
+    size_t max_datagram_size;
+
+    /**
+     * Maximum number of datagrams handed to the kernel in a single system
+     * call. Zero selects the default of 64.
+     */
+    int max_datagrams_per_send;
+} opentracing_socket_reporter_options;
+
+/**
+ * Create a reporter that sends finished spans to a local agent. Each report
+ * call packs its spans into as few datagrams as possible, each holding a
+ * self-contained span batch (see span_batch.h), and sends them with as few
+ * system calls as possible using sendmmsg where available. Pair it with the
+ * basic tracer's background_reporting option so spans arrive in batches
+ * rather than one per datagram.
+ *
+ * The socket never blocks. Datagrams the socket cannot take immediately, or
+ * that the agent is not there to receive, are dropped, as are spans that do
+ * not fit in a datagram on their own.
+ *
+ * @param options Reporter options.
+ * @return New reporter on success, NULL on failure with errno set. errno is
+ *         EINVAL if the address cannot be parsed.
+ */
+OPENTRACINGC_EXPORT opentracing_reporter* opentracing_make_socket_reporter(
+    const opentracing_socket_reporter_options* options)
+    OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_SOCKET_REPORTER_H */
@@ -0,0 +1,119 @@
+#include <opentracing-c/span.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define MAX_STACK_FIELDS 16
+
+opentracing_span_context*
+opentracing_span_context_retain(opentracing_span_context* span_context)
+{
+    assert(span_context != NULL);
+    if (OPENTRACINGC_SPAN_CONTEXT_HAS(span_context, retain)) {
+        return span_context->retain(span_context);
+    }
+    return NULL;
+}
+
+void opentracing_span_context_release(opentracing_span_context* span_context)
+{
+    if (span_context != NULL) {
+        ((opentracing_destructible*) span_context)
+            ->destroy((opentracing_destructible*) span_context);
+    }
+}
+
+void opentracing_span_set_tags(opentracing_span* span,
+                               const opentracing_tag* tags,
+                               int num_tags)
+{
+    int i;
+
+    assert(span != NULL);
+    assert(tags != NULL || num_tags == 0);
+    if (OPENTRACINGC_SPAN_HAS(span, set_tags)) {
+        span->set_tags(span, tags, num_tags);
+        return;
+    }
+    for (i = 0; i < num_tags; i++) {
+        span->set_tag(span, tags[i].key, &tags[i].value);
+    }
+}
+
+void opentracing_span_log_records(opentracing_span* span,
+                                  const opentracing_log_record* records,
+                                  int num_records)
+{
+    int i;
+
+    assert(span != NULL);
+    assert(records != NULL || num_records == 0);
+    if (OPENTRACINGC_SPAN_HAS(span, log_records)) {
+        span->log_records(span, records, num_records);
+        return;
+    }
+    for (i = 0; i < num_records; i++) {
+        span->log_fields(span, records[i].fields, records[i].num_fields);
+    }
+}
+
+void opentracing_span_set_tag_interned(opentracing_span* span,
+                                       opentracing_string_handle key,
+                                       const opentracing_value* value)
+{
+    const char* str;
+
+    assert(span != NULL);
+    assert(value != NULL);
+    if (OPENTRACINGC_SPAN_HAS(span, set_tag_interned)) {
+        span->set_tag_interned(span, key, value);
+        return;
+    }
+    str = opentracing_interned_string(key);
+    if (str != NULL) {
+        span->set_tag(span, str, value);
+    }
+}
+
+void opentracing_span_log_fields_interned(
+    opentracing_span* span,
+    const opentracing_interned_log_field* fields,
+    int num_fields)
+{
+    static const opentracing_log_field no_fields[1] = {
+        {NULL, {opentracing_value_null, {opentracing_false}}}};
+    opentracing_log_field stack_fields[MAX_STACK_FIELDS];
+    opentracing_log_field* converted;
+    int num_converted;
+    int i;
+
+    assert(span != NULL);
+    assert(fields != NULL || num_fields == 0);
+    if (OPENTRACINGC_SPAN_HAS(span, log_fields_interned)) {
+        span->log_fields_interned(span, fields, num_fields);
+        return;
+    }
+
+    converted = stack_fields;
+    if (num_fields > MAX_STACK_FIELDS) {
+        converted = (opentracing_log_field*) malloc(
+            sizeof(opentracing_log_field) * num_fields);
+        if (converted == NULL) {
+            return;
+        }
+    }
+    num_converted = 0;
+    for (i = 0; i < num_fields; i++) {
+        converted[num_converted].key = opentracing_interned_string(fields[i].key);
+        if (converted[num_converted].key != NULL) {
+            converted[num_converted].value = fields[i].value;
+            num_converted++;
+        }
+    }
+    /* Still log an empty record if every key was invalid. */
+    span->log_fields(
+        span, (num_converted > 0) ? converted : no_fields, num_converted);
+    if (converted != stack_fields) {
+        free(converted);
+    }
+}
@@ -3,7 +3,10 @@
 
 #include <opentracing-c/config.h>
 #include <opentracing-c/destructible.h>
+#include <opentracing-c/intern.h>
 #include <opentracing-c/value.h>
+#include <opentracing-c/visibility.h>
+#include <opentracing-c/vtable.h>
 
 /** @file */
 
@@ -21,6 +24,12 @@ typedef struct opentracing_span_context {
     /** Base class member. */
     opentracing_destructible base;
 
+    /**
+     * Layout of this interface the implementation was compiled against.
+     * Initialize with OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span_context).
+     */
+    opentracing_vtable_header header;
+
     /**
      * Calls a function for each baggage item in the span context. If the
      * function returns opentracing_false, it will not be called again, and
@@ -62,8 +71,57 @@ typedef struct opentracing_span_context {
      * Number of bytes the type descriptor occupies in memory.
      */
     unsigned int type_descriptor_length;
+
+    /**
+     * Take a new reference to the span context, which the caller drops with
+     * destroy(). Lets a borrowed context, like the one returned by
+     * span_context(), outlive its span, and lets references and other threads
+     * share one context instead of copying it. Must be safe to call
+     * concurrently with destroy() on other references.
+     * @attention Optional slot added in vtable version 7. Call through
+     *            opentracing_span_context_retain() unless the slot is known
+     *            to exist.
+     * @param span_context Span context instance.
+     * @return span_context.
+     */
+    struct opentracing_span_context* (*retain)(
+        struct opentracing_span_context* span_context) OPENTRACINGC_NONNULL_ALL;
 } opentracing_span_context;
 
+/**
+ * Check whether a span context implementation provides a slot.
+ * @see OPENTRACINGC_VTABLE_HAS
+ */
+#define OPENTRACINGC_SPAN_CONTEXT_HAS(span_context, slot) \
+    OPENTRACINGC_VTABLE_HAS(opentracing_span_context, span_context, slot)
+
+/**
+ * Call retain() if the span context provides it.
+ * @param span_context Span context instance.
+ * @return span_context with an added reference, or NULL if the
+ *         implementation cannot share contexts, in which case the caller
+ *         must keep the original alive instead.
+ */
+OPENTRACINGC_EXPORT opentracing_span_context*
+opentracing_span_context_retain(opentracing_span_context* span_context)
+    OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Drop a reference taken with opentracing_span_context_retain() or returned
+ * by extract(). Equivalent to calling destroy().
+ * @param span_context Span context instance. May be NULL.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_span_context_release(opentracing_span_context* span_context);
+
+/** Simple tag representation. */
+typedef struct opentracing_tag {
+    /** String key. */
+    char* key;
+    /** Generic value type. */
+    opentracing_value value;
+} opentracing_tag;
+
 /**
  * Log field to represent key-value pair for a log.
  */
@@ -74,6 +132,17 @@ typedef struct opentracing_log_field {
     opentracing_value value;
 } opentracing_log_field;
 
+/**
+ * Log field with an interned key.
+ * @see opentracing_intern()
+ */
+typedef struct opentracing_interned_log_field {
+    /** Key handle. */
+    opentracing_string_handle key;
+    /** Value representation. */
+    opentracing_value value;
+} opentracing_interned_log_field;
+
 /**
  * Log record can be used to describe events that occur in the lifetime of a
  * span.
@@ -162,6 +231,12 @@ typedef struct opentracing_span {
     /** Base class member. */
     opentracing_destructible base;
 
+    /**
+     * Layout of this interface the implementation was compiled against.
+     * Initialize with OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span).
+     */
+    opentracing_vtable_header header;
+
     /**
      * Sets the end timestamp and finalizes span state.
      *
@@ -268,8 +343,127 @@ typedef struct opentracing_span {
      */
     struct opentracing_tracer* (*tracer)(const struct opentracing_span* span)
         OPENTRACINGC_NONNULL_ALL;
+
+    /**
+     * Adds several tags to the span at once, with the same semantics as
+     * calling set_tag() for each of them in order. Allows the tracer to
+     * reserve storage once for the whole batch.
+     * @attention Optional slot added in vtable version 2. Call through
+     *            opentracing_span_set_tags() unless the slot is known to
+     *            exist.
+     * @param span Span instance.
+     * @param tags Array of tags. Keys and values are copied.
+     * @param num_tags Number of tags in array.
+     * @see set_tag
+     */
+    void (*set_tags)(struct opentracing_span* span,
+                     const opentracing_tag* tags,
+                     int num_tags) OPENTRACINGC_NONNULL(1);
+
+    /**
+     * Record several log records at once. Unlike log_fields(), each record
+     * carries its own timestamp. A zero timestamp means the current time.
+     * @attention Optional slot added in vtable version 2. Call through
+     *            opentracing_span_log_records() unless the slot is known to
+     *            exist.
+     * @param span Span instance.
+     * @param records Array of log records. Fields are copied.
+     * @param num_records Number of records in array.
+     * @see log_fields
+     */
+    void (*log_records)(struct opentracing_span* span,
+                        const opentracing_log_record* records,
+                        int num_records) OPENTRACINGC_NONNULL(1);
+
+    /**
+     * Like set_tag() but with an interned key. The tracer may keep the
+     * handle or the interned string instead of copying the key.
+     * @attention Optional slot added in vtable version 3. Call through
+     *            opentracing_span_set_tag_interned() unless the slot is known
+     *            to exist.
+     * @param span Span instance.
+     * @param key Tag key handle.
+     * @param value Tag value. Value copied into opentracing_value.
+     * @see set_tag
+     */
+    void (*set_tag_interned)(struct opentracing_span* span,
+                             opentracing_string_handle key,
+                             const opentracing_value* value)
+        OPENTRACINGC_NONNULL_ALL;
+
+    /**
+     * Like log_fields() but with interned keys.
+     * @attention Optional slot added in vtable version 3. Call through
+     *            opentracing_span_log_fields_interned() unless the slot is
+     *            known to exist.
+     * @param span Span instance.
+     * @param fields Array of log fields. Values must be copied from argument.
+     * @param num_fields Number of log fields.
+     * @see log_fields
+     */
+    void (*log_fields_interned)(struct opentracing_span* span,
+                                const opentracing_interned_log_field* fields,
+                                int num_fields) OPENTRACINGC_NONNULL(1);
 } opentracing_span;
 
+/**
+ * Check whether a span implementation provides a slot.
+ * @see OPENTRACINGC_VTABLE_HAS
+ */
+#define OPENTRACINGC_SPAN_HAS(span, slot) \
+    OPENTRACINGC_VTABLE_HAS(opentracing_span, span, slot)
+
+/**
+ * Call set_tags() if the span provides it, otherwise call set_tag() for each
+ * tag.
+ * @param span Span instance.
+ * @param tags Array of tags.
+ * @param num_tags Number of tags in array.
+ */
+OPENTRACINGC_EXPORT void opentracing_span_set_tags(opentracing_span* span,
+                                                   const opentracing_tag* tags,
+                                                   int num_tags)
+    OPENTRACINGC_NONNULL(1);
+
+/**
+ * Call log_records() if the span provides it, otherwise call log_fields()
+ * for each record. In that case the records are logged with the current
+ * time instead of their own timestamps.
+ * @param span Span instance.
+ * @param records Array of log records.
+ * @param num_records Number of records in array.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_span_log_records(opentracing_span* span,
+                             const opentracing_log_record* records,
+                             int num_records) OPENTRACINGC_NONNULL(1);
+
+/**
+ * Call set_tag_interned() if the span provides it, otherwise call set_tag()
+ * with the interned string. Invalid handles are ignored.
+ * @param span Span instance.
+ * @param key Tag key handle.
+ * @param value Tag value.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_span_set_tag_interned(opentracing_span* span,
+                                  opentracing_string_handle key,
+                                  const opentracing_value* value)
+    OPENTRACINGC_NONNULL(1, 3);
+
+/**
+ * Call log_fields_interned() if the span provides it, otherwise call
+ * log_fields() with the interned strings. Fields with invalid handles are
+ * skipped.
+ * @param span Span instance.
+ * @param fields Array of log fields.
+ * @param num_fields Number of log fields.
+ */
+OPENTRACINGC_EXPORT void opentracing_span_log_fields_interned(
+    opentracing_span* span,
+    const opentracing_interned_log_field* fields,
+    int num_fields) OPENTRACINGC_NONNULL(1);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
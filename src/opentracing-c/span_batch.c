@@ -0,0 +1,1000 @@
+#include <opentracing-c/span_batch.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/internal/hash.h>
+
+#define NS_PER_SEC INT64_C(1000000000)
+
+#define INITIAL_BUFFER_SIZE 4096
+#define INITIAL_DICTIONARY_SLOTS 256
+#define MAX_VARINT_LENGTH 10
+
+#define FLAG_HAS_PARENT 1
+#define FLAG_LOCAL_ROOT 2
+#define FLAG_SAME_TRACE 4
+
+#define REFERENCE_CHILD_OF 0
+#define REFERENCE_FOLLOWS_FROM 1
+#define REFERENCE_SAME_TRACE 2
+
+/* Shared helpers. */
+
+static uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static int64_t time_value_to_ns(const opentracing_time_value* value)
+{
+    return (int64_t) value->tv_sec * NS_PER_SEC + value->tv_nsec;
+}
+
+static void ns_to_time_value(int64_t ns, opentracing_time_value* value)
+{
+    value->tv_sec = (time_t)(ns / NS_PER_SEC);
+    value->tv_nsec = (long int) (ns % NS_PER_SEC);
+    if (value->tv_nsec < 0) {
+        value->tv_sec--;
+        value->tv_nsec += NS_PER_SEC;
+    }
+}
+
+/* Add a decoded delta to a timestamp, failing if int64_t would overflow. */
+static opentracing_bool add_ns(int64_t ns, int64_t delta, int64_t* sum)
+{
+    if ((delta > 0 && ns > INT64_MAX - delta) ||
+        (delta < 0 && ns < INT64_MIN - delta)) {
+        return opentracing_false;
+    }
+    *sum = ns + delta;
+    return opentracing_true;
+}
+
+/* Encoder. */
+
+/*
+ * Dictionary entries from earlier batches are told apart by generation, so
+ * starting a batch does not clear the table.
+ */
+typedef struct dictionary_entry {
+    const char* str;
+    size_t len;
+    uint32_t hash;
+    uint32_t index;
+    unsigned long generation;
+} dictionary_entry;
+
+struct opentracing_span_batch_encoder {
+    char* buffer;
+    size_t length;
+    size_t capacity;
+    opentracing_bool failed;
+
+    dictionary_entry* entries;
+    uint32_t mask;
+    uint32_t num_entries;
+    unsigned long generation;
+
+    opentracing_bool has_previous_span;
+    opentracing_trace_id previous_trace_id;
+    int64_t previous_start_ns;
+};
+
+/* Returns space for size more bytes, or NULL once out of memory. */
+static char* encoder_reserve(opentracing_span_batch_encoder* encoder,
+                             size_t size)
+{
+    char* buffer;
+    size_t capacity;
+
+    if (encoder->failed) {
+        return NULL;
+    }
+    if (encoder->length + size > encoder->capacity) {
+        capacity = encoder->capacity * 2;
+        while (capacity < encoder->length + size) {
+            capacity *= 2;
+        }
+        buffer = (char*) realloc(encoder->buffer, capacity);
+        if (buffer == NULL) {
+            encoder->failed = opentracing_true;
+            return NULL;
+        }
+        encoder->buffer = buffer;
+        encoder->capacity = capacity;
+    }
+    return encoder->buffer + encoder->length;
+}
+
+static void write_byte(opentracing_span_batch_encoder* encoder, int value)
+{
+    char* out;
+
+    out = encoder_reserve(encoder, 1);
+    if (out != NULL) {
+        *out = (char) value;
+        encoder->length++;
+    }
+}
+
+static void write_varint(opentracing_span_batch_encoder* encoder,
+                         uint64_t value)
+{
+    char* out;
+    size_t i;
+
+    out = encoder_reserve(encoder, MAX_VARINT_LENGTH);
+    if (out == NULL) {
+        return;
+    }
+    for (i = 0; value >= 0x80; i++) {
+        out[i] = (char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[i] = (char) value;
+    encoder->length += i + 1;
+}
+
+static void write_u64(opentracing_span_batch_encoder* encoder, uint64_t value)
+{
+    char* out;
+    int i;
+
+    out = encoder_reserve(encoder, 8);
+    if (out == NULL) {
+        return;
+    }
+    for (i = 7; i >= 0; i--) {
+        out[i] = (char) (value & 0xFF);
+        value >>= 8;
+    }
+    encoder->length += 8;
+}
+
+static void write_trace_id(opentracing_span_batch_encoder* encoder,
+                           const opentracing_trace_id* trace_id)
+{
+    write_u64(encoder, trace_id->high);
+    write_u64(encoder, trace_id->low);
+}
+
+static void write_string(opentracing_span_batch_encoder* encoder,
+                         const char* str,
+                         size_t len)
+{
+    char* out;
+
+    write_varint(encoder, len);
+    out = encoder_reserve(encoder, len + 1);
+    if (out == NULL) {
+        return;
+    }
+    if (len > 0) {
+        memcpy(out, str, len);
+    }
+    out[len] = '\0';
+    encoder->length += len + 1;
+}
+
+static opentracing_bool
+dictionary_grow(opentracing_span_batch_encoder* encoder)
+{
+    dictionary_entry* entries;
+    dictionary_entry* entry;
+    uint32_t mask;
+    uint32_t i;
+    uint32_t j;
+
+    mask = encoder->mask * 2 + 1;
+    entries =
+        (dictionary_entry*) calloc((size_t) mask + 1, sizeof(dictionary_entry));
+    if (entries == NULL) {
+        return opentracing_false;
+    }
+    for (i = 0; i <= encoder->mask; i++) {
+        entry = &encoder->entries[i];
+        if (entry->generation != encoder->generation) {
+            continue;
+        }
+        j = entry->hash & mask;
+        while (entries[j].generation != 0) {
+            j = (j + 1) & mask;
+        }
+        entries[j] = *entry;
+    }
+    free(encoder->entries);
+    encoder->entries = entries;
+    encoder->mask = mask;
+    return opentracing_true;
+}
+
+static void write_string_ref(opentracing_span_batch_encoder* encoder,
+                             const char* str)
+{
+    dictionary_entry* entry;
+    size_t len;
+    uint32_t hash;
+    uint32_t i;
+
+    len = strlen(str);
+    hash = opentracing_hash_fnv1a(str, len);
+    for (i = hash & encoder->mask;; i = (i + 1) & encoder->mask) {
+        entry = &encoder->entries[i];
+        if (entry->generation != encoder->generation) {
+            break;
+        }
+        if (entry->hash == hash && entry->len == len &&
+            memcmp(entry->str, str, len) == 0) {
+            write_varint(encoder, (uint64_t) entry->index + 1);
+            return;
+        }
+    }
+
+    /* Define a new entry. The table stays at most half full. */
+    write_varint(encoder, 0);
+    write_string(encoder, str, len);
+    if ((encoder->num_entries + 1) * 2 > encoder->mask + 1) {
+        if (!dictionary_grow(encoder)) {
+            encoder->failed = opentracing_true;
+            return;
+        }
+        i = hash & encoder->mask;
+        while (encoder->entries[i].generation == encoder->generation) {
+            i = (i + 1) & encoder->mask;
+        }
+        entry = &encoder->entries[i];
+    }
+    entry->str = str;
+    entry->len = len;
+    entry->hash = hash;
+    entry->index = encoder->num_entries++;
+    entry->generation = encoder->generation;
+}
+
+static void write_value(opentracing_span_batch_encoder* encoder,
+                        const opentracing_value* value)
+{
+    uint64_t bits;
+
+    if (value->type == opentracing_value_string &&
+        value->value.string_value == NULL) {
+        write_byte(encoder, opentracing_value_null);
+        return;
+    }
+    write_byte(encoder, value->type);
+    switch (value->type) {
+    case opentracing_value_bool:
+        write_byte(encoder, value->value.bool_value ? 1 : 0);
+        break;
+    case opentracing_value_double:
+        memcpy(&bits, &value->value.double_value, sizeof(bits));
+        write_u64(encoder, bits);
+        break;
+    case opentracing_value_int64:
+        write_varint(encoder, zigzag_encode(value->value.int64_value));
+        break;
+    case opentracing_value_uint64:
+        write_varint(encoder, value->value.uint64_value);
+        break;
+    case opentracing_value_string:
+        write_string(encoder,
+                     value->value.string_value,
+                     strlen(value->value.string_value));
+        break;
+    case opentracing_value_string_view:
+        write_string(encoder,
+                     value->value.string_view_value.data,
+                     value->value.string_view_value.length);
+        break;
+    default:
+        break;
+    }
+}
+
+static void write_span(opentracing_span_batch_encoder* encoder,
+                       const opentracing_span_data* span)
+{
+    const opentracing_span_data_reference* ref;
+    const opentracing_log_record* log;
+    int64_t start_ns;
+    int flags;
+    int type;
+    int i;
+    int j;
+
+    flags = 0;
+    if (span->parent_span_id != 0) {
+        flags |= FLAG_HAS_PARENT;
+    }
+    if (span->local_root) {
+        flags |= FLAG_LOCAL_ROOT;
+    }
+    if (encoder->has_previous_span &&
+        span->trace_id.high == encoder->previous_trace_id.high &&
+        span->trace_id.low == encoder->previous_trace_id.low) {
+        flags |= FLAG_SAME_TRACE;
+    }
+    write_byte(encoder, flags);
+    if (!(flags & FLAG_SAME_TRACE)) {
+        write_trace_id(encoder, &span->trace_id);
+    }
+    write_u64(encoder, span->span_id);
+    if (flags & FLAG_HAS_PARENT) {
+        write_u64(encoder, span->parent_span_id);
+    }
+    write_string_ref(encoder, span->operation_name);
+    start_ns = time_value_to_ns(&span->start_timestamp.value);
+    write_varint(encoder, zigzag_encode(start_ns - encoder->previous_start_ns));
+    write_varint(encoder,
+                 zigzag_encode(time_value_to_ns(&span->duration.value)));
+    encoder->has_previous_span = opentracing_true;
+    encoder->previous_trace_id = span->trace_id;
+    encoder->previous_start_ns = start_ns;
+
+    write_varint(encoder, (uint64_t) span->num_references);
+    for (i = 0; i < span->num_references; i++) {
+        ref = &span->references[i];
+        type = (ref->type == opentracing_span_reference_follows_from)
+                   ? REFERENCE_FOLLOWS_FROM
+                   : REFERENCE_CHILD_OF;
+        if (ref->trace_id.high == span->trace_id.high &&
+            ref->trace_id.low == span->trace_id.low) {
+            write_byte(encoder, type | REFERENCE_SAME_TRACE);
+        }
+        else {
+            write_byte(encoder, type);
+            write_trace_id(encoder, &ref->trace_id);
+        }
+        write_u64(encoder, ref->span_id);
+    }
+
+    write_varint(encoder, (uint64_t) span->num_tags);
+    for (i = 0; i < span->num_tags; i++) {
+        write_string_ref(encoder, span->tags[i].key);
+        write_value(encoder, &span->tags[i].value);
+    }
+
+    write_varint(encoder, (uint64_t) span->num_logs);
+    for (i = 0; i < span->num_logs; i++) {
+        log = &span->logs[i];
+        write_varint(encoder,
+                     zigzag_encode(time_value_to_ns(&log->timestamp.value) -
+                                   start_ns));
+        write_varint(encoder, (uint64_t) log->num_fields);
+        for (j = 0; j < log->num_fields; j++) {
+            write_string_ref(encoder, log->fields[j].key);
+            write_value(encoder, &log->fields[j].value);
+        }
+    }
+}
+
+opentracing_span_batch_encoder* opentracing_span_batch_encoder_new(void)
+{
+    opentracing_span_batch_encoder* encoder;
+
+    encoder = (opentracing_span_batch_encoder*) calloc(
+        1, sizeof(opentracing_span_batch_encoder));
+    if (encoder == NULL) {
+        return NULL;
+    }
+    encoder->buffer = (char*) malloc(INITIAL_BUFFER_SIZE);
+    encoder->entries = (dictionary_entry*) calloc(INITIAL_DICTIONARY_SLOTS,
+                                                  sizeof(dictionary_entry));
+    if (encoder->buffer == NULL || encoder->entries == NULL) {
+        opentracing_span_batch_encoder_destroy(encoder);
+        return NULL;
+    }
+    encoder->capacity = INITIAL_BUFFER_SIZE;
+    encoder->mask = INITIAL_DICTIONARY_SLOTS - 1;
+    return encoder;
+}
+
+void opentracing_span_batch_encoder_destroy(
+    opentracing_span_batch_encoder* encoder)
+{
+    if (encoder == NULL) {
+        return;
+    }
+    free(encoder->buffer);
+    free(encoder->entries);
+    free(encoder);
+}
+
+static int varint_length(uint64_t value)
+{
+    int length;
+
+    for (length = 1; value >= 0x80; length++) {
+        value >>= 7;
+    }
+    return length;
+}
+
+/* Writes value into exactly width bytes, padding with continuation bytes. */
+static void write_padded_varint(char* out, uint64_t value, int width)
+{
+    int i;
+
+    for (i = 0; i < width - 1; i++) {
+        out[i] = (char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[i] = (char) value;
+}
+
+opentracing_bool
+opentracing_span_batch_encode(opentracing_span_batch_encoder* encoder,
+                              const opentracing_span_data* const* spans,
+                              int num_spans,
+                              const char** data,
+                              size_t* length)
+{
+    int num_encoded;
+
+    return opentracing_span_batch_encode_prefix(
+        encoder, spans, num_spans, (size_t) -1, data, length, &num_encoded);
+}
+
+opentracing_bool
+opentracing_span_batch_encode_prefix(opentracing_span_batch_encoder* encoder,
+                                     const opentracing_span_data* const* spans,
+                                     int num_spans,
+                                     size_t max_length,
+                                     const char** data,
+                                     size_t* length,
+                                     int* num_encoded)
+{
+    size_t count_offset;
+    size_t span_offset;
+    int count_width;
+    int i;
+
+    assert(encoder != NULL);
+    assert(spans != NULL || num_spans == 0);
+    assert(data != NULL);
+    assert(length != NULL);
+    assert(num_encoded != NULL);
+    encoder->length = 0;
+    encoder->failed = opentracing_false;
+    encoder->num_entries = 0;
+    encoder->generation++;
+    encoder->has_previous_span = opentracing_false;
+    encoder->previous_start_ns = 0;
+
+    /*
+     * Reserve room for the largest count, then patch in the number of spans
+     * that fit. The count is only padded when spans are left out.
+     */
+    write_byte(encoder, OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION);
+    count_width = varint_length((uint64_t) num_spans);
+    count_offset = encoder->length;
+    if (encoder_reserve(encoder, (size_t) count_width) != NULL) {
+        encoder->length += (size_t) count_width;
+    }
+    for (i = 0; i < num_spans; i++) {
+        span_offset = encoder->length;
+        write_span(encoder, spans[i]);
+        if (encoder->length > max_length && i > 0) {
+            encoder->length = span_offset;
+            break;
+        }
+    }
+    if (encoder->failed) {
+        *data = NULL;
+        *length = 0;
+        *num_encoded = 0;
+        return opentracing_false;
+    }
+    write_padded_varint(
+        encoder->buffer + count_offset, (uint64_t) i, count_width);
+    *data = encoder->buffer;
+    *length = encoder->length;
+    *num_encoded = i;
+    return opentracing_true;
+}
+
+/* Decoder. */
+
+struct opentracing_span_batch_decoder {
+    const unsigned char* next;
+    const unsigned char* end;
+    int num_remaining;
+    opentracing_span_batch_status status;
+    opentracing_trace_id previous_trace_id;
+    int64_t previous_start_ns;
+
+    opentracing_string_view* strings;
+    int num_strings;
+    int string_capacity;
+
+    opentracing_span_data span;
+    opentracing_span_data_reference* references;
+    int reference_capacity;
+    opentracing_tag* tags;
+    int tag_capacity;
+    opentracing_log_record* logs;
+    int log_capacity;
+    /* Fields of every log in the span, in order. */
+    opentracing_log_field* fields;
+    int field_capacity;
+};
+
+/* Grow an array to hold at least count elements. */
+static opentracing_bool
+reserve_array(void** array, int* capacity, int count, size_t element_size)
+{
+    void* grown;
+    int new_capacity;
+
+    if (count <= *capacity) {
+        return opentracing_true;
+    }
+    new_capacity = (*capacity > 0) ? *capacity : 8;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    grown = realloc(*array, element_size * (size_t) new_capacity);
+    if (grown == NULL) {
+        return opentracing_false;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return opentracing_true;
+}
+
+#define DECODER_RESERVE(decoder, member, capacity, count) \
+    reserve_array((void**) &(decoder)->member,          \
+                  &(decoder)->capacity,                 \
+                  (count),                              \
+                  sizeof(*(decoder)->member))
+
+static opentracing_bool fail(opentracing_span_batch_decoder* decoder,
+                             opentracing_span_batch_status status)
+{
+    if (decoder->status == opentracing_span_batch_status_ok) {
+        decoder->status = status;
+    }
+    return opentracing_false;
+}
+
+static opentracing_bool read_byte(opentracing_span_batch_decoder* decoder,
+                                  int* value)
+{
+    if (decoder->next == decoder->end) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    *value = *decoder->next++;
+    return opentracing_true;
+}
+
+static opentracing_bool read_varint(opentracing_span_batch_decoder* decoder,
+                                    uint64_t* value)
+{
+    uint64_t byte;
+    int shift;
+
+    *value = 0;
+    for (shift = 0; shift < 64; shift += 7) {
+        if (decoder->next == decoder->end) {
+            break;
+        }
+        byte = *decoder->next++;
+        if (shift == 63 && byte > 1) {
+            break;
+        }
+        *value |= (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return opentracing_true;
+        }
+    }
+    return fail(decoder, opentracing_span_batch_status_corrupted);
+}
+
+static opentracing_bool read_zigzag(opentracing_span_batch_decoder* decoder,
+                                    int64_t* value)
+{
+    uint64_t encoded;
+
+    if (!read_varint(decoder, &encoded)) {
+        return opentracing_false;
+    }
+    *value = zigzag_decode(encoded);
+    return opentracing_true;
+}
+
+/* Counts are bounded by the remaining bytes, as each item takes one. */
+static opentracing_bool read_count(opentracing_span_batch_decoder* decoder,
+                                   int* count)
+{
+    uint64_t value;
+
+    if (!read_varint(decoder, &value)) {
+        return opentracing_false;
+    }
+    if (value > (uint64_t)(decoder->end - decoder->next)) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    *count = (int) value;
+    return opentracing_true;
+}
+
+static opentracing_bool read_u64(opentracing_span_batch_decoder* decoder,
+                                 uint64_t* value)
+{
+    int i;
+
+    if (decoder->end - decoder->next < 8) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    *value = 0;
+    for (i = 0; i < 8; i++) {
+        *value = (*value << 8) | decoder->next[i];
+    }
+    decoder->next += 8;
+    return opentracing_true;
+}
+
+static opentracing_bool
+read_trace_id(opentracing_span_batch_decoder* decoder,
+              opentracing_trace_id* trace_id)
+{
+    return (read_u64(decoder, &trace_id->high) &&
+            read_u64(decoder, &trace_id->low))
+               ? opentracing_true
+               : opentracing_false;
+}
+
+static opentracing_bool read_string(opentracing_span_batch_decoder* decoder,
+                                    opentracing_string_view* str)
+{
+    uint64_t len;
+
+    if (!read_varint(decoder, &len)) {
+        return opentracing_false;
+    }
+    if (len >= (uint64_t)(decoder->end - decoder->next) ||
+        decoder->next[len] != '\0') {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    str->data = (const char*) decoder->next;
+    str->length = (size_t) len;
+    decoder->next += len + 1;
+    return opentracing_true;
+}
+
+static opentracing_bool
+read_string_ref(opentracing_span_batch_decoder* decoder, const char** str)
+{
+    uint64_t ref;
+
+    if (!read_varint(decoder, &ref)) {
+        return opentracing_false;
+    }
+    if (ref == 0) {
+        if (!DECODER_RESERVE(decoder,
+                             strings,
+                             string_capacity,
+                             decoder->num_strings + 1)) {
+            return fail(decoder, opentracing_span_batch_status_out_of_memory);
+        }
+        if (!read_string(decoder, &decoder->strings[decoder->num_strings])) {
+            return opentracing_false;
+        }
+        ref = (uint64_t) ++decoder->num_strings;
+    }
+    if (ref > (uint64_t) decoder->num_strings) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    *str = decoder->strings[ref - 1].data;
+    return opentracing_true;
+}
+
+static opentracing_bool read_value(opentracing_span_batch_decoder* decoder,
+                                   opentracing_value* value)
+{
+    uint64_t bits;
+    int64_t signed_value;
+    opentracing_string_view str;
+    int type;
+    int byte;
+
+    if (!read_byte(decoder, &type)) {
+        return opentracing_false;
+    }
+    switch (type) {
+    case opentracing_value_bool:
+        if (!read_byte(decoder, &byte) || byte > 1) {
+            return fail(decoder, opentracing_span_batch_status_corrupted);
+        }
+        value->type = opentracing_value_bool;
+        value->value.bool_value = byte ? opentracing_true : opentracing_false;
+        return opentracing_true;
+    case opentracing_value_double:
+        if (!read_u64(decoder, &bits)) {
+            return opentracing_false;
+        }
+        value->type = opentracing_value_double;
+        memcpy(&value->value.double_value, &bits, sizeof(bits));
+        return opentracing_true;
+    case opentracing_value_int64:
+        if (!read_zigzag(decoder, &signed_value)) {
+            return opentracing_false;
+        }
+        value->type = opentracing_value_int64;
+        value->value.int64_value = signed_value;
+        return opentracing_true;
+    case opentracing_value_uint64:
+        value->type = opentracing_value_uint64;
+        return read_varint(decoder, &value->value.uint64_value);
+    case opentracing_value_string:
+        if (!read_string(decoder, &str)) {
+            return opentracing_false;
+        }
+        value->type = opentracing_value_string;
+        value->value.string_value = str.data;
+        return opentracing_true;
+    case opentracing_value_null:
+        value->type = opentracing_value_null;
+        return opentracing_true;
+    case opentracing_value_string_view:
+        value->type = opentracing_value_string_view;
+        return read_string(decoder, &value->value.string_view_value);
+    default:
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+}
+
+static opentracing_bool read_references(opentracing_span_batch_decoder* decoder)
+{
+    opentracing_span_data* span;
+    opentracing_span_data_reference* ref;
+    int type;
+    int i;
+
+    span = &decoder->span;
+    if (!read_count(decoder, &span->num_references)) {
+        return opentracing_false;
+    }
+    if (!DECODER_RESERVE(
+            decoder, references, reference_capacity, span->num_references)) {
+        return fail(decoder, opentracing_span_batch_status_out_of_memory);
+    }
+    for (i = 0; i < span->num_references; i++) {
+        ref = &decoder->references[i];
+        if (!read_byte(decoder, &type) ||
+            (type & ~REFERENCE_SAME_TRACE) > REFERENCE_FOLLOWS_FROM) {
+            return fail(decoder, opentracing_span_batch_status_corrupted);
+        }
+        ref->type = ((type & ~REFERENCE_SAME_TRACE) == REFERENCE_FOLLOWS_FROM)
+                        ? opentracing_span_reference_follows_from
+                        : opentracing_span_reference_child_of;
+        if (type & REFERENCE_SAME_TRACE) {
+            ref->trace_id = span->trace_id;
+        }
+        else if (!read_trace_id(decoder, &ref->trace_id)) {
+            return opentracing_false;
+        }
+        if (!read_u64(decoder, &ref->span_id)) {
+            return opentracing_false;
+        }
+    }
+    span->references =
+        (span->num_references > 0) ? decoder->references : NULL;
+    return opentracing_true;
+}
+
+static opentracing_bool read_tags(opentracing_span_batch_decoder* decoder)
+{
+    opentracing_span_data* span;
+    const char* key;
+    int i;
+
+    span = &decoder->span;
+    if (!read_count(decoder, &span->num_tags)) {
+        return opentracing_false;
+    }
+    if (!DECODER_RESERVE(decoder, tags, tag_capacity, span->num_tags)) {
+        return fail(decoder, opentracing_span_batch_status_out_of_memory);
+    }
+    for (i = 0; i < span->num_tags; i++) {
+        if (!read_string_ref(decoder, &key) ||
+            !read_value(decoder, &decoder->tags[i].value)) {
+            return opentracing_false;
+        }
+        decoder->tags[i].key = (char*) key;
+    }
+    span->tags = (span->num_tags > 0) ? decoder->tags : NULL;
+    return opentracing_true;
+}
+
+static opentracing_bool read_logs(opentracing_span_batch_decoder* decoder,
+                                  int64_t start_ns)
+{
+    opentracing_span_data* span;
+    opentracing_log_record* log;
+    int64_t delta;
+    int64_t timestamp_ns;
+    int num_fields;
+    int i;
+    int j;
+
+    span = &decoder->span;
+    if (!read_count(decoder, &span->num_logs)) {
+        return opentracing_false;
+    }
+    if (!DECODER_RESERVE(decoder, logs, log_capacity, span->num_logs)) {
+        return fail(decoder, opentracing_span_batch_status_out_of_memory);
+    }
+    num_fields = 0;
+    for (i = 0; i < span->num_logs; i++) {
+        log = &decoder->logs[i];
+        if (!read_zigzag(decoder, &delta) ||
+            !read_count(decoder, &log->num_fields)) {
+            return opentracing_false;
+        }
+        if (!add_ns(start_ns, delta, &timestamp_ns)) {
+            return fail(decoder, opentracing_span_batch_status_corrupted);
+        }
+        ns_to_time_value(timestamp_ns, &log->timestamp.value);
+        if (!DECODER_RESERVE(decoder,
+                             fields,
+                             field_capacity,
+                             num_fields + log->num_fields)) {
+            return fail(decoder, opentracing_span_batch_status_out_of_memory);
+        }
+        for (j = 0; j < log->num_fields; j++) {
+            if (!read_string_ref(decoder, &decoder->fields[num_fields].key) ||
+                !read_value(decoder, &decoder->fields[num_fields].value)) {
+                return opentracing_false;
+            }
+            num_fields++;
+        }
+    }
+
+    /* The field array may have moved while growing. */
+    num_fields = 0;
+    for (i = 0; i < span->num_logs; i++) {
+        log = &decoder->logs[i];
+        log->fields = (log->num_fields > 0) ? &decoder->fields[num_fields]
+                                            : NULL;
+        num_fields += log->num_fields;
+    }
+    span->logs = (span->num_logs > 0) ? decoder->logs : NULL;
+    return opentracing_true;
+}
+
+static opentracing_bool read_span(opentracing_span_batch_decoder* decoder)
+{
+    opentracing_span_data* span;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int flags;
+
+    span = &decoder->span;
+    memset(span, 0, sizeof(*span));
+    if (!read_byte(decoder, &flags)) {
+        return opentracing_false;
+    }
+    if (flags & ~(FLAG_HAS_PARENT | FLAG_LOCAL_ROOT | FLAG_SAME_TRACE)) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    span->local_root =
+        (flags & FLAG_LOCAL_ROOT) ? opentracing_true : opentracing_false;
+    if (flags & FLAG_SAME_TRACE) {
+        span->trace_id = decoder->previous_trace_id;
+    }
+    else if (!read_trace_id(decoder, &span->trace_id)) {
+        return opentracing_false;
+    }
+    if (!read_u64(decoder, &span->span_id) ||
+        ((flags & FLAG_HAS_PARENT) &&
+         !read_u64(decoder, &span->parent_span_id)) ||
+        !read_string_ref(decoder, &span->operation_name) ||
+        !read_zigzag(decoder, &start_ns) ||
+        !read_zigzag(decoder, &duration_ns)) {
+        return opentracing_false;
+    }
+    if (!add_ns(decoder->previous_start_ns, start_ns, &start_ns)) {
+        return fail(decoder, opentracing_span_batch_status_corrupted);
+    }
+    ns_to_time_value(start_ns, &span->start_timestamp.value);
+    ns_to_time_value(duration_ns, &span->duration.value);
+    decoder->previous_trace_id = span->trace_id;
+    decoder->previous_start_ns = start_ns;
+
+    return (read_references(decoder) && read_tags(decoder) &&
+            read_logs(decoder, start_ns))
+               ? opentracing_true
+               : opentracing_false;
+}
+
+opentracing_span_batch_decoder* opentracing_span_batch_decoder_new(void)
+{
+    opentracing_span_batch_decoder* decoder;
+
+    decoder = (opentracing_span_batch_decoder*) calloc(
+        1, sizeof(opentracing_span_batch_decoder));
+    if (decoder == NULL) {
+        return NULL;
+    }
+    decoder->status = opentracing_span_batch_status_end;
+    return decoder;
+}
+
+void opentracing_span_batch_decoder_destroy(
+    opentracing_span_batch_decoder* decoder)
+{
+    if (decoder == NULL) {
+        return;
+    }
+    free(decoder->strings);
+    free(decoder->references);
+    free(decoder->tags);
+    free(decoder->logs);
+    free(decoder->fields);
+    free(decoder);
+}
+
+opentracing_span_batch_status
+opentracing_span_batch_decode_begin(opentracing_span_batch_decoder* decoder,
+                                    const char* data,
+                                    size_t length,
+                                    int* num_spans)
+{
+    int version;
+
+    assert(decoder != NULL);
+    assert(data != NULL || length == 0);
+    assert(num_spans != NULL);
+    *num_spans = 0;
+    decoder->next = (const unsigned char*) data;
+    decoder->end = decoder->next + length;
+    decoder->num_remaining = 0;
+    decoder->status = opentracing_span_batch_status_ok;
+    decoder->num_strings = 0;
+    memset(&decoder->previous_trace_id, 0, sizeof(decoder->previous_trace_id));
+    decoder->previous_start_ns = 0;
+    if (!read_byte(decoder, &version) ||
+        version != OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION ||
+        !read_count(decoder, &decoder->num_remaining)) {
+        decoder->status = opentracing_span_batch_status_corrupted;
+        return decoder->status;
+    }
+    *num_spans = decoder->num_remaining;
+    return opentracing_span_batch_status_ok;
+}
+
+opentracing_span_batch_status
+opentracing_span_batch_decode_next(opentracing_span_batch_decoder* decoder,
+                                   const opentracing_span_data** span)
+{
+    assert(decoder != NULL);
+    assert(span != NULL);
+    *span = NULL;
+    if (decoder->status != opentracing_span_batch_status_ok) {
+        return decoder->status;
+    }
+    if (decoder->num_remaining == 0) {
+        /* Trailing bytes mean the count was wrong. */
+        if (decoder->next != decoder->end) {
+            fail(decoder, opentracing_span_batch_status_corrupted);
+            return decoder->status;
+        }
+        return opentracing_span_batch_status_end;
+    }
+    if (!read_span(decoder)) {
+        return decoder->status;
+    }
+    decoder->num_remaining--;
+    *span = &decoder->span;
+    return opentracing_span_batch_status_ok;
+}
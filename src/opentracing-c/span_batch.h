@@ -0,0 +1,195 @@
+#ifndef OPENTRACINGC_SPAN_BATCH_H
+#define OPENTRACINGC_SPAN_BATCH_H
+
+#include <stddef.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/span_data.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Span batch wire format. Integers marked varint are unsigned LEB128, and
+ * those marked zigzag are signed integers zigzag-encoded into a varint.
+ * Fixed-size integers are big endian. Times are in nanoseconds.
+ *
+ * Batch:
+ * | Field         | Encoding                                       |
+ * |---------------|------------------------------------------------|
+ * | Version       | 1 byte                                         |
+ * | Span count    | varint                                         |
+ * | Spans         | Span count spans                               |
+ *
+ * Span:
+ * | Field         | Encoding                                       |
+ * |---------------|------------------------------------------------|
+ * | Flags         | 1 byte: 1 = has parent, 2 = local root,        |
+ * |               | 4 = same trace ID as the previous span         |
+ * | Trace ID      | 16 bytes, high half first, unless flag 4       |
+ * | Span ID       | 8 bytes                                        |
+ * | Parent ID     | 8 bytes, only with flag 1                      |
+ * | Operation     | String reference                               |
+ * | Start time    | zigzag, delta from the previous span's start   |
+ * |               | (from zero for the first span)                 |
+ * | Duration      | zigzag                                         |
+ * | References    | varint count, then per reference: 1 byte type  |
+ * |               | (0 child_of, 1 follows_from) plus 2 if the     |
+ * |               | trace ID is the span's, 16 byte trace ID       |
+ * |               | unless 2 is set, 8 byte span ID                |
+ * | Tags          | varint count, then per tag: key string         |
+ * |               | reference, value                               |
+ * | Logs          | varint count, then per log: zigzag timestamp   |
+ * |               | delta from span start, varint field count,     |
+ * |               | then per field: key string reference, value    |
+ *
+ * String reference: varint. Zero defines the next dictionary entry, which
+ * follows as a string. N refers to dictionary entry N - 1. Entries are
+ * numbered from zero in each batch. Operation names and keys are
+ * referenced through the dictionary.
+ *
+ * String: varint length, bytes, then a zero byte so decoded strings can
+ * point into the batch.
+ *
+ * Decoders accept varints padded with redundant continuation bytes, which
+ * opentracing_span_batch_encode_prefix() uses for the span count.
+ *
+ * Value: 1 byte opentracing_value_type, then:
+ * - bool: 1 byte, 0 or 1.
+ * - double: 8 bytes of IEEE 754 binary64.
+ * - int64: zigzag.
+ * - uint64: varint.
+ * - string, string_view: String.
+ * - null: nothing.
+ */
+
+/** Format version written by the encoder. */
+#define OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION 1
+
+/** Span batch encoder. Reuses its buffers across batches. */
+typedef struct opentracing_span_batch_encoder opentracing_span_batch_encoder;
+
+/** Streaming span batch decoder. Reuses its buffers across spans. */
+typedef struct opentracing_span_batch_decoder opentracing_span_batch_decoder;
+
+/** Result of decoding the next span in a batch. */
+typedef enum opentracing_span_batch_status {
+    /** A span was decoded. */
+    opentracing_span_batch_status_ok = 0,
+    /** The batch has no more spans. */
+    opentracing_span_batch_status_end = 1,
+    /** The batch is not a valid encoding. */
+    opentracing_span_batch_status_corrupted = 2,
+    /** Out of memory. */
+    opentracing_span_batch_status_out_of_memory = 3
+} opentracing_span_batch_status;
+
+/**
+ * Create a span batch encoder.
+ * @return New encoder on success, NULL if out of memory.
+ */
+OPENTRACINGC_EXPORT opentracing_span_batch_encoder*
+opentracing_span_batch_encoder_new(void);
+
+/**
+ * Destroy a span batch encoder.
+ * @param encoder Encoder instance. May be NULL.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_span_batch_encoder_destroy(opentracing_span_batch_encoder* encoder);
+
+/**
+ * Encode a batch of spans.
+ * @param encoder Encoder instance.
+ * @param spans Array of spans.
+ * @param num_spans Number of spans in array.
+ * @param[out] data Set to the encoded batch, owned by the encoder and valid
+ *                  until the next call.
+ * @param[out] length Set to the size of the encoded batch.
+ * @return opentracing_true on success, opentracing_false if out of memory.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_span_batch_encode(opentracing_span_batch_encoder* encoder,
+                              const opentracing_span_data* const* spans,
+                              int num_spans,
+                              const char** data,
+                              size_t* length) OPENTRACINGC_NONNULL(1, 4, 5);
+
+/**
+ * Encode as many leading spans as fit in a batch of at most max_length
+ * bytes. The first span is always encoded, so the batch only exceeds
+ * max_length if that span does not fit on its own.
+ * @param encoder Encoder instance.
+ * @param spans Array of spans.
+ * @param num_spans Number of spans in array.
+ * @param max_length Maximum size of the encoded batch.
+ * @param[out] data Set to the encoded batch, owned by the encoder and valid
+ *                  until the next call.
+ * @param[out] length Set to the size of the encoded batch.
+ * @param[out] num_encoded Set to the number of spans in the batch.
+ * @return opentracing_true on success, opentracing_false if out of memory.
+ */
+OPENTRACINGC_EXPORT opentracing_bool
+opentracing_span_batch_encode_prefix(opentracing_span_batch_encoder* encoder,
+                                     const opentracing_span_data* const* spans,
+                                     int num_spans,
+                                     size_t max_length,
+                                     const char** data,
+                                     size_t* length,
+                                     int* num_encoded)
+    OPENTRACINGC_NONNULL(1, 5, 6, 7);
+
+/**
+ * Create a span batch decoder.
+ * @return New decoder on success, NULL if out of memory.
+ */
+OPENTRACINGC_EXPORT opentracing_span_batch_decoder*
+opentracing_span_batch_decoder_new(void);
+
+/**
+ * Destroy a span batch decoder.
+ * @param decoder Decoder instance. May be NULL.
+ */
+OPENTRACINGC_EXPORT void
+opentracing_span_batch_decoder_destroy(opentracing_span_batch_decoder* decoder);
+
+/**
+ * Start decoding a batch. The batch must outlive the decoded spans.
+ * @param decoder Decoder instance.
+ * @param data Encoded batch.
+ * @param length Size of data in bytes.
+ * @param[out] num_spans Set to the number of spans in the batch.
+ * @return opentracing_span_batch_status_ok on success,
+ *         opentracing_span_batch_status_corrupted if the header is invalid.
+ */
+OPENTRACINGC_EXPORT opentracing_span_batch_status
+opentracing_span_batch_decode_begin(opentracing_span_batch_decoder* decoder,
+                                    const char* data,
+                                    size_t length,
+                                    int* num_spans)
+    OPENTRACINGC_NONNULL(1, 4);
+
+/**
+ * Decode the next span in the batch. Strings point into the batch. Arrays
+ * are owned by the decoder.
+ * @param decoder Decoder instance.
+ * @param[out] span Set to the decoded span, valid until the next call.
+ * @return opentracing_span_batch_status_ok if a span was decoded,
+ *         opentracing_span_batch_status_end after the last span, or an
+ *         error. Errors are sticky until the next batch begins.
+ */
+OPENTRACINGC_EXPORT opentracing_span_batch_status
+opentracing_span_batch_decode_next(opentracing_span_batch_decoder* decoder,
+                                   const opentracing_span_data** span)
+    OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_SPAN_BATCH_H */
@@ -0,0 +1,93 @@
+#ifndef OPENTRACINGC_SPAN_DATA_H
+#define OPENTRACINGC_SPAN_DATA_H
+
+#include <stdint.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/span.h>
+#include <opentracing-c/tracer.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** 128 bit trace ID. The high half is zero for 64 bit trace IDs. */
+typedef struct opentracing_trace_id {
+    /** Most significant 64 bits. */
+    uint64_t high;
+    /** Least significant 64 bits. */
+    uint64_t low;
+} opentracing_trace_id;
+
+/** Reference from a finished span to another span, resolved to IDs. */
+typedef struct opentracing_span_data_reference {
+    /** Reference type. */
+    opentracing_span_reference_type type;
+    /** Trace ID of referenced span. */
+    opentracing_trace_id trace_id;
+    /** Span ID of referenced span. */
+    uint64_t span_id;
+} opentracing_span_data_reference;
+
+/**
+ * Read-only view of a finished span, as handed to reporters.
+ * @attention All pointers are owned by the tracer and only remain valid for
+ *            the duration of the call receiving the span data.
+ */
+typedef struct opentracing_span_data {
+    /** Trace ID. */
+    opentracing_trace_id trace_id;
+
+    /** Span ID. */
+    uint64_t span_id;
+
+    /** Span ID of the parent span, zero for root spans. */
+    uint64_t parent_span_id;
+
+    /** Operation name. */
+    const char* operation_name;
+
+    /** Start time using realtime clock. */
+    opentracing_timestamp start_timestamp;
+
+    /** Time elapsed between start and finish using monotonic clock. */
+    opentracing_duration duration;
+
+    /** Array of references. May be NULL. */
+    const opentracing_span_data_reference* references;
+
+    /**
+     * Number of references. If references is NULL, num_references must be
+     * zero.
+     */
+    int num_references;
+
+    /** Array of tags. May be NULL. */
+    const opentracing_tag* tags;
+
+    /** Number of tags. If tags is NULL, num_tags must be zero. */
+    int num_tags;
+
+    /** Array of log records. May be NULL. */
+    const opentracing_log_record* logs;
+
+    /** Number of log records. If logs is NULL, num_logs must be zero. */
+    int num_logs;
+
+    /**
+     * opentracing_true if the span has no parent in this process, either
+     * because it starts the trace or because its parent was extracted from
+     * a carrier. Its subtree in this process finishes no later than it,
+     * except for follows_from children.
+     */
+    opentracing_bool local_root;
+} opentracing_span_data;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_SPAN_DATA_H */
@@ -0,0 +1,49 @@
+#include <opentracing-c/stats.h>
+
+#include <assert.h>
+
+#include <opentracing-c/internal/stats.h>
+
+void opentracing_get_tracer_stats(opentracing_tracer_stats* stats)
+{
+    assert(stats != NULL);
+    opentracing_stats_merge(stats);
+}
+
+uint64_t opentracing_histogram_quantile(const opentracing_histogram* histogram,
+                                        double quantile)
+{
+    uint64_t total;
+    uint64_t rank;
+    uint64_t seen;
+    int i;
+
+    assert(histogram != NULL);
+    total = 0;
+    for (i = 0; i < OPENTRACINGC_HISTOGRAM_NUM_BUCKETS; i++) {
+        total += histogram->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (!(quantile > 0.0)) {
+        quantile = 0.0;
+    }
+    else if (quantile > 1.0) {
+        quantile = 1.0;
+    }
+
+    /* Smallest sample with at least the requested fraction at or below. */
+    rank = (uint64_t)(quantile * (double) total);
+    if (rank == 0) {
+        rank = 1;
+    }
+    seen = 0;
+    for (i = 0; i < OPENTRACINGC_HISTOGRAM_NUM_BUCKETS - 1; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return ((uint64_t) 1 << (i + 1)) - 1;
+}
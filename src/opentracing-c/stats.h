@@ -0,0 +1,105 @@
+#ifndef OPENTRACINGC_STATS_H
+#define OPENTRACINGC_STATS_H
+
+#include <stdint.h>
+
+#include <opentracing-c/config.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Number of buckets in an opentracing_histogram. */
+#define OPENTRACINGC_HISTOGRAM_NUM_BUCKETS 40
+
+/**
+ * Latency histogram with power-of-two buckets. Bucket i counts samples of at
+ * least 2^i and less than 2^(i + 1) nanoseconds. Bucket zero also counts
+ * samples of zero, and the last bucket counts every longer sample.
+ */
+typedef struct opentracing_histogram {
+    /** Number of samples in each bucket. */
+    uint64_t buckets[OPENTRACINGC_HISTOGRAM_NUM_BUCKETS];
+
+    /** Total number of samples. */
+    uint64_t count;
+
+    /** Sum of all samples in nanoseconds. */
+    uint64_t sum_ns;
+} opentracing_histogram;
+
+/**
+ * Self-telemetry of the tracers and reporters built into opentracing-c,
+ * summed over every instance in the process since it started. Tracers loaded
+ * from other libraries do not contribute.
+ */
+typedef struct opentracing_tracer_stats {
+    /** Spans started by basic tracers, sampled or not. */
+    uint64_t spans_started;
+
+    /** Spans started as part of a sampled trace. */
+    uint64_t spans_sampled;
+
+    /** Sampled spans finished. */
+    uint64_t spans_finished;
+
+    /**
+     * Finished sampled spans lost on their way to export: background
+     * reporting buffers that were full, traces evicted by a tail sampling
+     * reporter to stay within its buffer limit, and spans a socket reporter
+     * could not fit in a datagram or the socket refused.
+     */
+    uint64_t spans_dropped;
+
+    /** Bytes of span batches encoded for export by socket reporters. */
+    uint64_t bytes_encoded;
+
+    /**
+     * Finished spans waiting in background reporting buffers, i.e. pushed
+     * by the threads finishing them but not yet drained by a collector.
+     */
+    uint64_t export_queue_depth;
+
+    /**
+     * Time from a span finishing to it being handed to the reporter, for
+     * tracers using background reporting.
+     */
+    opentracing_histogram finish_to_export;
+
+    /**
+     * Time spent in each reporter call made by a background collector, and
+     * in each reporter flush made when a tracer is closed.
+     */
+    opentracing_histogram flush_duration;
+} opentracing_tracer_stats;
+
+/**
+ * Get a snapshot of the tracer statistics. Counters are kept in per-thread
+ * shards that are only merged here, so recording them adds no contention
+ * between threads. Counters are read one at a time while other threads may
+ * be updating them, so related counters may be slightly out of step.
+ * @param[out] stats Set to the current statistics.
+ */
+OPENTRACINGC_EXPORT void opentracing_get_tracer_stats(
+    opentracing_tracer_stats* stats) OPENTRACINGC_NONNULL_ALL;
+
+/**
+ * Estimate a quantile of a histogram.
+ * @param histogram Histogram instance.
+ * @param quantile Quantile between 0 and 1, e.g. 0.99.
+ * @return Largest sample in nanoseconds the bucket holding the quantile
+ *         can count, capped at 2^OPENTRACINGC_HISTOGRAM_NUM_BUCKETS - 1, or
+ *         zero if the histogram is empty.
+ */
+OPENTRACINGC_EXPORT uint64_t
+opentracing_histogram_quantile(const opentracing_histogram* histogram,
+                               double quantile) OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_STATS_H */
@@ -0,0 +1,643 @@
+#include <opentracing-c/tail_sampling_reporter.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/internal/stats.h>
+
+#define DEFAULT_MAX_BUFFER_BYTES ((size_t) 16 * 1024 * 1024)
+
+/* Both must be powers of two. */
+#define NUM_TRACE_BUCKETS 4096
+#define NUM_DECISIONS 4096
+
+#define COPY_ALIGNMENT 8
+#define COPY_ALIGN(size) \
+    (((size) + (COPY_ALIGNMENT - 1)) & ~((size_t) COPY_ALIGNMENT - 1))
+
+#define ERROR_TAG_KEY "error"
+
+/* Deep copy of a finished span, allocated as a single block. */
+typedef struct buffered_span {
+    opentracing_span_data data;
+    struct buffered_span* next;
+    size_t size;
+} buffered_span;
+
+typedef struct buffered_trace {
+    opentracing_trace_id trace_id;
+    struct buffered_trace* bucket_next;
+    /* Age list, oldest first. Reused for the list of complete traces. */
+    struct buffered_trace* older;
+    struct buffered_trace* newer;
+    /* Newest first. */
+    buffered_span* spans;
+    int num_spans;
+    const opentracing_span_data* local_root;
+    size_t size;
+} buffered_trace;
+
+/* Recent decisions, so spans that finish late follow them. */
+typedef struct trace_decision {
+    opentracing_trace_id trace_id;
+    opentracing_bool valid;
+    opentracing_bool keep;
+} trace_decision;
+
+typedef struct tail_sampling_reporter {
+    opentracing_reporter base;
+    opentracing_reporter* reporter;
+    opentracing_duration latency_threshold;
+    opentracing_bool keep_errors;
+    opentracing_trace_predicate predicate;
+    void* predicate_arg;
+    size_t max_buffer_bytes;
+
+    /* Guards everything below. */
+    pthread_mutex_t mutex;
+    size_t buffer_bytes;
+    buffered_trace* buckets[NUM_TRACE_BUCKETS];
+    buffered_trace* oldest;
+    buffered_trace* newest;
+    trace_decision decisions[NUM_DECISIONS];
+} tail_sampling_reporter;
+
+/* A trace detached from the buffer along with its decision. */
+typedef struct complete_trace {
+    buffered_trace* trace;
+    opentracing_bool keep;
+    const opentracing_span_data** spans;
+} complete_trace;
+
+static size_t hash_trace_id(const opentracing_trace_id* trace_id)
+{
+    return (size_t)(((trace_id->high ^ trace_id->low) *
+                     UINT64_C(0x9E3779B97F4A7C15)) >>
+                    32);
+}
+
+static opentracing_bool trace_id_equal(const opentracing_trace_id* a,
+                                       const opentracing_trace_id* b)
+{
+    return (a->high == b->high && a->low == b->low) ? opentracing_true
+                                                    : opentracing_false;
+}
+
+/* Span copies. */
+
+static size_t value_copy_size(const opentracing_value* value)
+{
+    switch (value->type) {
+    case opentracing_value_string:
+        return (value->value.string_value != NULL)
+                   ? strlen(value->value.string_value) + 1
+                   : 0;
+    case opentracing_value_string_view:
+        return value->value.string_view_value.length + 1;
+    default:
+        return 0;
+    }
+}
+
+static size_t span_copy_size(const opentracing_span_data* data)
+{
+    size_t size;
+    size_t strings;
+    int i;
+    int j;
+
+    size = COPY_ALIGN(sizeof(buffered_span)) +
+           COPY_ALIGN(sizeof(opentracing_span_data_reference) *
+                      data->num_references) +
+           COPY_ALIGN(sizeof(opentracing_tag) * data->num_tags) +
+           COPY_ALIGN(sizeof(opentracing_log_record) * data->num_logs);
+    strings = strlen(data->operation_name) + 1;
+    for (i = 0; i < data->num_tags; i++) {
+        strings += strlen(data->tags[i].key) + 1 +
+                   value_copy_size(&data->tags[i].value);
+    }
+    for (i = 0; i < data->num_logs; i++) {
+        size += COPY_ALIGN(sizeof(opentracing_log_field) *
+                           data->logs[i].num_fields);
+        for (j = 0; j < data->logs[i].num_fields; j++) {
+            strings += strlen(data->logs[i].fields[j].key) + 1 +
+                       value_copy_size(&data->logs[i].fields[j].value);
+        }
+    }
+    return size + strings;
+}
+
+static char* copy_string(char** next, const char* str, size_t len)
+{
+    char* copy;
+
+    copy = *next;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    *next += len + 1;
+    return copy;
+}
+
+static void copy_value(char** next,
+                       opentracing_value* dst,
+                       const opentracing_value* src)
+{
+    *dst = *src;
+    if (src->type == opentracing_value_string &&
+        src->value.string_value != NULL) {
+        dst->value.string_value = copy_string(
+            next, src->value.string_value, strlen(src->value.string_value));
+    }
+    else if (src->type == opentracing_value_string_view) {
+        dst->value.string_view_value.data =
+            copy_string(next,
+                        src->value.string_view_value.data,
+                        src->value.string_view_value.length);
+    }
+}
+
+static buffered_span* span_copy(const opentracing_span_data* data, size_t size)
+{
+    buffered_span* span;
+    opentracing_span_data_reference* references;
+    opentracing_tag* tags;
+    opentracing_log_record* logs;
+    opentracing_log_field* fields;
+    char* next;
+    int i;
+    int j;
+
+    span = (buffered_span*) malloc(size);
+    if (span == NULL) {
+        return NULL;
+    }
+    span->next = NULL;
+    span->size = size;
+    span->data = *data;
+    next = (char*) span + COPY_ALIGN(sizeof(buffered_span));
+
+    references = (opentracing_span_data_reference*) next;
+    next += COPY_ALIGN(sizeof(opentracing_span_data_reference) *
+                       data->num_references);
+    tags = (opentracing_tag*) next;
+    next += COPY_ALIGN(sizeof(opentracing_tag) * data->num_tags);
+    logs = (opentracing_log_record*) next;
+    next += COPY_ALIGN(sizeof(opentracing_log_record) * data->num_logs);
+    for (i = 0; i < data->num_logs; i++) {
+        logs[i] = data->logs[i];
+        logs[i].fields = (opentracing_log_field*) next;
+        next += COPY_ALIGN(sizeof(opentracing_log_field) *
+                           data->logs[i].num_fields);
+    }
+
+    /* Strings follow the arrays. */
+    span->data.operation_name = copy_string(
+        &next, data->operation_name, strlen(data->operation_name));
+    for (i = 0; i < data->num_references; i++) {
+        references[i] = data->references[i];
+    }
+    for (i = 0; i < data->num_tags; i++) {
+        tags[i].key = copy_string(
+            &next, data->tags[i].key, strlen(data->tags[i].key));
+        copy_value(&next, &tags[i].value, &data->tags[i].value);
+    }
+    for (i = 0; i < data->num_logs; i++) {
+        fields = logs[i].fields;
+        for (j = 0; j < data->logs[i].num_fields; j++) {
+            fields[j].key = copy_string(&next,
+                                        data->logs[i].fields[j].key,
+                                        strlen(data->logs[i].fields[j].key));
+            copy_value(&next, &fields[j].value, &data->logs[i].fields[j].value);
+        }
+    }
+    assert((size_t)(next - (char*) span) == size);
+
+    span->data.references = (data->num_references > 0) ? references : NULL;
+    span->data.tags = (data->num_tags > 0) ? tags : NULL;
+    span->data.logs = (data->num_logs > 0) ? logs : NULL;
+    return span;
+}
+
+/* Trace buffer. Called with the mutex held. */
+
+static buffered_trace* find_trace(tail_sampling_reporter* r,
+                                  const opentracing_trace_id* trace_id,
+                                  opentracing_bool create)
+{
+    buffered_trace** bucket;
+    buffered_trace* trace;
+
+    bucket = &r->buckets[hash_trace_id(trace_id) & (NUM_TRACE_BUCKETS - 1)];
+    for (trace = *bucket; trace != NULL; trace = trace->bucket_next) {
+        if (trace_id_equal(&trace->trace_id, trace_id)) {
+            return trace;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    trace = (buffered_trace*) calloc(1, sizeof(buffered_trace));
+    if (trace == NULL) {
+        return NULL;
+    }
+    trace->trace_id = *trace_id;
+    trace->size = sizeof(buffered_trace);
+    r->buffer_bytes += trace->size;
+    trace->bucket_next = *bucket;
+    *bucket = trace;
+    trace->older = r->newest;
+    if (r->newest != NULL) {
+        r->newest->newer = trace;
+    }
+    else {
+        r->oldest = trace;
+    }
+    r->newest = trace;
+    return trace;
+}
+
+static void detach_trace(tail_sampling_reporter* r, buffered_trace* trace)
+{
+    buffered_trace** link;
+
+    link = &r->buckets[hash_trace_id(&trace->trace_id) &
+                       (NUM_TRACE_BUCKETS - 1)];
+    while (*link != trace) {
+        link = &(*link)->bucket_next;
+    }
+    *link = trace->bucket_next;
+    if (trace->older != NULL) {
+        trace->older->newer = trace->newer;
+    }
+    else {
+        r->oldest = trace->newer;
+    }
+    if (trace->newer != NULL) {
+        trace->newer->older = trace->older;
+    }
+    else {
+        r->newest = trace->older;
+    }
+    trace->bucket_next = NULL;
+    trace->older = NULL;
+    trace->newer = NULL;
+    r->buffer_bytes -= trace->size;
+}
+
+static void free_trace(buffered_trace* trace)
+{
+    buffered_span* span;
+    buffered_span* next;
+
+    for (span = trace->spans; span != NULL; span = next) {
+        next = span->next;
+        free(span);
+    }
+    free(trace);
+}
+
+static trace_decision* decision_slot(tail_sampling_reporter* r,
+                                     const opentracing_trace_id* trace_id)
+{
+    return &r->decisions[hash_trace_id(trace_id) & (NUM_DECISIONS - 1)];
+}
+
+static void remember_decision(tail_sampling_reporter* r,
+                              const opentracing_trace_id* trace_id,
+                              opentracing_bool keep)
+{
+    trace_decision* decision;
+
+    decision = decision_slot(r, trace_id);
+    decision->trace_id = *trace_id;
+    decision->valid = opentracing_true;
+    decision->keep = keep;
+}
+
+static const trace_decision*
+find_decision(tail_sampling_reporter* r, const opentracing_trace_id* trace_id)
+{
+    const trace_decision* decision;
+
+    decision = decision_slot(r, trace_id);
+    return (decision->valid && trace_id_equal(&decision->trace_id, trace_id))
+               ? decision
+               : NULL;
+}
+
+/* Make room for size more bytes by discarding the oldest traces. */
+static opentracing_bool
+evict_traces(tail_sampling_reporter* r, const buffered_trace* keep, size_t size)
+{
+    buffered_trace* oldest;
+
+    while (r->buffer_bytes + size > r->max_buffer_bytes) {
+        oldest = r->oldest;
+        if (oldest == keep) {
+            oldest = oldest->newer;
+        }
+        if (oldest == NULL) {
+            return opentracing_false;
+        }
+        detach_trace(r, oldest);
+        remember_decision(r, &oldest->trace_id, opentracing_false);
+        opentracing_stats_add(opentracing_stats_spans_dropped,
+                              (uint64_t) oldest->num_spans);
+        free_trace(oldest);
+    }
+    return opentracing_true;
+}
+
+/* Decisions. */
+
+static opentracing_bool time_value_at_least(const opentracing_time_value* a,
+                                            const opentracing_time_value* b)
+{
+    return (a->tv_sec > b->tv_sec ||
+            (a->tv_sec == b->tv_sec && a->tv_nsec >= b->tv_nsec))
+               ? opentracing_true
+               : opentracing_false;
+}
+
+static opentracing_bool has_error_tag(const opentracing_span_data* data)
+{
+    const opentracing_tag* tag;
+    int i;
+
+    for (i = 0; i < data->num_tags; i++) {
+        tag = &data->tags[i];
+        if (tag->value.type == opentracing_value_bool &&
+            tag->value.value.bool_value &&
+            strcmp(tag->key, ERROR_TAG_KEY) == 0) {
+            return opentracing_true;
+        }
+    }
+    return opentracing_false;
+}
+
+/*
+ * Latency is measured on the local root, or on the longest span for traces
+ * decided before their local root finished.
+ */
+static opentracing_bool should_keep(const tail_sampling_reporter* r,
+                                    const buffered_trace* trace,
+                                    const opentracing_span_data** spans)
+{
+    const opentracing_span_data* root;
+    int i;
+
+    if (r->latency_threshold.value.tv_sec != 0 ||
+        r->latency_threshold.value.tv_nsec != 0) {
+        root = trace->local_root;
+        if (root == NULL) {
+            root = spans[0];
+            for (i = 1; i < trace->num_spans; i++) {
+                if (time_value_at_least(&spans[i]->duration.value,
+                                        &root->duration.value)) {
+                    root = spans[i];
+                }
+            }
+        }
+        if (time_value_at_least(&root->duration.value,
+                                &r->latency_threshold.value)) {
+            return opentracing_true;
+        }
+    }
+    if (r->keep_errors) {
+        for (i = 0; i < trace->num_spans; i++) {
+            if (has_error_tag(spans[i])) {
+                return opentracing_true;
+            }
+        }
+    }
+    return (r->predicate != NULL &&
+            r->predicate(r->predicate_arg, spans, trace->num_spans))
+               ? opentracing_true
+               : opentracing_false;
+}
+
+/*
+ * Detach a trace and decide it. Spans are listed in the order they finished.
+ * Traces that cannot be listed are discarded.
+ */
+static void complete(tail_sampling_reporter* r,
+                     buffered_trace* trace,
+                     complete_trace* result)
+{
+    const buffered_span* span;
+    int i;
+
+    detach_trace(r, trace);
+    result->trace = trace;
+    result->keep = opentracing_false;
+    result->spans = (const opentracing_span_data**) malloc(
+        sizeof(opentracing_span_data*) * trace->num_spans);
+    if (result->spans != NULL) {
+        i = trace->num_spans;
+        for (span = trace->spans; span != NULL; span = span->next) {
+            result->spans[--i] = &span->data;
+        }
+        result->keep = should_keep(r, trace, result->spans);
+    }
+    remember_decision(r, &trace->trace_id, result->keep);
+}
+
+/* Forward or discard a complete trace. Called without the mutex. */
+static void forward(tail_sampling_reporter* r, complete_trace* result)
+{
+    if (result->keep) {
+        r->reporter->report(
+            r->reporter, result->spans, result->trace->num_spans);
+    }
+    free((void*) result->spans);
+    free_trace(result->trace);
+}
+
+/* Reporter. */
+
+static void
+tail_sampling_reporter_report(opentracing_reporter* reporter,
+                              const opentracing_span_data* const* spans,
+                              int num_spans)
+{
+    tail_sampling_reporter* r;
+    const trace_decision* decision;
+    buffered_trace* trace;
+    buffered_span* span;
+    const opentracing_span_data** late;
+    complete_trace* completed;
+    int num_late;
+    int num_completed;
+    int num_dropped;
+    size_t size;
+    size_t needed;
+    int i;
+
+    assert(reporter != NULL);
+    assert(spans != NULL || num_spans == 0);
+    r = (tail_sampling_reporter*) reporter;
+    late = NULL;
+    completed = NULL;
+    num_late = 0;
+    num_completed = 0;
+    num_dropped = 0;
+
+    pthread_mutex_lock(&r->mutex);
+    for (i = 0; i < num_spans; i++) {
+        decision = find_decision(r, &spans[i]->trace_id);
+        if (decision != NULL) {
+            if (!decision->keep) {
+                continue;
+            }
+            if (late == NULL) {
+                late = (const opentracing_span_data**) malloc(
+                    sizeof(opentracing_span_data*) * num_spans);
+                if (late == NULL) {
+                    num_dropped++;
+                    continue;
+                }
+            }
+            late[num_late++] = spans[i];
+            continue;
+        }
+
+        /*
+         * Spans that do not fit even in an empty buffer are dropped. A new
+         * trace also needs room for its own bookkeeping.
+         */
+        size = span_copy_size(spans[i]);
+        if (size + sizeof(buffered_trace) > r->max_buffer_bytes) {
+            num_dropped++;
+            continue;
+        }
+        trace = find_trace(r, &spans[i]->trace_id, opentracing_false);
+        needed = (trace == NULL) ? size + sizeof(buffered_trace) : size;
+        if (!evict_traces(r, trace, needed)) {
+            num_dropped++;
+            continue;
+        }
+        span = span_copy(spans[i], size);
+        if (span == NULL) {
+            num_dropped++;
+            continue;
+        }
+        if (trace == NULL) {
+            trace = find_trace(r, &spans[i]->trace_id, opentracing_true);
+            if (trace == NULL) {
+                free(span);
+                num_dropped++;
+                continue;
+            }
+        }
+        span->next = trace->spans;
+        trace->spans = span;
+        trace->num_spans++;
+        trace->size += size;
+        r->buffer_bytes += size;
+        if (!spans[i]->local_root) {
+            continue;
+        }
+
+        trace->local_root = &span->data;
+        if (completed == NULL) {
+            completed =
+                (complete_trace*) malloc(sizeof(complete_trace) * num_spans);
+            if (completed == NULL) {
+                /* Left for eviction or flush. */
+                continue;
+            }
+        }
+        complete(r, trace, &completed[num_completed++]);
+    }
+    pthread_mutex_unlock(&r->mutex);
+
+    if (num_dropped > 0) {
+        opentracing_stats_add(opentracing_stats_spans_dropped,
+                              (uint64_t) num_dropped);
+    }
+    if (num_late > 0) {
+        r->reporter->report(r->reporter, late, num_late);
+    }
+    for (i = 0; i < num_completed; i++) {
+        forward(r, &completed[i]);
+    }
+    free((void*) late);
+    free(completed);
+}
+
+static void tail_sampling_reporter_flush(opentracing_reporter* reporter)
+{
+    tail_sampling_reporter* r;
+    complete_trace result;
+
+    assert(reporter != NULL);
+    r = (tail_sampling_reporter*) reporter;
+    for (;;) {
+        pthread_mutex_lock(&r->mutex);
+        if (r->oldest == NULL) {
+            pthread_mutex_unlock(&r->mutex);
+            break;
+        }
+        complete(r, r->oldest, &result);
+        pthread_mutex_unlock(&r->mutex);
+        forward(r, &result);
+    }
+    r->reporter->flush(r->reporter);
+}
+
+static void
+tail_sampling_reporter_destroy(opentracing_destructible* destructible)
+{
+    tail_sampling_reporter* r;
+    buffered_trace* trace;
+
+    assert(destructible != NULL);
+    r = (tail_sampling_reporter*) destructible;
+    while (r->oldest != NULL) {
+        trace = r->oldest;
+        detach_trace(r, trace);
+        free_trace(trace);
+    }
+    ((opentracing_destructible*) r->reporter)
+        ->destroy((opentracing_destructible*) r->reporter);
+    pthread_mutex_destroy(&r->mutex);
+    free(r);
+}
+
+opentracing_reporter* opentracing_make_tail_sampling_reporter(
+    const opentracing_tail_sampling_options* options)
+{
+    tail_sampling_reporter* r;
+
+    assert(options != NULL);
+    if (options->reporter == NULL) {
+        return NULL;
+    }
+    r = (tail_sampling_reporter*) calloc(1, sizeof(tail_sampling_reporter));
+    if (r == NULL) {
+        ((opentracing_destructible*) options->reporter)
+            ->destroy((opentracing_destructible*) options->reporter);
+        return NULL;
+    }
+    if (pthread_mutex_init(&r->mutex, NULL) != 0) {
+        free(r);
+        ((opentracing_destructible*) options->reporter)
+            ->destroy((opentracing_destructible*) options->reporter);
+        return NULL;
+    }
+    ((opentracing_destructible*) r)->destroy = &tail_sampling_reporter_destroy;
+    ((opentracing_reporter*) r)->report = &tail_sampling_reporter_report;
+    ((opentracing_reporter*) r)->flush = &tail_sampling_reporter_flush;
+    r->reporter = options->reporter;
+    r->latency_threshold = options->latency_threshold;
+    r->keep_errors = options->keep_errors;
+    r->predicate = options->predicate;
+    r->predicate_arg = options->predicate_arg;
+    r->max_buffer_bytes = (options->max_buffer_bytes > 0)
+                              ? options->max_buffer_bytes
+                              : DEFAULT_MAX_BUFFER_BYTES;
+    return (opentracing_reporter*) r;
+}
@@ -0,0 +1,91 @@
+#ifndef OPENTRACINGC_TAIL_SAMPLING_REPORTER_H
+#define OPENTRACINGC_TAIL_SAMPLING_REPORTER_H
+
+#include <stddef.h>
+
+#include <opentracing-c/common.h>
+#include <opentracing-c/config.h>
+#include <opentracing-c/reporter.h>
+#include <opentracing-c/span_data.h>
+#include <opentracing-c/visibility.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Custom trace predicate.
+ * @param arg User-supplied argument.
+ * @param spans Finished spans of the trace in this process.
+ * @param num_spans Number of spans in array.
+ * @return opentracing_true to keep the trace, opentracing_false otherwise.
+ */
+typedef opentracing_bool (*opentracing_trace_predicate)(
+    void* arg, const opentracing_span_data* const* spans, int num_spans);
+
+/** Options used when calling opentracing_make_tail_sampling_reporter(). */
+typedef struct opentracing_tail_sampling_options {
+    /**
+     * Reporter that receives the spans of kept traces. The tail sampling
+     * reporter takes ownership of it and destroys it when destroyed, or
+     * before opentracing_make_tail_sampling_reporter() returns NULL.
+     */
+    opentracing_reporter* reporter;
+
+    /**
+     * Traces whose local root span took at least this long are kept. Zero
+     * disables the latency check.
+     */
+    opentracing_duration latency_threshold;
+
+    /**
+     * If opentracing_true, traces with a span tagged error=true are kept.
+     */
+    opentracing_bool keep_errors;
+
+    /**
+     * Called for traces that neither check keeps. Runs with the reporter's
+     * lock held, so it must be quick and must not report spans. May be NULL,
+     * in which case those traces are discarded.
+     */
+    opentracing_trace_predicate predicate;
+
+    /** Argument passed to predicate. */
+    void* predicate_arg;
+
+    /**
+     * Maximum memory in bytes used by buffered spans and traces. Once
+     * reached, the oldest undecided traces are discarded to make room. Zero
+     * selects the default of 16 MiB.
+     */
+    size_t max_buffer_bytes;
+} opentracing_tail_sampling_options;
+
+/**
+ * Create a reporter that buffers finished spans by trace and decides
+ * whether to keep each trace once it is complete in this process. A trace
+ * is complete when its local root span finishes (see
+ * opentracing_span_data::local_root). The whole trace is then forwarded to
+ * the wrapped reporter or discarded. Spans that finish after the decision,
+ * such as follows_from children, follow it while it is still remembered.
+ *
+ * Head sampling still applies, so the tracer should sample every trace that
+ * tail sampling may need to keep. Flushing decides undecided traces on the
+ * spans received so far, then flushes the wrapped reporter. The reporter is
+ * safe to call from multiple threads.
+ * @param options Reporter options.
+ * @return New reporter on success, NULL if no wrapped reporter is given or
+ *         if out of memory, in which case the wrapped reporter has been
+ *         destroyed. Destroy using the opentracing_destructible interface.
+ */
+OPENTRACINGC_EXPORT opentracing_reporter*
+opentracing_make_tail_sampling_reporter(
+    const opentracing_tail_sampling_options* options) OPENTRACINGC_NONNULL_ALL;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_TAIL_SAMPLING_REPORTER_H */
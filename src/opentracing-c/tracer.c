@@ -1,6 +1,10 @@
 #include <opentracing-c/tracer.h>
 
 #include <assert.h>
+#include <string.h>
+
+#include <opentracing-c/internal/atomic.h>
+#include <opentracing-c/internal/epoch.h>
 
 static void noop_destroy(opentracing_destructible* destructible)
 {
@@ -23,8 +27,20 @@ static void noop_foreach_baggage_item(opentracing_span_context* span_context,
     (void) arg;
 }
 
+/* The singleton is immortal: retain and destroy do not count references. */
+static opentracing_span_context*
+noop_span_context_retain(opentracing_span_context* span_context)
+{
+    return span_context;
+}
+
 static opentracing_span_context noop_span_context_singleton = {
-    NOOP_DESTRUCTIBLE_INIT, &noop_foreach_baggage_item, NULL, 0};
+    NOOP_DESTRUCTIBLE_INIT,
+    OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span_context),
+    &noop_foreach_baggage_item,
+    NULL,
+    0,
+    &noop_span_context_retain};
 
 typedef struct noop_span {
     opentracing_span base;
@@ -95,25 +111,67 @@ static const char* noop_span_baggage_item(const opentracing_span* span,
     return empty_str;
 }
 
+static void noop_span_set_tags(opentracing_span* span,
+                               const opentracing_tag* tags,
+                               int num_tags)
+{
+    (void) span;
+    (void) tags;
+    (void) num_tags;
+}
+
+static void noop_span_set_tag_interned(opentracing_span* span,
+                                       opentracing_string_handle key,
+                                       const opentracing_value* value)
+{
+    (void) span;
+    (void) key;
+    (void) value;
+}
+
+static void
+noop_span_log_fields_interned(opentracing_span* span,
+                              const opentracing_interned_log_field* fields,
+                              int num_fields)
+{
+    (void) span;
+    (void) fields;
+    (void) num_fields;
+}
+
+static void noop_span_log_records(opentracing_span* span,
+                                  const opentracing_log_record* records,
+                                  int num_records)
+{
+    (void) span;
+    (void) records;
+    (void) num_records;
+}
+
 static opentracing_tracer* noop_span_tracer(const opentracing_span* span)
 {
     assert(span != NULL);
     return ((const noop_span*) span)->tracer_ptr;
 }
 
-#define NOOP_SPAN_INIT                   \
-    {                                    \
-        {NOOP_DESTRUCTIBLE_INIT,         \
-         &noop_span_finish,              \
-         &noop_span_finish_with_options, \
-         &noop_span_span_context,        \
-         &noop_span_set_operation_name,  \
-         &noop_span_set_tag,             \
-         &noop_span_log_fields,          \
-         &noop_span_set_baggage_item,    \
-         &noop_span_baggage_item,        \
-         &noop_span_tracer},             \
-            NULL                         \
+#define NOOP_SPAN_INIT                                      \
+    {                                                       \
+        {NOOP_DESTRUCTIBLE_INIT,                            \
+         OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_span), \
+         &noop_span_finish,                                 \
+         &noop_span_finish_with_options,                    \
+         &noop_span_span_context,                           \
+         &noop_span_set_operation_name,                     \
+         &noop_span_set_tag,                                \
+         &noop_span_log_fields,                             \
+         &noop_span_set_baggage_item,                       \
+         &noop_span_baggage_item,                           \
+         &noop_span_tracer,                                 \
+         &noop_span_set_tags,                               \
+         &noop_span_log_records,                            \
+         &noop_span_set_tag_interned,                       \
+         &noop_span_log_fields_interned},                   \
+            NULL                                            \
     }
 
 static noop_span noop_span_singleton = NOOP_SPAN_INIT;
@@ -139,6 +197,15 @@ static opentracing_span* noop_tracer_start_span_with_options(
     return (opentracing_span*) span;
 }
 
+static opentracing_span*
+noop_tracer_start_span_interned(opentracing_tracer* tracer,
+                                opentracing_string_handle operation_name,
+                                const opentracing_start_span_options* options)
+{
+    (void) operation_name;
+    return noop_tracer_start_span_with_options(tracer, "", options);
+}
+
 static opentracing_span* noop_tracer_start_span(opentracing_tracer* tracer,
                                                 const char* operation_name)
 {
@@ -211,32 +278,187 @@ noop_tracer_extract_binary(opentracing_tracer* tracer,
     return opentracing_propagation_error_code_success;
 }
 
+static opentracing_propagation_error_code
+noop_tracer_inject_binary_buffer(opentracing_tracer* tracer,
+                                 char* buffer,
+                                 size_t capacity,
+                                 size_t* length,
+                                 const opentracing_span_context* span_context)
+{
+    (void) tracer;
+    (void) buffer;
+    (void) capacity;
+    (void) span_context;
+    assert(length != NULL);
+    *length = 0;
+    return opentracing_propagation_error_code_success;
+}
+
+static opentracing_propagation_error_code
+noop_tracer_extract_binary_buffer(opentracing_tracer* tracer,
+                                  const char* data,
+                                  size_t length,
+                                  opentracing_span_context** span_context)
+{
+    (void) tracer;
+    (void) data;
+    (void) length;
+    assert(span_context != NULL);
+    *span_context = &noop_span_context_singleton;
+    return opentracing_propagation_error_code_success;
+}
+
 #define NOOP_TRACER_INIT                                                      \
     {                                                                         \
-        NOOP_DESTRUCTIBLE_INIT, &noop_tracer_close, &noop_tracer_start_span,  \
+        NOOP_DESTRUCTIBLE_INIT,                                               \
+            OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_tracer),              \
+            &noop_tracer_close, &noop_tracer_start_span,                      \
             &noop_tracer_start_span_with_options,                             \
             &noop_tracer_inject_text_map, &noop_tracer_inject_http_headers,   \
             &noop_tracer_inject_binary, &noop_tracer_inject_custom_carrier,   \
             &noop_tracer_extract_text_map, &noop_tracer_extract_http_headers, \
-            &noop_tracer_extract_binary, &noop_tracer_extract_custom_carrier  \
+            &noop_tracer_extract_binary, &noop_tracer_extract_custom_carrier, \
+            &noop_tracer_start_span_interned,                                 \
+            &noop_tracer_inject_binary_buffer,                                \
+            &noop_tracer_extract_binary_buffer                                \
     }
 
 static opentracing_tracer noop_tracer_singleton = NOOP_TRACER_INIT;
 static opentracing_tracer* global_tracer = &noop_tracer_singleton;
 
+opentracing_span* opentracing_tracer_start_span_interned(
+    opentracing_tracer* tracer,
+    opentracing_string_handle operation_name,
+    const opentracing_start_span_options* options)
+{
+    const char* name;
+
+    assert(tracer != NULL);
+    if (OPENTRACINGC_TRACER_HAS(tracer, start_span_interned)) {
+        return tracer->start_span_interned(tracer, operation_name, options);
+    }
+    name = opentracing_interned_string(operation_name);
+    if (name == NULL) {
+        return NULL;
+    }
+    return tracer->start_span_with_options(tracer, name, options);
+}
+
+typedef struct binary_buffer {
+    char* data;
+    size_t capacity;
+    size_t length;
+} binary_buffer;
+
+/* Keeps counting past the end so the caller learns the size needed. */
+static int binary_buffer_write(void* arg, const char* data, size_t len)
+{
+    binary_buffer* buffer;
+
+    buffer = (binary_buffer*) arg;
+    if (buffer->length <= buffer->capacity &&
+        len <= buffer->capacity - buffer->length) {
+        memcpy(buffer->data + buffer->length, data, len);
+    }
+    buffer->length += len;
+    return 0;
+}
+
+static int binary_buffer_read(void* arg, char* data, size_t len)
+{
+    binary_buffer* buffer;
+
+    buffer = (binary_buffer*) arg;
+    if (len > buffer->capacity - buffer->length) {
+        len = buffer->capacity - buffer->length;
+    }
+    if (len > 0) {
+        memcpy(data, buffer->data + buffer->length, len);
+    }
+    buffer->length += len;
+    return (int) len;
+}
+
+opentracing_propagation_error_code opentracing_tracer_inject_binary_buffer(
+    opentracing_tracer* tracer,
+    char* buffer,
+    size_t capacity,
+    size_t* length,
+    const opentracing_span_context* span_context)
+{
+    opentracing_propagation_error_code return_code;
+    binary_buffer writer;
+
+    assert(tracer != NULL);
+    assert(length != NULL);
+    if (OPENTRACINGC_TRACER_HAS(tracer, inject_binary_buffer)) {
+        return tracer->inject_binary_buffer(
+            tracer, buffer, capacity, length, span_context);
+    }
+    writer.data = buffer;
+    writer.capacity = capacity;
+    writer.length = 0;
+    return_code = tracer->inject_binary(
+        tracer, &binary_buffer_write, &writer, span_context);
+    *length = writer.length;
+    if (return_code == opentracing_propagation_error_code_success &&
+        writer.length > capacity) {
+        return opentracing_propagation_error_code_invalid_carrier;
+    }
+    return return_code;
+}
+
+opentracing_propagation_error_code opentracing_tracer_extract_binary_buffer(
+    opentracing_tracer* tracer,
+    const char* data,
+    size_t length,
+    opentracing_span_context** span_context)
+{
+    binary_buffer reader;
+
+    assert(tracer != NULL);
+    assert(span_context != NULL);
+    if (OPENTRACINGC_TRACER_HAS(tracer, extract_binary_buffer)) {
+        return tracer->extract_binary_buffer(
+            tracer, data, length, span_context);
+    }
+    /* The read callback never writes through data. */
+    reader.data = (char*) data;
+    reader.capacity = length;
+    reader.length = 0;
+    return tracer->extract_binary(
+        tracer, &binary_buffer_read, &reader, span_context);
+}
+
 opentracing_tracer* opentracing_global_tracer(void)
 {
-    return global_tracer;
+    return OPENTRACINGC_ATOMIC_LOAD(&global_tracer,
+                                    OPENTRACINGC_ATOMIC_ACQUIRE);
+}
+
+opentracing_tracer* opentracing_global_tracer_acquire(void)
+{
+    opentracing_epoch_enter();
+    return OPENTRACINGC_ATOMIC_LOAD(&global_tracer,
+                                    OPENTRACINGC_ATOMIC_SEQ_CST);
+}
+
+void opentracing_global_tracer_release(void)
+{
+    opentracing_epoch_exit();
 }
 
 void opentracing_init_global_tracer(opentracing_tracer* tracer)
 {
+    opentracing_tracer* old_tracer;
+
     assert(tracer != NULL);
-    assert(global_tracer != NULL);
-    if (global_tracer == tracer) {
+    old_tracer = OPENTRACINGC_ATOMIC_EXCHANGE(
+        &global_tracer, tracer, OPENTRACINGC_ATOMIC_SEQ_CST);
+    assert(old_tracer != NULL);
+    if (old_tracer == tracer) {
         return;
     }
-    ((opentracing_destructible*) global_tracer)
-        ->destroy((opentracing_destructible*) global_tracer);
-    global_tracer = tracer;
+    /* Readers that acquired the old tracer keep it until they release it. */
+    opentracing_epoch_retire((opentracing_destructible*) old_tracer);
 }
@@ -5,6 +5,7 @@
 #include <opentracing-c/propagation.h>
 #include <opentracing-c/span.h>
 #include <opentracing-c/visibility.h>
+#include <opentracing-c/vtable.h>
 
 /** @file */
 
@@ -12,14 +13,6 @@
 extern "C" {
 #endif /* __cplusplus */
 
-/** Simple tag representation. */
-typedef struct opentracing_tag {
-    /** String key. */
-    char* key;
-    /** Generic value type. */
-    opentracing_value value;
-} opentracing_tag;
-
 /** Options used when calling start_span_with_options(). */
 typedef struct opentracing_start_span_options {
     /**
@@ -62,6 +55,12 @@ typedef struct opentracing_tracer {
     /** Base class member. */
     opentracing_destructible base;
 
+    /**
+     * Layout of this interface the implementation was compiled against.
+     * Initialize with OPENTRACINGC_VTABLE_HEADER_INIT(opentracing_tracer).
+     */
+    opentracing_vtable_header header;
+
     /**
      * Close the tracer. This may do nothing, flush pending spans, or whatever
      * else a tracing implementation decides close should mean. If not called
@@ -229,10 +228,129 @@ typedef struct opentracing_tracer {
         struct opentracing_tracer* tracer,
         opentracing_custom_carrier_reader* carrier,
         opentracing_span_context** span_context) OPENTRACINGC_NONNULL_ALL;
+
+    /**
+     * Like start_span_with_options() but with an interned operation name.
+     * The tracer may keep the handle or the interned string instead of
+     * copying the name.
+     * @attention Optional slot added in vtable version 3. Call through
+     *            opentracing_tracer_start_span_interned() unless the slot is
+     *            known to exist.
+     * @param tracer Tracer instance.
+     * @param operation_name Handle of operation name.
+     * @param options Options to override default span initialization values.
+     *                May be NULL.
+     * @return Span pointer on success, NULL otherwise.
+     */
+    opentracing_span* (*start_span_interned)(
+        struct opentracing_tracer* tracer,
+        opentracing_string_handle operation_name,
+        const opentracing_start_span_options* options) OPENTRACINGC_NONNULL(1);
+
+    /**
+     * Inject span context into a caller-provided buffer in a single call.
+     * @attention Optional slot added in vtable version 5. Call through
+     *            opentracing_tracer_inject_binary_buffer() unless the slot is
+     *            known to exist.
+     * @param tracer Tracer instance.
+     * @param buffer Output buffer. May be NULL if capacity is zero.
+     * @param capacity Size of buffer in bytes.
+     * @param[out] length Set to the number of bytes the encoding needs, even
+     *                    if buffer is too small.
+     * @param span_context Span context to serialize.
+     * @return opentracing_propagation_error_code_invalid_carrier if buffer is
+     *         too small, otherwise as for inject_binary().
+     */
+    opentracing_propagation_error_code (*inject_binary_buffer)(
+        struct opentracing_tracer* tracer,
+        char* buffer,
+        size_t capacity,
+        size_t* length,
+        const opentracing_span_context* span_context)
+        OPENTRACINGC_NONNULL(1, 4, 5);
+
+    /**
+     * Extract span context from a buffer in a single call.
+     * @attention Optional slot added in vtable version 5. Call through
+     *            opentracing_tracer_extract_binary_buffer() unless the slot
+     *            is known to exist.
+     * @param tracer Tracer instance.
+     * @param data Data written by inject_binary() or inject_binary_buffer().
+     * @param length Size of data in bytes.
+     * @param[out] span_context Span context pointer to return decoded span.
+     *                          Set to NULL on propagation failure or out of
+     *                          memory.
+     * @return Error code indicating success or failure.
+     */
+    opentracing_propagation_error_code (*extract_binary_buffer)(
+        struct opentracing_tracer* tracer,
+        const char* data,
+        size_t length,
+        opentracing_span_context** span_context) OPENTRACINGC_NONNULL(1, 4);
 } opentracing_tracer;
 
 /**
- * Get the tracer singleton. At process start, set to a no-op tracer.
+ * Check whether a tracer implementation provides a slot.
+ * @see OPENTRACINGC_VTABLE_HAS
+ */
+#define OPENTRACINGC_TRACER_HAS(tracer, slot) \
+    OPENTRACINGC_VTABLE_HAS(opentracing_tracer, tracer, slot)
+
+/**
+ * Call start_span_interned() if the tracer provides it, otherwise call
+ * start_span_with_options() with the interned string.
+ * @param tracer Tracer instance.
+ * @param operation_name Handle of operation name.
+ * @param options Span options. May be NULL.
+ * @return Span pointer on success, NULL otherwise, including if the handle
+ *         is invalid.
+ */
+OPENTRACINGC_EXPORT opentracing_span* opentracing_tracer_start_span_interned(
+    opentracing_tracer* tracer,
+    opentracing_string_handle operation_name,
+    const opentracing_start_span_options* options) OPENTRACINGC_NONNULL(1);
+
+/**
+ * Call inject_binary_buffer() if the tracer provides it, otherwise adapt
+ * inject_binary() to write into the buffer.
+ * @param tracer Tracer instance.
+ * @param buffer Output buffer. May be NULL if capacity is zero.
+ * @param capacity Size of buffer in bytes.
+ * @param[out] length Set to the number of bytes the encoding needs.
+ * @param span_context Span context to serialize.
+ * @return Error code indicating success or failure.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_tracer_inject_binary_buffer(
+    opentracing_tracer* tracer,
+    char* buffer,
+    size_t capacity,
+    size_t* length,
+    const opentracing_span_context* span_context)
+    OPENTRACINGC_NONNULL(1, 4, 5);
+
+/**
+ * Call extract_binary_buffer() if the tracer provides it, otherwise adapt
+ * extract_binary() to read from the buffer.
+ * @param tracer Tracer instance.
+ * @param data Encoded span context.
+ * @param length Size of data in bytes.
+ * @param[out] span_context Span context pointer to return decoded span.
+ * @return Error code indicating success or failure.
+ */
+OPENTRACINGC_EXPORT opentracing_propagation_error_code
+opentracing_tracer_extract_binary_buffer(
+    opentracing_tracer* tracer,
+    const char* data,
+    size_t length,
+    opentracing_span_context** span_context) OPENTRACINGC_NONNULL(1, 4);
+
+/**
+ * Get the tracer singleton. At process start, set to a no-op tracer. This is
+ * a single atomic load. The tracer returned may be destroyed as soon as it is
+ * replaced, so code that can run concurrently with
+ * opentracing_init_global_tracer() should use
+ * opentracing_global_tracer_acquire() instead.
  * @return Global tracer instance.
  * @attention Do not modify members.
  * @see opentracing_init_global_tracer()
@@ -240,10 +358,37 @@ typedef struct opentracing_tracer {
 OPENTRACINGC_EXPORT opentracing_tracer* opentracing_global_tracer(void);
 
 /**
- * Install a global tracer. Ideally, only called once. Good candidate for use
- * of pthread_once.
+ * Get the tracer singleton and keep it alive until the matching call to
+ * opentracing_global_tracer_release() on the same thread. This is the
+ * accessor for code that traces while the tracer may be swapped: it enters
+ * an epoch read section, which only touches a per-thread record, and loads
+ * the tracer once. If the global tracer is replaced in the meantime,
+ * destroying the old tracer is deferred until every thread holding it has
+ * released it. Calls may nest. Spans started from the tracer must be
+ * destroyed before it is released. OPENTRACINGC_START_GLOBAL_SPAN() and
+ * opentracingc::Tracer::global() use this.
+ * @return Global tracer instance.
+ * @attention Do not modify members.
+ * @see opentracing_global_tracer_release()
+ */
+OPENTRACINGC_EXPORT opentracing_tracer* opentracing_global_tracer_acquire(void);
+
+/**
+ * Release the tracer returned by opentracing_global_tracer_acquire(). The
+ * tracer must not be used after this call.
+ * @see opentracing_global_tracer_acquire()
+ */
+OPENTRACINGC_EXPORT void opentracing_global_tracer_release(void);
+
+/**
+ * Install a global tracer. Safe to call while other threads are using the
+ * global tracer through opentracing_global_tracer_acquire(). The previous
+ * tracer is destroyed once no thread holds it, immediately if possible and
+ * otherwise by the last thread to release it. A replaced tracer must not be
+ * installed again, except the no-op tracer set at process start, which is
+ * never destroyed.
  * @param tracer New global tracer instance.
- * @see opentracing_global_tracer()
+ * @see opentracing_global_tracer_acquire()
  */
 OPENTRACINGC_EXPORT void opentracing_init_global_tracer(
     opentracing_tracer* tracer) OPENTRACINGC_NONNULL_ALL;
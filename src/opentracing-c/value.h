@@ -1,6 +1,7 @@
 #ifndef OPENTRACINGC_VALUE_H
 #define OPENTRACINGC_VALUE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <opentracing-c/common.h>
@@ -21,9 +22,22 @@ typedef enum opentracing_value_type {
     opentracing_value_int64,
     opentracing_value_uint64,
     opentracing_value_string,
-    opentracing_value_null
+    opentracing_value_null,
+    opentracing_value_string_view
 } opentracing_value_type;
 
+/**
+ * String with explicit length. Unlike opentracing_value_string, the data
+ * need not be null-terminated, so values can point directly into a larger
+ * buffer, e.g. a parsed request, without being copied first.
+ */
+typedef struct opentracing_string_view {
+    /** Pointer to the first character. May be NULL if length is zero. */
+    const char* data;
+    /** Number of characters. */
+    size_t length;
+} opentracing_string_view;
+
 /**
  * Tagged union that can represent a number of value types.
  */
@@ -42,6 +56,8 @@ typedef struct opentracing_value {
         uint64_t uint64_value;
         /** Storage for string value. */
         const char* string_value;
+        /** Storage for string view value. */
+        opentracing_string_view string_view_value;
     } value;
 } opentracing_value;
 
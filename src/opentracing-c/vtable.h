@@ -0,0 +1,79 @@
+#ifndef OPENTRACINGC_VTABLE_H
+#define OPENTRACINGC_VTABLE_H
+
+#include <stddef.h>
+
+#include <opentracing-c/config.h>
+
+/** @file */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Revision of the interface layouts declared by this version of
+ * opentracing-c. Incremented whenever slots are appended to
+ * opentracing_tracer, opentracing_span, opentracing_span_context or
+ * opentracing_text_map_reader.
+ *
+ * Version history:
+ *   - 1: Initial layout.
+ *   - 2: opentracing_span set_tags and log_records.
+ *   - 3: opentracing_span set_tag_interned and log_fields_interned,
+ *        opentracing_tracer start_span_interned.
+ *   - 4: opentracing_value_string_view values, which slots taking an
+ *        opentracing_value may now receive.
+ *   - 5: opentracing_tracer inject_binary_buffer and
+ *        extract_binary_buffer.
+ *   - 6: opentracing_text_map_reader header and get.
+ *   - 7: opentracing_span_context retain.
+ */
+#define OPENTRACINGC_VTABLE_VERSION 7
+
+/**
+ * Layout information every interface stores directly after its base member.
+ * Implementations record the layout they were compiled against, so slots
+ * appended to an interface in later versions can be detected at runtime
+ * instead of being read past the end of an older implementation's struct.
+ */
+typedef struct opentracing_vtable_header {
+    /**
+     * Size in bytes of the interface struct (not the implementation's
+     * derived struct) the implementation was compiled against.
+     */
+    size_t size;
+
+    /** Value of OPENTRACINGC_VTABLE_VERSION the implementation used. */
+    int version;
+} opentracing_vtable_header;
+
+/**
+ * Initializer for the header of an interface.
+ * @param type Interface type, e.g. opentracing_span.
+ */
+#define OPENTRACINGC_VTABLE_HEADER_INIT(type)      \
+    {                                              \
+        sizeof(type), OPENTRACINGC_VTABLE_VERSION \
+    }
+
+/**
+ * Check whether an implementation provides a slot. Optional slots lie
+ * beyond the end of older layouts and may be NULL in newer ones, so callers
+ * must check before calling them and fall back to the required slots
+ * otherwise. Evaluates object more than once.
+ * @param type Interface type, e.g. opentracing_span.
+ * @param object Pointer to interface instance.
+ * @param slot Slot member name.
+ * @return Nonzero if the slot may be called.
+ */
+#define OPENTRACINGC_VTABLE_HAS(type, object, slot)                  \
+    (((const type*) (object))->header.size >=                       \
+         offsetof(type, slot) + sizeof(((const type*) 0)->slot) &&  \
+     ((const type*) (object))->slot != NULL)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OPENTRACINGC_VTABLE_H */
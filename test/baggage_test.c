@@ -0,0 +1,127 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <opentracing-c/baggage.h>
+
+#define NUM_MANY_ITEMS 100
+
+static opentracing_baggage* with_item(const opentracing_baggage* baggage,
+                                      const char* key,
+                                      const char* value)
+{
+    opentracing_baggage* result;
+    result = opentracing_baggage_with_item(
+        baggage, key, strlen(key), value, strlen(value));
+    assert(result != NULL);
+    return result;
+}
+
+static opentracing_bool
+append_item(void* arg, const char* key, const char* value)
+{
+    strcat((char*) arg, key);
+    strcat((char*) arg, "=");
+    strcat((char*) arg, value);
+    strcat((char*) arg, ";");
+    return opentracing_true;
+}
+
+static opentracing_bool stop_early(void* arg, const char* key, const char* value)
+{
+    (void) key;
+    (void) value;
+    (*(int*) arg)++;
+    return opentracing_false;
+}
+
+static void test_copy_on_write(void)
+{
+    opentracing_baggage* parent;
+    opentracing_baggage* child;
+    opentracing_string_view key;
+    opentracing_string_view value;
+    char items[64];
+    int count;
+
+    assert(opentracing_baggage_size(NULL) == 0);
+    assert(opentracing_baggage_get(NULL, "user") == NULL);
+    assert(opentracing_baggage_retain(NULL) == NULL);
+    opentracing_baggage_release(NULL);
+
+    parent = with_item(NULL, "user", "alice");
+    child = with_item(parent, "region", "eu");
+    assert(opentracing_baggage_size(parent) == 1);
+    assert(opentracing_baggage_get(parent, "region") == NULL);
+    assert(opentracing_baggage_size(child) == 2);
+    assert(strcmp(opentracing_baggage_get(child, "user"), "alice") == 0);
+
+    /* Replacing keeps the position, and the parent is unchanged. */
+    opentracing_baggage_release(parent);
+    parent = child;
+    child = with_item(parent, "user", "bob");
+    assert(opentracing_baggage_size(child) == 2);
+    items[0] = '\0';
+    opentracing_baggage_foreach(child, &append_item, items);
+    assert(strcmp(items, "user=bob;region=eu;") == 0);
+    items[0] = '\0';
+    opentracing_baggage_foreach(parent, &append_item, items);
+    assert(strcmp(items, "user=alice;region=eu;") == 0);
+    count = 0;
+    opentracing_baggage_foreach(child, &stop_early, &count);
+    assert(count == 1);
+
+    /* Sharing is reference counted. */
+    assert(opentracing_baggage_retain(child) == child);
+    opentracing_baggage_release(child);
+    opentracing_baggage_item(child, 1, &key, &value);
+    assert(key.length == 6 && strcmp(key.data, "region") == 0);
+    assert(value.length == 2 && strcmp(value.data, "eu") == 0);
+    opentracing_baggage_release(child);
+    opentracing_baggage_release(parent);
+
+    /* Keys and values need not be null-terminated. */
+    parent = opentracing_baggage_with_item(NULL, "keyX", 3, "", 0);
+    assert(parent != NULL);
+    assert(strcmp(opentracing_baggage_get(parent, "key"), "") == 0);
+    assert(opentracing_baggage_get(parent, "keyX") == NULL);
+    opentracing_baggage_release(parent);
+}
+
+static void test_many_items(void)
+{
+    opentracing_baggage* baggage;
+    opentracing_baggage* next;
+    char key[32];
+    char value[32];
+    int i;
+
+    /* Enough items to need the hash index. */
+    baggage = NULL;
+    for (i = 0; i < NUM_MANY_ITEMS; i++) {
+        sprintf(key, "key-%d", i);
+        sprintf(value, "value-%d", i);
+        next = with_item(baggage, key, value);
+        opentracing_baggage_release(baggage);
+        baggage = next;
+    }
+    next = with_item(baggage, "key-50", "replaced");
+    opentracing_baggage_release(baggage);
+    baggage = next;
+    assert(opentracing_baggage_size(baggage) == NUM_MANY_ITEMS);
+    for (i = 0; i < NUM_MANY_ITEMS; i++) {
+        sprintf(key, "key-%d", i);
+        sprintf(value, "value-%d", i);
+        assert(strcmp(opentracing_baggage_get(baggage, key),
+                      (i == 50) ? "replaced" : value) == 0);
+    }
+    assert(opentracing_baggage_get(baggage, "key-100") == NULL);
+    opentracing_baggage_release(baggage);
+}
+
+int main(void)
+{
+    test_copy_on_write();
+    test_many_items();
+    return 0;
+}
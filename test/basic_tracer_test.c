@@ -0,0 +1,1037 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <opentracing-c/basic_tracer.h>
+
+#include "mock_reporter.h"
+
+#define NUM_THREAD_SPANS 4096
+#define NUM_THREADS 4
+#define NUM_BACKGROUND_SPANS 1000
+#define MAX_TEXT_MAP_ENTRIES 16
+
+typedef struct mock_text_map {
+    opentracing_text_map_writer writer;
+    opentracing_text_map_reader reader;
+    char keys[MAX_TEXT_MAP_ENTRIES][64];
+    char values[MAX_TEXT_MAP_ENTRIES][64];
+    int num_entries;
+    int num_foreach;
+} mock_text_map;
+
+static void null_destroy(opentracing_destructible* destructible)
+{
+    (void) destructible;
+}
+
+static opentracing_propagation_error_code
+mock_text_map_set(opentracing_text_map_writer* writer,
+                  const char* key,
+                  const char* value)
+{
+    mock_text_map* map;
+    map = (mock_text_map*) writer;
+    assert(map->num_entries < MAX_TEXT_MAP_ENTRIES);
+    strncpy(map->keys[map->num_entries], key, 63);
+    strncpy(map->values[map->num_entries], value, 63);
+    map->num_entries++;
+    return opentracing_propagation_error_code_success;
+}
+
+static opentracing_propagation_error_code mock_text_map_foreach_key(
+    opentracing_text_map_reader* reader,
+    opentracing_propagation_error_code (*handler)(void*,
+                                                  const char*,
+                                                  const char*),
+    void* arg)
+{
+    mock_text_map* map;
+    opentracing_propagation_error_code return_code;
+    int i;
+
+    map = (mock_text_map*) (((char*) reader) -
+                            offsetof(mock_text_map, reader));
+    map->num_foreach++;
+    for (i = 0; i < map->num_entries; i++) {
+        return_code = handler(arg, map->keys[i], map->values[i]);
+        if (return_code != opentracing_propagation_error_code_success) {
+            return return_code;
+        }
+    }
+    return opentracing_propagation_error_code_success;
+}
+
+static void mock_text_map_init(mock_text_map* map)
+{
+    memset(map, 0, sizeof(*map));
+    map->writer.base.destroy = &null_destroy;
+    map->writer.set = &mock_text_map_set;
+    map->reader.base.destroy = &null_destroy;
+    map->reader.foreach_key = &mock_text_map_foreach_key;
+}
+
+static opentracing_propagation_error_code
+mock_text_map_get(opentracing_text_map_reader* reader,
+                  const char* key,
+                  const char** value)
+{
+    mock_text_map* map;
+    int i;
+
+    map = (mock_text_map*) (((char*) reader) -
+                            offsetof(mock_text_map, reader));
+    for (i = 0; i < map->num_entries; i++) {
+        if (strcasecmp(map->keys[i], key) == 0) {
+            *value = map->values[i];
+            return opentracing_propagation_error_code_success;
+        }
+    }
+    return opentracing_propagation_error_code_span_context_not_found;
+}
+
+static void mock_text_map_init_keyed(mock_text_map* map)
+{
+    mock_text_map_init(map);
+    map->reader.header.size = sizeof(opentracing_text_map_reader);
+    map->reader.header.version = OPENTRACINGC_VTABLE_VERSION;
+    map->reader.get = &mock_text_map_get;
+}
+
+typedef struct binary_buffer {
+    char data[512];
+    size_t len;
+    size_t offset;
+} binary_buffer;
+
+static int binary_write(void* arg, const char* data, size_t len)
+{
+    binary_buffer* buffer;
+    buffer = (binary_buffer*) arg;
+    assert(buffer->len + len <= sizeof(buffer->data));
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    return 0;
+}
+
+static int binary_read(void* arg, char* data, size_t len)
+{
+    binary_buffer* buffer;
+    size_t remaining;
+    buffer = (binary_buffer*) arg;
+    remaining = buffer->len - buffer->offset;
+    if (len > remaining) {
+        len = remaining;
+    }
+    /* Deliberately return data in small chunks. */
+    if (len > 7) {
+        len = 7;
+    }
+    memcpy(data, buffer->data + buffer->offset, len);
+    buffer->offset += len;
+    return (int) len;
+}
+
+static opentracing_bool
+count_baggage(void* arg, const char* key, const char* value)
+{
+    (void) key;
+    (void) value;
+    (*(int*) arg)++;
+    return opentracing_true;
+}
+
+static void test_batched_tags_and_logs(opentracing_tracer* tracer,
+                                       mock_reporter* reporter)
+{
+    opentracing_span* span;
+    opentracing_tag tags[20];
+    opentracing_log_field field;
+    opentracing_log_record records[6];
+    char keys[20][8];
+    int i;
+
+    span = tracer->start_span(tracer, "batched");
+    assert(span != NULL);
+    assert(OPENTRACINGC_SPAN_HAS(span, set_tags));
+    assert(OPENTRACINGC_SPAN_HAS(span, log_records));
+
+    /* More than fit inline, with one key repeated. */
+    for (i = 0; i < 20; i++) {
+        sprintf(keys[i], "tag%d", (i == 19) ? 0 : i);
+        tags[i].key = keys[i];
+        tags[i].value.type = opentracing_value_int64;
+        tags[i].value.value.int64_value = i;
+    }
+    opentracing_span_set_tags(span, tags, 20);
+    opentracing_span_set_tags(span, tags, 0);
+
+    field.key = "event";
+    field.value.type = opentracing_value_string;
+    field.value.value.string_value = "batched";
+    memset(records, 0, sizeof(records));
+    for (i = 0; i < 6; i++) {
+        records[i].fields = &field;
+        records[i].num_fields = 1;
+    }
+    records[0].timestamp.value.tv_sec = 1234;
+    opentracing_span_log_records(span, records, 6);
+
+    span->finish(span);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    assert(strcmp(reporter->last_operation_name, "batched") == 0);
+    assert(reporter->last.num_tags == 19);
+    assert(reporter->last.num_logs == 6);
+    assert(reporter->last_first_log_timestamp.value.tv_sec == 1234);
+}
+
+/* binary holds the output of inject_binary() for context. */
+static void test_binary_buffer(opentracing_tracer* tracer,
+                               const opentracing_span_context* context,
+                               const binary_buffer* binary)
+{
+    opentracing_tracer old_tracer;
+    opentracing_span_context* extracted;
+    char buffer[512];
+    size_t length;
+    int num_baggage;
+
+    assert(OPENTRACINGC_TRACER_HAS(tracer, inject_binary_buffer));
+    assert(opentracing_tracer_inject_binary_buffer(
+               tracer, buffer, sizeof(buffer), &length, context) ==
+           opentracing_propagation_error_code_success);
+    assert(length == binary->len);
+    assert(memcmp(buffer, binary->data, length) == 0);
+    assert(opentracing_tracer_inject_binary_buffer(
+               tracer, buffer, length - 1, &length, context) ==
+           opentracing_propagation_error_code_invalid_carrier);
+    assert(length == binary->len);
+
+    assert(opentracing_tracer_extract_binary_buffer(
+               tracer, buffer, length, &extracted) ==
+           opentracing_propagation_error_code_success);
+    num_baggage = 0;
+    extracted->foreach_baggage_item(extracted, &count_baggage, &num_baggage);
+    assert(num_baggage == 1);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+    assert(opentracing_tracer_extract_binary_buffer(
+               tracer, buffer, length - 1, &extracted) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(extracted == NULL);
+
+    /* Tracer built before the buffer slots existed. */
+    old_tracer = *tracer;
+    old_tracer.header.size =
+        offsetof(opentracing_tracer, inject_binary_buffer);
+    assert(opentracing_tracer_inject_binary_buffer(
+               &old_tracer, buffer, 8, &length, context) ==
+           opentracing_propagation_error_code_invalid_carrier);
+    assert(length == binary->len);
+    memset(buffer, 0, sizeof(buffer));
+    assert(opentracing_tracer_inject_binary_buffer(
+               &old_tracer, buffer, sizeof(buffer), &length, context) ==
+           opentracing_propagation_error_code_success);
+    assert(memcmp(buffer, binary->data, length) == 0);
+    assert(opentracing_tracer_extract_binary_buffer(
+               &old_tracer, buffer, length, &extracted) ==
+           opentracing_propagation_error_code_success);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+}
+
+static void test_interned(opentracing_tracer* tracer, mock_reporter* reporter)
+{
+    opentracing_span* span;
+    opentracing_interned_log_field field;
+    opentracing_value value;
+    opentracing_string_handle key;
+
+    assert(OPENTRACINGC_TRACER_HAS(tracer, start_span_interned));
+    span = opentracing_tracer_start_span_interned(
+        tracer, opentracing_intern("interned"), NULL);
+    assert(span != NULL);
+    assert(OPENTRACINGC_SPAN_HAS(span, set_tag_interned));
+    assert(OPENTRACINGC_SPAN_HAS(span, log_fields_interned));
+
+    /* Interned and plain keys with equal contents are the same tag. */
+    key = opentracing_intern("component");
+    value.type = opentracing_value_string;
+    value.value.string_value = "db";
+    opentracing_span_set_tag_interned(span, key, &value);
+    span->set_tag(span, "component", &value);
+    opentracing_span_set_tag_interned(span, key, &value);
+    opentracing_span_set_tag_interned(
+        span, OPENTRACINGC_INVALID_STRING_HANDLE, &value);
+
+    field.key = opentracing_intern("event");
+    field.value = value;
+    opentracing_span_log_fields_interned(span, &field, 1);
+
+    span->finish(span);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    assert(strcmp(reporter->last_operation_name, "interned") == 0);
+    assert(reporter->last.num_tags == 1);
+    assert(reporter->last.num_logs == 1);
+    assert(opentracing_tracer_start_span_interned(
+               tracer, OPENTRACINGC_INVALID_STRING_HANDLE, NULL) == NULL);
+}
+
+static void test_string_view(opentracing_tracer* tracer,
+                             mock_reporter* reporter)
+{
+    static const char request[] = "GET /index.html HTTP/1.1";
+    opentracing_span* span;
+    opentracing_value value;
+    opentracing_log_field field;
+
+    span = tracer->start_span(tracer, "string_view");
+    assert(span != NULL);
+
+    /* Not null-terminated at the end of the view. */
+    value.type = opentracing_value_string_view;
+    value.value.string_view_value.data = request;
+    value.value.string_view_value.length = 3;
+    span->set_tag(span, "http.method", &value);
+
+    value.value.string_view_value.data = NULL;
+    value.value.string_view_value.length = 0;
+    field.key = "empty";
+    field.value = value;
+    span->log_fields(span, &field, 1);
+
+    span->finish(span);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    assert(reporter->last.num_tags == 1);
+    assert(reporter->last.num_logs == 1);
+    assert(strcmp(reporter->last_string_view, "GET") == 0);
+}
+
+static void* release_contexts(void* arg)
+{
+    opentracing_span_context* span_context;
+    int i;
+
+    span_context = (opentracing_span_context*) arg;
+    for (i = 0; i < NUM_THREAD_SPANS; i++) {
+        opentracing_span_context_release(
+            opentracing_span_context_retain(span_context));
+    }
+    opentracing_span_context_release(span_context);
+    return NULL;
+}
+
+static void test_retain(opentracing_tracer* tracer, mock_reporter* reporter)
+{
+    opentracing_span* parent;
+    opentracing_span* child;
+    opentracing_span_context* retained;
+    opentracing_start_span_options options;
+    opentracing_span_reference refs[1];
+    pthread_t threads[NUM_THREADS];
+    int num_baggage;
+    int i;
+
+    parent = tracer->start_span(tracer, "retained");
+    assert(parent != NULL);
+    parent->set_baggage_item(parent, "user", "alice");
+    retained = opentracing_span_context_retain(parent->span_context(parent));
+    assert(retained == parent->span_context(parent));
+
+    /* Changing the span's baggage leaves retained references alone. */
+    parent->set_baggage_item(parent, "region", "eu");
+    assert(parent->span_context(parent) != retained);
+    num_baggage = 0;
+    retained->foreach_baggage_item(retained, &count_baggage, &num_baggage);
+    assert(num_baggage == 1);
+
+    /* The retained context outlives its span. */
+    parent->finish(parent);
+    ((opentracing_destructible*) parent)
+        ->destroy((opentracing_destructible*) parent);
+    memset(&options, 0, sizeof(options));
+    refs[0].type = opentracing_span_reference_child_of;
+    refs[0].referenced_context = retained;
+    options.references = refs;
+    options.num_references = 1;
+    child = tracer->start_span_with_options(tracer, "child", &options);
+    assert(child != NULL);
+    assert(strcmp(child->baggage_item(child, "user"), "alice") == 0);
+    child->finish(child);
+    assert(reporter->last.parent_span_id != 0);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+
+    /* Threads share the context, the last release frees it. */
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_create(&threads[i],
+                              NULL,
+                              &release_contexts,
+                              opentracing_span_context_retain(retained)) ==
+               0);
+    }
+    opentracing_span_context_release(retained);
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+}
+
+static void* destroy_spans(void* arg)
+{
+    opentracing_span** spans;
+    int i;
+
+    spans = (opentracing_span**) arg;
+    for (i = 0; i < NUM_THREAD_SPANS; i++) {
+        ((opentracing_destructible*) spans[i])
+            ->destroy((opentracing_destructible*) spans[i]);
+    }
+    return NULL;
+}
+
+static void test_cross_thread_destroy(opentracing_tracer* tracer)
+{
+    opentracing_span** spans;
+    pthread_t thread;
+    int round;
+    int i;
+
+    spans = (opentracing_span**) malloc(sizeof(opentracing_span*) *
+                                        NUM_THREAD_SPANS);
+    assert(spans != NULL);
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < NUM_THREAD_SPANS; i++) {
+            spans[i] = tracer->start_span(tracer, "cross_thread");
+            assert(spans[i] != NULL);
+            spans[i]->finish(spans[i]);
+        }
+        assert(pthread_create(&thread, NULL, &destroy_spans, spans) == 0);
+        assert(pthread_join(thread, NULL) == 0);
+    }
+    free(spans);
+}
+
+static void* finish_spans(void* arg)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    int i;
+
+    tracer = (opentracing_tracer*) arg;
+    for (i = 0; i < NUM_BACKGROUND_SPANS; i++) {
+        span = tracer->start_span(tracer, "background");
+        assert(span != NULL);
+        span->finish(span);
+        ((opentracing_destructible*) span)
+            ->destroy((opentracing_destructible*) span);
+    }
+    return NULL;
+}
+
+static int extract_keyed(opentracing_tracer* tracer,
+                         mock_text_map* text_map,
+                         opentracing_propagation_error_code expected)
+{
+    opentracing_span_context* extracted;
+    int num_baggage;
+
+    text_map->num_foreach = 0;
+    assert(tracer->extract_http_headers(
+               tracer,
+               (opentracing_http_headers_reader*) &text_map->reader,
+               &extracted) == expected);
+    num_baggage = 0;
+    if (extracted != NULL) {
+        extracted->foreach_baggage_item(
+            extracted, &count_baggage, &num_baggage);
+        ((opentracing_destructible*) extracted)
+            ->destroy((opentracing_destructible*) extracted);
+    }
+    return num_baggage;
+}
+
+static void test_keyed_extract(void)
+{
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    mock_text_map text_map;
+    const char* value;
+
+    memset(&options, 0, sizeof(options));
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    span = tracer->start_span(tracer, "keyed");
+    assert(span != NULL);
+    span->set_baggage_item(span, "user", "alice");
+
+    /* Lookups find the context, one pass collects the baggage. */
+    mock_text_map_init_keyed(&text_map);
+    assert(tracer->inject_text_map(
+               tracer, &text_map.writer, span->span_context(span)) ==
+           opentracing_propagation_error_code_success);
+    assert(extract_keyed(
+               tracer, &text_map, opentracing_propagation_error_code_success) ==
+           1);
+    assert(text_map.num_foreach == 1);
+
+    /* Carriers without a context are never enumerated. */
+    mock_text_map_init_keyed(&text_map);
+    mock_text_map_set(&text_map.writer, "ot-baggage-user", "alice");
+    assert(extract_keyed(
+               tracer,
+               &text_map,
+               opentracing_propagation_error_code_span_context_not_found) ==
+           0);
+    assert(text_map.num_foreach == 0);
+
+    /* Enumerating the same carrier gives the same result. */
+    text_map.reader.get = NULL;
+    assert(extract_keyed(
+               tracer,
+               &text_map,
+               opentracing_propagation_error_code_span_context_not_found) ==
+           0);
+    assert(text_map.num_foreach == 1);
+    text_map.reader.get = &mock_text_map_get;
+    mock_text_map_set(
+        &text_map.writer, "B3", "64fe8b2a57d3eff7-e457b5a2e4d86bd1-1");
+    assert(extract_keyed(
+               tracer, &text_map, opentracing_propagation_error_code_success) ==
+           1);
+    mock_text_map_init_keyed(&text_map);
+    mock_text_map_set(&text_map.writer, "ot-tracer-spanid", "1");
+    assert(extract_keyed(
+               tracer,
+               &text_map,
+               opentracing_propagation_error_code_span_context_corrupted) ==
+           0);
+
+    /* The helper falls back to foreach_key. */
+    mock_text_map_init(&text_map);
+    mock_text_map_set(&text_map.writer, "ot-tracer-sampled", "true");
+    assert(opentracing_text_map_reader_get(
+               &text_map.reader, "OT-Tracer-Sampled", &value) ==
+           opentracing_propagation_error_code_success);
+    assert(strcmp(value, "true") == 0);
+    assert(opentracing_text_map_reader_get(&text_map.reader, "b3", &value) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    assert(value == NULL);
+    assert(text_map.num_foreach == 2);
+    text_map.reader.get = &mock_text_map_get;
+    assert(opentracing_text_map_reader_get(&text_map.reader, "b3", &value) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    assert(text_map.num_foreach == 3);
+    mock_text_map_init_keyed(&text_map);
+    assert(opentracing_text_map_reader_get(&text_map.reader, "b3", &value) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    assert(text_map.num_foreach == 0);
+
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+
+    /* Ignoring baggage avoids enumeration entirely. */
+    options.ignore_text_map_baggage = opentracing_true;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    span = tracer->start_span(tracer, "keyed");
+    assert(span != NULL);
+    span->set_baggage_item(span, "user", "alice");
+    mock_text_map_init_keyed(&text_map);
+    assert(tracer->inject_text_map(
+               tracer, &text_map.writer, span->span_context(span)) ==
+           opentracing_propagation_error_code_success);
+    assert(extract_keyed(
+               tracer, &text_map, opentracing_propagation_error_code_success) ==
+           0);
+    assert(text_map.num_foreach == 0);
+    mock_text_map_init(&text_map);
+    assert(tracer->inject_text_map(
+               tracer, &text_map.writer, span->span_context(span)) ==
+           opentracing_propagation_error_code_success);
+    assert(extract_keyed(
+               tracer, &text_map, opentracing_propagation_error_code_success) ==
+           0);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+static const char* mock_text_map_value(const mock_text_map* map,
+                                       const char* key)
+{
+    int i;
+
+    for (i = 0; i < map->num_entries; i++) {
+        if (strcmp(map->keys[i], key) == 0) {
+            return map->values[i];
+        }
+    }
+    return NULL;
+}
+
+#define W3C_TRACEPARENT \
+    "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"
+#define B3_SINGLE "64fe8b2a57d3eff7-e457b5a2e4d86bd1-1"
+
+/* Extract with and without get(), expecting span_id or, if NULL, failure. */
+static void check_extracted_span_id(opentracing_tracer* tracer,
+                                    const char* const* entries,
+                                    int num_entries,
+                                    const char* span_id)
+{
+    mock_text_map text_map;
+    opentracing_span_context* extracted;
+    opentracing_propagation_error_code return_code;
+    int keyed;
+    int i;
+
+    for (keyed = 0; keyed < 2; keyed++) {
+        if (keyed) {
+            mock_text_map_init_keyed(&text_map);
+        }
+        else {
+            mock_text_map_init(&text_map);
+        }
+        for (i = 0; i < num_entries; i++) {
+            mock_text_map_set(
+                &text_map.writer, entries[2 * i], entries[2 * i + 1]);
+        }
+        return_code =
+            tracer->extract_text_map(tracer, &text_map.reader, &extracted);
+        if (span_id == NULL) {
+            assert(return_code ==
+                   opentracing_propagation_error_code_span_context_corrupted);
+            continue;
+        }
+        assert(return_code == opentracing_propagation_error_code_success);
+        mock_text_map_init(&text_map);
+        assert(tracer->inject_text_map(tracer, &text_map.writer, extracted) ==
+               opentracing_propagation_error_code_success);
+        assert(strcmp(mock_text_map_value(&text_map, "ot-tracer-spanid"),
+                      span_id) == 0);
+        ((opentracing_destructible*) extracted)
+            ->destroy((opentracing_destructible*) extracted);
+    }
+}
+
+static void test_multi_format_extract(void)
+{
+    static const char* const all_formats[] = {"b3",
+                                              B3_SINGLE,
+                                              "traceparent",
+                                              W3C_TRACEPARENT,
+                                              "ot-tracer-spanid",
+                                              "2",
+                                              "ot-tracer-traceid",
+                                              "1"};
+    static const char* const all_formats_reversed[] = {"ot-tracer-traceid",
+                                                       "1",
+                                                       "ot-tracer-spanid",
+                                                       "2",
+                                                       "traceparent",
+                                                       W3C_TRACEPARENT,
+                                                       "b3",
+                                                       B3_SINGLE};
+    static const char* const headers[] = {
+        "b3", B3_SINGLE, "traceparent", W3C_TRACEPARENT};
+    static const char* const headers_reversed[] = {
+        "traceparent", W3C_TRACEPARENT, "b3", B3_SINGLE};
+    static const char* const partial_ot[] = {
+        "b3", B3_SINGLE, "ot-tracer-traceid", "1"};
+    static const char* const corrupted_b3[] = {
+        "b3", "zz", "traceparent", W3C_TRACEPARENT};
+    static const char* const corrupted_traceparent[] = {
+        "b3", B3_SINGLE, "traceparent", "zz"};
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+
+    memset(&options, 0, sizeof(options));
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+
+    /* ot-tracer keys win, then traceparent, then b3, in any key order. */
+    check_extracted_span_id(tracer, all_formats, 4, "0000000000000002");
+    check_extracted_span_id(
+        tracer, all_formats_reversed, 4, "0000000000000002");
+    check_extracted_span_id(tracer, headers, 2, "b7ad6b7169203331");
+    check_extracted_span_id(tracer, headers_reversed, 2, "b7ad6b7169203331");
+
+    /* IDs are never mixed across formats. */
+    check_extracted_span_id(tracer, partial_ot, 2, NULL);
+
+    /* Only the chosen format has to be well formed. */
+    check_extracted_span_id(tracer, corrupted_b3, 2, "b7ad6b7169203331");
+    check_extracted_span_id(tracer, corrupted_traceparent, 2, NULL);
+
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+static void test_sampling(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* root;
+    opentracing_span* child;
+    opentracing_span_context* context;
+    opentracing_span_context* extracted;
+    opentracing_start_span_options start_options;
+    opentracing_span_reference refs[1];
+    mock_text_map text_map;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.sampler = opentracing_make_const_sampler(opentracing_false);
+    assert(options.sampler != NULL);
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+
+    /* Unsampled spans keep baggage and propagate the decision. */
+    root = tracer->start_span(tracer, "unsampled");
+    assert(root != NULL);
+    assert(root->tracer(root) == tracer);
+    root->set_operation_name(root, "renamed");
+    root->set_baggage_item(root, "user", "alice");
+    assert(strcmp(root->baggage_item(root, "user"), "alice") == 0);
+    assert(strcmp(root->baggage_item(root, "region"), "") == 0);
+    mock_text_map_init(&text_map);
+    assert(tracer->inject_text_map(
+               tracer, &text_map.writer, root->span_context(root)) ==
+           opentracing_propagation_error_code_success);
+    assert(strcmp(mock_text_map_value(&text_map, "ot-tracer-sampled"),
+                  "false") == 0);
+    assert(strcmp(mock_text_map_value(&text_map, "ot-baggage-user"),
+                  "alice") == 0);
+
+    /* Children share the unsampled context until they change it. */
+    memset(&start_options, 0, sizeof(start_options));
+    refs[0].type = opentracing_span_reference_child_of;
+    refs[0].referenced_context = root->span_context(root);
+    start_options.references = refs;
+    start_options.num_references = 1;
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    assert(child->span_context(child) == root->span_context(root));
+    child->set_baggage_item(child, "user", "bob");
+    assert(child->span_context(child) != root->span_context(root));
+    assert(strcmp(child->baggage_item(child, "user"), "bob") == 0);
+    assert(strcmp(root->baggage_item(root, "user"), "alice") == 0);
+    child->finish(child);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    root->finish(root);
+    ((opentracing_destructible*) root)
+        ->destroy((opentracing_destructible*) root);
+    assert(reporter.num_reported == 0);
+
+    /* Contexts handed out stay valid after the span changes baggage. */
+    root = tracer->start_span(tracer, "unsampled");
+    assert(root != NULL);
+    context = root->span_context(root);
+    refs[0].referenced_context = context;
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    root->set_baggage_item(root, "user", "carol");
+    assert(root->span_context(root) != context);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    assert(child->span_context(child) == context);
+    assert(strcmp(child->baggage_item(child, "user"), "") == 0);
+    assert(strcmp(root->baggage_item(root, "user"), "carol") == 0);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    ((opentracing_destructible*) root)
+        ->destroy((opentracing_destructible*) root);
+
+    /* A sampled parent overrides the sampler. */
+    mock_text_map_init(&text_map);
+    mock_text_map_set(&text_map.writer, "ot-tracer-traceid", "1");
+    mock_text_map_set(&text_map.writer, "ot-tracer-spanid", "2");
+    mock_text_map_set(&text_map.writer, "ot-tracer-sampled", "true");
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_success);
+    refs[0].referenced_context = extracted;
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.num_reported == 1);
+    assert(reporter.last.trace_id.low == 1);
+    assert(reporter.last.parent_span_id == 2);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+    assert(reporter.destroyed);
+}
+
+static void test_background_reporting(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.background_reporting = opentracing_true;
+    options.buffer_size = NUM_BACKGROUND_SPANS;
+    options.batch_size = 64;
+    options.flush_interval_ms = 10000;
+    options.close_timeout_ms = 5000;
+
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_create(&threads[i], NULL, &finish_spans, tracer) == 0);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+    finish_spans(tracer);
+
+    /* Close must drain every buffer long before the flush interval. */
+    tracer->close(tracer);
+    assert(reporter.num_reported == (NUM_THREADS + 1) * NUM_BACKGROUND_SPANS);
+    assert(strcmp(reporter.last_operation_name, "background") == 0);
+    assert(reporter.num_flushed == 1);
+
+    finish_spans(tracer);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+    assert(reporter.num_reported ==
+           (NUM_THREADS + 2) * NUM_BACKGROUND_SPANS);
+    assert(reporter.destroyed);
+}
+
+int main(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* parent;
+    opentracing_span* child;
+    opentracing_span_context* context;
+    opentracing_span_context* extracted;
+    opentracing_start_span_options start_options;
+    opentracing_finish_span_options finish_options;
+    opentracing_span_reference refs[1];
+    opentracing_tag tags[2];
+    opentracing_log_field fields[2];
+    opentracing_log_record record;
+    opentracing_value value;
+    opentracing_trace_id parent_trace_id;
+    mock_text_map text_map;
+    binary_buffer binary;
+    char long_name[1024];
+    int num_baggage;
+    int i;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+
+    /* Root span with tags, logs and baggage. */
+    parent = tracer->start_span(tracer, "parent");
+    assert(parent != NULL);
+    assert(parent->tracer(parent) == tracer);
+    value.type = opentracing_value_string;
+    value.value.string_value = "v1";
+    parent->set_tag(parent, "key", &value);
+    value.value.string_value = "v2";
+    parent->set_tag(parent, "key", &value);
+    value.type = opentracing_value_int64;
+    value.value.int64_value = 42;
+    parent->set_tag(parent, "other", &value);
+    fields[0].key = "event";
+    fields[0].value.type = opentracing_value_string;
+    fields[0].value.value.string_value = "started";
+    fields[1].key = "count";
+    fields[1].value.type = opentracing_value_uint64;
+    fields[1].value.value.uint64_value = 7;
+    parent->log_fields(parent, fields, 2);
+    parent->set_baggage_item(parent, "user", "alice");
+    parent->set_baggage_item(parent, "user", "bob");
+    assert(strcmp(parent->baggage_item(parent, "user"), "bob") == 0);
+    assert(strlen(parent->baggage_item(parent, "missing")) == 0);
+    parent->set_operation_name(parent, "renamed");
+
+    /* Child inherits trace and baggage. */
+    context = parent->span_context(parent);
+    memset(&start_options, 0, sizeof(start_options));
+    refs[0] = (opentracing_span_reference) OPENTRACINGC_CHILD_OF(*context);
+    start_options.references = refs;
+    start_options.num_references = 1;
+    tags[0].key = "component";
+    tags[0].value.type = opentracing_value_bool;
+    tags[0].value.value.bool_value = opentracing_true;
+    tags[1].key = "ratio";
+    tags[1].value.type = opentracing_value_double;
+    tags[1].value.value.double_value = 0.5;
+    start_options.tags = tags;
+    start_options.num_tags = 2;
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    assert(strcmp(child->baggage_item(child, "user"), "bob") == 0);
+
+    /* Many tags and a long operation name overflow inline storage. */
+    memset(long_name, 'x', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    child->set_operation_name(child, long_name);
+    child->set_operation_name(child, "child");
+    value.type = opentracing_value_null;
+    for (i = 0; i < 32; i++) {
+        long_name[i] = 'a';
+        long_name[i + 1] = '\0';
+        child->set_tag(child, long_name, &value);
+    }
+
+    memset(&finish_options, 0, sizeof(finish_options));
+    memset(&record, 0, sizeof(record));
+    record.fields = fields;
+    record.num_fields = 2;
+    finish_options.log_records = &record;
+    finish_options.num_log_records = 1;
+    child->finish_with_options(child, &finish_options);
+    assert(reporter.num_reported == 1);
+    assert(strcmp(reporter.last_operation_name, "child") == 0);
+    assert(reporter.last.num_tags == 34);
+    assert(reporter.last.num_logs == 1);
+    assert(reporter.last.num_references == 1);
+    assert(reporter.last.parent_span_id != 0);
+    child->finish(child);
+    assert(reporter.num_reported == 1);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+
+    parent->finish(parent);
+    assert(reporter.num_reported == 2);
+    assert(strcmp(reporter.last_operation_name, "renamed") == 0);
+    assert(reporter.last.num_tags == 2);
+    assert(reporter.last.num_logs == 1);
+    assert(reporter.last.parent_span_id == 0);
+    parent_trace_id = reporter.last.trace_id;
+
+    /* Text map round trip. */
+    mock_text_map_init(&text_map);
+    assert(tracer->inject_text_map(tracer, &text_map.writer, context) ==
+           opentracing_propagation_error_code_success);
+    assert(text_map.num_entries == 4);
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_success);
+    num_baggage = 0;
+    extracted->foreach_baggage_item(extracted, &count_baggage, &num_baggage);
+    assert(num_baggage == 1);
+    refs[0] = (opentracing_span_reference) OPENTRACINGC_CHILD_OF(*extracted);
+    start_options.num_tags = 0;
+    child = tracer->start_span_with_options(tracer, "remote", &start_options);
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.last.trace_id.high == parent_trace_id.high);
+    assert(reporter.last.trace_id.low == parent_trace_id.low);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+
+    mock_text_map_init(&text_map);
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    assert(extracted == NULL);
+    mock_text_map_set(&text_map.writer, "ot-tracer-traceid", "xyz");
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    /* W3C and B3 headers from other tracers. */
+    mock_text_map_init(&text_map);
+    mock_text_map_set(&text_map.writer,
+                      "Traceparent",
+                      "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01");
+    assert(tracer->extract_http_headers(
+               tracer,
+               (opentracing_http_headers_reader*) &text_map.reader,
+               &extracted) == opentracing_propagation_error_code_success);
+    memset(&start_options, 0, sizeof(start_options));
+    refs[0].type = opentracing_span_reference_child_of;
+    refs[0].referenced_context = extracted;
+    start_options.references = refs;
+    start_options.num_references = 1;
+    child = tracer->start_span_with_options(tracer, "w3c", &start_options);
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.last.trace_id.high == 0x0af7651916cd43ddULL);
+    assert(reporter.last.trace_id.low == 0x8448eb211c80319cULL);
+    assert(reporter.last.parent_span_id == 0xb7ad6b7169203331ULL);
+    ((opentracing_destructible*) child)
+        ->destroy((opentracing_destructible*) child);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+    mock_text_map_init(&text_map);
+    mock_text_map_set(
+        &text_map.writer, "b3", "64fe8b2a57d3eff7-e457b5a2e4d86bd1-1");
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_success);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+    mock_text_map_init(&text_map);
+    mock_text_map_set(&text_map.writer, "b3", "64fe8b2a57d3eff7");
+    assert(tracer->extract_text_map(tracer, &text_map.reader, &extracted) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    /* Binary round trip. */
+    memset(&binary, 0, sizeof(binary));
+    assert(tracer->inject_binary(tracer, &binary_write, &binary, context) ==
+           opentracing_propagation_error_code_success);
+    assert(tracer->extract_binary(tracer, &binary_read, &binary, &extracted) ==
+           opentracing_propagation_error_code_success);
+    num_baggage = 0;
+    extracted->foreach_baggage_item(extracted, &count_baggage, &num_baggage);
+    assert(num_baggage == 1);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+
+    test_binary_buffer(tracer, context, &binary);
+
+    ((opentracing_destructible*) parent)
+        ->destroy((opentracing_destructible*) parent);
+
+    test_batched_tags_and_logs(tracer, &reporter);
+    test_interned(tracer, &reporter);
+    test_string_view(tracer, &reporter);
+    test_retain(tracer, &reporter);
+    test_cross_thread_destroy(tracer);
+
+    tracer->close(tracer);
+    assert(reporter.num_flushed == 1);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+    assert(reporter.destroyed);
+
+    test_keyed_extract();
+    test_multi_format_extract();
+    test_sampling();
+    test_background_reporting();
+    return 0;
+}
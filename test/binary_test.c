@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <string.h>
+
+#include <opentracing-c/binary.h>
+
+static void set_view(opentracing_string_view* view, const char* str)
+{
+    view->data = str;
+    view->length = strlen(str);
+}
+
+static void test_round_trip(void)
+{
+    opentracing_binary_span_context context;
+    opentracing_binary_span_context decoded;
+    opentracing_binary_baggage_item items[2];
+    opentracing_binary_baggage_item decoded_items[2];
+    char buffer[128];
+    size_t length;
+
+    set_view(&items[0].key, "user");
+    set_view(&items[0].value, "alice");
+    set_view(&items[1].key, "empty");
+    set_view(&items[1].value, "");
+    context.trace_id.high = 0x0123456789abcdefULL;
+    context.trace_id.low = 0xfedcba9876543210ULL;
+    context.span_id = 42;
+    context.sampled = opentracing_true;
+    context.baggage = items;
+    context.num_baggage = 2;
+
+    assert(opentracing_binary_encoded_length(&context) ==
+           OPENTRACINGC_BINARY_HEADER_LENGTH + 4 + 9 + 4 + 5);
+    assert(opentracing_binary_encode(&context, buffer, sizeof(buffer), &length) ==
+           opentracing_propagation_error_code_success);
+    assert(length == opentracing_binary_encoded_length(&context));
+    assert(buffer[0] == OPENTRACINGC_BINARY_FORMAT_VERSION);
+    assert(buffer[2] == 0x01 && buffer[9] == (char) 0xef);
+
+    memset(&decoded, 0, sizeof(decoded));
+    decoded.baggage = decoded_items;
+    assert(opentracing_binary_decode(buffer, length, &decoded, 2) ==
+           opentracing_propagation_error_code_success);
+    assert(decoded.trace_id.high == context.trace_id.high);
+    assert(decoded.trace_id.low == context.trace_id.low);
+    assert(decoded.span_id == 42);
+    assert(decoded.sampled);
+    assert(decoded.num_baggage == 2);
+    assert(decoded_items[0].key.length == 4);
+    assert(memcmp(decoded_items[0].key.data, "user", 4) == 0);
+    assert(decoded_items[0].value.length == 5);
+    assert(memcmp(decoded_items[0].value.data, "alice", 5) == 0);
+    assert(decoded_items[1].value.length == 0);
+
+    /* Baggage beyond the caller's array is validated but not stored. */
+    memset(decoded_items, 0, sizeof(decoded_items));
+    assert(opentracing_binary_decode(buffer, length, &decoded, 1) ==
+           opentracing_propagation_error_code_success);
+    assert(decoded.num_baggage == 2);
+    assert(decoded_items[1].key.data == NULL);
+
+    /* Buffer too small reports the size needed. */
+    assert(opentracing_binary_encode(&context, buffer, 10, &length) ==
+           opentracing_propagation_error_code_invalid_carrier);
+    assert(length == opentracing_binary_encoded_length(&context));
+    assert(opentracing_binary_encode(&context, NULL, 0, &length) ==
+           opentracing_propagation_error_code_invalid_carrier);
+}
+
+static void test_invalid(void)
+{
+    opentracing_binary_span_context context;
+    opentracing_binary_span_context decoded;
+    opentracing_binary_baggage_item item;
+    opentracing_binary_baggage_item decoded_item;
+    char buffer[128];
+    size_t length;
+    size_t i;
+
+    set_view(&item.key, "key");
+    set_view(&item.value, "value");
+    memset(&context, 0, sizeof(context));
+    context.baggage = &item;
+    context.num_baggage = 1;
+    assert(opentracing_binary_encode(&context, buffer, sizeof(buffer), &length) ==
+           opentracing_propagation_error_code_success);
+
+    decoded.baggage = &decoded_item;
+    assert(opentracing_binary_decode(buffer, 0, &decoded, 1) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    /* Every truncation is rejected. */
+    for (i = 1; i < length; i++) {
+        assert(opentracing_binary_decode(buffer, i, &decoded, 1) ==
+               opentracing_propagation_error_code_span_context_corrupted);
+    }
+    buffer[0] = OPENTRACINGC_BINARY_FORMAT_VERSION + 1;
+    assert(opentracing_binary_decode(buffer, length, &decoded, 1) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    item.value.length = 0x10000;
+    assert(opentracing_binary_encode(&context, buffer, sizeof(buffer), &length) ==
+           opentracing_propagation_error_code_invalid_span_context);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_invalid();
+    return 0;
+}
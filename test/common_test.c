@@ -0,0 +1,55 @@
+#include <assert.h>
+#include <time.h>
+
+#include <opentracing-c/common.h>
+
+#define NUM_READINGS 100000
+#define NS_PER_SEC 1000000000.0
+
+static double to_seconds(const opentracing_time_value* value)
+{
+    return (double) value->tv_sec + (double) value->tv_nsec / NS_PER_SEC;
+}
+
+static void check_clocks(void)
+{
+    opentracing_duration steady;
+    opentracing_duration previous;
+    opentracing_timestamp system;
+    struct timespec ts;
+    int i;
+
+    opentracing_now_steady(&previous);
+    for (i = 0; i < NUM_READINGS; i++) {
+        opentracing_now_steady(&steady);
+        assert(steady.value.tv_nsec >= 0 && steady.value.tv_nsec < 1000000000L);
+        assert(to_seconds(&steady.value) >= to_seconds(&previous.value));
+        previous = steady;
+    }
+
+    /* The derived system time tracks the real clock. */
+    opentracing_now_system(&system);
+    clock_gettime(CLOCK_REALTIME, &ts);
+    assert(system.value.tv_nsec >= 0 && system.value.tv_nsec < 1000000000L);
+    assert(to_seconds(&system.value) > (double) ts.tv_sec - 1.0);
+    assert(to_seconds(&system.value) < (double) ts.tv_sec + 2.0);
+
+    opentracing_now(&steady, &system);
+    assert(to_seconds(&steady.value) >= to_seconds(&previous.value));
+    assert(to_seconds(&system.value) > (double) ts.tv_sec - 1.0);
+}
+
+int main(void)
+{
+    check_clocks();
+    assert(opentracing_set_clock_source(opentracing_clock_source_default));
+    check_clocks();
+    if (opentracing_set_clock_source(opentracing_clock_source_coarse)) {
+        check_clocks();
+    }
+    if (opentracing_set_clock_source(opentracing_clock_source_tsc)) {
+        check_clocks();
+    }
+    assert(!opentracing_set_clock_source((opentracing_clock_source) 42));
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/continuation.h>
+#include <opentracing-c/scope_manager.h>
+
+#include "mock_reporter.h"
+
+static opentracing_tracer* make_tracer(mock_reporter* reporter)
+{
+    opentracing_basic_tracer_options options;
+
+    mock_reporter_init(reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) reporter;
+    return opentracing_make_basic_tracer(&options);
+}
+
+static void destroy(void* object)
+{
+    ((opentracing_destructible*) object)
+        ->destroy((opentracing_destructible*) object);
+}
+
+/* Start, finish and destroy a span, returning its parent's ID. */
+static uint64_t run_span(opentracing_tracer* tracer, mock_reporter* reporter)
+{
+    opentracing_span* span;
+
+    span = tracer->start_span(tracer, "callback");
+    assert(span != NULL);
+    span->finish(span);
+    destroy(span);
+    return reporter->last.parent_span_id;
+}
+
+/* Start and finish a root span, capturing it in a continuation. */
+static uint64_t start_request(opentracing_tracer* tracer,
+                              mock_reporter* reporter,
+                              opentracing_continuation* continuation)
+{
+    opentracing_span* span;
+
+    span = tracer->start_span(tracer, "request");
+    assert(span != NULL);
+    assert(opentracing_activate_span(span));
+    assert(opentracing_continuation_capture(continuation));
+    assert(continuation->span_context == span->span_context(span));
+    opentracing_deactivate_span(span);
+    span->finish(span);
+    destroy(span);
+    return reporter->last.span_id;
+}
+
+static void test_restore(void)
+{
+    mock_reporter reporter;
+    opentracing_tracer* tracer;
+    opentracing_continuation first;
+    opentracing_continuation second;
+    uint64_t first_id;
+    uint64_t second_id;
+
+    tracer = make_tracer(&reporter);
+    assert(tracer != NULL);
+    first_id = start_request(tracer, &reporter, &first);
+    second_id = start_request(tracer, &reporter, &second);
+    assert(first_id != second_id);
+
+    /* Callbacks of both requests interleave on the same thread. */
+    assert(opentracing_continuation_restore(&first));
+    assert(opentracing_active_span() == NULL);
+    assert(opentracing_active_span_context() == first.span_context);
+    assert(run_span(tracer, &reporter) == first_id);
+    assert(reporter.last.num_references == 1);
+    assert(reporter.last_reference.type ==
+           opentracing_span_reference_child_of);
+    assert(reporter.last_reference.span_id == first_id);
+    opentracing_continuation_suspend(&first);
+
+    assert(opentracing_continuation_restore(&second));
+    assert(run_span(tracer, &reporter) == second_id);
+    assert(opentracing_continuation_restore(&first));
+    assert(run_span(tracer, &reporter) == first_id);
+    opentracing_continuation_suspend(&first);
+    assert(run_span(tracer, &reporter) == second_id);
+    opentracing_continuation_suspend(&second);
+
+    assert(opentracing_active_span_context() == NULL);
+    assert(run_span(tracer, &reporter) == 0);
+
+    opentracing_continuation_release(&first);
+    assert(first.span_context == NULL);
+    opentracing_continuation_release(&second);
+    destroy(tracer);
+}
+
+static void test_reference(void)
+{
+    mock_reporter reporter;
+    opentracing_tracer* tracer;
+    opentracing_continuation continuation;
+    opentracing_span_reference ref;
+    opentracing_start_span_options options;
+    opentracing_span* span;
+    uint64_t request_id;
+
+    /* The captured context can be referenced explicitly too. */
+    tracer = make_tracer(&reporter);
+    assert(tracer != NULL);
+    request_id = start_request(tracer, &reporter, &continuation);
+    ref.type = opentracing_span_reference_follows_from;
+    ref.referenced_context = continuation.span_context;
+    memset(&options, 0, sizeof(options));
+    options.references = &ref;
+    options.num_references = 1;
+    span = tracer->start_span_with_options(tracer, "async", &options);
+    assert(span != NULL);
+    span->finish(span);
+    destroy(span);
+    assert(reporter.last.parent_span_id == request_id);
+    assert(reporter.last_reference.type ==
+           opentracing_span_reference_follows_from);
+    opentracing_continuation_release(&continuation);
+    destroy(tracer);
+}
+
+static void test_empty(void)
+{
+    mock_reporter reporter;
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_continuation continuation;
+    opentracing_span_context foreign;
+
+    tracer = make_tracer(&reporter);
+    assert(tracer != NULL);
+    assert(opentracing_continuation_capture(&continuation));
+    assert(continuation.span_context == NULL);
+
+    /* Restoring an empty continuation hides the active span. */
+    span = tracer->start_span(tracer, "outer");
+    assert(span != NULL);
+    assert(opentracing_activate_span(span));
+    assert(opentracing_continuation_restore(&continuation));
+    assert(run_span(tracer, &reporter) == 0);
+    opentracing_continuation_suspend(&continuation);
+    opentracing_deactivate_span(span);
+    span->finish(span);
+    destroy(span);
+    opentracing_continuation_release(&continuation);
+
+    /* Contexts that cannot be retained are not captured. */
+    memset(&foreign, 0, sizeof(foreign));
+    assert(!opentracing_continuation_capture_context(&continuation,
+                                                     &foreign));
+    assert(continuation.span_context == NULL);
+    destroy(tracer);
+}
+
+typedef struct thread_arg {
+    opentracing_tracer* tracer;
+    mock_reporter* reporter;
+    const opentracing_continuation* continuation;
+    uint64_t parent_id;
+} thread_arg;
+
+static void* run_thread(void* arg)
+{
+    thread_arg* t;
+
+    t = (thread_arg*) arg;
+    assert(opentracing_continuation_restore(t->continuation));
+    t->parent_id = run_span(t->tracer, t->reporter);
+    opentracing_continuation_suspend(t->continuation);
+    return NULL;
+}
+
+static void test_thread(void)
+{
+    mock_reporter reporter;
+    opentracing_continuation continuation;
+    thread_arg arg;
+    pthread_t thread;
+    uint64_t request_id;
+
+    /* Work handed to another thread stays in the same trace. */
+    arg.tracer = make_tracer(&reporter);
+    assert(arg.tracer != NULL);
+    arg.reporter = &reporter;
+    arg.continuation = &continuation;
+    request_id = start_request(arg.tracer, &reporter, &continuation);
+    assert(pthread_create(&thread, NULL, &run_thread, &arg) == 0);
+    assert(pthread_join(thread, NULL) == 0);
+    assert(arg.parent_id == request_id);
+    opentracing_continuation_release(&continuation);
+    destroy(arg.tracer);
+}
+
+int main(void)
+{
+    test_restore();
+    test_reference();
+    test_empty();
+    test_thread();
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <pthread.h>
 #include <string.h>
 
 #include <opentracing-c/dynamic_load.h>
@@ -7,11 +8,71 @@
 #include "mock_tracing_lib_names.h"
 #endif /* OPENTRACINGC_HAVE_WEAK_SYMBOLS */
 
+typedef struct load_result {
+    pthread_mutex_t mutex;
+    opentracing_bool done;
+    opentracing_dynamic_load_error_code return_code;
+    opentracing_tracer* global_tracer;
+} load_result;
+
+static void load_callback(void* arg,
+                          opentracing_dynamic_load_error_code return_code)
+{
+    load_result* result;
+
+    result = (load_result*) arg;
+    pthread_mutex_lock(&result->mutex);
+    result->return_code = return_code;
+    result->global_tracer = opentracing_global_tracer();
+    result->done = opentracing_true;
+    pthread_mutex_unlock(&result->mutex);
+}
+
+static opentracing_dynamic_load_error_code
+load_async(const char* lib,
+           const char* config,
+           opentracing_library_handle* handle,
+           char* error,
+           int error_length,
+           opentracing_tracer** global_tracer)
+{
+    load_result result;
+    opentracing_dynamic_load_error_code error_code;
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+
+    memset(&result, 0, sizeof(result));
+    pthread_mutex_init(&result.mutex, NULL);
+    memset(error, 0, (size_t) error_length);
+    error_code = opentracing_dynamically_load_tracer_async(
+        lib, config, handle, &load_callback, &result, error, error_length);
+    if (error_code == opentracing_dynamic_load_error_code_success) {
+        /* Keep using the global tracer while it is swapped. */
+        pthread_mutex_lock(&result.mutex);
+        while (!result.done) {
+            pthread_mutex_unlock(&result.mutex);
+            tracer = opentracing_global_tracer_acquire();
+            span = tracer->start_span(tracer, "loading");
+            assert(span != NULL);
+            ((opentracing_destructible*) span)
+                ->destroy((opentracing_destructible*) span);
+            opentracing_global_tracer_release();
+            pthread_mutex_lock(&result.mutex);
+        }
+        pthread_mutex_unlock(&result.mutex);
+        error_code = result.return_code;
+        *global_tracer = result.global_tracer;
+    }
+    pthread_mutex_destroy(&result.mutex);
+    return error_code;
+}
+
 int main(void)
 {
     opentracing_library_handle handle;
     char error[256];
     opentracing_dynamic_load_error_code error_code;
+    opentracing_tracer* global_tracer;
 
     opentracing_library_handle_destroy(NULL);
 
@@ -63,8 +124,53 @@ int main(void)
         ->destroy((opentracing_destructible*) tracer);
     opentracing_library_handle_destroy(&handle);
 
+    /* The global tracer only changes once a load succeeds. */
+    tracer = opentracing_global_tracer();
+    assert(load_async("libdoesnotexist.so",
+                      "",
+                      &handle,
+                      error,
+                      sizeof(error),
+                      &global_tracer) ==
+           opentracing_dynamic_load_error_code_failure);
+    assert(strlen(error) > 0);
+    assert(global_tracer == tracer);
+    assert(handle.lib_handle == NULL);
+
+    assert(load_async(MOCK_TRACING_LIB_NAME,
+                      "invalid",
+                      &handle,
+                      error,
+                      sizeof(error),
+                      &global_tracer) ==
+           opentracing_dynamic_load_error_code_failure);
+    assert(strcmp(error, "Invalid config") == 0);
+    assert(global_tracer == tracer);
+    assert(handle.lib_handle == NULL);
+
+    assert(load_async(MOCK_TRACING_LIB_NAME,
+                      "",
+                      &handle,
+                      error,
+                      sizeof(error),
+                      &global_tracer) ==
+           opentracing_dynamic_load_error_code_success);
+    assert(global_tracer != tracer);
+    assert(opentracing_global_tracer() == global_tracer);
+    assert(handle.lib_handle != NULL);
+    opentracing_init_global_tracer(tracer);
+    opentracing_library_handle_destroy(&handle);
+
 #else
 
+    assert(load_async("libdoesnotexist.so",
+                      "",
+                      &handle,
+                      error,
+                      sizeof(error),
+                      &global_tracer) ==
+           opentracing_dynamic_load_error_code_not_supported);
+
     assert(error_code == opentracing_dynamic_load_error_code_not_supported);
     assert(handle.factory == NULL);
     assert(handle.lib_handle == NULL);
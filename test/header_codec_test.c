@@ -0,0 +1,267 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/header_codec.h>
+#include <opentracing-c/internal/hex.h>
+
+static uint64_t next_random(uint64_t* state)
+{
+    /* xorshift64 */
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void test_hex(void)
+{
+    static const char valid[] = "0123456789abcdefABCDEF";
+    char scalar[17];
+    char simd[17];
+    uint64_t state;
+    uint64_t value;
+    uint64_t scalar_value;
+    uint64_t simd_value;
+    opentracing_bool scalar_ok;
+    opentracing_bool simd_ok;
+    int i;
+    int j;
+
+    state = 88172645463325252ULL;
+    for (i = 0; i < 10000; i++) {
+        value = next_random(&state);
+        opentracing_hex_encode16_scalar(value, scalar);
+        opentracing_hex_encode16(value, simd);
+        assert(memcmp(scalar, simd, 16) == 0);
+        assert(opentracing_hex_decode16(simd, &simd_value));
+        assert(simd_value == value);
+
+        /* Random strings, mostly of hex digits, some with one bad byte. */
+        for (j = 0; j < 16; j++) {
+            simd[j] = valid[next_random(&state) % (sizeof(valid) - 1)];
+        }
+        if (i % 2 == 0) {
+            simd[next_random(&state) % 16] = (char) (next_random(&state) & 0xFF);
+        }
+        scalar_ok = opentracing_hex_decode16_scalar(simd, &scalar_value);
+        simd_ok = opentracing_hex_decode16(simd, &simd_value);
+        assert(scalar_ok == simd_ok);
+        assert(!scalar_ok || scalar_value == simd_value);
+        scalar_ok = opentracing_hex_decode16_lower_scalar(simd, &scalar_value);
+        simd_ok = opentracing_hex_decode16_lower(simd, &simd_value);
+        assert(scalar_ok == simd_ok);
+        assert(!scalar_ok || scalar_value == simd_value);
+    }
+
+    opentracing_hex_encode_u64(0x00000000000000FFULL, scalar);
+    assert(memcmp(scalar, "00000000000000ff", 16) == 0);
+    assert(opentracing_hex_decode_u64("Ff", 2, &value) && value == 0xFF);
+    assert(opentracing_hex_decode_u64("123456789abcdef0", 16, &value) &&
+           value == 0x123456789abcdef0ULL);
+    assert(!opentracing_hex_decode_u64("", 0, &value));
+    assert(!opentracing_hex_decode_u64("12345678901234567", 17, &value));
+    assert(!opentracing_hex_decode_u64("12g4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12 4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12:4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12/4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12`4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12@4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12G4", 4, &value));
+    assert(!opentracing_hex_decode_u64("12\2004", 4, &value));
+
+    assert(opentracing_hex_decode16_lower("0123456789abcdef", &value) &&
+           value == 0x0123456789abcdefULL);
+    assert(!opentracing_hex_decode16_lower("0123456789abcdeF", &value));
+    assert(!opentracing_hex_decode16_lower("A123456789abcdef", &value));
+}
+
+static void test_trace_id(void)
+{
+    opentracing_trace_id trace_id;
+    char out[32];
+
+    assert(opentracing_hex_decode_trace_id(
+        "0af7651916cd43dd8448eb211c80319c", 32, &trace_id));
+    assert(trace_id.high == 0x0af7651916cd43ddULL);
+    assert(trace_id.low == 0x8448eb211c80319cULL);
+    opentracing_hex_encode_trace_id(&trace_id, out);
+    assert(memcmp(out, "0af7651916cd43dd8448eb211c80319c", 32) == 0);
+
+    assert(opentracing_hex_decode_trace_id("abc", 3, &trace_id));
+    assert(trace_id.high == 0 && trace_id.low == 0xabc);
+    assert(opentracing_hex_decode_trace_id(
+        "1ffffffffffffffff", 17, &trace_id));
+    assert(trace_id.high == 1 && trace_id.low == ~(uint64_t) 0);
+    assert(!opentracing_hex_decode_trace_id(
+        "0af7651916cd43dd8448eb211c80319c0", 33, &trace_id));
+    assert(!opentracing_hex_decode_trace_id(
+        "0af7651916cd43dd-448eb211c80319c", 32, &trace_id));
+}
+
+static void test_traceparent(void)
+{
+    static const char header[] =
+        "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+    opentracing_trace_id trace_id;
+    uint64_t span_id;
+    opentracing_bool sampled;
+    char out[OPENTRACINGC_TRACEPARENT_LENGTH + 1];
+    char buffer[128];
+
+    assert(strlen(header) == OPENTRACINGC_TRACEPARENT_LENGTH);
+    assert(opentracing_traceparent_decode(
+               header, strlen(header), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_success);
+    assert(trace_id.high == 0x0af7651916cd43ddULL);
+    assert(span_id == 0xb7ad6b7169203331ULL);
+    assert(sampled);
+    opentracing_traceparent_encode(&trace_id, span_id, sampled, out);
+    assert(strcmp(out, header) == 0);
+
+    /* Future versions may append fields. */
+    strcpy(buffer, header);
+    buffer[1] = '1';
+    strcat(buffer, "-extra");
+    assert(opentracing_traceparent_decode(
+               buffer, strlen(buffer), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_success);
+    buffer[55] = 'x';
+    assert(opentracing_traceparent_decode(
+               buffer, strlen(buffer), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    /* Version 00 has no extra fields. */
+    strcpy(buffer, header);
+    strcat(buffer, "-extra");
+    assert(opentracing_traceparent_decode(
+               buffer, strlen(buffer), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    strcpy(buffer, header);
+    buffer[0] = 'f';
+    buffer[1] = 'f';
+    assert(opentracing_traceparent_decode(
+               buffer, strlen(buffer), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    assert(opentracing_traceparent_decode(
+               "00-00000000000000000000000000000000-b7ad6b7169203331-01",
+               55,
+               &trace_id,
+               &span_id,
+               &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(opentracing_traceparent_decode(
+               "00-0af7651916cd43dd8448eb211c80319c-0000000000000000-01",
+               55,
+               &trace_id,
+               &span_id,
+               &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(opentracing_traceparent_decode(
+               "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-0z",
+               55,
+               &trace_id,
+               &span_id,
+               &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+
+    /* Unlike the other formats, traceparent is lowercase only. */
+    assert(opentracing_traceparent_decode(
+               "00-0AF7651916CD43DD8448EB211C80319C-b7ad6b7169203331-01",
+               55,
+               &trace_id,
+               &span_id,
+               &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(opentracing_traceparent_decode(
+               "00-0af7651916cd43dd8448eb211c80319c-B7AD6B7169203331-01",
+               55,
+               &trace_id,
+               &span_id,
+               &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    strcpy(buffer, header);
+    buffer[1] = '1';
+    buffer[54] = 'F';
+    assert(opentracing_traceparent_decode(
+               buffer, strlen(buffer), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(opentracing_traceparent_decode(
+               header, 54, &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+}
+
+static opentracing_propagation_error_code decode_b3(const char* str,
+                                                    opentracing_bool* sampled)
+{
+    opentracing_trace_id trace_id;
+    uint64_t span_id;
+    return opentracing_b3_decode(
+        str, strlen(str), &trace_id, &span_id, sampled);
+}
+
+static void test_b3(void)
+{
+    static const char header[] =
+        "80f198ee56343ba864fe8b2a57d3eff7-e457b5a2e4d86bd1-1";
+    opentracing_trace_id trace_id;
+    uint64_t span_id;
+    opentracing_bool sampled;
+    char out[OPENTRACINGC_B3_LENGTH + 1];
+
+    assert(strlen(header) == OPENTRACINGC_B3_LENGTH);
+    sampled = opentracing_false;
+    assert(opentracing_b3_decode(
+               header, strlen(header), &trace_id, &span_id, &sampled) ==
+           opentracing_propagation_error_code_success);
+    assert(trace_id.high == 0x80f198ee56343ba8ULL);
+    assert(trace_id.low == 0x64fe8b2a57d3eff7ULL);
+    assert(span_id == 0xe457b5a2e4d86bd1ULL);
+    assert(sampled);
+    opentracing_b3_encode(&trace_id, span_id, sampled, out);
+    assert(strcmp(out, header) == 0);
+
+    sampled = opentracing_true;
+    assert(opentracing_b3_decode("64fe8b2a57d3eff7-e457b5a2e4d86bd1",
+                                 33,
+                                 &trace_id,
+                                 &span_id,
+                                 &sampled) ==
+           opentracing_propagation_error_code_success);
+    assert(trace_id.high == 0 && trace_id.low == 0x64fe8b2a57d3eff7ULL);
+    assert(sampled);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd1-0-05e3ac9a4f6e3b90",
+                     &sampled) == opentracing_propagation_error_code_success);
+    assert(!sampled);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd1-d", &sampled) ==
+           opentracing_propagation_error_code_success);
+    assert(sampled);
+    assert(decode_b3("0", &sampled) ==
+           opentracing_propagation_error_code_span_context_not_found);
+    assert(!sampled);
+
+    assert(decode_b3("x", &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd", &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd1-2", &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd1-1-", &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(decode_b3("64fe8b2a57d3eff7-e457b5a2e4d86bd1-1-05e3ac9a4f6e3b9",
+                     &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+    assert(decode_b3("64fe8b2a57d3eff7e457b5a2e4d86bd1", &sampled) ==
+           opentracing_propagation_error_code_span_context_corrupted);
+}
+
+int main(void)
+{
+    test_hex();
+    test_trace_id();
+    test_traceparent();
+    test_b3();
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <opentracing-c/intern.h>
+#include <opentracing-c/tracer.h>
+
+/* Spans more than one storage chunk. */
+#define NUM_STRINGS 3000
+#define NUM_THREADS 4
+
+static opentracing_string_handle thread_handles[NUM_THREADS][NUM_STRINGS];
+
+static void* register_strings(void* arg)
+{
+    opentracing_string_handle* handles;
+    char str[32];
+    int i;
+
+    handles = (opentracing_string_handle*) arg;
+    for (i = 0; i < NUM_STRINGS; i++) {
+        sprintf(str, "key%d", i);
+        handles[i] = opentracing_intern(str);
+        assert(handles[i] != OPENTRACINGC_INVALID_STRING_HANDLE);
+        assert(strcmp(opentracing_interned_string(handles[i]), str) == 0);
+    }
+    return NULL;
+}
+
+static void test_concurrent_registration(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+    int j;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_create(&threads[i],
+                              NULL,
+                              &register_strings,
+                              thread_handles[i]) == 0);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+    for (i = 1; i < NUM_THREADS; i++) {
+        for (j = 0; j < NUM_STRINGS; j++) {
+            assert(thread_handles[i][j] == thread_handles[0][j]);
+        }
+    }
+}
+
+static int num_set_tag_calls = 0;
+static int num_log_fields_calls = 0;
+static char last_key[32];
+
+static void counting_set_tag(opentracing_span* span,
+                             const char* key,
+                             const opentracing_value* value)
+{
+    (void) span;
+    (void) value;
+    num_set_tag_calls++;
+    strncpy(last_key, key, sizeof(last_key) - 1);
+}
+
+static void counting_log_fields(opentracing_span* span,
+                                const opentracing_log_field* fields,
+                                int num_fields)
+{
+    (void) span;
+    num_log_fields_calls++;
+    assert(num_fields == 2);
+    assert(strcmp(fields[0].key, "event") == 0);
+    assert(strcmp(fields[1].key, "message") == 0);
+}
+
+static void test_fallback(void)
+{
+    opentracing_tracer* tracer;
+    opentracing_tracer old_tracer;
+    opentracing_span* span;
+    opentracing_span old_span;
+    opentracing_interned_log_field fields[3];
+    opentracing_value value;
+
+    tracer = opentracing_global_tracer();
+    span = opentracing_tracer_start_span_interned(
+        tracer, opentracing_intern("op"), NULL);
+    assert(span != NULL);
+
+    /* Span built before the interned slots existed. */
+    old_span = *span;
+    old_span.header.size = offsetof(opentracing_span, set_tag_interned);
+    old_span.set_tag = &counting_set_tag;
+    old_span.log_fields = &counting_log_fields;
+    assert(!OPENTRACINGC_SPAN_HAS(&old_span, set_tag_interned));
+
+    value.type = opentracing_value_null;
+    opentracing_span_set_tag_interned(
+        &old_span, opentracing_intern("component"), &value);
+    assert(num_set_tag_calls == 1);
+    assert(strcmp(last_key, "component") == 0);
+    opentracing_span_set_tag_interned(
+        &old_span, OPENTRACINGC_INVALID_STRING_HANDLE, &value);
+    assert(num_set_tag_calls == 1);
+
+    /* Fields with invalid keys are dropped. */
+    fields[0].key = opentracing_intern("event");
+    fields[0].value = value;
+    fields[1].key = OPENTRACINGC_INVALID_STRING_HANDLE;
+    fields[1].value = value;
+    fields[2].key = opentracing_intern("message");
+    fields[2].value = value;
+    opentracing_span_log_fields_interned(&old_span, fields, 3);
+    assert(num_log_fields_calls == 1);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+
+    old_tracer = *tracer;
+    old_tracer.header.size = offsetof(opentracing_tracer, start_span_interned);
+    span = opentracing_tracer_start_span_interned(
+        &old_tracer, opentracing_intern("op"), NULL);
+    assert(span != NULL);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    assert(opentracing_tracer_start_span_interned(
+               &old_tracer, OPENTRACINGC_INVALID_STRING_HANDLE, NULL) == NULL);
+}
+
+int main(void)
+{
+    opentracing_string_handle handle;
+    char copy[16];
+
+    handle = opentracing_intern("http.method");
+    assert(handle != OPENTRACINGC_INVALID_STRING_HANDLE);
+    assert(opentracing_intern("http.url") != handle);
+    /* Equal contents, different address. */
+    strcpy(copy, "http.method");
+    assert(opentracing_intern(copy) == handle);
+    assert(strcmp(opentracing_interned_string(handle), "http.method") == 0);
+    assert(opentracing_interned_string(OPENTRACINGC_INVALID_STRING_HANDLE) ==
+           NULL);
+    assert(opentracing_interned_string((opentracing_string_handle) -1) ==
+           NULL);
+    assert(opentracing_interned_string(handle + 100000) == NULL);
+    assert(strcmp(opentracing_interned_string(opentracing_intern("")), "") ==
+           0);
+
+    test_concurrent_registration();
+    test_fallback();
+    return 0;
+}
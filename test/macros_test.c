@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/macros.h>
+
+#include "mock_reporter.h"
+
+/* Built twice, once with OPENTRACINGC_DISABLE defined. */
+
+static int num_evaluations = 0;
+
+static const char* evaluate(const char* str)
+{
+    num_evaluations++;
+    return str;
+}
+
+static opentracing_tracer* evaluate_tracer(opentracing_tracer* tracer)
+{
+    num_evaluations++;
+    return tracer;
+}
+
+int main(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    opentracing_tracer* noop_tracer;
+    opentracing_span* span;
+    opentracing_span* null_span;
+    opentracing_log_field field;
+    opentracing_log_record record;
+    opentracing_tag tags[2];
+    opentracing_value value;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = &reporter.base;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+
+    field.key = "event";
+    field.value.type = opentracing_value_string;
+    field.value.value.string_value = "retry";
+    value.type = opentracing_value_null;
+    memset(&record, 0, sizeof(record));
+    record.fields = &field;
+    record.num_fields = 1;
+    tags[0].key = "batch0";
+    tags[0].value = value;
+    tags[1].key = "batch1";
+    tags[1].value = value;
+
+    OPENTRACINGC_START_SPAN(span, evaluate_tracer(tracer), evaluate("a"));
+    OPENTRACINGC_SET_TAG(span, evaluate("null"), &value);
+    OPENTRACINGC_SET_TAG_BOOL(span, "bool", opentracing_true);
+    OPENTRACINGC_SET_TAG_DOUBLE(span, "double", 0.5);
+    OPENTRACINGC_SET_TAG_INT64(span, "int64", -1);
+    OPENTRACINGC_SET_TAG_UINT64(span, "uint64", 1);
+    OPENTRACINGC_SET_TAG_STRING(span, "string", evaluate("value"));
+    OPENTRACINGC_SET_TAG_STRING_VIEW(span, "string_view", "value", 2);
+    OPENTRACINGC_SET_TAGS(span, tags, 2);
+    OPENTRACINGC_LOG_FIELDS(span, &field, 1);
+    OPENTRACINGC_LOG_RECORDS(span, &record, 1);
+    OPENTRACINGC_FINISH_SPAN(span);
+    assert(span == NULL);
+
+    OPENTRACINGC_START_SPAN_WITH_OPTIONS(span, tracer, "b", NULL);
+    OPENTRACINGC_FINISH_SPAN_WITH_OPTIONS(span, NULL);
+    assert(span == NULL);
+
+    /* Macros accept NULL spans. */
+    null_span = NULL;
+    OPENTRACINGC_SET_TAG_BOOL(null_span, "bool", opentracing_true);
+    OPENTRACINGC_LOG_FIELDS(null_span, &field, 1);
+    OPENTRACINGC_FINISH_SPAN(null_span);
+
+    /* The tracer outlives a swap until the global span is finished, then
+       it is destroyed. */
+    noop_tracer = opentracing_global_tracer();
+    opentracing_init_global_tracer(tracer);
+    OPENTRACINGC_START_GLOBAL_SPAN(span, "c");
+    opentracing_init_global_tracer(noop_tracer);
+#ifndef OPENTRACINGC_DISABLE
+    assert(!reporter.destroyed);
+#endif /* OPENTRACINGC_DISABLE */
+    OPENTRACINGC_FINISH_GLOBAL_SPAN(span);
+    assert(span == NULL);
+    assert(reporter.destroyed);
+
+#ifdef OPENTRACINGC_DISABLE
+    assert(num_evaluations == 0);
+    assert(reporter.num_reported == 0);
+#else
+    assert(num_evaluations == 4);
+    assert(reporter.num_reported == 3);
+    assert(reporter.num_tags == 9);
+    assert(reporter.num_logs == 2);
+    assert(strcmp(reporter.last_operation_name, "c") == 0);
+#endif /* OPENTRACINGC_DISABLE */
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#ifndef MOCK_REPORTER_H
+#define MOCK_REPORTER_H
+
+#include <assert.h>
+#include <string.h>
+
+#include <opentracing-c/reporter.h>
+
+/* Reporter that remembers what it was given, shared by the tests. */
+
+#define MOCK_REPORTER_MAX_SPANS 64
+
+typedef struct mock_reporter {
+    opentracing_reporter base;
+    int num_reported;
+    int num_flushed;
+    opentracing_bool destroyed;
+
+    /* Tags and logs of every reported span. */
+    int num_tags;
+    int num_logs;
+
+    /* Last reported span, with its pointers cleared. */
+    opentracing_span_data last;
+    char last_operation_name[64];
+    opentracing_value last_tag;
+    opentracing_span_data_reference last_reference;
+    opentracing_timestamp last_first_log_timestamp;
+    char last_string_view[64];
+
+    /* Operation names of the first spans reported, in order. */
+    char operation_names[MOCK_REPORTER_MAX_SPANS][32];
+} mock_reporter;
+
+static void mock_reporter_destroy(opentracing_destructible* destructible)
+{
+    ((mock_reporter*) destructible)->destroyed = opentracing_true;
+}
+
+static void mock_reporter_report(opentracing_reporter* reporter,
+                                 const opentracing_span_data* const* spans,
+                                 int num_spans)
+{
+    mock_reporter* r;
+    const opentracing_span_data* span;
+    const opentracing_string_view* view;
+    int i;
+    int j;
+
+    r = (mock_reporter*) reporter;
+    for (i = 0; i < num_spans; i++) {
+        span = spans[i];
+        if (r->num_reported < MOCK_REPORTER_MAX_SPANS) {
+            strncpy(r->operation_names[r->num_reported],
+                    span->operation_name,
+                    sizeof(r->operation_names[0]) - 1);
+        }
+        r->num_reported++;
+        r->num_tags += span->num_tags;
+        r->num_logs += span->num_logs;
+
+        r->last = *span;
+        memset(r->last_operation_name, 0, sizeof(r->last_operation_name));
+        strncpy(r->last_operation_name,
+                span->operation_name,
+                sizeof(r->last_operation_name) - 1);
+        if (span->num_tags > 0) {
+            r->last_tag = span->tags[span->num_tags - 1].value;
+        }
+        if (span->num_references > 0) {
+            r->last_reference = span->references[0];
+        }
+        if (span->num_logs > 0) {
+            r->last_first_log_timestamp = span->logs[0].timestamp;
+        }
+        for (j = 0; j < span->num_tags; j++) {
+            if (span->tags[j].value.type == opentracing_value_string_view) {
+                view = &span->tags[j].value.value.string_view_value;
+                assert(view->data[view->length] == '\0');
+                assert(view->length < sizeof(r->last_string_view));
+                memcpy(r->last_string_view, view->data, view->length + 1);
+            }
+        }
+        r->last.operation_name = NULL;
+        r->last.tags = NULL;
+        r->last.logs = NULL;
+        r->last.references = NULL;
+    }
+}
+
+static void mock_reporter_flush(opentracing_reporter* reporter)
+{
+    ((mock_reporter*) reporter)->num_flushed++;
+}
+
+static void mock_reporter_init(mock_reporter* reporter)
+{
+    memset(reporter, 0, sizeof(*reporter));
+    reporter->base.base.destroy = &mock_reporter_destroy;
+    reporter->base.report = &mock_reporter_report;
+    reporter->base.flush = &mock_reporter_flush;
+}
+
+#endif /* MOCK_REPORTER_H */
@@ -4,16 +4,21 @@
 
 #include <opentracing-c/dynamic_load.h>
 
+/* Copy of the no-op tracer, so tests can tell it apart. */
+static opentracing_tracer mock_tracer;
+
 opentracing_bool mock_tracer_factory(const char* config,
                                      opentracing_tracer** tracer,
                                      char* error_buffer,
                                      int error_buffer_length)
 {
-    (void) config;
-    (void) error_buffer;
-    (void) error_buffer_length;
     assert(tracer != NULL);
-    *tracer = opentracing_global_tracer();
+    if (strcmp(config, "invalid") == 0) {
+        snprintf(error_buffer, error_buffer_length, "Invalid config");
+        return opentracing_false;
+    }
+    mock_tracer = *opentracing_global_tracer();
+    *tracer = &mock_tracer;
     return opentracing_true;
 }
 
@@ -0,0 +1,243 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/opentracing.hpp>
+
+#include "mock_reporter.h"
+
+namespace {
+
+struct Fixture {
+    mock_reporter reporter;
+    opentracing_tracer* tracer;
+
+    Fixture()
+    {
+        mock_reporter_init(&reporter);
+        opentracing_basic_tracer_options options;
+        std::memset(&options, 0, sizeof(options));
+        options.reporter = &reporter.base;
+        tracer = opentracing_make_basic_tracer(&options);
+        assert(tracer != nullptr);
+    }
+
+    ~Fixture() { tracer->base.destroy(&tracer->base); }
+};
+
+void test_span()
+{
+    Fixture f;
+    opentracingc::Tracer tracer(f.tracer);
+
+    {
+        opentracingc::Span span = tracer.start_span("scoped");
+        assert(span);
+        span.set_tag("int", 7);
+        assert(f.reporter.num_reported == 0);
+    }
+    assert(f.reporter.num_reported == 1);
+    assert(f.reporter.last_tag.type == opentracing_value_int64);
+    assert(f.reporter.last_tag.value.int64_value == 7);
+
+    /* Finishing explicitly reports once, moving transfers ownership. */
+    opentracingc::Span span = tracer.start_span(std::string("moved"));
+    span.finish();
+    span.finish();
+    assert(f.reporter.num_reported == 2);
+    opentracingc::Span other(std::move(span));
+    assert(!span);
+    assert(other);
+    span = std::move(other);
+    span.reset();
+    assert(!span);
+    assert(f.reporter.num_reported == 2);
+
+    /* Moving onto a live span finishes it. */
+    span = tracer.start_span("first");
+    span = tracer.start_span("second");
+    assert(f.reporter.num_reported == 3);
+    span.reset();
+    assert(f.reporter.num_reported == 4);
+}
+
+void test_values()
+{
+    Fixture f;
+    opentracingc::Tracer tracer(f.tracer);
+    std::string str("string");
+    const char request[] = "GET /index.html HTTP/1.1";
+    opentracing_string_view view = {request + 4, 11};
+
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("bool", true);
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_bool);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("double", 1.5f);
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_double);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("uint64", 42u);
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_uint64);
+    assert(f.reporter.last_tag.value.uint64_value == 42);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("int64", static_cast<short>(-3));
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_int64);
+    assert(f.reporter.last_tag.value.int64_value == -3);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag(str, str);
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_string);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("view", view);
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_string_view);
+    assert(f.reporter.last_tag.value.string_view_value.length == 11);
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("null", nullptr);
+        span.log({{"event", "error"}, {"code", 500}});
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_null);
+    assert(f.reporter.last.num_logs == 1);
+#if __cplusplus >= 201703L
+    {
+        opentracingc::Span span = tracer.start_span("values");
+        span.set_tag("string_view", std::string_view(request, 3));
+    }
+    assert(f.reporter.last_tag.type == opentracing_value_string_view);
+    assert(f.reporter.last_tag.value.string_view_value.length == 3);
+#endif /* __cplusplus >= 201703L */
+}
+
+void test_span_context()
+{
+    Fixture f;
+    opentracingc::Tracer tracer(f.tracer);
+    opentracingc::SpanContext context;
+    uint64_t parent_id;
+    int num_items;
+
+    assert(!context);
+    {
+        opentracingc::Span parent = tracer.start_span("parent");
+        parent.set_baggage_item("tenant", "acme");
+        assert(std::strcmp(parent.baggage_item("tenant"), "acme") == 0);
+        context = opentracingc::SpanContext::retain(parent.context());
+        assert(context.get() == parent.context());
+
+        /* Borrowed contexts survive a baggage change. */
+        opentracing_span_context* borrowed = parent.context();
+        parent.set_baggage_item("region", "eu");
+        assert(parent.context() != borrowed);
+        num_items = 0;
+        opentracingc::SpanContext::retain(borrowed).foreach_baggage_item(
+            [&](const char*, const char*) {
+                num_items++;
+                return true;
+            });
+        assert(num_items == 1);
+    }
+    parent_id = f.reporter.last.span_id;
+
+    /* The retained context outlives its span. */
+    num_items = 0;
+    context.foreach_baggage_item([&](const char* key, const char* value) {
+        assert(std::strcmp(key, "tenant") == 0);
+        assert(std::strcmp(value, "acme") == 0);
+        num_items++;
+        return true;
+    });
+    assert(num_items == 1);
+    {
+        opentracingc::Span child = tracer.start_span(
+            "child", {opentracingc::follows_from(context)});
+        assert(child);
+    }
+    assert(f.reporter.last.parent_span_id == parent_id);
+
+    opentracingc::SpanContext moved(std::move(context));
+    assert(!context);
+    assert(moved);
+}
+
+void test_scope()
+{
+    Fixture f;
+    opentracingc::Tracer tracer(f.tracer);
+    uint64_t parent_id;
+
+    opentracingc::Span parent = tracer.start_span("parent");
+    {
+        opentracingc::Scope scope(parent);
+        assert(scope);
+        assert(opentracing_active_span() == parent.get());
+        opentracingc::Span child = tracer.start_span("child");
+        {
+            opentracingc::Scope inner(child);
+            opentracingc::Scope moved(std::move(inner));
+            assert(opentracing_active_span() == child.get());
+        }
+        assert(opentracing_active_span() == parent.get());
+    }
+    assert(opentracing_active_span() == nullptr);
+    parent.finish();
+    parent_id = f.reporter.last.span_id;
+    assert(f.reporter.num_reported == 2);
+
+    /* A retained context resumes the trace without its span. */
+    opentracingc::SpanContext context =
+        opentracingc::SpanContext::retain(parent.context());
+    parent.reset();
+    {
+        opentracingc::Scope scope(context);
+        assert(opentracing_active_span_context() == context.get());
+        tracer.start_span("resumed").finish();
+    }
+    assert(f.reporter.last.parent_span_id == parent_id);
+}
+
+void test_global()
+{
+    mock_reporter reporter;
+    mock_reporter_init(&reporter);
+    opentracing_basic_tracer_options options;
+    std::memset(&options, 0, sizeof(options));
+    options.reporter = &reporter.base;
+    opentracing_tracer* noop = opentracing_global_tracer();
+    opentracing_init_global_tracer(opentracing_make_basic_tracer(&options));
+
+    /* A swap destroys the old tracer once the handle is gone. */
+    {
+        opentracingc::GlobalTracer tracer = opentracingc::Tracer::global();
+        opentracingc::Span span = tracer.start_span("global");
+        opentracing_init_global_tracer(noop);
+        assert(opentracingc::Tracer::global().get() == noop);
+        assert(!reporter.destroyed);
+    }
+    assert(reporter.num_reported == 1);
+    assert(reporter.destroyed);
+}
+
+} /* namespace */
+
+int main()
+{
+    test_span();
+    test_values();
+    test_span_context();
+    test_scope();
+    test_global();
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <opentracing-c/sampler.h>
+
+#define NUM_TRACES 100000
+#define NUM_THREADS 4
+#define NUM_THREAD_TRACES 10000
+#define NUM_RATE_LIMITED_TRACES 1000
+#define RATE_LIMIT 100.0
+#define ADAPTIVE_TARGET 100
+#define ADAPTIVE_INTERVAL_MS 100
+#define ADAPTIVE_RUN_MS 300
+
+static void destroy_sampler(opentracing_sampler* sampler)
+{
+    ((opentracing_destructible*) sampler)
+        ->destroy((opentracing_destructible*) sampler);
+}
+
+static int count_operation_sampled(opentracing_sampler* sampler,
+                                   const char* operation_name,
+                                   int num_traces)
+{
+    opentracing_trace_id trace_id;
+    uint64_t x;
+    int num_sampled;
+    int i;
+
+    /* Spread trace IDs evenly, as random IDs would be. */
+    x = 0;
+    num_sampled = 0;
+    for (i = 0; i < num_traces; i++) {
+        x += UINT64_C(0x9E3779B97F4A7C15);
+        trace_id.high = 0;
+        trace_id.low = x;
+        if (sampler->is_sampled(sampler, &trace_id, operation_name)) {
+            num_sampled++;
+        }
+    }
+    return num_sampled;
+}
+
+static int count_sampled(opentracing_sampler* sampler, int num_traces)
+{
+    return count_operation_sampled(sampler, "op", num_traces);
+}
+
+static int64_t elapsed_ms(const struct timespec* start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - start->tv_sec) * 1000 +
+           (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void test_const(void)
+{
+    opentracing_sampler* sampler;
+
+    sampler = opentracing_make_const_sampler(opentracing_true);
+    assert(sampler != NULL);
+    assert(count_sampled(sampler, 10) == 10);
+    destroy_sampler(sampler);
+
+    sampler = opentracing_make_const_sampler(opentracing_false);
+    assert(sampler != NULL);
+    assert(count_sampled(sampler, 10) == 0);
+    destroy_sampler(sampler);
+}
+
+static void test_probabilistic(void)
+{
+    opentracing_sampler* sampler;
+    int num_sampled;
+
+    sampler = opentracing_make_probabilistic_sampler(0.0);
+    assert(sampler != NULL);
+    assert(count_sampled(sampler, NUM_TRACES) == 0);
+    destroy_sampler(sampler);
+
+    sampler = opentracing_make_probabilistic_sampler(2.0);
+    assert(sampler != NULL);
+    assert(count_sampled(sampler, NUM_TRACES) == NUM_TRACES);
+    destroy_sampler(sampler);
+
+    sampler = opentracing_make_probabilistic_sampler(0.25);
+    assert(sampler != NULL);
+    num_sampled = count_sampled(sampler, NUM_TRACES);
+    assert(num_sampled > NUM_TRACES / 4 - NUM_TRACES / 100);
+    assert(num_sampled < NUM_TRACES / 4 + NUM_TRACES / 100);
+    destroy_sampler(sampler);
+}
+
+typedef struct thread_arg {
+    opentracing_sampler* sampler;
+    int num_sampled;
+} thread_arg;
+
+static void* sample_traces(void* arg)
+{
+    thread_arg* t;
+
+    t = (thread_arg*) arg;
+    t->num_sampled = count_sampled(t->sampler, NUM_THREAD_TRACES);
+    return NULL;
+}
+
+static void test_rate_limiting(void)
+{
+    opentracing_sampler* sampler;
+    pthread_t threads[NUM_THREADS];
+    thread_arg args[NUM_THREADS];
+    struct timespec delay;
+    int num_sampled;
+    int i;
+
+    assert(opentracing_make_rate_limiting_sampler(0.0) == NULL);
+    assert(opentracing_make_rate_limiting_sampler(-1.0) == NULL);
+
+    /* A full bucket allows one second's worth, then refills over time. */
+    sampler = opentracing_make_rate_limiting_sampler(RATE_LIMIT);
+    assert(sampler != NULL);
+    num_sampled = count_sampled(sampler, NUM_RATE_LIMITED_TRACES);
+    assert(num_sampled >= (int) RATE_LIMIT);
+    assert(num_sampled <= RATE_LIMIT + RATE_LIMIT / 10);
+    delay.tv_sec = 0;
+    delay.tv_nsec = 100000000L;
+    nanosleep(&delay, NULL);
+    num_sampled = count_sampled(sampler, NUM_RATE_LIMITED_TRACES);
+    assert(num_sampled >= RATE_LIMIT / 10 - 1);
+    assert(num_sampled <= RATE_LIMIT / 2);
+    destroy_sampler(sampler);
+
+    /* Concurrent callers share the same limit. */
+    sampler = opentracing_make_rate_limiting_sampler(RATE_LIMIT);
+    assert(sampler != NULL);
+    for (i = 0; i < NUM_THREADS; i++) {
+        args[i].sampler = sampler;
+        assert(pthread_create(&threads[i], NULL, &sample_traces, &args[i]) ==
+               0);
+    }
+    num_sampled = 0;
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+        num_sampled += args[i].num_sampled;
+    }
+    assert(num_sampled >= (int) RATE_LIMIT);
+    assert(num_sampled <= RATE_LIMIT * 2);
+    destroy_sampler(sampler);
+
+    /* Limits below one per second still allow a single trace. */
+    sampler = opentracing_make_rate_limiting_sampler(0.5);
+    assert(sampler != NULL);
+    assert(count_sampled(sampler, 10) == 1);
+    destroy_sampler(sampler);
+}
+
+static void test_adaptive(void)
+{
+    opentracing_adaptive_sampler_options options;
+    opentracing_sampler* sampler;
+    struct timespec start;
+    int num_sampled;
+
+    memset(&options, 0, sizeof(options));
+    assert(opentracing_make_adaptive_sampler(&options) == NULL);
+
+    options.target_per_second = ADAPTIVE_TARGET;
+    options.adjust_interval_ms = ADAPTIVE_INTERVAL_MS;
+    options.max_operations = 2;
+    sampler = opentracing_make_adaptive_sampler(&options);
+    assert(sampler != NULL);
+
+    /* Busy operations are brought down to the target rate. */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    num_sampled = 0;
+    while (elapsed_ms(&start) < ADAPTIVE_RUN_MS) {
+        num_sampled += count_operation_sampled(sampler, "health", 1000);
+    }
+    assert(num_sampled > 0);
+    assert(num_sampled <=
+           2 * ADAPTIVE_TARGET * (elapsed_ms(&start) + ADAPTIVE_INTERVAL_MS) /
+               1000);
+
+    /* Rare operations keep being sampled. */
+    assert(count_operation_sampled(sampler, "checkout", 5) == 5);
+
+    /* Operations beyond the limit use the default rate. */
+    assert(count_operation_sampled(sampler, "other", 100) == 0);
+    destroy_sampler(sampler);
+
+    options.default_rate = 1.0;
+    options.max_operations = 1;
+    sampler = opentracing_make_adaptive_sampler(&options);
+    assert(sampler != NULL);
+    assert(count_operation_sampled(sampler, "first", 5) == 5);
+    assert(count_operation_sampled(sampler, "second", 100) == 100);
+    destroy_sampler(sampler);
+}
+
+int main(void)
+{
+    test_const();
+    test_probabilistic();
+    test_rate_limiting();
+    test_adaptive();
+    return 0;
+}
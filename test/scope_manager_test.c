@@ -0,0 +1,145 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/scope_manager.h>
+
+#include "mock_reporter.h"
+
+#define DEEP_NESTING 100
+
+/* Spans are only compared, so any distinct addresses will do. */
+static opentracing_span fake_spans[DEEP_NESTING];
+
+static void test_nesting(void)
+{
+    int i;
+
+    assert(opentracing_active_span() == NULL);
+    for (i = 0; i < DEEP_NESTING; i++) {
+        assert(opentracing_activate_span(&fake_spans[i]));
+        assert(opentracing_active_span() == &fake_spans[i]);
+    }
+    for (i = DEEP_NESTING - 1; i >= 0; i--) {
+        assert(opentracing_active_span() == &fake_spans[i]);
+        opentracing_deactivate_span(&fake_spans[i]);
+    }
+    assert(opentracing_active_span() == NULL);
+
+    /* Activating NULL hides the active span. */
+    assert(opentracing_activate_span(&fake_spans[0]));
+    assert(opentracing_activate_span(NULL));
+    assert(opentracing_active_span() == NULL);
+    opentracing_deactivate_span(NULL);
+    assert(opentracing_active_span() == &fake_spans[0]);
+    opentracing_deactivate_span(&fake_spans[0]);
+}
+
+static void* check_thread(void* arg)
+{
+    (void) arg;
+    assert(opentracing_active_span() == NULL);
+    assert(opentracing_activate_span(&fake_spans[1]));
+    assert(opentracing_active_span() == &fake_spans[1]);
+    opentracing_deactivate_span(&fake_spans[1]);
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    pthread_t thread;
+
+    /* Every thread has its own stack. */
+    assert(opentracing_activate_span(&fake_spans[0]));
+    assert(pthread_create(&thread, NULL, &check_thread, NULL) == 0);
+    assert(pthread_join(thread, NULL) == 0);
+    assert(opentracing_active_span() == &fake_spans[0]);
+    opentracing_deactivate_span(&fake_spans[0]);
+}
+
+static void destroy_span(opentracing_span* span)
+{
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+}
+
+static void test_implicit_parent(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* root;
+    opentracing_span* other_root;
+    opentracing_span* child;
+    opentracing_span_reference ref;
+    opentracing_start_span_options start_options;
+    uint64_t root_id;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+
+    root = tracer->start_span(tracer, "root");
+    assert(root != NULL);
+    root->finish(root);
+    assert(reporter.last.parent_span_id == 0);
+    assert(reporter.last.num_references == 0);
+    root_id = reporter.last.span_id;
+
+    /* Spans started without references follow the active span. */
+    assert(opentracing_activate_span(root));
+    child = tracer->start_span(tracer, "child");
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.last.parent_span_id == root_id);
+    assert(reporter.last.num_references == 1);
+    assert(reporter.last_reference.type ==
+           opentracing_span_reference_child_of);
+    assert(reporter.last_reference.span_id == root_id);
+    destroy_span(child);
+
+    /* Explicit references take precedence. */
+    other_root = tracer->start_span(tracer, "other_root");
+    assert(other_root != NULL);
+    memset(&start_options, 0, sizeof(start_options));
+    ref.type = opentracing_span_reference_follows_from;
+    ref.referenced_context = other_root->span_context(other_root);
+    start_options.references = &ref;
+    start_options.num_references = 1;
+    child = tracer->start_span_with_options(tracer, "child", &start_options);
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.last.parent_span_id != root_id);
+    assert(reporter.last.num_references == 1);
+    assert(reporter.last_reference.type ==
+           opentracing_span_reference_follows_from);
+    destroy_span(child);
+    destroy_span(other_root);
+
+    /* Hiding the active span starts a new trace. */
+    assert(opentracing_activate_span(NULL));
+    child = tracer->start_span(tracer, "root");
+    assert(child != NULL);
+    child->finish(child);
+    assert(reporter.last.parent_span_id == 0);
+    destroy_span(child);
+    opentracing_deactivate_span(NULL);
+
+    opentracing_deactivate_span(root);
+    destroy_span(root);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+int main(void)
+{
+    test_nesting();
+    test_threads();
+    test_implicit_parent();
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/socket_reporter.h>
+#include <opentracing-c/span_batch.h>
+
+#define NUM_SPANS 200
+#define MAX_DATAGRAM_SIZE 512
+
+/* Stand-in for the agent: receives datagrams and decodes their spans. */
+typedef struct receiver {
+    int fd;
+    char address[128];
+    int num_datagrams;
+    int num_spans;
+    uint64_t span_ids[NUM_SPANS];
+    char operation_names[NUM_SPANS][32];
+} receiver;
+
+static void receiver_init_udp(receiver* r)
+{
+    struct sockaddr_in address;
+    socklen_t address_length;
+
+    memset(r, 0, sizeof(*r));
+    r->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(r->fd >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(bind(r->fd, (struct sockaddr*) &address, sizeof(address)) == 0);
+    address_length = sizeof(address);
+    assert(getsockname(r->fd, (struct sockaddr*) &address, &address_length) ==
+           0);
+    sprintf(r->address, "127.0.0.1:%d", (int) ntohs(address.sin_port));
+}
+
+static void receiver_init_unix(receiver* r, const char* path)
+{
+    struct sockaddr_un address;
+
+    memset(r, 0, sizeof(*r));
+    r->fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    assert(r->fd >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+    assert(bind(r->fd, (struct sockaddr*) &address, sizeof(address)) == 0);
+    sprintf(r->address, "unix:%s", path);
+}
+
+/* Loopback delivery is synchronous, so everything sent is already queued. */
+static void receiver_receive(receiver* r, size_t max_datagram_size)
+{
+    char datagram[65536];
+    opentracing_span_batch_decoder* decoder;
+    const opentracing_span_data* span;
+    ssize_t length;
+    int num_spans;
+
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+    for (;;) {
+        length = recv(r->fd, datagram, sizeof(datagram), MSG_DONTWAIT);
+        if (length < 0) {
+            assert(errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+        assert((size_t) length <= max_datagram_size);
+        r->num_datagrams++;
+        assert(opentracing_span_batch_decode_begin(
+                   decoder, datagram, (size_t) length, &num_spans) ==
+               opentracing_span_batch_status_ok);
+        while (opentracing_span_batch_decode_next(decoder, &span) ==
+               opentracing_span_batch_status_ok) {
+            assert(r->num_spans < NUM_SPANS);
+            r->span_ids[r->num_spans] = span->span_id;
+            strncpy(r->operation_names[r->num_spans],
+                    span->operation_name,
+                    sizeof(r->operation_names[0]) - 1);
+            r->num_spans++;
+            num_spans--;
+        }
+        assert(num_spans == 0);
+    }
+    opentracing_span_batch_decoder_destroy(decoder);
+}
+
+static void test_udp(void)
+{
+    receiver r;
+    opentracing_socket_reporter_options options;
+    opentracing_reporter* reporter;
+    opentracing_span_data spans[NUM_SPANS];
+    const opentracing_span_data* span_ptrs[NUM_SPANS];
+    opentracing_tag tags[2];
+    char big_value[MAX_DATAGRAM_SIZE * 2];
+    int i;
+
+    receiver_init_udp(&r);
+    memset(&options, 0, sizeof(options));
+    options.address = r.address;
+    options.max_datagram_size = MAX_DATAGRAM_SIZE;
+    options.max_datagrams_per_send = 4;
+    reporter = opentracing_make_socket_reporter(&options);
+    assert(reporter != NULL);
+
+    tags[0].key = (char*) "component";
+    tags[0].value.type = opentracing_value_string;
+    tags[0].value.value.string_value = "test";
+    memset(big_value, 'x', sizeof(big_value) - 1);
+    big_value[sizeof(big_value) - 1] = '\0';
+    tags[1].key = (char*) "big";
+    tags[1].value.type = opentracing_value_string;
+    tags[1].value.value.string_value = big_value;
+    memset(spans, 0, sizeof(spans));
+    for (i = 0; i < NUM_SPANS; i++) {
+        spans[i].trace_id.low = (uint64_t) (i / 10 + 1);
+        spans[i].span_id = (uint64_t) i + 1;
+        spans[i].operation_name = "op";
+        spans[i].start_timestamp.value.tv_sec = 1500000000;
+        spans[i].start_timestamp.value.tv_nsec = i * 1000;
+        spans[i].tags = tags;
+        spans[i].num_tags = 1;
+        span_ptrs[i] = &spans[i];
+    }
+
+    /* Spans are coalesced into datagrams that fit. */
+    reporter->report(reporter, span_ptrs, NUM_SPANS);
+    receiver_receive(&r, MAX_DATAGRAM_SIZE);
+    assert(r.num_spans == NUM_SPANS);
+    assert(r.num_datagrams > 1);
+    assert(r.num_datagrams < NUM_SPANS / 5);
+    for (i = 0; i < NUM_SPANS; i++) {
+        assert(r.span_ids[i] == (uint64_t) i + 1);
+    }
+
+    /* A span too big for any datagram is dropped on its own. */
+    spans[1].num_tags = 2;
+    r.num_datagrams = 0;
+    r.num_spans = 0;
+    reporter->report(reporter, span_ptrs, 3);
+    receiver_receive(&r, MAX_DATAGRAM_SIZE);
+    assert(r.num_spans == 2);
+    assert(r.span_ids[0] == 1);
+    assert(r.span_ids[1] == 3);
+
+    ((opentracing_destructible*) reporter)
+        ->destroy((opentracing_destructible*) reporter);
+    close(r.fd);
+}
+
+static void test_unix(void)
+{
+    receiver r;
+    char path[64];
+    opentracing_socket_reporter_options socket_options;
+    opentracing_basic_tracer_options tracer_options;
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    int i;
+
+    sprintf(
+        path, "/tmp/opentracingc_socket_reporter_test.%ld", (long) getpid());
+    receiver_init_unix(&r, path);
+    memset(&socket_options, 0, sizeof(socket_options));
+    socket_options.address = r.address;
+    memset(&tracer_options, 0, sizeof(tracer_options));
+    tracer_options.reporter = opentracing_make_socket_reporter(&socket_options);
+    assert(tracer_options.reporter != NULL);
+    tracer_options.background_reporting = opentracing_true;
+    tracer = opentracing_make_basic_tracer(&tracer_options);
+    assert(tracer != NULL);
+
+    /* Closing the tracer drains buffered spans to the agent. */
+    for (i = 0; i < 5; i++) {
+        span = tracer->start_span(tracer, "unix");
+        assert(span != NULL);
+        span->finish(span);
+        ((opentracing_destructible*) span)
+            ->destroy((opentracing_destructible*) span);
+    }
+    tracer->close(tracer);
+    receiver_receive(&r, 1472);
+    assert(r.num_spans == 5);
+    assert(r.num_datagrams == 1);
+    assert(strcmp(r.operation_names[4], "unix") == 0);
+
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+    close(r.fd);
+    unlink(path);
+}
+
+static void test_bad_address(void)
+{
+    static const char* const addresses[] = {"nonsense",
+                                            "unix:",
+                                            "127.0.0.1",
+                                            "127.0.0.1:",
+                                            ":6831",
+                                            "localhost:6831",
+                                            "[::1:6831",
+                                            "[]:6831"};
+    opentracing_socket_reporter_options options;
+    size_t i;
+
+    memset(&options, 0, sizeof(options));
+    assert(opentracing_make_socket_reporter(&options) == NULL);
+    for (i = 0; i < sizeof(addresses) / sizeof(addresses[0]); i++) {
+        options.address = addresses[i];
+        errno = 0;
+        assert(opentracing_make_socket_reporter(&options) == NULL);
+        assert(errno == EINVAL);
+    }
+}
+
+int main(void)
+{
+    test_udp();
+    test_unix();
+    test_bad_address();
+    return 0;
+}
@@ -0,0 +1,468 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opentracing-c/span_batch.h>
+
+#define NUM_SPANS 3
+
+static void make_spans(opentracing_span_data* spans,
+                       opentracing_span_data_reference* references,
+                       opentracing_tag* tags,
+                       opentracing_log_record* logs,
+                       opentracing_log_field* fields)
+{
+    static const char view[] = "viewXX";
+
+    memset(spans, 0, sizeof(opentracing_span_data) * NUM_SPANS);
+
+    /* One tag of every value type. */
+    tags[0].key = (char*) "bool";
+    tags[0].value.type = opentracing_value_bool;
+    tags[0].value.value.bool_value = opentracing_true;
+    tags[1].key = (char*) "double";
+    tags[1].value.type = opentracing_value_double;
+    tags[1].value.value.double_value = -1.5e300;
+    tags[2].key = (char*) "int64";
+    tags[2].value.type = opentracing_value_int64;
+    tags[2].value.value.int64_value = INT64_MIN;
+    tags[3].key = (char*) "uint64";
+    tags[3].value.type = opentracing_value_uint64;
+    tags[3].value.value.uint64_value = UINT64_MAX;
+    tags[4].key = (char*) "string";
+    tags[4].value.type = opentracing_value_string;
+    tags[4].value.value.string_value = "value";
+    tags[5].key = (char*) "null";
+    tags[5].value.type = opentracing_value_null;
+    tags[6].key = (char*) "string_view";
+    tags[6].value.type = opentracing_value_string_view;
+    tags[6].value.value.string_view_value.data = view;
+    tags[6].value.value.string_view_value.length = 4;
+
+    fields[0].key = "event";
+    fields[0].value.type = opentracing_value_string;
+    fields[0].value.value.string_value = "error";
+    fields[1].key = "int64";
+    fields[1].value.type = opentracing_value_int64;
+    fields[1].value.value.int64_value = -7;
+    fields[2].key = "event";
+    fields[2].value.type = opentracing_value_bool;
+    fields[2].value.value.bool_value = opentracing_false;
+    logs[0].timestamp.value.tv_sec = 1500000000;
+    logs[0].timestamp.value.tv_nsec = 500;
+    logs[0].fields = &fields[0];
+    logs[0].num_fields = 2;
+    logs[1].timestamp.value.tv_sec = 1499999999;
+    logs[1].timestamp.value.tv_nsec = 999999999;
+    logs[1].fields = &fields[2];
+    logs[1].num_fields = 1;
+
+    references[0].type = opentracing_span_reference_child_of;
+    references[0].trace_id.high = 1;
+    references[0].trace_id.low = 2;
+    references[0].span_id = 3;
+    references[1].type = opentracing_span_reference_follows_from;
+    references[1].trace_id.high = 9;
+    references[1].trace_id.low = 8;
+    references[1].span_id = 7;
+
+    spans[0].trace_id.high = 1;
+    spans[0].trace_id.low = 2;
+    spans[0].span_id = 4;
+    spans[0].parent_span_id = 3;
+    spans[0].operation_name = "GET /users";
+    spans[0].start_timestamp.value.tv_sec = 1500000000;
+    spans[0].duration.value.tv_nsec = 2500;
+    spans[0].references = references;
+    spans[0].num_references = 2;
+    spans[0].tags = tags;
+    spans[0].num_tags = 7;
+    spans[0].logs = logs;
+    spans[0].num_logs = 2;
+
+    /* Same trace, earlier start, shared names. */
+    spans[1].trace_id = spans[0].trace_id;
+    spans[1].span_id = 3;
+    spans[1].operation_name = "GET /users";
+    spans[1].start_timestamp.value.tv_sec = 1499999999;
+    spans[1].start_timestamp.value.tv_nsec = 1;
+    spans[1].duration.value.tv_sec = 2;
+    spans[1].tags = &tags[4];
+    spans[1].num_tags = 2;
+    spans[1].local_root = opentracing_true;
+
+    spans[2].trace_id.high = 0;
+    spans[2].trace_id.low = UINT64_MAX;
+    spans[2].span_id = UINT64_MAX;
+    spans[2].operation_name = "";
+    spans[2].start_timestamp.value.tv_sec = 1500000001;
+    spans[2].local_root = opentracing_true;
+}
+
+static void check_value(const opentracing_value* expected,
+                        const opentracing_value* actual)
+{
+    assert(expected->type == actual->type);
+    switch (expected->type) {
+    case opentracing_value_bool:
+        assert(expected->value.bool_value == actual->value.bool_value);
+        break;
+    case opentracing_value_double:
+        assert(expected->value.double_value == actual->value.double_value);
+        break;
+    case opentracing_value_int64:
+        assert(expected->value.int64_value == actual->value.int64_value);
+        break;
+    case opentracing_value_uint64:
+        assert(expected->value.uint64_value == actual->value.uint64_value);
+        break;
+    case opentracing_value_string:
+        assert(strcmp(expected->value.string_value,
+                      actual->value.string_value) == 0);
+        break;
+    case opentracing_value_string_view:
+        assert(expected->value.string_view_value.length ==
+               actual->value.string_view_value.length);
+        assert(memcmp(expected->value.string_view_value.data,
+                      actual->value.string_view_value.data,
+                      actual->value.string_view_value.length) == 0);
+        break;
+    default:
+        break;
+    }
+}
+
+static void check_time(const opentracing_time_value* expected,
+                       const opentracing_time_value* actual)
+{
+    assert(expected->tv_sec == actual->tv_sec);
+    assert(expected->tv_nsec == actual->tv_nsec);
+}
+
+static void check_span(const opentracing_span_data* expected,
+                       const opentracing_span_data* actual)
+{
+    int i;
+    int j;
+
+    assert(expected->trace_id.high == actual->trace_id.high);
+    assert(expected->trace_id.low == actual->trace_id.low);
+    assert(expected->span_id == actual->span_id);
+    assert(expected->parent_span_id == actual->parent_span_id);
+    assert(expected->local_root == actual->local_root);
+    assert(strcmp(expected->operation_name, actual->operation_name) == 0);
+    check_time(&expected->start_timestamp.value,
+               &actual->start_timestamp.value);
+    check_time(&expected->duration.value, &actual->duration.value);
+    assert(expected->num_references == actual->num_references);
+    for (i = 0; i < expected->num_references; i++) {
+        assert(expected->references[i].type == actual->references[i].type);
+        assert(expected->references[i].trace_id.high ==
+               actual->references[i].trace_id.high);
+        assert(expected->references[i].trace_id.low ==
+               actual->references[i].trace_id.low);
+        assert(expected->references[i].span_id ==
+               actual->references[i].span_id);
+    }
+    assert(expected->num_tags == actual->num_tags);
+    for (i = 0; i < expected->num_tags; i++) {
+        assert(strcmp(expected->tags[i].key, actual->tags[i].key) == 0);
+        check_value(&expected->tags[i].value, &actual->tags[i].value);
+    }
+    assert(expected->num_logs == actual->num_logs);
+    for (i = 0; i < expected->num_logs; i++) {
+        check_time(&expected->logs[i].timestamp.value,
+                   &actual->logs[i].timestamp.value);
+        assert(expected->logs[i].num_fields == actual->logs[i].num_fields);
+        for (j = 0; j < expected->logs[i].num_fields; j++) {
+            assert(strcmp(expected->logs[i].fields[j].key,
+                          actual->logs[i].fields[j].key) == 0);
+            check_value(&expected->logs[i].fields[j].value,
+                        &actual->logs[i].fields[j].value);
+        }
+    }
+}
+
+static int count_occurrences(const char* data, size_t length, const char* str)
+{
+    size_t len;
+    size_t i;
+    int count;
+
+    len = strlen(str);
+    count = 0;
+    for (i = 0; i + len <= length; i++) {
+        if (memcmp(data + i, str, len) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/* Decode a whole batch, returning the final status. */
+static opentracing_span_batch_status
+decode_all(opentracing_span_batch_decoder* decoder,
+           const char* data,
+           size_t length,
+           const opentracing_span_data* expected)
+{
+    const opentracing_span_data* span;
+    opentracing_span_batch_status status;
+    int num_spans;
+    int i;
+
+    status =
+        opentracing_span_batch_decode_begin(decoder, data, length, &num_spans);
+    if (status != opentracing_span_batch_status_ok) {
+        return status;
+    }
+    for (i = 0;; i++) {
+        status = opentracing_span_batch_decode_next(decoder, &span);
+        if (status != opentracing_span_batch_status_ok) {
+            assert(span == NULL);
+            assert(status != opentracing_span_batch_status_end ||
+                   i == num_spans);
+            return status;
+        }
+        if (expected != NULL) {
+            check_span(&expected[i], span);
+        }
+    }
+}
+
+static void test_round_trip(void)
+{
+    opentracing_span_data spans[NUM_SPANS];
+    opentracing_span_data_reference references[2];
+    opentracing_tag tags[7];
+    opentracing_log_record logs[2];
+    opentracing_log_field fields[3];
+    const opentracing_span_data* span_ptrs[NUM_SPANS];
+    opentracing_span_batch_encoder* encoder;
+    opentracing_span_batch_decoder* decoder;
+    const char* data;
+    char* copy;
+    size_t length;
+    size_t i;
+
+    make_spans(spans, references, tags, logs, fields);
+    for (i = 0; i < NUM_SPANS; i++) {
+        span_ptrs[i] = &spans[i];
+    }
+    encoder = opentracing_span_batch_encoder_new();
+    assert(encoder != NULL);
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+
+    assert(opentracing_span_batch_encode(
+        encoder, span_ptrs, NUM_SPANS, &data, &length));
+    assert(decode_all(decoder, data, length, spans) ==
+           opentracing_span_batch_status_end);
+
+    /* Names and keys are written once per batch. */
+    assert(count_occurrences(data, length, "GET /users") == 1);
+    assert(count_occurrences(data, length, "double") == 1);
+    assert(count_occurrences(data, length, "event") == 1);
+
+    /* Encoders and decoders are reusable. */
+    copy = (char*) malloc(length);
+    assert(copy != NULL);
+    memcpy(copy, data, length);
+    assert(opentracing_span_batch_encode(
+        encoder, span_ptrs, NUM_SPANS, &data, &length));
+    assert(memcmp(copy, data, length) == 0);
+    assert(decode_all(decoder, copy, length, spans) ==
+           opentracing_span_batch_status_end);
+
+    /* Truncated and padded batches are rejected. */
+    for (i = 0; i < length; i++) {
+        assert(decode_all(decoder, copy, i, NULL) ==
+               opentracing_span_batch_status_corrupted);
+    }
+    copy = (char*) realloc(copy, length + 1);
+    assert(copy != NULL);
+    copy[length] = '\0';
+    assert(decode_all(decoder, copy, length + 1, NULL) ==
+           opentracing_span_batch_status_corrupted);
+    copy[0] = OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION + 1;
+    assert(decode_all(decoder, copy, length, NULL) ==
+           opentracing_span_batch_status_corrupted);
+    free(copy);
+
+    assert(opentracing_span_batch_encode(encoder, NULL, 0, &data, &length));
+    assert(length == 2);
+    assert(decode_all(decoder, data, length, NULL) ==
+           opentracing_span_batch_status_end);
+
+    opentracing_span_batch_encoder_destroy(encoder);
+    opentracing_span_batch_decoder_destroy(decoder);
+    opentracing_span_batch_encoder_destroy(NULL);
+    opentracing_span_batch_decoder_destroy(NULL);
+}
+
+static void test_prefix(void)
+{
+    opentracing_span_data spans[NUM_SPANS];
+    opentracing_span_data_reference references[2];
+    opentracing_tag tags[7];
+    opentracing_log_record logs[2];
+    opentracing_log_field fields[3];
+    const opentracing_span_data* span_ptrs[NUM_SPANS];
+    opentracing_span_batch_encoder* encoder;
+    opentracing_span_batch_decoder* decoder;
+    const char* data;
+    size_t length;
+    size_t full_length;
+    int num_encoded;
+    int i;
+
+    make_spans(spans, references, tags, logs, fields);
+    for (i = 0; i < NUM_SPANS; i++) {
+        span_ptrs[i] = &spans[i];
+    }
+    encoder = opentracing_span_batch_encoder_new();
+    assert(encoder != NULL);
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+
+    assert(opentracing_span_batch_encode(
+        encoder, span_ptrs, NUM_SPANS, &data, &full_length));
+    assert(opentracing_span_batch_encode_prefix(encoder,
+                                                span_ptrs,
+                                                NUM_SPANS,
+                                                full_length,
+                                                &data,
+                                                &length,
+                                                &num_encoded));
+    assert(num_encoded == NUM_SPANS);
+    assert(length == full_length);
+
+    /* The last span does not fit. */
+    assert(opentracing_span_batch_encode_prefix(encoder,
+                                                span_ptrs,
+                                                NUM_SPANS,
+                                                full_length - 1,
+                                                &data,
+                                                &length,
+                                                &num_encoded));
+    assert(num_encoded == NUM_SPANS - 1);
+    assert(length < full_length);
+    assert(decode_all(decoder, data, length, spans) ==
+           opentracing_span_batch_status_end);
+
+    /* The first span is encoded even if it does not fit. */
+    assert(opentracing_span_batch_encode_prefix(
+        encoder, span_ptrs, NUM_SPANS, 0, &data, &length, &num_encoded));
+    assert(num_encoded == 1);
+    assert(decode_all(decoder, data, length, spans) ==
+           opentracing_span_batch_status_end);
+
+    opentracing_span_batch_encoder_destroy(encoder);
+    opentracing_span_batch_decoder_destroy(decoder);
+}
+
+static void test_many_strings(void)
+{
+    opentracing_span_data spans[NUM_SPANS];
+    opentracing_span_data_reference references[2];
+    opentracing_tag tags[7];
+    opentracing_log_record logs[2];
+    opentracing_log_field fields[3];
+    opentracing_tag many_tags[1000];
+    char keys[1000][8];
+    const opentracing_span_data* span_ptr;
+    opentracing_span_batch_encoder* encoder;
+    opentracing_span_batch_decoder* decoder;
+    const char* data;
+    size_t length;
+    int i;
+
+    /* Enough keys to grow the dictionary. */
+    make_spans(spans, references, tags, logs, fields);
+    for (i = 0; i < 1000; i++) {
+        keys[i][0] = 'k';
+        keys[i][1] = (char) ('0' + i / 100);
+        keys[i][2] = (char) ('0' + i / 10 % 10);
+        keys[i][3] = (char) ('0' + i % 10);
+        keys[i][4] = '\0';
+        many_tags[i].key = keys[i];
+        many_tags[i].value = tags[i % 7].value;
+    }
+    spans[0].tags = many_tags;
+    spans[0].num_tags = 1000;
+    span_ptr = &spans[0];
+    encoder = opentracing_span_batch_encoder_new();
+    assert(encoder != NULL);
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+    assert(
+        opentracing_span_batch_encode(encoder, &span_ptr, 1, &data, &length));
+    assert(decode_all(decoder, data, length, spans) ==
+           opentracing_span_batch_status_end);
+    opentracing_span_batch_encoder_destroy(encoder);
+    opentracing_span_batch_decoder_destroy(decoder);
+}
+
+/* Span with a zero trace ID, span ID 1 and an empty name. It is followed by
+ * its start delta, HAND_SPAN_SUFFIX for a zero duration without references
+ * or tags, and its logs. */
+#define HAND_SPAN_PREFIX                                                     \
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+        1, 0, 0, 0
+#define HAND_SPAN_SUFFIX 0, 0, 0
+/* Zigzag varint of INT64_MAX. */
+#define ZIGZAG_INT64_MAX                                                     \
+    (char) 0xFE, (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,         \
+        (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF, 1
+
+static void test_timestamp_overflow(void)
+{
+    static const char valid[] = {OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION,
+                                 1,
+                                 HAND_SPAN_PREFIX,
+                                 ZIGZAG_INT64_MAX,
+                                 HAND_SPAN_SUFFIX,
+                                 0};
+    /* The second span starts one nanosecond after INT64_MAX. */
+    static const char start_overflow[] = {
+        OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION,
+        2,
+        HAND_SPAN_PREFIX,
+        ZIGZAG_INT64_MAX,
+        HAND_SPAN_SUFFIX,
+        0,
+        HAND_SPAN_PREFIX,
+        2,
+        HAND_SPAN_SUFFIX,
+        0};
+    /* The log is one nanosecond after its span's start of INT64_MAX. */
+    static const char log_overflow[] = {OPENTRACINGC_SPAN_BATCH_FORMAT_VERSION,
+                                        1,
+                                        HAND_SPAN_PREFIX,
+                                        ZIGZAG_INT64_MAX,
+                                        HAND_SPAN_SUFFIX,
+                                        1,
+                                        2,
+                                        0};
+    opentracing_span_batch_decoder* decoder;
+
+    decoder = opentracing_span_batch_decoder_new();
+    assert(decoder != NULL);
+    assert(decode_all(decoder, valid, sizeof(valid), NULL) ==
+           opentracing_span_batch_status_end);
+    assert(decode_all(decoder, start_overflow, sizeof(start_overflow), NULL) ==
+           opentracing_span_batch_status_corrupted);
+    assert(decode_all(decoder, log_overflow, sizeof(log_overflow), NULL) ==
+           opentracing_span_batch_status_corrupted);
+    opentracing_span_batch_decoder_destroy(decoder);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_prefix();
+    test_many_strings();
+    test_timestamp_overflow();
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/stats.h>
+
+#include "mock_reporter.h"
+
+#define NUM_THREADS 4
+#define SPANS_PER_THREAD 1000
+
+static void run_spans(opentracing_tracer* tracer, int num_spans)
+{
+    opentracing_span* span;
+    int i;
+
+    for (i = 0; i < num_spans; i++) {
+        span = tracer->start_span(tracer, "span");
+        assert(span != NULL);
+        span->finish(span);
+        ((opentracing_destructible*) span)
+            ->destroy((opentracing_destructible*) span);
+    }
+}
+
+static void destroy_tracer(opentracing_tracer* tracer)
+{
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+static void test_counters(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer_stats before;
+    opentracing_tracer_stats after;
+    opentracing_tracer* tracer;
+
+    opentracing_get_tracer_stats(&before);
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    run_spans(tracer, 10);
+    destroy_tracer(tracer);
+
+    memset(&options, 0, sizeof(options));
+    options.sampler = opentracing_make_const_sampler(opentracing_false);
+    assert(options.sampler != NULL);
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    run_spans(tracer, 5);
+    destroy_tracer(tracer);
+
+    opentracing_get_tracer_stats(&after);
+    assert(after.spans_started - before.spans_started == 15);
+    assert(after.spans_sampled - before.spans_sampled == 10);
+    assert(after.spans_finished - before.spans_finished == 10);
+    assert(after.spans_dropped == before.spans_dropped);
+    assert(reporter.num_reported == 10);
+}
+
+static void test_background(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer_stats before;
+    opentracing_tracer_stats after;
+    opentracing_tracer* tracer;
+
+    /* A ring of two spans that is only drained on close overflows. */
+    opentracing_get_tracer_stats(&before);
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.background_reporting = opentracing_true;
+    options.buffer_size = 2;
+    options.flush_interval_ms = 60000;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    run_spans(tracer, 10);
+    opentracing_get_tracer_stats(&after);
+    assert(after.export_queue_depth - before.export_queue_depth == 2);
+    tracer->close(tracer);
+
+    opentracing_get_tracer_stats(&after);
+    assert(after.export_queue_depth == before.export_queue_depth);
+    assert(reporter.num_reported == 2);
+    assert(after.spans_dropped - before.spans_dropped == 8);
+    assert(after.finish_to_export.count - before.finish_to_export.count == 2);
+    assert(after.flush_duration.count - before.flush_duration.count >= 2);
+    destroy_tracer(tracer);
+}
+
+static void* run_thread(void* arg)
+{
+    run_spans((opentracing_tracer*) arg, SPANS_PER_THREAD);
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    mock_reporter reporter;
+    opentracing_basic_tracer_options options;
+    opentracing_tracer_stats before;
+    opentracing_tracer_stats after;
+    opentracing_tracer* tracer;
+    pthread_t threads[NUM_THREADS];
+    int round;
+    int i;
+
+    /* Shards of every thread are merged. */
+    opentracing_get_tracer_stats(&before);
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.background_reporting = opentracing_true;
+    tracer = opentracing_make_basic_tracer(&options);
+    assert(tracer != NULL);
+    /* The second round takes over the shards of the first. */
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < NUM_THREADS; i++) {
+            assert(pthread_create(&threads[i], NULL, &run_thread, tracer) ==
+                   0);
+        }
+        for (i = 0; i < NUM_THREADS; i++) {
+            assert(pthread_join(threads[i], NULL) == 0);
+        }
+    }
+    destroy_tracer(tracer);
+
+    opentracing_get_tracer_stats(&after);
+    assert(after.spans_finished - before.spans_finished ==
+           2 * NUM_THREADS * SPANS_PER_THREAD);
+    assert(after.finish_to_export.count - before.finish_to_export.count ==
+           2 * NUM_THREADS * SPANS_PER_THREAD);
+    assert(reporter.num_reported == 2 * NUM_THREADS * SPANS_PER_THREAD);
+}
+
+static void test_quantile(void)
+{
+    opentracing_histogram histogram;
+
+    memset(&histogram, 0, sizeof(histogram));
+    assert(opentracing_histogram_quantile(&histogram, 0.5) == 0);
+    histogram.buckets[0] = 1;
+    histogram.buckets[3] = 2;
+    histogram.buckets[10] = 1;
+    assert(opentracing_histogram_quantile(&histogram, 0.0) == 1);
+    assert(opentracing_histogram_quantile(&histogram, 0.25) == 1);
+    assert(opentracing_histogram_quantile(&histogram, 0.5) == 15);
+    assert(opentracing_histogram_quantile(&histogram, 0.75) == 15);
+    assert(opentracing_histogram_quantile(&histogram, 1.0) == 2047);
+    histogram.buckets[OPENTRACINGC_HISTOGRAM_NUM_BUCKETS - 1] = 100;
+    assert(opentracing_histogram_quantile(&histogram, 1.0) ==
+           ((uint64_t) 1 << OPENTRACINGC_HISTOGRAM_NUM_BUCKETS) - 1);
+}
+
+int main(void)
+{
+    test_counters();
+    test_background();
+    test_threads();
+    test_quantile();
+    return 0;
+}
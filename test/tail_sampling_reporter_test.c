@@ -0,0 +1,300 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <opentracing-c/basic_tracer.h>
+#include <opentracing-c/tail_sampling_reporter.h>
+
+#include "mock_reporter.h"
+
+#define NUM_EVICTION_TRACES 100
+
+static opentracing_bool keep_named(void* arg,
+                                   const opentracing_span_data* const* spans,
+                                   int num_spans)
+{
+    int i;
+
+    for (i = 0; i < num_spans; i++) {
+        if (strcmp(spans[i]->operation_name, (const char*) arg) == 0) {
+            return opentracing_true;
+        }
+    }
+    return opentracing_false;
+}
+
+static opentracing_tracer*
+make_tracer(const opentracing_tail_sampling_options* options)
+{
+    opentracing_basic_tracer_options tracer_options;
+    opentracing_tracer* tracer;
+
+    memset(&tracer_options, 0, sizeof(tracer_options));
+    tracer_options.reporter = opentracing_make_tail_sampling_reporter(options);
+    assert(tracer_options.reporter != NULL);
+    tracer = opentracing_make_basic_tracer(&tracer_options);
+    assert(tracer != NULL);
+    return tracer;
+}
+
+static void destroy_span(opentracing_span* span)
+{
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+}
+
+static opentracing_span* start_child(opentracing_tracer* tracer,
+                                     const char* operation_name,
+                                     opentracing_span_reference_type type,
+                                     opentracing_span_context* parent)
+{
+    opentracing_start_span_options options;
+    opentracing_span_reference ref;
+    opentracing_span* span;
+
+    memset(&options, 0, sizeof(options));
+    ref.type = type;
+    ref.referenced_context = parent;
+    options.references = &ref;
+    options.num_references = 1;
+    span = tracer->start_span_with_options(tracer, operation_name, &options);
+    assert(span != NULL);
+    return span;
+}
+
+/* Finish a span as if it had run for the given number of seconds. */
+static void finish_after(opentracing_span* span, long seconds)
+{
+    opentracing_finish_span_options options;
+
+    memset(&options, 0, sizeof(options));
+    opentracing_now_steady(&options.finish_time);
+    options.finish_time.value.tv_sec += seconds;
+    span->finish_with_options(span, &options);
+}
+
+/* Root span with one child, which may be tagged as an error. */
+static void run_trace(opentracing_tracer* tracer,
+                      const char* child_name,
+                      opentracing_bool error,
+                      long root_seconds)
+{
+    opentracing_span* root;
+    opentracing_span* child;
+    opentracing_value value;
+
+    root = tracer->start_span(tracer, "root");
+    assert(root != NULL);
+    child = start_child(tracer,
+                        child_name,
+                        opentracing_span_reference_child_of,
+                        root->span_context(root));
+    if (error) {
+        value.type = opentracing_value_bool;
+        value.value.bool_value = opentracing_true;
+        child->set_tag(child, "error", &value);
+    }
+    child->finish(child);
+    destroy_span(child);
+    finish_after(root, root_seconds);
+    destroy_span(root);
+}
+
+static void test_decisions(void)
+{
+    mock_reporter reporter;
+    opentracing_tail_sampling_options options;
+    opentracing_tracer* tracer;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.latency_threshold.value.tv_sec = 1;
+    options.keep_errors = opentracing_true;
+    options.predicate = &keep_named;
+    options.predicate_arg = (void*) "wanted";
+    tracer = make_tracer(&options);
+
+    run_trace(tracer, "child", opentracing_false, 0);
+    assert(reporter.num_reported == 0);
+
+    /* Whole traces are kept, in the order their spans finished. */
+    run_trace(tracer, "child", opentracing_true, 0);
+    assert(reporter.num_reported == 2);
+    assert(strcmp(reporter.operation_names[0], "child") == 0);
+    assert(strcmp(reporter.operation_names[1], "root") == 0);
+    run_trace(tracer, "child", opentracing_false, 2);
+    assert(reporter.num_reported == 4);
+    run_trace(tracer, "wanted", opentracing_false, 0);
+    assert(reporter.num_reported == 6);
+    assert(strcmp(reporter.operation_names[4], "wanted") == 0);
+
+    tracer->close(tracer);
+    assert(reporter.num_flushed == 1);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+    assert(reporter.destroyed);
+}
+
+static void test_late_spans(void)
+{
+    mock_reporter reporter;
+    opentracing_tail_sampling_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* root;
+    opentracing_span* late;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.latency_threshold.value.tv_sec = 1;
+    tracer = make_tracer(&options);
+
+    /* Follows-from children finishing after a decision follow it. */
+    root = tracer->start_span(tracer, "slow");
+    assert(root != NULL);
+    late = start_child(tracer,
+                       "async",
+                       opentracing_span_reference_follows_from,
+                       root->span_context(root));
+    finish_after(root, 2);
+    assert(reporter.num_reported == 1);
+    late->finish(late);
+    assert(reporter.num_reported == 2);
+    assert(strcmp(reporter.operation_names[1], "async") == 0);
+    destroy_span(late);
+    destroy_span(root);
+
+    root = tracer->start_span(tracer, "fast");
+    assert(root != NULL);
+    late = start_child(tracer,
+                       "async",
+                       opentracing_span_reference_follows_from,
+                       root->span_context(root));
+    root->finish(root);
+    late->finish(late);
+    destroy_span(late);
+    destroy_span(root);
+
+    /* Nothing is left to flush. */
+    tracer->close(tracer);
+    assert(reporter.num_reported == 2);
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+static void test_remote_parent(void)
+{
+    mock_reporter reporter;
+    opentracing_tail_sampling_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* client;
+    opentracing_span* server;
+    opentracing_span_context* extracted;
+    char buffer[128];
+    size_t length;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.latency_threshold.value.tv_sec = 1;
+    tracer = make_tracer(&options);
+
+    /* Spans whose parent was extracted decide their part of the trace. */
+    client = tracer->start_span(tracer, "client");
+    assert(client != NULL);
+    assert(tracer->inject_binary_buffer(tracer,
+                                        buffer,
+                                        sizeof(buffer),
+                                        &length,
+                                        client->span_context(client)) ==
+           opentracing_propagation_error_code_success);
+    assert(tracer->extract_binary_buffer(
+               tracer, buffer, length, &extracted) ==
+           opentracing_propagation_error_code_success);
+    server = start_child(
+        tracer, "server", opentracing_span_reference_child_of, extracted);
+    finish_after(server, 2);
+    assert(reporter.num_reported == 1);
+    assert(strcmp(reporter.operation_names[0], "server") == 0);
+    destroy_span(server);
+    ((opentracing_destructible*) extracted)
+        ->destroy((opentracing_destructible*) extracted);
+    destroy_span(client);
+
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+static void test_eviction(void)
+{
+    mock_reporter reporter;
+    opentracing_tail_sampling_options options;
+    opentracing_tracer* tracer;
+    opentracing_span* roots[NUM_EVICTION_TRACES];
+    opentracing_span* child;
+    opentracing_value value;
+    int i;
+
+    mock_reporter_init(&reporter);
+    memset(&options, 0, sizeof(options));
+    options.reporter = (opentracing_reporter*) &reporter;
+    options.keep_errors = opentracing_true;
+    options.max_buffer_bytes = 4096;
+    tracer = make_tracer(&options);
+
+    /* Undecided traces beyond the cap are discarded, oldest first. */
+    value.type = opentracing_value_bool;
+    value.value.bool_value = opentracing_true;
+    for (i = 0; i < NUM_EVICTION_TRACES; i++) {
+        roots[i] = tracer->start_span(tracer, "root");
+        assert(roots[i] != NULL);
+        child = start_child(tracer,
+                            "child",
+                            opentracing_span_reference_child_of,
+                            roots[i]->span_context(roots[i]));
+        child->set_tag(child, "error", &value);
+        child->finish(child);
+        destroy_span(child);
+    }
+    for (i = 0; i < NUM_EVICTION_TRACES; i++) {
+        roots[i]->finish(roots[i]);
+        destroy_span(roots[i]);
+    }
+    assert(reporter.num_reported > 0);
+    assert(reporter.num_reported < NUM_EVICTION_TRACES * 2);
+    assert(reporter.num_reported % 2 == 0);
+
+    /* Flush decides traces whose local root has not finished. */
+    reporter.num_reported = 0;
+    roots[0] = tracer->start_span(tracer, "root");
+    assert(roots[0] != NULL);
+    child = start_child(tracer,
+                        "child",
+                        opentracing_span_reference_child_of,
+                        roots[0]->span_context(roots[0]));
+    child->set_tag(child, "error", &value);
+    child->finish(child);
+    destroy_span(child);
+    assert(reporter.num_reported == 0);
+    tracer->close(tracer);
+    assert(reporter.num_reported == 1);
+    destroy_span(roots[0]);
+
+    ((opentracing_destructible*) tracer)
+        ->destroy((opentracing_destructible*) tracer);
+}
+
+int main(void)
+{
+    opentracing_tail_sampling_options options;
+
+    memset(&options, 0, sizeof(options));
+    assert(opentracing_make_tail_sampling_reporter(&options) == NULL);
+
+    test_decisions();
+    test_late_spans();
+    test_remote_parent();
+    test_eviction();
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
 #include <string.h>
 
 #include <opentracing-c/tracer.h>
@@ -59,6 +62,200 @@ static int mock_binary_write_callback(void* arg, const char* data, size_t len)
     return 0;
 }
 
+#define NUM_SWAP_TRACERS 64
+#define NUM_SWAP_READERS 4
+
+typedef struct swap_tracer {
+    opentracing_tracer base;
+    int destroyed;
+} swap_tracer;
+
+static swap_tracer swap_tracers[NUM_SWAP_TRACERS];
+static int swapping_done = 0;
+
+static void swap_tracer_destroy(opentracing_destructible* destructible)
+{
+    swap_tracer* tracer = (swap_tracer*) destructible;
+    assert(!__atomic_load_n(&tracer->destroyed, __ATOMIC_ACQUIRE));
+    __atomic_store_n(&tracer->destroyed, 1, __ATOMIC_RELEASE);
+}
+
+static void* swap_reader(void* arg)
+{
+    opentracing_tracer* tracer;
+    int i;
+    (void) arg;
+    while (!__atomic_load_n(&swapping_done, __ATOMIC_ACQUIRE)) {
+        tracer = opentracing_global_tracer_acquire();
+        for (i = 0; i < 100; i++) {
+            assert(!__atomic_load_n(&((swap_tracer*) tracer)->destroyed,
+                                    __ATOMIC_ACQUIRE));
+        }
+        /* Nested sections keep the outer tracer alive. */
+        assert(opentracing_global_tracer_acquire() != NULL);
+        opentracing_global_tracer_release();
+        assert(!__atomic_load_n(&((swap_tracer*) tracer)->destroyed,
+                                __ATOMIC_ACQUIRE));
+        opentracing_global_tracer_release();
+    }
+    return NULL;
+}
+
+static void test_concurrent_global_tracer_swap(void)
+{
+    opentracing_tracer* original;
+    pthread_t readers[NUM_SWAP_READERS];
+    int i;
+
+    memset(swap_tracers, 0, sizeof(swap_tracers));
+    for (i = 0; i < NUM_SWAP_TRACERS; i++) {
+        swap_tracers[i].base.base.destroy = &swap_tracer_destroy;
+    }
+
+    /* Keep the original tracer out of the rotation, it is not a
+       swap_tracer. */
+    original = opentracing_global_tracer();
+    opentracing_init_global_tracer(&swap_tracers[0].base);
+    assert(!swap_tracers[0].destroyed);
+
+    for (i = 0; i < NUM_SWAP_READERS; i++) {
+        assert(pthread_create(&readers[i], NULL, &swap_reader, NULL) == 0);
+    }
+    for (i = 1; i < NUM_SWAP_TRACERS; i++) {
+        opentracing_init_global_tracer(&swap_tracers[i].base);
+    }
+
+    /* Replaced tracers are reclaimed while readers keep coming and going,
+       without waiting for them all to stop. */
+    for (i = 0; i < NUM_SWAP_TRACERS - 1; i++) {
+        while (!__atomic_load_n(&swap_tracers[i].destroyed, __ATOMIC_ACQUIRE)) {
+            sched_yield();
+        }
+    }
+    assert(!__atomic_load_n(&swap_tracers[NUM_SWAP_TRACERS - 1].destroyed,
+                            __ATOMIC_ACQUIRE));
+    __atomic_store_n(&swapping_done, 1, __ATOMIC_RELEASE);
+    for (i = 0; i < NUM_SWAP_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    opentracing_init_global_tracer(original);
+    assert(__atomic_load_n(&swap_tracers[NUM_SWAP_TRACERS - 1].destroyed,
+                           __ATOMIC_ACQUIRE));
+}
+
+static int num_set_tag_calls = 0;
+static int num_log_fields_calls = 0;
+
+static void counting_set_tag(opentracing_span* span,
+                             const char* key,
+                             const opentracing_value* value)
+{
+    (void) span;
+    (void) key;
+    (void) value;
+    num_set_tag_calls++;
+}
+
+static void counting_log_fields(opentracing_span* span,
+                                const opentracing_log_field* fields,
+                                int num_fields)
+{
+    (void) span;
+    (void) fields;
+    (void) num_fields;
+    num_log_fields_calls++;
+}
+
+static void test_batched_fallback(void)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_span old_span;
+    opentracing_tag tags[3];
+    opentracing_log_record records[2];
+
+    memset(tags, 0, sizeof(tags));
+    memset(records, 0, sizeof(records));
+    tracer = opentracing_global_tracer();
+    span = tracer->start_span(tracer, "test");
+
+    /* Span built before set_tags and log_records existed. */
+    old_span = *span;
+    old_span.header.size = offsetof(opentracing_span, set_tags);
+    old_span.set_tag = &counting_set_tag;
+    old_span.log_fields = &counting_log_fields;
+    assert(!OPENTRACINGC_SPAN_HAS(&old_span, set_tags));
+    opentracing_span_set_tags(&old_span, tags, 3);
+    opentracing_span_log_records(&old_span, records, 2);
+    assert(num_set_tag_calls == 3);
+    assert(num_log_fields_calls == 2);
+
+    /* Batched slots are used when present. */
+    old_span = *span;
+    old_span.set_tag = &counting_set_tag;
+    assert(OPENTRACINGC_SPAN_HAS(&old_span, set_tags));
+    opentracing_span_set_tags(&old_span, tags, 3);
+    assert(num_set_tag_calls == 3);
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+}
+
+static void test_vtable_header(void)
+{
+    opentracing_tracer* tracer;
+    opentracing_tracer old_tracer;
+    opentracing_span* span;
+
+    tracer = opentracing_global_tracer();
+    assert(tracer->header.size == sizeof(opentracing_tracer));
+    assert(tracer->header.version == OPENTRACINGC_VTABLE_VERSION);
+    assert(OPENTRACINGC_TRACER_HAS(tracer, extract_custom));
+    span = tracer->start_span(tracer, "test");
+    assert(OPENTRACINGC_SPAN_HAS(span, tracer));
+    assert(OPENTRACINGC_SPAN_CONTEXT_HAS(span->span_context(span),
+                                         foreach_baggage_item));
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+
+    /* Implementation built against a layout that ended before
+       inject_text_map. */
+    old_tracer = *tracer;
+    old_tracer.header.size =
+        offsetof(opentracing_tracer, inject_text_map);
+    assert(OPENTRACINGC_TRACER_HAS(&old_tracer, start_span_with_options));
+    assert(!OPENTRACINGC_TRACER_HAS(&old_tracer, inject_text_map));
+
+    /* Present but unset slots are reported as missing. */
+    old_tracer = *tracer;
+    old_tracer.close = NULL;
+    assert(!OPENTRACINGC_TRACER_HAS(&old_tracer, close));
+}
+
+static void test_span_context_retain(void)
+{
+    opentracing_tracer* tracer;
+    opentracing_span* span;
+    opentracing_span_context* span_context;
+    opentracing_span_context old_context;
+
+    /* The noop context is immortal, so it outlives its span. */
+    tracer = opentracing_global_tracer();
+    span = tracer->start_span(tracer, "test");
+    span_context = opentracing_span_context_retain(span->span_context(span));
+    assert(span_context == span->span_context(span));
+    ((opentracing_destructible*) span)
+        ->destroy((opentracing_destructible*) span);
+    opentracing_span_context_release(span_context);
+    opentracing_span_context_release(span_context);
+    opentracing_span_context_release(NULL);
+
+    /* Contexts that cannot be shared report it. */
+    old_context = *span_context;
+    old_context.header.size = offsetof(opentracing_span_context, retain);
+    assert(opentracing_span_context_retain(&old_context) == NULL);
+}
+
 int main(void)
 {
     opentracing_tracer* tracer;
@@ -157,6 +354,12 @@ int main(void)
     opentracing_init_global_tracer(global_tracer);
     assert(opentracing_global_tracer() == global_tracer);
 
+    test_vtable_header();
+    test_span_context_retain();
+    test_batched_fallback();
+    test_concurrent_global_tracer_swap();
+    assert(opentracing_global_tracer() == global_tracer);
+
     global_tracer->close(global_tracer);
 
     return 0;